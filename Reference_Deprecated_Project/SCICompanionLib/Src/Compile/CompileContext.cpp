@@ -91,6 +91,8 @@ void CompileTables::Save()
 {
     _species.Save();
     _selectors.Save();
+    // Compiling may have added new selectors, which should show up in autocomplete.
+    appState->GetClassBrowser().TriggerReloadKernelAndSelectorNames();
 }
 
 CompileResults::CompileResults(ICompileLog &log) : _log(log), _text(CreateDefaultTextResource(appState->GetVersion())) {}
@@ -105,31 +107,24 @@ void CompileContext::_LoadSCO(const std::string &name, bool fErrorIfNotFound)
 {
     assert(!name.empty());
     string scoFileName = appState->GetResourceMap().Helper().GetScriptObjectFileName(name);
-    HANDLE hFile = CreateFile(scoFileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
-    if (hFile == INVALID_HANDLE_VALUE)
+    SCOLoadStatus status;
+    string openError;
+    shared_ptr<const IndexedSCOFile> sco = GetCachedSCO(scoFileName, _tables.Selectors(), status, openError);
+    if (sco)
     {
-        scoFileName = appState->GetResourceMap().Helper().GetScriptObjectFileName(name);
-        hFile = CreateFile(scoFileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
-    }
-    if (hFile != INVALID_HANDLE_VALUE)
-    {
-        sci::streamOwner streamOwner(hFile);
-        CSCOFile scoFile;
-        if (scoFile.Load(streamOwner.getReader(), _tables.Selectors()))
-        {
-            _scos[scoFile.GetScriptNumber()] = scoFile;
-        }
-        else
+        _scos[sco->GetScriptNumber()] = sco;
+        for (auto &nameAndIndex : sco->GetClassIndices())
         {
-            ReportError(_pErrorScript, "'%s' is corrupt.", scoFileName.c_str());
+            _classSpecies.emplace(nameAndIndex.first, sco->GetSCO().GetObjects()[nameAndIndex.second].GetSpecies());
         }
-        CloseHandle(hFile);
+    }
+    else if (status == SCOLoadStatus::Corrupt)
+    {
+        ReportError(_pErrorScript, "'%s' is corrupt.", scoFileName.c_str());
     }
     else if (fErrorIfNotFound)
     {
-        char szError[200];
-        FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM, 0, GetLastError(), 0, szError, ARRAYSIZE(szError), nullptr);
-        ReportError(_pErrorScript, "Unable to open '%s': %s", scoFileName.c_str(), szError);
+        ReportError(_pErrorScript, "Unable to open '%s': %s", scoFileName.c_str(), openError.c_str());
     }
 }
 
@@ -137,8 +132,7 @@ void CompileContext::_LoadSCO(const std::string &name, bool fErrorIfNotFound)
 // Doesn't produce an error if we can't get one.  (Maybe it should?)
 void CompileContext::_LoadSCOIfNone(WORD wScript)
 {
-    WordSCOMap::iterator iter = _scos.find(wScript);
-    if ((iter == _scos.end()) || (iter->second.IsEmpty()))
+    if (_scos.find(wScript) == _scos.end())
     {
         assert((wScript != _wScriptNumber) && (_wScriptNumber != InvalidResourceNumber)); // The "this" script should always be found.
         std::string scriptName = _numberToNameMap[wScript];
@@ -152,9 +146,21 @@ void CompileContext::_LoadSCOIfNone(WORD wScript)
         {
             _LoadSCO(scriptName);
         }
+        // Remember that we tried, so we don't go to disk again.
+        _scos.emplace(wScript, nullptr);
     }
 }
 
+const CSCOFile *CompileContext::_GetSCO(WORD wScript)
+{
+    if ((wScript == _wScriptNumber) && (wScript != InvalidResourceNumber))
+    {
+        return &_scriptSCO;
+    }
+    auto it = _scos.find(wScript);
+    return ((it != _scos.end()) && it->second) ? &it->second->GetSCO() : nullptr;
+}
+
 const uint16_t TempTokenBase = 2345;
 
 CompileContext::CompileContext(SCIVersion version, Script &script, PrecompiledHeaders &headers, CompileTables &tables, ICompileLog &results, bool generateDebugInfo) :
@@ -349,7 +355,8 @@ ResolvedToken CompileContext::LookupToken(const SyntaxNode *pNodeForError, const
         {
             // ResolvedToken::GlobalVariable
             // Keep going - check for global vars (script 0)
-            if (_scos[0].GetVariableIndex(str, wIndex)) // May not have a main - that's ok, this will create a dummy empty one.
+            const CSCOFile *mainSCO = _GetSCO(0); // May not have a main - that's ok.
+            if (mainSCO && mainSCO->GetVariableIndex(str, wIndex))
             {
                 dataType = DataTypeAny;
                 tokenType = ResolvedToken::GlobalVariable;
@@ -418,13 +425,15 @@ bool CompileContext::LookupSpeciesIndex(const string &str, SpeciesIndex &wSpecie
 {
     // Check the scoFiles for this class. We used to check the index of the class in the sco file, then
     // reference the global class table to find the species#. No need for that though.
-    for (WordSCOMap::value_type &p : _scos)
+    if (_scriptSCO.GetClassSpecies(str, wSpeciesIndex))
     {
-        CSCOFile &scoFile = p.second;
-        if (scoFile.GetClassSpecies(str, wSpeciesIndex))
-        {
-            return true;
-        }
+        return true;
+    }
+    auto it = _classSpecies.find(str);
+    if (it != _classSpecies.end())
+    {
+        wSpeciesIndex = it->second;
+        return true;
     }
     return false;
 }
@@ -464,10 +473,16 @@ std::string CompileContext::SpeciesIndexToDataTypeString(SpeciesIndex wSpeciesIn
         WORD wScript, wClassIndexInScript;
         if (_tables.Species().GetSpeciesLocation(wSpeciesIndex, wScript, wClassIndexInScript))
         {
-            _LoadSCOIfNone(wScript);
-            CSCOFile &scoFile = _scos[wScript];
-            // Find the name.
-            dataType = scoFile.GetClassName(wClassIndexInScript);
+            if (wScript != _wScriptNumber)
+            {
+                _LoadSCOIfNone(wScript);
+            }
+            const CSCOFile *scoFile = _GetSCO(wScript);
+            if (scoFile)
+            {
+                // Find the name.
+                dataType = scoFile->GetClassName(wClassIndexInScript);
+            }
         }
     }
  
@@ -480,10 +495,11 @@ std::string CompileContext::SpeciesIndexToDataTypeString(SpeciesIndex wSpeciesIn
 SpeciesIndex CompileContext::GetSpeciesSuperClass(SpeciesIndex wSpeciesIndex)
 {
     SpeciesIndex ret = DataTypeNone;
-    CSCOObjectClass object;
-    if (_GetSCOObject(wSpeciesIndex, object))
+    WORD wScript;
+    const CSCOObjectClass *object = _GetSCOObject(wSpeciesIndex, wScript);
+    if (object)
     {
-        ret = object.GetSuperClass();
+        ret = object->GetSuperClass();
     }
     return ret;
 }
@@ -515,20 +531,29 @@ vector<species_property> CompileContext::GetSpeciesProperties(const string &spec
     if (!speciesNames.empty())
     {
         // Find the scofile that contains this species.
-        for (WordSCOMap::value_type &p : _scos)
+        const CSCOObjectClass *pClass = nullptr;
+        if (!_scriptSCO.GetClass(speciesNames, &pClass))
         {
-            CSCOFile &scoFile = p.second;
-            const CSCOObjectClass *pClass = nullptr;
-            if (scoFile.GetClass(speciesNames, &pClass))
+            for (WordSCOMap::value_type &p : _scos)
             {
-                // We have the class.
-                const vector<CSCOObjectProperty> &properties = pClass->GetProperties();
-                for (auto &theProp : properties)
+                if (p.second && (p.first != _wScriptNumber))
                 {
-                    species_property specProp = { theProp.GetSelector(), theProp.GetValue(), DataTypeAny, false };
-                    propertiesRet.push_back(specProp);
+                    pClass = p.second->GetClass(speciesNames);
+                    if (pClass)
+                    {
+                        break;
+                    }
                 }
-                break;
+            }
+        }
+        if (pClass)
+        {
+            // We have the class.
+            const vector<CSCOObjectProperty> &properties = pClass->GetProperties();
+            for (auto &theProp : properties)
+            {
+                species_property specProp = { theProp.GetSelector(), theProp.GetValue(), DataTypeAny, false };
+                propertiesRet.push_back(specProp);
             }
         }
     }
@@ -605,7 +630,8 @@ ProcedureType CompileContext::LookupProc(const string &str, WORD &wScript, WORD
         else
         {
             // Then main
-            if (_scos[0].GetExportIndex(str, wIndex))
+            const CSCOFile *mainSCO = _GetSCO(0);
+            if (mainSCO && mainSCO->GetExportIndex(str, wIndex))
             {
                 // Found a proc in main.
                 type = ProcedureMain;
@@ -614,13 +640,17 @@ ProcedureType CompileContext::LookupProc(const string &str, WORD &wScript, WORD
             else
             {
                 // Then other sco files.
+                if (_scriptSCO.GetExportIndex(str, wIndex))
+                {
+                    wScript = _scriptSCO.GetScriptNumber();
+                    type = ProcedureExternal;
+                }
                 for (WordSCOMap::value_type &p : _scos)
                 {
-                    CSCOFile &scoFile = p.second;
-                    if (scoFile.GetExportIndex(str, wIndex))
+                    if (p.second && (p.first != _wScriptNumber) && p.second->GetSCO().GetExportIndex(str, wIndex))
                     {
                         // Found it.
-                        wScript = scoFile.GetScriptNumber();
+                        wScript = p.second->GetScriptNumber();
                         type = ProcedureExternal;
                     }
                 }
@@ -662,31 +692,116 @@ ProcedureType CompileContext::LookupProc(const std::string &str)
     string classOwner;
     return LookupProc(str, wScript, wIndex, classOwner);
 }
-bool CompileContext::_GetSCOObject(SpeciesIndex wSpecies, CSCOObjectClass &scoObject)
+const CSCOObjectClass *CompileContext::_GetSCOObject(SpeciesIndex wSpecies, WORD &wScript)
 {
-    bool fRet = false;
     if (!IsPODType(wSpecies))
     {
-        WORD wScript, wClassIndexInScript;
+        WORD wClassIndexInScript;
         if (_tables.Species().GetSpeciesLocation(wSpecies, wScript, wClassIndexInScript))
         {
+            if (wScript == _wScriptNumber)
+            {
+                for (const CSCOObjectClass &theClass : _scriptSCO.GetObjects())
+                {
+                    if (theClass.GetSpecies() == wSpecies)
+                    {
+                        return &theClass;
+                    }
+                }
+                return nullptr;
+            }
             _LoadSCOIfNone(wScript);
-            CSCOFile &scoFile = _scos[wScript];
-            scoObject = scoFile.GetObjectBySpecies(wSpecies);
-            fRet = true;
+            const shared_ptr<const IndexedSCOFile> &scoFile = _scos[wScript];
+            return scoFile ? scoFile->GetClassBySpecies(wSpecies) : nullptr;
         }
     }
-    return fRet;
+    return nullptr;
 }
+
+// Returns the selectors understood by a class, including its superclasses'. These are shared between compiles
+// until one of the .sco files they came from changes. Returns null if the class (or one of its superclasses)
+// is in the script we're compiling, since those are still changing.
+std::shared_ptr<const SCOClassSelectors> CompileContext::_GetClassSelectors(SpeciesIndex wSpecies)
+{
+    shared_ptr<const SCOClassSelectors> cached = GetCachedClassSelectors(wSpecies);
+    if (cached)
+    {
+        bool current = true;
+        for (auto &source : cached->Sources)
+        {
+            if (source.first == _wScriptNumber)
+            {
+                return nullptr;
+            }
+            _LoadSCOIfNone(source.first);
+            if (_scos[source.first] != source.second)
+            {
+                current = false;
+                break;
+            }
+        }
+        if (current)
+        {
+            return cached;
+        }
+    }
+
+    shared_ptr<SCOClassSelectors> selectors = make_shared<SCOClassSelectors>();
+    SpeciesIndex wCallee = wSpecies;
+    WORD wScript;
+    const CSCOObjectClass *object;
+    while ((object = _GetSCOObject(wCallee, wScript)) != nullptr)
+    {
+        if (wScript == _wScriptNumber)
+        {
+            return nullptr;
+        }
+        selectors->Sources.emplace_back(wScript, _scos[wScript]);
+        // Methods take precedence over properties, and subclasses over superclasses.
+        for (uint16_t method : object->GetMethods())
+        {
+            selectors->Selectors.emplace(method, true);
+        }
+        for (const CSCOObjectProperty &property : object->GetProperties())
+        {
+            selectors->Selectors.emplace(property.GetSelector(), false);
+        }
+        wCallee = object->GetSuperClass(); // Try the super class
+    }
+    if (selectors->Sources.empty())
+    {
+        return nullptr;
+    }
+    CacheClassSelectors(wSpecies, selectors);
+    return selectors;
+}
+
 bool CompileContext::LookupSpeciesMethodOrProperty(SpeciesIndex wCallee, WORD wSelector, SpeciesIndex &propertyType, bool &fMethod)
 {
     bool fRet = false;
     fMethod = false;
-    // Find the CSCOObject for wCallee.
-    CSCOObjectClass object;
-    while (!fRet && _GetSCOObject(wCallee, object))
+    shared_ptr<const SCOClassSelectors> selectors = _GetClassSelectors(wCallee);
+    if (selectors)
+    {
+        auto it = selectors->Selectors.find(wSelector);
+        fRet = (it != selectors->Selectors.end());
+        if (fRet)
+        {
+            fMethod = it->second;
+            if (!fMethod)
+            {
+                propertyType = DataTypeAny;
+            }
+        }
+        return fRet;
+    }
+
+    // The class hierarchy includes classes from this script, so walk it.
+    WORD wScript;
+    const CSCOObjectClass *object;
+    while (!fRet && ((object = _GetSCOObject(wCallee, wScript)) != nullptr))
     {
-        for(uint16_t method : object.GetMethods())
+        for(uint16_t method : object->GetMethods())
         {
             fRet = (method == wSelector);
             if (fRet)
@@ -697,7 +812,7 @@ bool CompileContext::LookupSpeciesMethodOrProperty(SpeciesIndex wCallee, WORD wS
         }
         if (!fRet)
         {
-            for(const CSCOObjectProperty &property : object.GetProperties())
+            for(const CSCOObjectProperty &property : object->GetProperties())
             {
                 fRet = (property.GetSelector() == wSelector);
                 if (fRet)
@@ -707,7 +822,7 @@ bool CompileContext::LookupSpeciesMethodOrProperty(SpeciesIndex wCallee, WORD wS
                 }
             }
         }
-        wCallee = object.GetSuperClass(); // Try the super class
+        wCallee = object->GetSuperClass(); // Try the super class
     }
     return fRet;
 }
@@ -1048,7 +1163,7 @@ void CompileContext::SetScriptNumber()
     {
         ReportError(&_script, "Script number must be less than %d: %d", _version.GetMaximumResourceNumber(), _wScriptNumber);
     }
-    _scos[_wScriptNumber].SetScriptNumber(_wScriptNumber);
+    _scriptSCO.SetScriptNumber(_wScriptNumber);
 }
 WORD CompileContext::EnsureSpeciesTableEntry(WORD wIndexInScript)
 {
@@ -1071,25 +1186,25 @@ void CompileContext::AddSCOClass(CSCOObjectClass scoClass, bool fInstance)
     else
     {
         assert(_wScriptNumber != InvalidResourceNumber);
-        assert(_scos[_wScriptNumber].GetScriptNumber() != 0xffff); // Script number not supplied yet.
-        _scos[_wScriptNumber].AddObject(scoClass);
+        assert(_scriptSCO.GetScriptNumber() != 0xffff); // Script number not supplied yet.
+        _scriptSCO.AddObject(scoClass);
     }
 }
 void CompileContext::ReplaceSCOClass(CSCOObjectClass scoClass)
 {
     // This is a bit of a hack.
     assert(_wScriptNumber != InvalidResourceNumber);
-    _scos[_wScriptNumber].ReplaceObject(scoClass);
+    _scriptSCO.ReplaceObject(scoClass);
 }
 void CompileContext::AddSCOVariable(CSCOLocalVariable scoVar)
 {
     assert(_wScriptNumber != InvalidResourceNumber);
-    _scos[_wScriptNumber].AddVariable(scoVar);
+    _scriptSCO.AddVariable(scoVar);
 }
 void CompileContext::AddSCOPublics(CSCOPublicExport scoPublic)
 {
     assert(_wScriptNumber != InvalidResourceNumber);
-    _scos[_wScriptNumber].AddPublic(scoPublic);
+    _scriptSCO.AddPublic(scoPublic);
 }
 std::vector<CSCOObjectClass> &CompileContext::GetInstanceSCOs()
 {
@@ -1098,7 +1213,7 @@ std::vector<CSCOObjectClass> &CompileContext::GetInstanceSCOs()
 CSCOFile &CompileContext::GetScriptSCO()
 {
     assert(_wScriptNumber != InvalidResourceNumber);
-    return _scos[_wScriptNumber];
+    return _scriptSCO;
 }
 std::string CompileContext::LookupSelectorName(WORD wIndex) const
 {
@@ -15,6 +15,7 @@
 
 #include "scii.h"
 #include "SCO.h"
+#include "SCOCache.h"
 #include "Vocab000.h"
 #include "Vocab99x.h"
 #include "ScriptOMSmall.h"
@@ -198,8 +199,13 @@ private:
     sci::Script &_script;       // Script being compiled
     sci::Script *_pErrorScript;  // Current script used for error reporting (could be header file)
 
-    typedef std::unordered_map<WORD, CSCOFile> WordSCOMap;
+    // The .sco files of other scripts, shared with other compiles. Null if we failed to load it.
+    typedef std::unordered_map<WORD, std::shared_ptr<const IndexedSCOFile>> WordSCOMap;
     WordSCOMap _scos;
+    // Class names from all the .sco files in _scos, to their species.
+    std::unordered_map<std::string, SpeciesIndex> _classSpecies;
+    // The .sco for the script being compiled, which is built up as we go.
+    CSCOFile _scriptSCO;
     std::unordered_map<WORD, std::string> _numberToNameMap;
     std::vector<CSCOObjectClass> _instances;
     WORD _wScriptNumber;
@@ -218,6 +224,9 @@ private:
     // Loads an SCOFile if we don't already have one for this script.
     // Doesn't produce an error if we can't get one.  (Maybe it should?)
     void _LoadSCOIfNone(WORD wScript);
+    // Returns the .sco for a script, or null if it isn't loaded. The script being compiled is included.
+    const CSCOFile *_GetSCO(WORD wScript);
+    std::shared_ptr<const SCOClassSelectors> _GetClassSelectors(SpeciesIndex wSpecies);
 
     bool _WasSinkWritten(uint16_t tempToken);
 
@@ -263,7 +272,8 @@ public:
     // pSignatures - optional: accepts the list of function signatures for this call.
     ProcedureType LookupProc(const std::string &str, WORD &wScript, WORD &wIndex, std::string &classOwner);
     ProcedureType LookupProc(const std::string &str);
-    bool _GetSCOObject(SpeciesIndex wSpecies, CSCOObjectClass &scoObject);
+    // Returns null if the species isn't a class we know about. wScript gets the script it is in.
+    const CSCOObjectClass *_GetSCOObject(SpeciesIndex wSpecies, WORD &wScript);
     bool LookupSpeciesMethodOrProperty(SpeciesIndex wCallee, WORD wSelector, SpeciesIndex &propertyType, bool &fMethod);
     void PushOutputContext(OutputContext outputContext);
     void PopOutputContext();
@@ -395,8 +395,6 @@ bool IsNotAllowedAsPredecessor(code_pos pos)
     return pos->get_opcode() == Opcode::JMP || pos->get_opcode() == Opcode::RET;
 }
 
-int debugIndex = 1;
-
 ControlFlowNode *_GetFirstPredecessorOrNull(ControlFlowNode *node)
 {
     return node->Predecessors().empty() ? nullptr : *node->Predecessors().begin();
@@ -440,7 +438,7 @@ void ControlFlowGraph::_IdentifySwitchCases(ControlFlowNode *switchNodeIn)
     // Now we need to find the case tails and collect the nodes between head/tail. Then create the case nodes
     // We can look at the toss predecessors and see which ones are dominated by which cases.
     // Nope, that is actually not sufficient. The first case node dominate ALL toss preds.
-    DominatorMap dominators = GenerateDominators(switchNodeIn, switchHead);
+    const DominatorMap &dominators = GenerateDominators(switchNodeIn, switchHead);
     NodeSet caseNodes;
     for (ControlFlowNode *caseHead : caseHeads)
     {
@@ -635,7 +633,7 @@ ControlFlowNode *ControlFlowGraph::_ProcessNaturalLoop(ControlFlowGraph &loopDet
     // Now let's collect more children. Any predecessors of the child who are dominated by our header node should be included.
     // This will collect things like breaks, etc... that were not collected when we went from the latch node to the header to
     // collect children.
-    DominatorMap dominators = GenerateDominators(parent, (*parent)[SemId::Head]);
+    const DominatorMap &dominators = GenerateDominators(parent, (*parent)[SemId::Head]);
     CollectMoreChildren(loopNode, dominators);
 
     loopDetection._ReplaceNodeInWorkingSet(parent, loopNode);
@@ -671,7 +669,7 @@ ControlFlowNode *ControlFlowGraph::_ProcessSwitch(ControlFlowGraph &loopDetectio
     return switchNode;
 }
 
-vector<NodeBlock> ControlFlowGraph::_FindSwitchBlocks(DominatorMap &dominators, DominatorMap &postDominators, ControlFlowNode *structure)
+vector<NodeBlock> ControlFlowGraph::_FindSwitchBlocks(const DominatorMap &dominators, const DominatorMap &postDominators, ControlFlowNode *structure)
 {
     ControlFlowNode *header = (*structure)[SemId::Head];
     const NodeSet &allNodes = structure->Children();
@@ -1216,7 +1214,7 @@ void ControlFlowGraph::_FindCompoundConditions(ControlFlowNode *structure)
     }
 }
 
-vector<NodeBlock> _FindBackEdges(DominatorMap &dominators, DominatorMap &postDominators, ControlFlowNode *structure)
+vector<NodeBlock> _FindBackEdges(const DominatorMap &dominators, const DominatorMap &postDominators, ControlFlowNode *structure)
 {
     map<ControlFlowNode*, ControlFlowNode*> immediatePostDominators = CalculateImmediatePostDominators(postDominators);
 
@@ -1344,7 +1342,7 @@ vector<ControlFlowNode*> _GetPostOrder(ControlFlowNode *structure)
     return ordered;
 }
 
-ControlFlowNode *_FindMaxNodeDominatedByMWithTwoOrMoreInEdges(DominatorMap &dominators, const map<ControlFlowNode*, ControlFlowNode*> &immediateDominators, vector<ControlFlowNode*> &postOrdered, ControlFlowNode *m, ControlFlowNode *dontGoBeyondThis)
+ControlFlowNode *_FindMaxNodeDominatedByMWithTwoOrMoreInEdges(const DominatorMap &dominators, const map<ControlFlowNode*, ControlFlowNode*> &immediateDominators, vector<ControlFlowNode*> &postOrdered, ControlFlowNode *m, ControlFlowNode *dontGoBeyondThis)
 {
     auto endIt = find(postOrdered.begin(), postOrdered.end(), dontGoBeyondThis);
     auto it = postOrdered.begin();
@@ -1354,7 +1352,7 @@ ControlFlowNode *_FindMaxNodeDominatedByMWithTwoOrMoreInEdges(DominatorMap &domi
         ControlFlowNode *possibleFollow = *it;
         if (possibleFollow->Predecessors().size() >= 2)
         {
-            NodeSet &dominatorsForNode = dominators.at(possibleFollow);
+            const NodeSet &dominatorsForNode = dominators.at(possibleFollow);
             if (dominatorsForNode.contains(m))
             {
                 if (immediateDominators.at(possibleFollow) == m)
@@ -1378,7 +1376,7 @@ void ControlFlowGraph::_FindAllIfStatements()
     // We discover structures from the most inner to the most outer (in this particular call of the function)
     for (ControlFlowNode *structure : controlStructuresCopy)
     {
-        DominatorMap dominators = GenerateDominators(structure, (*structure)[SemId::Head]);
+        const DominatorMap &dominators = GenerateDominators(structure, (*structure)[SemId::Head]);
         _FindIfStatements(dominators, structure);
         if (_decompilerResults.IsAborted())
         {
@@ -1412,7 +1410,7 @@ ControlFlowNode *_GetTrueLoopLatchOrHead(ControlFlowNode *loop)
     return nullptr;
 }
 
-void ControlFlowGraph::_FindIfStatements(DominatorMap &dominators, ControlFlowNode *structure)
+void ControlFlowGraph::_FindIfStatements(const DominatorMap &dominators, ControlFlowNode *structure)
 {
     if ((structure->Type == CFGNodeType::CompoundCondition) || (structure->Type == CFGNodeType::Switch) || (structure->Type == CFGNodeType::Invert))
     {
@@ -1847,7 +1845,7 @@ bool ControlFlowGraph::Generate(code_pos start, code_pos end)
         // so maybe it causes no problems). The nodes being pruned really have no chance of affecting code.
         _PruneDegenerateNodes(main);
 
-        DominatorMap dominators = GenerateDominators(main, (*main)[SemId::Head]);
+        const DominatorMap &dominators = GenerateDominators(main, (*main)[SemId::Head]);
 
         if (showFile)
         {
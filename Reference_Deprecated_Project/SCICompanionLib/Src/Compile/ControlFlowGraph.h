@@ -29,7 +29,7 @@ struct NodeBlock
 class ControlFlowGraph
 {
 public:
-    ControlFlowGraph(const std::string &statusMessagePrefix, IDecompilerResults &decompilerResults, const std::string &contextName, bool allowContinues, bool debug, PCSTR pszDebugFilter) : _decompilerResults(decompilerResults), _contextName(contextName), _statusMessagePrefix(statusMessagePrefix), _debug(debug), _pszDebugFilter(pszDebugFilter), _allowContinues(allowContinues) {}
+    ControlFlowGraph(const std::string &statusMessagePrefix, IDecompilerResults &decompilerResults, const std::string &contextName, bool allowContinues, bool debug, PCSTR pszDebugFilter) : _decompilerResults(decompilerResults), _contextName(contextName), _statusMessagePrefix(statusMessagePrefix), _debug(debug), _pszDebugFilter(pszDebugFilter), _allowContinues(allowContinues), _nextDebugIndex(1) {}
     ControlFlowGraph(const ControlFlowGraph &src) = delete;
     ControlFlowGraph& operator=(const ControlFlowGraph &src) = delete;
 
@@ -44,7 +44,7 @@ public:
         unique_ptr<_TNode> newNode = std::make_unique<_TNode>(args...);
         _TNode *ret = newNode.get();
         nodesOwner.push_back(move(newNode));
-        ret->ArbitraryDebugIndex = debugIndex++;
+        ret->ArbitraryDebugIndex = _nextDebugIndex++;
         discoveredControlStructures.insert(ret);
         return ret;
     }
@@ -55,7 +55,7 @@ public:
         unique_ptr<_TNode> newNode = std::make_unique<_TNode>(args...);
         _TNode *ret = newNode.get();
         nodesOwner.push_back(move(newNode));
-        ret->ArbitraryDebugIndex = debugIndex++;
+        ret->ArbitraryDebugIndex = _nextDebugIndex++;
         return ret;
     }
 
@@ -77,13 +77,13 @@ private:
     void _DoLoopTransform(ControlFlowNode *loop);
     void _FindCompoundConditions(ControlFlowNode *structure);
     void _FindAllIfStatements();
-    void _FindIfStatements(DominatorMap &dominators, ControlFlowNode *structure);
+    void _FindIfStatements(const DominatorMap &dominators, ControlFlowNode *structure);
     ControlFlowNode *_PartitionCode(code_pos start, code_pos end);
     ControlFlowNode *_FindFollowNodeForStructure(ControlFlowNode *structure);
 
     static ControlFlowNode *_ProcessNaturalLoop(ControlFlowGraph &loopDetection, ControlFlowNode *parent, const NodeBlock &backEdge);
     static ControlFlowNode *_ProcessSwitch(ControlFlowGraph &loopDetection, ControlFlowNode *parent, NodeBlock &switchBlock);
-    static std::vector<NodeBlock> _FindSwitchBlocks(DominatorMap &dominators, DominatorMap &postDominators, ControlFlowNode *structure);
+    static std::vector<NodeBlock> _FindSwitchBlocks(const DominatorMap &dominators, const DominatorMap &postDominators, ControlFlowNode *structure);
 
     template<typename FuncFindBlocks, typename PossiblyRearrangeAndProceed, typename ProcessBlock>
     void _FindAllStructuresOf(FuncFindBlocks findBlocks, PossiblyRearrangeAndProceed possiblyRearrangeAndProceed, ProcessBlock processBlock)
@@ -99,9 +99,9 @@ private:
             do
             {
                 // 1) calculate dominators
-                DominatorMap dominators = GenerateDominators(structure, (*structure)[SemId::Head]);
+                const DominatorMap &dominators = GenerateDominators(structure, (*structure)[SemId::Head]);
                 assert(structure->MaybeGet(SemId::Tail));
-                DominatorMap postDominators = GeneratePostDominators(structure, (*structure)[SemId::Tail]);
+                const DominatorMap &postDominators = GeneratePostDominators(structure, (*structure)[SemId::Tail]);
 
                 // 2) Find the head/tail of the constructs we're looking for (e.g. for switch: toss nodes, and follow them back to a dominator, bounding the switch statement).
                 blocks = findBlocks(dominators, postDominators, structure);
@@ -161,4 +161,6 @@ private:
 
     bool _debug;
     PCSTR _pszDebugFilter;
+    // Per graph, since several scripts can be decompiled at once.
+    int _nextDebugIndex;
 };
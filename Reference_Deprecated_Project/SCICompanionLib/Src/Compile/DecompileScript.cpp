@@ -373,7 +373,7 @@ private:
     const IDecompilerConfig &_config;
 };
 
-Script *Decompile(const GameFolderHelper &helper, const CompiledScript &compiledScript, DecompileLookups &lookups, const Vocab000 *pWords)
+Script *DecompileCode(const GameFolderHelper &helper, const CompiledScript &compiledScript, DecompileLookups &lookups, const Vocab000 *pWords, map<int, string> &exportSlotToName)
 {
     unique_ptr<Script> pScript = std::make_unique<Script>();
     pScript->SyntaxVersion = 2;
@@ -448,8 +448,6 @@ Script *Decompile(const GameFolderHelper &helper, const CompiledScript &compiled
         }
     }
 
-    map<int, string> exportSlotToName;
-
     // Now the exported procedures.
     for (size_t i = 0; i < compiledScript._exportsTO.size() && !lookups.DecompileResults().IsAborted(); i++)
     {
@@ -497,10 +495,15 @@ Script *Decompile(const GameFolderHelper &helper, const CompiledScript &compiled
         DecompileFunction(compiledScript, *pProc, lookups, offset, codePointersTO);
         pScript->AddProcedure(std::move(pProc));
     }
+    return pScript.release();
+}
 
+bool FinishDecompile(const GameFolderHelper &helper, const CompiledScript &compiledScript, DecompileLookups &lookups, Script &script, const map<int, string> &exportSlotToName)
+{
+    bool mainUpdated = false;
     if (!lookups.DecompileResults().IsAborted())
     {
-        AddLocalVariablesToScript(*pScript, compiledScript, lookups, compiledScript._localVars);
+        AddLocalVariablesToScript(script, compiledScript, lookups, compiledScript._localVars);
 
         // Load this script's SCO, and main's SCO (assuming this isn't main)
         unique_ptr<CSCOFile> mainSCO;
@@ -511,31 +514,31 @@ Script *Decompile(const GameFolderHelper &helper, const CompiledScript &compiled
         unique_ptr<CSCOFile> oldScriptSCO = GetExistingSCOFromScriptNumber(helper, compiledScript.GetScriptNumber(), lookups.GetSelectorTable());
 
         vector<pair<string, string>> mainDirtyRenames;
-        AutoDetectVariableNames(*pScript, lookups.GetDecompilerConfig(), mainSCO.get(), oldScriptSCO.get(), mainDirtyRenames);
+        AutoDetectVariableNames(script, lookups.GetDecompilerConfig(), mainSCO.get(), oldScriptSCO.get(), mainDirtyRenames);
 
-        ResolvePublicProcedureCalls(lookups, helper, *pScript, compiledScript);
+        ResolvePublicProcedureCalls(lookups, helper, script, compiledScript);
 
-        MassageProcedureCalls(lookups, *pScript);
+        MassageProcedureCalls(lookups, script);
 
         if (lookups.GetDecompilerConfig())
         {
             ResolveVariableValues resolveVariableValues(*lookups.GetDecompilerConfig());
-            pScript->Traverse(resolveVariableValues);
+            script.Traverse(resolveVariableValues);
         }
 
-        InsertHeaders(*pScript);
+        InsertHeaders(script);
 
-        DetermineAndInsertUsings(helper, *pScript, lookups);
+        DetermineAndInsertUsings(helper, script, lookups);
 
         for (auto &pair : exportSlotToName)
         {
             unique_ptr<ExportEntry> entry = make_unique<ExportEntry>(pair.first, pair.second);
-            pScript->GetExports().push_back(move(entry));
+            script.GetExports().push_back(move(entry));
         }
 
         // Decompiling always generates an SCO. Any pertinent info from the old SCO should be transfered
         // to the new one based extracting info from the script.
-        std::unique_ptr<CSCOFile> scoFile = SCOFromScriptAndCompiledScript(*pScript, compiledScript);
+        std::unique_ptr<CSCOFile> scoFile = SCOFromScriptAndCompiledScript(script, compiledScript);
         SaveSCOFile(helper, *scoFile);
 
         // We may have added some global info to main's SCO. Save that now.
@@ -544,7 +547,8 @@ Script *Decompile(const GameFolderHelper &helper, const CompiledScript &compiled
             lookups.DecompileResults().AddResult(DecompilerResultType::Important, "Updating global variables in script 0");
             lookups.DecompileResults().SetGlobalVarsUpdated(mainDirtyRenames);
             SaveSCOFile(helper, *mainSCO);
+            mainUpdated = true;
         }
     }
-    return pScript.release();
+    return mainUpdated;
 }
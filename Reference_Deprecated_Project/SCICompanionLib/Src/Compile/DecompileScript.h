@@ -22,4 +22,11 @@ class DecompileLookups;
 class ILookupNames;
 class GameFolderHelper;
 struct Vocab000;
-sci::Script *Decompile(const GameFolderHelper &helper, const CompiledScript &compiledScript, DecompileLookups &lookups, const Vocab000 *pWords);
\ No newline at end of file
+
+// Decompiling a script is done in two steps. DecompileCode only depends on the script itself (and on
+// the existing .sco files), so it can be run for several scripts at once.
+// FinishDecompile generates and saves the script's .sco file (and possibly main's), which other scripts
+// depend on, so it should be called one script at a time. It returns true if it updated main's global
+// variable names, which DecompileCode uses for any scripts after this one.
+sci::Script *DecompileCode(const GameFolderHelper &helper, const CompiledScript &compiledScript, DecompileLookups &lookups, const Vocab000 *pWords, std::map<int, std::string> &exportSlotToName);
+bool FinishDecompile(const GameFolderHelper &helper, const CompiledScript &compiledScript, DecompileLookups &lookups, sci::Script &script, const std::map<int, std::string> &exportSlotToName);
\ No newline at end of file
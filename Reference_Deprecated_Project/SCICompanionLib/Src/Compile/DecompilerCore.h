@@ -259,3 +259,6 @@ class IDecompilerResults;
 class GameFolderHelper;
 class GlobalCompiledScriptLookups;
 std::unique_ptr<sci::Script> DecompileScript(const IDecompilerConfig *config, GlobalCompiledScriptLookups &scriptLookups, const GameFolderHelper &helper, uint16_t wScript, CompiledScript &compiledScript, IDecompilerResults &results, bool debugControlFlow = false, bool debugInstConsumption = false, PCSTR pszDebugFilter = nullptr, bool decompileAsm = false, bool substituteTextTuples = false);
+// Decompiles several scripts, with their code decompiled on up to workerCount threads. onScriptDecompiled is
+// called for each script on the calling thread, in script number order. The results don't depend on workerCount.
+void DecompileScripts(const IDecompilerConfig *config, GlobalCompiledScriptLookups &scriptLookups, const GameFolderHelper &helper, const std::set<uint16_t> &scriptNumbers, IDecompilerResults &results, unsigned int workerCount, std::function<void(uint16_t, sci::Script &)> onScriptDecompiled, bool debugControlFlow = false, bool debugInstConsumption = false, PCSTR pszDebugFilter = nullptr, bool decompileAsm = false, bool substituteTextTuples = false);
@@ -21,6 +21,7 @@
 #include "DecompilerResults.h"
 #include "PMachine.h"
 #include "Operators.h"
+#include <atomic>
 
 // Lifting assignments out of condtionals still has some issues. It causes some decompilations to fail,
 // for instance Motion::init in the 1990 VGA Christmas Card Demo.
@@ -922,7 +923,7 @@ void _ApplyChildren(ConsumptionNode &node, StatementsNode &statementsNode, Decom
     }
 }
 
-int g_negated = 0;
+std::atomic<int> g_negated(0);   // Several scripts can be decompiled at once
 
 std::unique_ptr<SyntaxNode> _CodeNodeToSyntaxNode2(ConsumptionNode &node, DecompileLookups &lookups)
 {
@@ -9,6 +9,13 @@ const ParseACChannels BlockAllChannels =
 
 const ParseACChannels NoChannels = 0;
 
+// Like BlockAllChannels, but with said strings on the first one.
+const ParseACChannels SaidStringChannels =
+    ((uint32_t)ParseAutoCompleteContext::SaidString) |
+    ((uint32_t)ParseAutoCompleteContext::Block << 8) |
+    ((uint32_t)ParseAutoCompleteContext::Block << 16) |
+    ((uint32_t)ParseAutoCompleteContext::Block << 24);
+
 ParseAutoCompleteContext ExtractChannel(ParseACChannels data, ParseAutoCompleteChannel channel)
 {
     assert(channel != ParseAutoCompleteChannel::All);
@@ -34,6 +34,7 @@ enum class ParseAutoCompleteContext : uint8_t
     StartStatementExtras, // If, cond, repeat, while, etc.... Also procedure and kernel names.
     Rest,               // Special: &rest is ok.
     Else,
+    SaidString,         // Inside a said string: vocab words.
 
     Block               // Use this in parsing in order to block searching up the context stack.
 };
@@ -51,6 +52,7 @@ typedef uint32_t ParseACChannels;
 
 extern const ParseACChannels BlockAllChannels;
 extern const ParseACChannels NoChannels;
+extern const ParseACChannels SaidStringChannels;
 
 ParseAutoCompleteContext ExtractChannel(ParseACChannels data, ParseAutoCompleteChannel channel);
 ParseACChannels SetChannel(ParseACChannels existing, ParseAutoCompleteChannel channel, ParseAutoCompleteContext ac);
@@ -0,0 +1,70 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "ParsedScriptCache.h"
+#include "ScriptOM.h"
+
+using namespace std;
+
+namespace
+{
+    struct ParsedScript
+    {
+        FileStamp Stamp;
+        shared_ptr<sci::Script> Script;
+    };
+
+    mutex g_parsedScriptsMutex;
+    unordered_map<string, ParsedScript> g_parsedScripts;
+
+    string _GetKey(const ScriptId &scriptId)
+    {
+        string key = scriptId.GetFullPath();
+        transform(key.begin(), key.end(), key.begin(), ::tolower);
+        return key;
+    }
+}
+
+void CacheParsedScript(const ScriptId &scriptId, const FileStamp &stampWhenParsed, std::shared_ptr<sci::Script> script)
+{
+    string key = _GetKey(scriptId);
+    lock_guard<mutex> lock(g_parsedScriptsMutex);
+    ParsedScript &parsed = g_parsedScripts[key];
+    parsed.Stamp = stampWhenParsed;
+    parsed.Script = script;
+}
+
+std::shared_ptr<sci::Script> GetCachedParsedScript(const ScriptId &scriptId)
+{
+    string key = _GetKey(scriptId);
+    FileStamp stamp = GetFileStamp(scriptId.GetFullPath());
+    lock_guard<mutex> lock(g_parsedScriptsMutex);
+    auto it = g_parsedScripts.find(key);
+    if (it != g_parsedScripts.end())
+    {
+        if (stamp.Exists && (it->second.Stamp == stamp))
+        {
+            return it->second.Script;
+        }
+        // Stale
+        g_parsedScripts.erase(it);
+    }
+    return nullptr;
+}
+
+void ClearParsedScriptCache()
+{
+    lock_guard<mutex> lock(g_parsedScriptsMutex);
+    g_parsedScripts.clear();
+}
@@ -0,0 +1,36 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+#include "ResourceSourceCache.h"
+
+namespace sci
+{
+    class Script;
+}
+class ScriptId;
+
+//
+// Holds onto the scripts parsed while compiling, so that things that only need to read a script's
+// source (like validating said strings) don't need to parse it again.
+//
+// Each one is checked against the size and last write time its file had when it was parsed. Note that
+// they have been through the compiler, which resolves defines and so on in place. Said strings and
+// synonyms are left as they were written.
+// Cached scripts must be treated as read-only, since they may be handed to several threads at once.
+//
+void CacheParsedScript(const ScriptId &scriptId, const FileStamp &stampWhenParsed, std::shared_ptr<sci::Script> script);
+// Returns null if the script wasn't cached, or its file has changed since.
+std::shared_ptr<sci::Script> GetCachedParsedScript(const ScriptId &scriptId);
+void ClearParsedScriptCache();
@@ -359,6 +359,16 @@ void FunctionParameterA(MatchResult &match, const _TParser *pParser, SyntaxConte
     }
 }
 
+template<typename _TParser>
+void TopLevelFormCloseA(MatchResult &match, const _TParser *pParser, SyntaxContext *pContext, const streamIt &stream)
+{
+    GeneralE(match, pParser, pContext, stream);
+    if (match.Result())
+    {
+        pContext->RecordTopLevelCheckpoint(stream);
+    }
+}
+
 template<typename _TParser>
 void FunctionCloseA(MatchResult &match, const _TParser *pParser, SyntaxContext *pContext, const streamIt &stream)
 {
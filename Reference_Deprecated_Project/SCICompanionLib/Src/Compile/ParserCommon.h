@@ -259,9 +259,9 @@ public:
 template<typename _TContext>
 struct BlockAllACChannelsGuard
 {
-    BlockAllACChannelsGuard(_TContext *pContext) : _pContext(pContext)
+    BlockAllACChannelsGuard(_TContext *pContext, ParseACChannels channels = BlockAllChannels) : _pContext(pContext)
     {
-        if (_pContext) _pContext->PushParseAutoCompleteContext(BlockAllChannels);
+        if (_pContext) _pContext->PushParseAutoCompleteContext(channels);
     }
     ~BlockAllACChannelsGuard()
     {
@@ -415,7 +415,8 @@ bool _ReadStringStudio(_TContext *pContext, _It &stream, std::string &str)
     str.clear();
     while (Q1 == *stream)
     {
-        BlockAllACChannelsGuard<_TContext> blockGuard(pContext);
+        // Said strings get vocab words for autocomplete.
+        BlockAllACChannelsGuard<_TContext> blockGuard(pContext, (Q1 == '\'') ? SaidStringChannels : BlockAllChannels);
 
         char chPrev = 0;
         char ch;
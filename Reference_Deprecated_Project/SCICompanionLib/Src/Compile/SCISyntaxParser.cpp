@@ -1162,7 +1162,7 @@ void SCISyntaxParser::Load()
         | procedures_fwd
 
         | script_var)[{IdentifierE, ParseAutoCompleteContext::TopLevelKeyword}]
-        >> clpar[GeneralE]);
+        >> clpar[TopLevelFormCloseA]);
 
     // And for headers, only defines, includes are allowed. And also #ifdef!
     // REVIEW: This is kind of a hack.
@@ -16,6 +16,7 @@
 #include "ScriptOM.h"
 #include "CompiledScript.h"
 #include "GameFolderHelper.h"
+#include "SCOCache.h"
 
 using namespace std;
 using namespace sci;
@@ -650,6 +651,7 @@ void SaveSCOFile(const GameFolderHelper &helper, const CSCOFile &sco, ScriptId s
     // REVIEW: yucky
     scoFile.write((const char *)&scoOutput[0], (std::streamsize)scoOutput.size());
     scoFile.close();
+    InvalidateCachedSCO(scoFileName);
 }
 
 unique_ptr<CSCOFile> SCOFromScriptAndCompiledScript(const Script &script, const CompiledScript &compiledScript)
@@ -0,0 +1,141 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "SCOCache.h"
+
+using namespace std;
+
+IndexedSCOFile::IndexedSCOFile(CSCOFile &&sco) : _sco(move(sco))
+{
+    const vector<CSCOObjectClass> &classes = _sco.GetObjects();
+    for (size_t i = 0; i < classes.size(); i++)
+    {
+        // Like the linear searches in CSCOFile, the first one with a given name or species wins.
+        _nameToClass.emplace(classes[i].GetName(), i);
+        _speciesToClass.emplace(classes[i].GetSpecies(), i);
+    }
+}
+
+const CSCOObjectClass *IndexedSCOFile::GetClass(const std::string &className) const
+{
+    auto it = _nameToClass.find(className);
+    return (it != _nameToClass.end()) ? &_sco.GetObjects()[it->second] : nullptr;
+}
+
+const CSCOObjectClass *IndexedSCOFile::GetClassBySpecies(WORD species) const
+{
+    auto it = _speciesToClass.find(species);
+    return (it != _speciesToClass.end()) ? &_sco.GetObjects()[it->second] : nullptr;
+}
+
+namespace
+{
+    struct CachedSCO
+    {
+        FileStamp Stamp;
+        shared_ptr<const IndexedSCOFile> SCO;
+    };
+
+    mutex g_scoMutex;
+    unordered_map<string, CachedSCO> g_scos;
+    unordered_map<WORD, shared_ptr<const SCOClassSelectors>> g_classSelectors;
+
+    string _GetKey(const std::string &scoFileName)
+    {
+        string key = scoFileName;
+        transform(key.begin(), key.end(), key.begin(), ::tolower);
+        return key;
+    }
+}
+
+std::shared_ptr<const IndexedSCOFile> GetCachedSCO(const std::string &scoFileName, const SelectorTable &selectors, SCOLoadStatus &status, std::string &openError)
+{
+    string key = _GetKey(scoFileName);
+    FileStamp stamp = GetFileStamp(scoFileName);
+    if (stamp.Exists)
+    {
+        lock_guard<mutex> lock(g_scoMutex);
+        auto it = g_scos.find(key);
+        if ((it != g_scos.end()) && (it->second.Stamp == stamp))
+        {
+            status = SCOLoadStatus::Loaded;
+            return it->second.SCO;
+        }
+    }
+
+    shared_ptr<const IndexedSCOFile> sco;
+    HANDLE hFile = CreateFile(scoFileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
+    if (hFile != INVALID_HANDLE_VALUE)
+    {
+        sci::streamOwner streamOwner(hFile);
+        CSCOFile scoFile;
+        if (scoFile.Load(streamOwner.getReader(), selectors))
+        {
+            sco = make_shared<IndexedSCOFile>(move(scoFile));
+            status = SCOLoadStatus::Loaded;
+        }
+        else
+        {
+            status = SCOLoadStatus::Corrupt;
+        }
+        CloseHandle(hFile);
+    }
+    else
+    {
+        char szError[200];
+        FormatMessage(FORMAT_MESSAGE_FROM_SYSTEM, 0, GetLastError(), 0, szError, ARRAYSIZE(szError), nullptr);
+        openError = szError;
+        status = SCOLoadStatus::NotFound;
+    }
+
+    lock_guard<mutex> lock(g_scoMutex);
+    if (sco)
+    {
+        CachedSCO &cached = g_scos[key];
+        cached.Stamp = stamp;
+        cached.SCO = sco;
+    }
+    else
+    {
+        g_scos.erase(key);
+    }
+    return sco;
+}
+
+void InvalidateCachedSCO(const std::string &scoFileName)
+{
+    string key = _GetKey(scoFileName);
+    lock_guard<mutex> lock(g_scoMutex);
+    g_scos.erase(key);
+}
+
+std::shared_ptr<const SCOClassSelectors> GetCachedClassSelectors(WORD species)
+{
+    lock_guard<mutex> lock(g_scoMutex);
+    auto it = g_classSelectors.find(species);
+    return (it != g_classSelectors.end()) ? it->second : nullptr;
+}
+
+void CacheClassSelectors(WORD species, std::shared_ptr<const SCOClassSelectors> selectors)
+{
+    lock_guard<mutex> lock(g_scoMutex);
+    g_classSelectors[species] = selectors;
+}
+
+void ClearSCOCache()
+{
+    lock_guard<mutex> lock(g_scoMutex);
+    g_scos.clear();
+    g_classSelectors.clear();
+}
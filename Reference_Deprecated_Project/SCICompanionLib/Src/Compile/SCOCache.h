@@ -0,0 +1,77 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+#include "SCO.h"
+#include "ResourceSourceCache.h"
+
+class SelectorTable;
+
+//
+// A .sco file along with hashed lookups of its classes. These are immutable once created, and
+// shared by every CompileContext that uses the script.
+//
+class IndexedSCOFile
+{
+public:
+    IndexedSCOFile(CSCOFile &&sco);
+    IndexedSCOFile(const IndexedSCOFile &src) = delete;
+    IndexedSCOFile &operator=(const IndexedSCOFile &src) = delete;
+
+    const CSCOFile &GetSCO() const { return _sco; }
+    WORD GetScriptNumber() const { return _sco.GetScriptNumber(); }
+    const CSCOObjectClass *GetClass(const std::string &className) const;
+    const CSCOObjectClass *GetClassBySpecies(WORD species) const;
+    const std::unordered_map<std::string, size_t> &GetClassIndices() const { return _nameToClass; }
+
+private:
+    CSCOFile _sco;
+    std::unordered_map<std::string, size_t> _nameToClass;
+    std::unordered_map<WORD, size_t> _speciesToClass;
+};
+
+//
+// Every selector a class responds to, including those it inherits. Each maps to true for
+// methods and false for properties. If a subclass and superclass disagree, the subclass wins.
+//
+struct SCOClassSelectors
+{
+    std::unordered_map<uint16_t, bool> Selectors;
+    // The .sco files this was built from (the class's own first, then each superclass's), along
+    // with their script numbers. It is out of date if any of these has since been reloaded.
+    std::vector<std::pair<WORD, std::shared_ptr<const IndexedSCOFile>>> Sources;
+};
+
+enum class SCOLoadStatus
+{
+    Loaded,
+    NotFound,
+    Corrupt,
+};
+
+//
+// Returns the .sco file, only reading it from disk if its size or last write time has changed
+// since the last time it was read. On failure this returns null; if the file couldn't be opened,
+// openError describes why.
+//
+std::shared_ptr<const IndexedSCOFile> GetCachedSCO(const std::string &scoFileName, const SelectorTable &selectors, SCOLoadStatus &status, std::string &openError);
+// Call after writing a .sco file.
+void InvalidateCachedSCO(const std::string &scoFileName);
+
+// Returns null if the class's selectors haven't been cached. The caller is responsible for checking that
+// the sources are still current.
+std::shared_ptr<const SCOClassSelectors> GetCachedClassSelectors(WORD species);
+void CacheClassSelectors(WORD species, std::shared_ptr<const SCOClassSelectors> selectors);
+
+void ClearSCOCache();
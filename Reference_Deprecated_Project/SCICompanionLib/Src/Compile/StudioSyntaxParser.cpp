@@ -855,7 +855,7 @@ void StudioSyntaxParser::Load()
             | synonyms
             | script_var
             | script_string)[{IdentifierE, ParseAutoCompleteContext::TopLevelKeyword}]
-        >> clpar[GeneralE]);
+        >> clpar[TopLevelFormCloseA]);
 
     // And for headers, only defines and includes are allowed. And also #ifdef!
     entire_header = *
@@ -885,6 +885,14 @@ void SyntaxContext::ReportError(const std::string &error, streamIt pos)
     }
 }
 
+void SyntaxContext::RecordTopLevelCheckpoint(const streamIt &stream)
+{
+    if (TopLevelCheckpoints && (ifDefDefineState == IfDefDefineState::None))
+    {
+        TopLevelCheckpoints->push_back({ stream.GetPosition(), _script.GetIncludes(), _script.GetUses(), _script.SyntaxVersion });
+    }
+}
+
 //
 // This does the parsing.
 //
@@ -209,8 +209,7 @@ bool QuotedStringP(const ParserBase<_TContext, _It, _CommentPolicy> *pParser, _T
 template<typename _It, typename _TContext, typename _CommentPolicy>
 bool SQuotedStringP(const ParserBase<_TContext, _It, _CommentPolicy> *pParser, _TContext *pContext, _It &stream)
 {
-    // Note: We could expand autocomplete coverage to include said tokens. In that case we'd need to
-    // have ReadStringStudio *not* block all autocomplete channels.
+    // ReadStringStudio sets the SaidString autocomplete context for these.
     return pParser->ReadStringStudio<_TContext, _It, '\'', '\''>(pContext, stream, pContext->ScratchString());
 }
 
@@ -27,6 +27,17 @@ enum class IfDefDefineState
     True,   // In a clause that is true
 };
 
+// A point just after a complete top-level form (class, instance, procedure, define...) from which
+// parsing can be resumed with a fresh script. Only the bits of script-wide state that affect parsing
+// or autocomplete are kept.
+struct ParseCheckpoint
+{
+    LineCol Position;
+    std::vector<std::string> Includes;
+    std::vector<std::string> Uses;
+    int SyntaxVersion;
+};
+
 class SyntaxContext
 {
 public:
@@ -307,6 +318,10 @@ public:
         return _collectComments;
     }
 
+    // If set, a checkpoint is recorded here at the end of each top-level form.
+    std::vector<ParseCheckpoint> *TopLevelCheckpoints = nullptr;
+    void RecordTopLevelCheckpoint(const streamIt &stream);
+
 private:
     std::unordered_set<std::string> _preProcessorDefines;
 
@@ -18,79 +18,178 @@
 
 using namespace std;
 
+// Dense bitsets for node sets, indexed by a node's position in the list of nodes we're working on.
+const size_t BitsPerWord = 64;
+
+size_t _WordsFor(size_t count)
+{
+    return (count + BitsPerWord - 1) / BitsPerWord;
+}
+
+void _SetBit(uint64_t *bits, size_t index)
+{
+    bits[index / BitsPerWord] |= (1ull << (index % BitsPerWord));
+}
+
+bool _IsBitSet(const uint64_t *bits, size_t index)
+{
+    return (bits[index / BitsPerWord] & (1ull << (index % BitsPerWord))) != 0;
+}
+
+// This is the iterative data-flow algorithm (every node starts out dominated by all of N, and
+// we intersect the predecessors' dominators until nothing changes). But it works on bitsets,
+// and visits nodes in reverse post-order, so it converges in a few cheap passes.
+// It ends up at exactly the same fixed point as intersecting NodeSets did. That includes nodes
+// that aren't reachable from n0, and predecessors outside of N (which get an empty entry), so the
+// decompiler's results don't change.
 template<typename _Func>
-void SomeFunction(DominatorMap &dominators, NodeSet &newDominators, ControlFlowNode *n, _Func func)
+unique_ptr<DominatorMap> GenerateDominators(const NodeSet &N, ControlFlowNode *n0, _Func func)
 {
-    newDominators.insert(n);
+    vector<ControlFlowNode*> nodes(N.begin(), N.end());
+    size_t countInN = nodes.size();
+    unordered_map<ControlFlowNode*, size_t> indices;
+    for (size_t i = 0; i < countInN; i++)
+    {
+        indices[nodes[i]] = i;
+    }
+    if (indices.find(n0) == indices.end())
+    {
+        indices[n0] = nodes.size();
+        nodes.push_back(n0);
+    }
+    size_t start = indices[n0];
+    size_t count = nodes.size();
+    size_t words = _WordsFor(count);
+
+    unique_ptr<DominatorMap> dominators = make_unique<DominatorMap>();
+
+    // Predecessors by index. Those outside N have no dominators, so they're marked with
+    // noIndex, which empties the intersection.
+    const size_t noIndex = (size_t)-1;
+    vector<vector<size_t>> preds(count);
+    vector<vector<size_t>> succs(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        if (i != start)
+        {
+            for (ControlFlowNode *pred : func(nodes[i]))
+            {
+                auto itIndex = indices.find(pred);
+                if (itIndex != indices.end())
+                {
+                    preds[i].push_back(itIndex->second);
+                    succs[itIndex->second].push_back(i);
+                }
+                else
+                {
+                    preds[i].push_back(noIndex);
+                    (*dominators)[pred];
+                }
+            }
+        }
+    }
 
-    if (!func(n).empty())
+    // Reverse post-order from n0. Then anything unreachable.
+    vector<size_t> order;
+    order.reserve(count);
     {
-        NodeSet result;
-        bool first = true;
-        for (ControlFlowNode *pred : func(n))
+        vector<bool> visited(count, false);
+        stack<pair<size_t, size_t>> toProcess; // node, next successor to look at
+        visited[start] = true;
+        toProcess.emplace(start, 0);
+        while (!toProcess.empty())
         {
-            if (first)
+            auto &top = toProcess.top();
+            if (top.second < succs[top.first].size())
             {
-                result = dominators[pred];
-                first = false;
+                size_t succ = succs[top.first][top.second++];
+                if (!visited[succ])
+                {
+                    visited[succ] = true;
+                    toProcess.emplace(succ, 0);
+                }
             }
             else
             {
-                NodeSet resultTemp;
-                NodeSet &temp = dominators[pred];
-                set_intersection(result.begin(), result.end(),
-                    temp.begin(), temp.end(),
-                    inserter(resultTemp, resultTemp.begin()),
-                    std::less<ControlFlowNode*>()
-                    );
-
-                swap(resultTemp, result);
+                order.push_back(top.first);
+                toProcess.pop();
             }
         }
-
-        for (ControlFlowNode *node : result)
+        reverse(order.begin(), order.end());
+        order.erase(order.begin()); // That's n0, which doesn't change
+        for (size_t i = 0; i < count; i++)
         {
-            newDominators.insert(node);
+            if (!visited[i])
+            {
+                order.push_back(i);
+            }
         }
     }
-    // Now look at all the predecessors p of n. 
-    // Add in the intersection of all those dominators for them.
-}
-
-template<typename _Func>
-DominatorMap GenerateDominators(NodeSet N, ControlFlowNode *n0, _Func func)
-{
-    NodeSet N_minus_n0 = N;
-    N_minus_n0.erase(n0);
-
-    DominatorMap dominators;
-
-    // dominator of the start node is the start itself
-    dominators[n0].insert(n0);
 
-    // for all other nodes, set all nodes as the dominators
-    for (ControlFlowNode *n : N_minus_n0)
+    // dominator of the start node is the start itself. For all other nodes, set all nodes as the dominators
+    vector<uint64_t> bits(count * words, 0);
+    vector<uint64_t> all(words, 0);
+    for (size_t i = 0; i < countInN; i++)
+    {
+        _SetBit(&all[0], i);
+    }
+    for (size_t i = 0; i < count; i++)
     {
-        dominators[n] = N;
+        if (i == start)
+        {
+            _SetBit(&bits[i * words], i);
+        }
+        else
+        {
+            copy(all.begin(), all.end(), bits.begin() + i * words);
+        }
     }
 
     // Iteratively eliminate nodes that are not dominators
+    vector<uint64_t> newBits(words);
     bool changes = true;
     while (changes)
     {
         changes = false;
-        for (ControlFlowNode *n : N_minus_n0)
+        for (size_t n : order)
         {
-            NodeSet newDominatorsFor_n;
-            SomeFunction(dominators, newDominatorsFor_n, n, func);
-            if (newDominatorsFor_n != dominators[n])
+            const vector<size_t> &predsOf_n = preds[n];
+            fill(newBits.begin(), newBits.end(), 0);
+            if (!predsOf_n.empty() && (find(predsOf_n.begin(), predsOf_n.end(), noIndex) == predsOf_n.end()))
             {
-                dominators[n] = newDominatorsFor_n;
+                copy(bits.begin() + predsOf_n[0] * words, bits.begin() + (predsOf_n[0] + 1) * words, newBits.begin());
+                for (size_t p = 1; p < predsOf_n.size(); p++)
+                {
+                    const uint64_t *predBits = &bits[predsOf_n[p] * words];
+                    for (size_t w = 0; w < words; w++)
+                    {
+                        newBits[w] &= predBits[w];
+                    }
+                }
+            }
+            _SetBit(&newBits[0], n);
+
+            if (!equal(newBits.begin(), newBits.end(), bits.begin() + n * words))
+            {
+                copy(newBits.begin(), newBits.end(), bits.begin() + n * words);
                 changes = true;
             }
         }
     }
 
+    for (size_t i = 0; i < count; i++)
+    {
+        NodeSet &nodeDominators = (*dominators)[nodes[i]];
+        const uint64_t *nodeBits = &bits[i * words];
+        for (size_t j = 0; j < count; j++)
+        {
+            if (_IsBitSet(nodeBits, j))
+            {
+                nodeDominators.insert(nodeDominators.end(), nodes[j]);
+            }
+        }
+    }
+
     return dominators;
 }
 
@@ -118,22 +217,22 @@ NodeSet NoJmpPreds(ControlFlowNode *node)
     return filtered;
 }
 
-DominatorMap GenerateDominators(ControlFlowNode *parent, ControlFlowNode *n0)
+const DominatorMap &GenerateDominators(ControlFlowNode *parent, ControlFlowNode *n0)
 {
     if (parent->dirty)
     {
-        parent->dominators = make_unique<DominatorMap>(GenerateDominators(parent->Children(), n0, [](ControlFlowNode *node) { return NoJmpPreds(node); }));
+        parent->dominators = GenerateDominators(parent->Children(), n0, [](ControlFlowNode *node) { return NoJmpPreds(node); });
         parent->dirty = false;
     }
     return *parent->dominators;
 }
 
 
-DominatorMap GeneratePostDominators(ControlFlowNode *parent, ControlFlowNode *n0)
+const DominatorMap &GeneratePostDominators(ControlFlowNode *parent, ControlFlowNode *n0)
 {
     if (parent->postDirty)
     {
-        parent->postDominators = make_unique<DominatorMap>(GenerateDominators(parent->Children(), n0, [](ControlFlowNode *node) { return node->Successors(); }));
+        parent->postDominators = GenerateDominators(parent->Children(), n0, [](ControlFlowNode *node) { return node->Successors(); });
         parent->postDirty = false;
     }
     return *parent->postDominators;
@@ -204,34 +303,58 @@ NodeSet CollectNodesBetween(ControlFlowNode *head, ControlFlowNode *tail, NodeSe
 
 map<ControlFlowNode*, ControlFlowNode*> CalculateImmediateDominators(const DominatorMap &dominatorMap)
 {
+    // Index the nodes, and figure out which nodes each one dominates.
+    unordered_map<ControlFlowNode*, size_t> indices;
+    for (const auto &pair : dominatorMap)
+    {
+        size_t index = indices.size();
+        indices[pair.first] = index;
+    }
+    size_t count = indices.size();
+    size_t words = _WordsFor(count);
+    vector<uint64_t> dominatesBits(count * words, 0);
+    for (const auto &pair : dominatorMap)
+    {
+        size_t dominatee = indices[pair.first];
+        for (ControlFlowNode *dominator : pair.second)
+        {
+            _SetBit(&dominatesBits[indices.at(dominator) * words], dominatee);
+        }
+    }
+
     map<ControlFlowNode*, ControlFlowNode*> immediateDominators;
+    vector<uint64_t> others(words);
     for (const auto &pair : dominatorMap)
     {
         ControlFlowNode *dominatee = pair.first;
+        size_t dominateeIndex = indices[dominatee];
         // One of its dominators is its immediate dominator
         // Its immediate dominator is the dominator that dominates it, but does not dominate any other
         // node that dominates the dominatee.
-        // So this algorithm, I guess, is n^2 in complexity with the number of dominators for a node.
-        // (If we care about perf, we could find the guy with the highest address and it would likely be the imm dom)
         const NodeSet &dominators = pair.second;
+        fill(others.begin(), others.end(), 0);
+        for (ControlFlowNode *test : dominators)
+        {
+            _SetBit(&others[0], indices.at(test));
+        }
+        others[dominateeIndex / BitsPerWord] &= ~(1ull << (dominateeIndex % BitsPerWord));
 
         for (ControlFlowNode *potentialImmDom : dominators)
         {
             if (potentialImmDom != dominatee)   // I forget if dominator map for the dominatee includes the dominatee
             {
+                // Our potential immediate dominator can't dominate other nodes of the dominatee's dominators.
+                size_t potentialIndex = indices[potentialImmDom];
+                const uint64_t *dominates = &dominatesBits[potentialIndex * words];
                 bool found = true;
-                for (ControlFlowNode *test : dominators)
+                for (size_t w = 0; found && (w < words); w++)
                 {
-                    if ((test != potentialImmDom) && (test != dominatee))
+                    uint64_t overlap = others[w] & dominates[w];
+                    if (w == (potentialIndex / BitsPerWord))
                     {
-                        if (dominatorMap.at(test).contains(potentialImmDom))
-                        {
-                            // Our potential immediate dominator dominates other nodes of the dominatees dominators.
-                            // So it can't be the immediate dominator
-                            found = false;
-                            break;
-                        }
+                        overlap &= ~(1ull << (potentialIndex % BitsPerWord));
                     }
+                    found = (overlap == 0);
                 }
                 if (found)
                 {
@@ -15,8 +15,10 @@
 
 struct ControlFlowNode;
 
-DominatorMap GenerateDominators(ControlFlowNode *parent, ControlFlowNode *n0);
-DominatorMap GeneratePostDominators(ControlFlowNode *parent, ControlFlowNode *n0);
+// These are cached on parent. The returned map stays valid until the next call for parent after
+// its children have changed.
+const DominatorMap &GenerateDominators(ControlFlowNode *parent, ControlFlowNode *n0);
+const DominatorMap &GeneratePostDominators(ControlFlowNode *parent, ControlFlowNode *n0);
 
 bool IsReachable(ControlFlowNode *head, ControlFlowNode *tail);
 NodeSet CollectNodesBetween(ControlFlowNode *head, ControlFlowNode *tail, NodeSet possible);
@@ -8,6 +8,8 @@
 #include "CompileContext.h"
 #include "AppState.h"
 #include "ScriptOM.h"
+#include "ParsedScriptCache.h"
+#include "ParallelFor.h"
 #include <format.h>
 
 // This contains code to warn about situations where a synonym statement will replace word A with B in the player's input,
@@ -320,50 +322,86 @@ void ListUnusedOfType(CompileLog &log, const Vocab000 &vocab000, WordClass wordC
 
 }
 
-void ValidateSaids(CompileLog &log, const Vocab000 &vocab000)
+struct SaidValidationJob
+{
+    SaidValidationJob(ScriptId scriptId) : Script(scriptId) {}
+
+    ScriptId Script;
+    shared_ptr<sci::Script> Parsed;
+    CompileLog ParseLog;
+    unique_ptr<ExtractSaids> Saids;
+    exception_ptr Exception;
+};
+
+void ValidateSaids(CompileLog &log, const Vocab000 &vocab000, unsigned int workerCount)
 {
     std::map<uint16_t, int> saidsUsedInScripts;
     std::map<string, int> rootsUsedInScripts;
 
     std::vector<ScriptId> scripts;
     appState->GetResourceMap().GetAllScripts(scripts);
-    std::unique_ptr<Script> mainScript;
-    std::unique_ptr<ExtractSaids> mainSaids;
-    for (ScriptId script : scripts)
+    auto mainIt = find_if(scripts.begin(), scripts.end(), [](const ScriptId &script) { return script.GetResourceNumber() == 0; });
+    if (mainIt != scripts.end())
     {
-        if (script.GetResourceNumber() == 0)
+        // Main goes first, then the rest in their usual order.
+        vector<SaidValidationJob> jobs;
+        jobs.emplace_back(*mainIt);
+        for (const ScriptId &scriptId : scripts)
         {
-            // Main
-            mainScript = SimpleCompile(log, script);
-            mainSaids = std::make_unique<ExtractSaids>(script, log, vocab000);
-            mainScript->Traverse(*mainSaids);
-            mainSaids->GrabWordGroups(saidsUsedInScripts);
-            mainSaids->GrabRoots(rootsUsedInScripts);
-            break;
+            if (scriptId.GetResourceNumber() != 0)
+            {
+                jobs.emplace_back(scriptId);
+            }
         }
-    }
-    
-    if (mainScript)
-    {
-        for (ScriptId scriptId : scripts)
+
+        // Parse the scripts (unless the compiler already did) and pull out their saids in parallel. Each job
+        // gets its own log and counters, so nothing is shared between the workers other than the vocab.
+        ParallelFor(jobs.size(), workerCount,
+            [&](size_t index)
         {
-            if (scriptId.GetResourceNumber() != 0)
+            SaidValidationJob &job = jobs[index];
+            try
             {
-                std::unique_ptr<Script> script = SimpleCompile(log, scriptId);
-                ExtractSaids scriptSaids(scriptId, log, vocab000);
-                script->Traverse(scriptSaids);
-                scriptSaids.GrabWordGroups(saidsUsedInScripts);
-                scriptSaids.GrabRoots(rootsUsedInScripts);
-                if (!script->GetSynonyms().empty())
+                job.Parsed = GetCachedParsedScript(job.Script);
+                if (!job.Parsed)
                 {
-                    // This script declares synonyms - so we'll validate against itself and main.
-                    scriptSaids.ValidateAgainst(scriptId, script->GetSynonyms(), true);
-
-                    // Then against main
-                    mainSaids->ValidateAgainst(scriptId, script->GetSynonyms(), false);
+                    job.Parsed = SimpleCompile(job.ParseLog, job.Script);
                 }
+                job.Saids = make_unique<ExtractSaids>(job.Script, log, vocab000);
+                job.Parsed->Traverse(*job.Saids);
+            }
+            catch (...)
+            {
+                job.Exception = current_exception();
+            }
+        }
+            );
+
+        // Now merge everything in order, so the output doesn't depend on which worker finished first.
+        ExtractSaids *mainSaids = nullptr;
+        for (SaidValidationJob &job : jobs)
+        {
+            if (job.Exception)
+            {
+                rethrow_exception(job.Exception);
+            }
+            log.Results().insert(log.Results().end(), job.ParseLog.Results().begin(), job.ParseLog.Results().end());
+            job.Saids->GrabWordGroups(saidsUsedInScripts);
+            job.Saids->GrabRoots(rootsUsedInScripts);
+            if (!mainSaids)
+            {
+                mainSaids = job.Saids.get();
+            }
+            else if (!job.Parsed->GetSynonyms().empty())
+            {
+                // This script declares synonyms - so we'll validate against itself and main.
+                job.Saids->ValidateAgainst(job.Script, job.Parsed->GetSynonyms(), true);
+
+                // Then against main
+                mainSaids->ValidateAgainst(job.Script, job.Parsed->GetSynonyms(), false);
             }
         }
+        log.CalculateErrors();
     }
 
     uint16_t wordClass = (uint16_t)WordClass::ImperativeVerb;
@@ -3,4 +3,5 @@
 struct Vocab000;
 class CompileLog;
 
-void ValidateSaids(CompileLog &log, const Vocab000 &vocab000);
\ No newline at end of file
+// Parses the scripts on up to workerCount threads. Results are the same regardless of the number of workers.
+void ValidateSaids(CompileLog &log, const Vocab000 &vocab000, unsigned int workerCount);
\ No newline at end of file
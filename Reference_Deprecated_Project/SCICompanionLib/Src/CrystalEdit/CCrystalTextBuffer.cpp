@@ -62,34 +62,6 @@ const TCHAR crlf[] = _T("\r\n");
 
 #pragma warning (disable: 4996)
 
-/////////////////////////////////////////////////////////////////////////////
-// CCrystalTextBuffer::SUndoRecord
-
-void CCrystalTextBuffer::SUndoRecord::SetText(LPCTSTR pszText)
-{
-	m_pszText = NULL;
-	if (pszText != NULL && pszText[0] != _T('\0'))
-	{
-		int nLength = (int)_tcslen(pszText);
-		if (nLength > 1)
-		{
-			m_pszText = new TCHAR[(nLength + 1) * sizeof(TCHAR)];
-			_tcscpy(m_pszText, pszText);
-		}
-		else
-		{
-			m_szText[0] = pszText[0];
-		}
-	}
-}
-
-void CCrystalTextBuffer::SUndoRecord::FreeText()
-{
-	if (HIWORD((DWORD)(DWORD_PTR) m_pszText) != 0)
-		delete m_pszText;
-}
-
-
 /////////////////////////////////////////////////////////////////////////////
 // CCrystalTextBuffer::CUpdateContext
 
@@ -166,6 +138,17 @@ END_MESSAGE_MAP()
 /////////////////////////////////////////////////////////////////////////////
 // CCrystalTextBuffer message handlers
 
+void CCrystalTextBuffer::InitLine(SLineInfo &li, LPCTSTR pszLine, int nLength)
+{
+	li.m_nLength = nLength;
+	li.m_nMax = ALIGN_BUF_SIZE(li.m_nLength);
+	ASSERT(li.m_nMax >= li.m_nLength);
+	if (li.m_nMax > 0)
+		li.m_pcLine = new TCHAR[li.m_nMax];
+	if (li.m_nLength > 0)
+		memcpy(li.m_pcLine, pszLine, sizeof(TCHAR) * li.m_nLength);
+}
+
 void CCrystalTextBuffer::InsertLine(LPCTSTR pszLine, int nLength /*= -1*/, int nPosition /*= -1*/)
 {
 	if (nLength == -1)
@@ -177,13 +160,7 @@ void CCrystalTextBuffer::InsertLine(LPCTSTR pszLine, int nLength /*= -1*/, int n
 	}
 
 	SLineInfo li;
-	li.m_nLength = nLength;
-	li.m_nMax = ALIGN_BUF_SIZE(li.m_nLength);
-	ASSERT(li.m_nMax >= li.m_nLength);
-	if (li.m_nMax > 0)
-		li.m_pcLine = new TCHAR[li.m_nMax];
-	if (li.m_nLength > 0)
-		memcpy(li.m_pcLine, pszLine, sizeof(TCHAR) * li.m_nLength);
+	InitLine(li, pszLine, nLength);
 
 	if (nPosition == -1)
 		m_aLines.Add(li);
@@ -213,13 +190,16 @@ void CCrystalTextBuffer::AppendLine(int nLineIndex, LPCTSTR pszChars, int nLengt
 	int nBufNeeded = li.m_nLength + nLength;
 	if (nBufNeeded > li.m_nMax)
 	{
-		li.m_nMax = ALIGN_BUF_SIZE(nBufNeeded);
-		ASSERT(li.m_nMax >= li.m_nLength + nLength);
-		TCHAR *pcNewBuf = new TCHAR[li.m_nMax];
+		//	This is also where lines still pointing into the loaded text get their own copy
+		int nNewMax = ALIGN_BUF_SIZE(nBufNeeded);
+		ASSERT(nNewMax >= li.m_nLength + nLength);
+		TCHAR *pcNewBuf = new TCHAR[nNewMax];
 		if (li.m_nLength > 0)
 			memcpy(pcNewBuf, li.m_pcLine, sizeof(TCHAR) * li.m_nLength);
-		delete li.m_pcLine;
+		if (li.m_nMax > 0)
+			delete li.m_pcLine;
 		li.m_pcLine = pcNewBuf;
+		li.m_nMax = nNewMax;
 	}
 	memcpy(li.m_pcLine + li.m_nLength, pszChars, sizeof(TCHAR) * nLength);
 	li.m_nLength += nLength;
@@ -237,12 +217,11 @@ void CCrystalTextBuffer::FreeAll()
 			delete m_aLines[I].m_pcLine;
 	}
 	m_aLines.RemoveAll();
+	std::vector<TCHAR>().swap(m_aLoadedText);
 
 	//	Free undo buffer
-	int nBufSize = (int)m_aUndoBuf.GetSize();
-	for (I = 0; I < nBufSize; I ++)
-		m_aUndoBuf[I].FreeText();
 	m_aUndoBuf.RemoveAll();
+	std::vector<TCHAR>().swap(m_aUndoText);
 
 	m_bInit = FALSE;
 }
@@ -290,10 +269,10 @@ BOOL CCrystalTextBuffer::LoadFromFile(LPCTSTR pszFileName, int nCrlfStyle /*= CR
 {
 	ASSERT(! m_bInit);
 	ASSERT(m_aLines.GetSize() == 0);
+	ASSERT(m_aLoadedText.empty());
 
 	HANDLE hFile = NULL;
-	int nCurrentMax = 256;
-	char *pcLineBuf = new char[nCurrentMax];
+	char *pcFileBuf = NULL;
 
 	BOOL bSuccess = FALSE;
 	__try
@@ -307,24 +286,40 @@ BOOL CCrystalTextBuffer::LoadFromFile(LPCTSTR pszFileName, int nCrlfStyle /*= CR
 		if (hFile == INVALID_HANDLE_VALUE)
 			__leave;
 
-		int nCurrentLength = 0;
-
-		const DWORD dwBufSize = 32768;
-		char *pcBuf = (char *) _alloca(dwBufSize);
+		//	Read the whole file in one go. Lines point directly into the text until
+		//	they're modified, so we don't need an allocation per line.
+		LARGE_INTEGER liFileSize;
+		if (! ::GetFileSizeEx(hFile, &liFileSize) || liFileSize.HighPart != 0 || liFileSize.LowPart >= INT_MAX)
+			__leave;
+		DWORD dwFileSize = liFileSize.LowPart;
+		pcFileBuf = new char[dwFileSize + 1];
 		DWORD dwCurSize;
-		if (! ::ReadFile(hFile, pcBuf, dwBufSize, &dwCurSize, NULL))
+		if (! ::ReadFile(hFile, pcFileBuf, dwFileSize, &dwCurSize, NULL) || dwCurSize != dwFileSize)
 			__leave;
 
+#ifdef _UNICODE
+		int nTextLength = ::MultiByteToWideChar(CP_ACP, 0, pcFileBuf, (int) dwFileSize, NULL, 0);
+		m_aLoadedText.resize(nTextLength + 1);
+		::MultiByteToWideChar(CP_ACP, 0, pcFileBuf, (int) dwFileSize, &m_aLoadedText[0], nTextLength);
+#else
+		int nTextLength = (int) dwFileSize;
+		m_aLoadedText.assign(pcFileBuf, pcFileBuf + dwFileSize);
+		m_aLoadedText.push_back(0);
+#endif
+		//	Always null-terminated, so even an empty file gives us a valid pointer
+		TCHAR *pcText = &m_aLoadedText[0];
+		pcText[nTextLength] = 0;
+
 		if (nCrlfStyle == CRLF_STYLE_AUTOMATIC)
 		{
 			//	Try to determine current CRLF mode
-            DWORD I = 0;
-			for (; I < dwCurSize; I ++)
+            int I = 0;
+			for (; I < nTextLength; I ++)
 			{
-				if (pcBuf[I] == _T('\x0a'))
+				if (pcText[I] == _T('\x0a'))
 					break;
 			}
-			if (I == dwCurSize)
+			if (I == nTextLength)
 			{
 				//	By default (or in the case of empty file), set DOS style
 				nCrlfStyle = CRLF_STYLE_DOS;
@@ -332,13 +327,13 @@ BOOL CCrystalTextBuffer::LoadFromFile(LPCTSTR pszFileName, int nCrlfStyle /*= CR
 			else
 			{
 				//	Otherwise, analyse the first occurance of line-feed character
-				if (I > 0 && pcBuf[I - 1] == _T('\x0d'))
+				if (I > 0 && pcText[I - 1] == _T('\x0d'))
 				{
 					nCrlfStyle = CRLF_STYLE_DOS;
 				}
 				else
 				{
-					if (I < dwCurSize - 1 && pcBuf[I + 1] == _T('\x0d'))
+					if (I < nTextLength - 1 && pcText[I + 1] == _T('\x0d'))
 						nCrlfStyle = CRLF_STYLE_UNIX;
 					else
 						nCrlfStyle = CRLF_STYLE_MAC;
@@ -349,52 +344,41 @@ BOOL CCrystalTextBuffer::LoadFromFile(LPCTSTR pszFileName, int nCrlfStyle /*= CR
 		ASSERT(nCrlfStyle >= 0 && nCrlfStyle <= 2);
 		m_nCRLFMode = nCrlfStyle;
 		const char *crlf = crlfs[nCrlfStyle];
+		int nCrlfLength = (int) strlen(crlf);
 
-		m_aLines.SetSize(0, 4096);
-
-		DWORD dwBufPtr = 0;
-		int nCrlfPtr = 0;
-		USES_CONVERSION;
-		while (dwBufPtr < dwCurSize)
+		//	Count the lines first, so the line array is only allocated once
+		int nLineCount = 1;
+		for (int nPos = 0; nPos <= nTextLength - nCrlfLength; )
 		{
-			int c = pcBuf[dwBufPtr];
-			dwBufPtr ++;
-			if (dwBufPtr == dwCurSize && dwCurSize == dwBufSize)
-			{
-				if (! ::ReadFile(hFile, pcBuf, dwBufSize, &dwCurSize, NULL))
-					__leave;
-				dwBufPtr = 0;
-			}
-
-			pcLineBuf[nCurrentLength] = (char) c;
-			nCurrentLength ++;
-			if (nCurrentLength == nCurrentMax)
+			if (pcText[nPos] == (TCHAR) crlf[0] && (nCrlfLength == 1 || pcText[nPos + 1] == (TCHAR) crlf[1]))
 			{
-				//	Reallocate line buffer
-				nCurrentMax += 256;
-				char *pcNewBuf = new char[nCurrentMax];
-				memcpy(pcNewBuf, pcLineBuf, nCurrentLength);
-				delete pcLineBuf;
-				pcLineBuf = pcNewBuf;
+				nLineCount ++;
+				nPos += nCrlfLength;
 			}
+			else
+				nPos ++;
+		}
+		m_aLines.SetSize(nLineCount);
 
-			if ((char) c == crlf[nCrlfPtr])
+		int nLine = 0;
+		int nLineStart = 0;
+		for (int nPos = 0; nLine < nLineCount - 1; )
+		{
+			if (pcText[nPos] == (TCHAR) crlf[0] && (nCrlfLength == 1 || pcText[nPos + 1] == (TCHAR) crlf[1]))
 			{
-				nCrlfPtr ++;
-				if (crlf[nCrlfPtr] == 0)
-				{
-					pcLineBuf[nCurrentLength - nCrlfPtr] = 0;
-					InsertLine(A2T(pcLineBuf));
-					nCurrentLength = 0;
-					nCrlfPtr = 0;
-				}
+				SLineInfo &li = m_aLines[nLine];
+				li.m_pcLine = pcText + nLineStart;
+				li.m_nLength = nPos - nLineStart;
+				nLine ++;
+				nPos += nCrlfLength;
+				nLineStart = nPos;
 			}
 			else
-				nCrlfPtr = 0;
+				nPos ++;
 		}
-
-		pcLineBuf[nCurrentLength] = 0;
-		InsertLine(A2T(pcLineBuf));
+		SLineInfo &liLast = m_aLines[nLine];
+		liLast.m_pcLine = pcText + nLineStart;
+		liLast.m_nLength = nTextLength - nLineStart;
 
 		ASSERT(m_aLines.GetSize() > 0);		//	At least one empty line must present
 
@@ -411,10 +395,13 @@ BOOL CCrystalTextBuffer::LoadFromFile(LPCTSTR pszFileName, int nCrlfStyle /*= CR
 	}
 	__finally
 	{
-		if (pcLineBuf != NULL)
-			delete pcLineBuf;
-		if (hFile != NULL)
+		if (pcFileBuf != NULL)
+			delete [] pcFileBuf;
+		if (hFile != NULL && hFile != INVALID_HANDLE_VALUE)
 			::CloseHandle(hFile);
+		//	(No temporaries in here, since we can't have object unwinding with __try)
+		if (! bSuccess)
+			m_aLoadedText.clear();
 	}
 	return bSuccess;
 }
@@ -771,7 +758,15 @@ BOOL CCrystalTextBuffer::InternalDeleteText(CCrystalTextView *pSource, int nStar
 		SLineInfo &li = m_aLines[nStartLine];
 		if (nEndChar < li.m_nLength)
 		{
-			memcpy(li.m_pcLine + nStartChar, li.m_pcLine + nEndChar,
+			if (li.m_nMax == 0)
+			{
+				//	Still pointing into the loaded text: make our own copy before modifying it
+				SLineInfo liOwned = li;
+				InitLine(liOwned, li.m_pcLine, li.m_nLength);
+				li.m_pcLine = liOwned.m_pcLine;
+				li.m_nMax = liOwned.m_nMax;
+			}
+			memmove(li.m_pcLine + nStartChar, li.m_pcLine + nEndChar,
 					sizeof(TCHAR) * (li.m_nLength - nEndChar));
 		}
 		li.m_nLength -= (nEndChar - nStartChar);
@@ -790,7 +785,10 @@ BOOL CCrystalTextBuffer::InternalDeleteText(CCrystalTextView *pSource, int nStar
 
 		int nDelCount = nEndLine - nStartLine;
 		for (int L = nStartLine + 1; L <= nEndLine; L ++)
-			delete m_aLines[L].m_pcLine;
+		{
+			if (m_aLines[L].m_nMax > 0)
+				delete m_aLines[L].m_pcLine;
+		}
 		m_aLines.RemoveAt(nStartLine + 1, nDelCount);
 
 		//	nEndLine is no more valid
@@ -831,6 +829,20 @@ BOOL CCrystalTextBuffer::InternalInsertText(CCrystalTextView *pSource, int nLine
 		m_aLines[nLine].m_nLength = nPos;
 	}
 
+	//	Make room for all the new lines at once, rather than shifting the
+	//	rest of the lines down for each one.
+	int nNewLines = 0;
+	for (LPCTSTR pszCur = pszText; *pszCur != 0; pszCur ++)
+	{
+		if (*pszCur == _T('\r'))
+			nNewLines ++;
+	}
+	if (nNewLines > 0)
+	{
+		SLineInfo liEmpty;
+		m_aLines.InsertAt(nLine + 1, liEmpty, nNewLines);
+	}
+
 	int nCurrentLine = nLine;
 	BOOL bNewLines = FALSE;
 	int nTextPos;
@@ -846,7 +858,7 @@ BOOL CCrystalTextBuffer::InternalInsertText(CCrystalTextView *pSource, int nLine
 		}
 		else
 		{
-			InsertLine(pszText, nTextPos, nCurrentLine);
+			InitLine(m_aLines[nCurrentLine], pszText, nTextPos);
 			bNewLines = TRUE;
 		}
 
@@ -984,7 +996,7 @@ BOOL CCrystalTextBuffer::Undo(CPoint &ptCursorPos)
 			//	Just compare the text as it was before Undo operation
 			CString text;
 			GetText(ur.m_ptStartPos.y, ur.m_ptStartPos.x, ur.m_ptEndPos.y, ur.m_ptEndPos.x, text);
-			ASSERT(lstrcmp(text, ur.GetText()) == 0);
+			ASSERT(lstrcmp(text, GetUndoText(ur)) == 0);
 #endif
 			VERIFY(InternalDeleteText(NULL, ur.m_ptStartPos.y, ur.m_ptStartPos.x, ur.m_ptEndPos.y, ur.m_ptEndPos.x));
 			ptCursorPos = ur.m_ptStartPos;
@@ -992,7 +1004,7 @@ BOOL CCrystalTextBuffer::Undo(CPoint &ptCursorPos)
 		else
 		{
 			int nEndLine, nEndChar;
-			VERIFY(InternalInsertText(NULL, ur.m_ptStartPos.y, ur.m_ptStartPos.x, ur.GetText(), nEndLine, nEndChar));
+			VERIFY(InternalInsertText(NULL, ur.m_ptStartPos.y, ur.m_ptStartPos.x, GetUndoText(ur), nEndLine, nEndChar));
 #ifdef _ADVANCED_BUGCHECK
 			ASSERT(ur.m_ptEndPos.y == nEndLine);
 			ASSERT(ur.m_ptEndPos.x == nEndChar);
@@ -1020,7 +1032,7 @@ BOOL CCrystalTextBuffer::Redo(CPoint &ptCursorPos)
 		if (ur.m_dwFlags & UNDO_INSERT)
 		{
 			int nEndLine, nEndChar;
-			VERIFY(InternalInsertText(NULL, ur.m_ptStartPos.y, ur.m_ptStartPos.x, ur.GetText(), nEndLine, nEndChar));
+			VERIFY(InternalInsertText(NULL, ur.m_ptStartPos.y, ur.m_ptStartPos.x, GetUndoText(ur), nEndLine, nEndChar));
 #ifdef _ADVANCED_BUGCHECK
 			ASSERT(ur.m_ptEndPos.y == nEndLine);
 			ASSERT(ur.m_ptEndPos.x == nEndChar);
@@ -1032,7 +1044,7 @@ BOOL CCrystalTextBuffer::Redo(CPoint &ptCursorPos)
 #ifdef _ADVANCED_BUGCHECK
 			CString text;
 			GetText(ur.m_ptStartPos.y, ur.m_ptStartPos.x, ur.m_ptEndPos.y, ur.m_ptEndPos.x, text);
-			ASSERT(lstrcmp(text, ur.GetText()) == 0);
+			ASSERT(lstrcmp(text, GetUndoText(ur)) == 0);
 #endif
 			VERIFY(InternalDeleteText(NULL, ur.m_ptStartPos.y, ur.m_ptStartPos.x, ur.m_ptEndPos.y, ur.m_ptEndPos.x));
 			ptCursorPos = ur.m_ptStartPos;
@@ -1050,6 +1062,27 @@ BOOL CCrystalTextBuffer::Redo(CPoint &ptCursorPos)
 	return TRUE;
 }
 
+LPCTSTR CCrystalTextBuffer::GetUndoText(const SUndoRecord &ur) const
+{
+	return &m_aUndoText[ur.m_nTextOffset];
+}
+
+void CCrystalTextBuffer::RemoveOldestUndoRecords(int nCount)
+{
+	m_aUndoBuf.RemoveAt(0, nCount);
+
+	//	The text of the removed records is at the start of m_aUndoText. Only
+	//	compact it once that is most of it, so this stays cheap per edit.
+	int nDeadText = (m_aUndoBuf.GetSize() > 0) ? m_aUndoBuf[0].m_nTextOffset : (int)m_aUndoText.size();
+	if (nDeadText > (int)m_aUndoText.size() / 2)
+	{
+		m_aUndoText.erase(m_aUndoText.begin(), m_aUndoText.begin() + nDeadText);
+		int nBufSize = (int)m_aUndoBuf.GetSize();
+		for (int I = 0; I < nBufSize; I ++)
+			m_aUndoBuf[I].m_nTextOffset -= nDeadText;
+	}
+}
+
 //	[JRT] Support For Descriptions On Undo/Redo Actions
 void CCrystalTextBuffer::AddUndoRecord(BOOL bInsert, const CPoint &ptStartPos, const CPoint &ptEndPos, LPCTSTR pszText, int nActionType)
 {
@@ -1061,8 +1094,8 @@ void CCrystalTextBuffer::AddUndoRecord(BOOL bInsert, const CPoint &ptStartPos, c
 	int nBufSize = (int)m_aUndoBuf.GetSize();
 	if (m_nUndoPosition < nBufSize)
 	{
-		for (int I = m_nUndoPosition; I < nBufSize; I++)
-			m_aUndoBuf[I].FreeText();
+		//	Their text is all at the end
+		m_aUndoText.resize(m_aUndoBuf[m_nUndoPosition].m_nTextOffset);
 		m_aUndoBuf.SetSize(m_nUndoPosition);
 	}
 	
@@ -1074,12 +1107,11 @@ void CCrystalTextBuffer::AddUndoRecord(BOOL bInsert, const CPoint &ptStartPos, c
 		int nIndex = 0;
 		for (;;)
 		{
-			m_aUndoBuf[nIndex].FreeText();
 			nIndex ++;
 			if (nIndex == nBufSize || (m_aUndoBuf[nIndex].m_dwFlags & UNDO_BEGINGROUP) != 0)
 				break;
 		}
-		m_aUndoBuf.RemoveAt(0, nIndex);
+		RemoveOldestUndoRecords(nIndex);
 	}
 	ASSERT(m_aUndoBuf.GetSize() < m_nUndoBufSize);
 	
@@ -1094,7 +1126,10 @@ void CCrystalTextBuffer::AddUndoRecord(BOOL bInsert, const CPoint &ptStartPos, c
 	}
 	ur.m_ptStartPos = ptStartPos;
 	ur.m_ptEndPos = ptEndPos;
-	ur.SetText(pszText);
+	ur.m_nTextOffset = (int)m_aUndoText.size();
+	if (pszText != NULL)
+		m_aUndoText.insert(m_aUndoText.end(), pszText, pszText + lstrlen(pszText));
+	m_aUndoText.push_back(0);
 	
 	m_aUndoBuf.Add(ur);
 	m_nUndoPosition = (int)m_aUndoBuf.GetSize();
@@ -1212,7 +1247,7 @@ void CCrystalTextBuffer::FlushUndoGroup(CCrystalTextView *pSource)
 		if (m_nUndoPosition > 0)
 		{
 			m_bUndoBeginGroup = TRUE;
-			pSource->OnEditOperation(m_aUndoBuf[m_nUndoPosition - 1].m_nAction, m_aUndoBuf[m_nUndoPosition - 1].GetText());
+			pSource->OnEditOperation(m_aUndoBuf[m_nUndoPosition - 1].m_nAction, GetUndoText(m_aUndoBuf[m_nUndoPosition - 1]));
 		}
 	}
 	m_bUndoGroup = FALSE;
@@ -102,7 +102,7 @@ protected:
 	struct SLineInfo
 	{
 		TCHAR	*m_pcLine;
-		int		m_nLength, m_nMax;
+		int		m_nLength, m_nMax;		//	m_nMax == 0: m_pcLine points into m_aLoadedText, and isn't ours
 		DWORD	m_dwFlags;
 
 		SLineInfo() { memset(this, 0, sizeof(SLineInfo)); };
@@ -122,35 +122,12 @@ protected:
 		CPoint	m_ptStartPos, m_ptEndPos;			//	Block of text participating
 		int		m_nAction;							//	For information only: action type
 
-	private:
-		//	TCHAR	*m_pcText;
-		//	Since in most cases we have 1 character here, 
-		//	we should invent a better way. Note: 2 * sizeof(WORD) <= sizeof(TCHAR*)
-		//
-		//	Here we will use the following trick: on Win32 platforms high-order word
-		//	of any pointer will be != 0. So we can store 1 character strings without
-		//	allocating memory.
-		//
-
-		union
-		{
-			TCHAR	*m_pszText;		//	For cases when we have > 1 character strings
-			TCHAR	m_szText[2];	//	For single-character strings
-		};
+		//	The text lives in m_aUndoText, rather than each record allocating its own.
+		//	Records are added in order, so their text is in the same order there.
+		int		m_nTextOffset;
 
-	public:
 		//	constructor/destructor for this struct
 		SUndoRecord() { memset(this, 0, sizeof(SUndoRecord)); };
-
-		void SetText(LPCTSTR pszText);
-		void FreeText();
-
-		LPCTSTR GetText() const
-		{
-			if (HIWORD((DWORD) (DWORD_PTR)m_pszText) != 0)
-				return m_pszText;
-			return m_szText;
-		};
 	};
 
 #pragma pack(pop)
@@ -171,9 +148,12 @@ protected:
 
 	//	Lines of text
 	CArray <SLineInfo, SLineInfo&> m_aLines;
+	//	The text of the file we loaded. Lines point directly into this until they're modified.
+	std::vector<TCHAR> m_aLoadedText;
 
 	//	Undo
 	CArray <SUndoRecord, SUndoRecord&> m_aUndoBuf;
+	std::vector<TCHAR> m_aUndoText;		//	Null-terminated text of each undo record
 	int m_nUndoPosition;
 	int m_nSyncPosition;
 	BOOL m_bUndoGroup, m_bUndoBeginGroup;
@@ -182,8 +162,11 @@ protected:
 	CList <CCrystalTextView *, CCrystalTextView *> m_lpViews;
 
 	//	Helper methods
+	void InitLine(SLineInfo &li, LPCTSTR pszLine, int nLength);
 	void InsertLine(LPCTSTR pszLine, int nLength = -1, int nPosition = -1);
 	void AppendLine(int nLineIndex, LPCTSTR pszChars, int nLength = -1);
+	LPCTSTR GetUndoText(const SUndoRecord &ur) const;
+	void RemoveOldestUndoRecords(int nCount);
 
 	//	Implementation
 	BOOL InternalInsertText(CCrystalTextView *pSource, int nLine, int nPos, LPCTSTR pszText, int &nEndLine, int &nEndChar);
@@ -794,26 +794,19 @@ void DecompileDialog::s_DecompileThreadWorker(DecompileDialog *pThis)
 
         if (pThis->_lookups)
         {
-            for (uint16_t scriptNum : scriptNumbers)
+            DecompileScripts(pThis->_decompilerConfig.get(), *pThis->_lookups, helper, scriptNumbers, *pThis->_decompileResults, std::thread::hardware_concurrency(),
+                [pThis, &helper](uint16_t scriptNum, sci::Script &script)
             {
-                if (!pThis->_decompileResults->IsAborted())
-                {
-                    pThis->_decompileResults->AddResult(DecompilerResultType::Important, fmt::format("Decompiling script {0}", scriptNum));
-                    CompiledScript compiledScript(0, CompiledScriptFlags::RemoveBadExports);
-                    if (compiledScript.Load(helper, helper.Version, scriptNum))
-                    {
-                        unique_ptr<sci::Script> pScript = DecompileScript(pThis->_decompilerConfig.get(), *pThis->_lookups, helper, scriptNum, compiledScript, *pThis->_decompileResults, pThis->_debugControlFlow, pThis->_debugInstConsumption, (PCSTR)pThis->_debugFunctionMatch, pThis->_debugAsm, pThis->_substituteTextTuples);
-                        // Dump it to the .sc file
-                        // TODO: If it already exists, we might want to ask for confirmation.
-                        std::stringstream ss;
-                        sci::SourceCodeWriter out(ss, helper.GetDefaultGameLanguage(), pScript.get());
-                        pScript->OutputSourceCode(out);
-                        string sourceFilename = helper.GetScriptFileName(scriptNum);
-                        MakeTextFile(ss.str().c_str(), sourceFilename);
-                        pThis->_decompileResults->AddResult(DecompilerResultType::Important, fmt::format("Generated {0}", sourceFilename));
-                    }
-                }
-            }
+                // Dump it to the .sc file
+                // TODO: If it already exists, we might want to ask for confirmation.
+                std::stringstream ss;
+                sci::SourceCodeWriter out(ss, helper.GetDefaultGameLanguage(), &script);
+                script.OutputSourceCode(out);
+                string sourceFilename = helper.GetScriptFileName(scriptNum);
+                MakeTextFile(ss.str().c_str(), sourceFilename);
+                pThis->_decompileResults->AddResult(DecompilerResultType::Important, fmt::format("Generated {0}", sourceFilename));
+            },
+                pThis->_debugControlFlow, pThis->_debugInstConsumption, (PCSTR)pThis->_debugFunctionMatch, pThis->_debugAsm, pThis->_substituteTextTuples);
             if (pThis->_decompileResults->IsAborted())
             {
                 pThis->_decompileResults->AddResult(DecompilerResultType::Warning, "Decompile aborted");
@@ -851,6 +844,7 @@ void DecompilerDialogResults::AddResult(DecompilerResultType type, const std::st
 
 void DecompilerDialogResults::InformStats(bool functionSuccessful, int byteCount)
 {
+    std::lock_guard<std::mutex> lock(_statsMutex);
     if (functionSuccessful)
     {
         _successCount++;
@@ -40,6 +40,7 @@ public:
     int _fallbackBytes;
 
 private:
+    std::mutex _statsMutex;     // Scripts are decompiled on several threads
     bool _aborted;
     HWND _hwnd;
     std::vector<std::pair<std::string, std::string>> _globalsUpdated;
@@ -237,22 +237,45 @@ void AudioWaveformUI::_DrawWaveform(CDC *pDC, LPRECT prc)
         int width = RECTWIDTH(*prc);
         std::unique_ptr<int[]> waveFormMax = std::make_unique<int[]>(width);
         std::unique_ptr<int[]> waveFormMin = std::make_unique<int[]>(width);
-        int binSize = (sampleCount + (width - 1)) / width;  // "round up"
-        for (int i = 0; i < sampleCount; i++)
+        int binSize = max(1, (sampleCount + (width - 1)) / width);  // "round up"
+        const DPCMSampleSource *encoded = _audioComponent->GetEncodedSource();
+        if (encoded && (binSize >= (int)encoded->GetSamplesPerOverviewEntry()))
         {
-            int value;
-            if (blockAlign == 1)
-            { 
-                value = (int)_audioComponent->DigitalSamplePCM[i] - scale; // Normalize
-            }
-            else
+            // Long clip that hasn't been decoded. The precomputed overview is detailed enough, so use that
+            // instead of decoding everything.
+            int samplesPerEntry = (int)encoded->GetSamplesPerOverviewEntry();
+            const std::vector<AudioPeak> &overview = encoded->GetOverview();
+            for (size_t entry = 0; entry < overview.size(); entry++)
             {
-                // 16 bit is signed already? (usually)
-                value = *reinterpret_cast<const int16_t*>(&_audioComponent->DigitalSamplePCM[i * 2]);
+                // An entry may straddle two bins.
+                int firstBin = (int)(entry * samplesPerEntry / binSize);
+                int lastBin = min(width - 1, (int)((min((int)((entry + 1) * samplesPerEntry), sampleCount) - 1) / binSize));
+                for (int bin = firstBin; bin <= lastBin; bin++)
+                {
+                    waveFormMax[bin] = max(waveFormMax[bin], (int)overview[entry].Max);
+                    waveFormMin[bin] = min(waveFormMin[bin], (int)overview[entry].Min);
+                }
             }
+        }
+        else
+        {
+            const std::vector<uint8_t> &pcm = _audioComponent->GetPCM();
+            for (int i = 0; i < sampleCount; i++)
+            {
+                int value;
+                if (blockAlign == 1)
+                {
+                    value = (int)pcm[i] - scale; // Normalize
+                }
+                else
+                {
+                    // 16 bit is signed already? (usually)
+                    value = *reinterpret_cast<const int16_t*>(&pcm[i * 2]);
+                }
 
-            waveFormMax[i / binSize] = max(waveFormMax[i / binSize], value);
-            waveFormMin[i / binSize] = min(waveFormMin[i / binSize], value);
+                waveFormMax[i / binSize] = max(waveFormMax[i / binSize], value);
+                waveFormMin[i / binSize] = min(waveFormMin[i / binSize], value);
+            }
         }
 
         for (int x = 0; x < width; x++)
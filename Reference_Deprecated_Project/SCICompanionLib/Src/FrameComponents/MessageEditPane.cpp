@@ -803,7 +803,7 @@ void MessageEditPane::OnBnClickedButtonlipsyncDialog()
         // phil temp min max
         uint8_t maxV = 0;
         uint8_t minV = 255;
-        for (uint8_t value : _pDoc->GetAudioResource()->GetComponent<AudioComponent>().DigitalSamplePCM)
+        for (uint8_t value : _pDoc->GetAudioResource()->GetComponent<AudioComponent>().GetPCM())
         {
             maxV = max(maxV, value);
             minV = min(minV, value);
@@ -29,6 +29,7 @@
 #include "View.h"
 #include "ResourceBlob.h"
 #include "format.h"
+#include "WorkerPool.h"
 
 using namespace std;
 
@@ -102,7 +103,7 @@ BEGIN_MESSAGE_MAP(CResourceListCtrl, CListCtrl)
     ON_WM_CONTEXTMENU()
     // XP only...
     //ON_NOTIFY_REFLECT(LVN_BEGINSCROLL, OnBeginScroll)
-    //ON_NOTIFY_REFLECT(LVN_ENDSCROLL, OnEndScroll)
+    ON_NOTIFY_REFLECT(LVN_ENDSCROLL, OnEndScroll)
     ON_WM_KEYDOWN()
 END_MESSAGE_MAP()
 
@@ -127,6 +128,37 @@ void CResourceListCtrl::OnBeginScroll(NMHDR* pNMHDR, LRESULT* pResult)
 void CResourceListCtrl::OnEndScroll(NMHDR* pNMHDR, LRESULT* pResult)
 {
     _bScrolling = FALSE;
+    _OnEndScroll();
+}
+
+//
+// For deciding which previews to generate first: items that intersect the client area are
+// visible, and those within a page of it are near-visible. Other items aren't included.
+//
+std::unordered_map<LPARAM, WorkPriority> CResourceListCtrl::_GetPreviewPriorities()
+{
+    std::unordered_map<LPARAM, WorkPriority> priorities;
+    CRect rcVisible;
+    GetClientRect(&rcVisible);
+    CRect rcNearVisible = rcVisible;
+    rcNearVisible.InflateRect(0, rcVisible.Height());
+    int count = GetItemCount();
+    for (int i = 0; i < count; i++)
+    {
+        CRect rcItem, rcIntersect;
+        if (GetItemRect(i, &rcItem, LVIR_BOUNDS))
+        {
+            if (rcIntersect.IntersectRect(&rcItem, &rcVisible))
+            {
+                priorities[GetItemData(i)] = WorkPriority::Visible;
+            }
+            else if (rcIntersect.IntersectRect(&rcItem, &rcNearVisible))
+            {
+                priorities[GetItemData(i)] = WorkPriority::NearVisible;
+            }
+        }
+    }
+    return priorities;
 }
 
 
@@ -22,6 +22,8 @@ class CResourceListDoc;
 class ResourceBlob;
 enum class ResourceLoadStatusFlags : uint8_t;
 enum class ResourceSourceFlags;
+enum class WorkPriority;
+template <class TITEM, class TRESULT> class QueueItems;
 
 typedef CDocument*(* PFNRESOURCEOPEN )(const ResourceBlob *pData);
 
@@ -91,6 +93,41 @@ protected:
     LPARAM _InsertItem(std::unique_ptr<ResourceBlob> pData);
     void _DeleteItem(const ResourceBlob *pData);
     virtual void _RegenerateImages() {}
+    virtual void _OnEndScroll() {}
+    std::unordered_map<LPARAM, WorkPriority> _GetPreviewPriorities();
+    template<class TITEM, class TRESULT>
+    void _ReprioritizePreviews(QueueItems<TITEM, TRESULT> &queue)
+    {
+        // Work on what's now in view first, and forget about what's scrolled well out of view.
+        std::unordered_map<LPARAM, WorkPriority> priorities = _GetPreviewPriorities();
+        std::vector<std::unique_ptr<TITEM>> cancelled = queue.ReprioritizeWorkItems(
+            [&priorities](const TITEM &workItem, WorkPriority &priority)
+        {
+            auto it = priorities.find(workItem.lParam);
+            if (it != priorities.end())
+            {
+                priority = it->second;
+                return true;
+            }
+            return false;
+        });
+
+        // Ask for these again when they come back into view.
+        for (auto &workItem : cancelled)
+        {
+            LVFINDINFO findInfo = {};
+            findInfo.flags = LVFI_PARAM;
+            findInfo.lParam = workItem->lParam;
+            LVITEM item = {};
+            item.iItem = FindItem(&findInfo);
+            if (item.iItem != -1)
+            {
+                item.mask = LVIF_IMAGE;
+                item.iImage = I_IMAGECALLBACK;
+                SetItem(&item);
+            }
+        }
+    }
     virtual void _PrepareLVITEM(LVITEM *pItem);
     virtual void _OnItemDoubleClick(const ResourceBlob *pData);
     virtual void _OnInitListView(int cItems);
@@ -100,8 +100,7 @@ BOOL CResourcePicListCtrl::SetItemImage(int nItem , int nImageIndex)
 
 LRESULT CResourcePicListCtrl::OnPicReady(WPARAM wParam, LPARAM lParam)
 {
-    PICWORKRESULT *pWorkResult;
-    while (_pQueue->TakeWorkResult(&pWorkResult))
+    for (unique_ptr<PICWORKRESULT> &pWorkResult : _pQueue->TakeWorkResults())
     {
         int cItems = GetItemCount();
         for (int i = 0; i < cItems; i++)
@@ -121,7 +120,6 @@ LRESULT CResourcePicListCtrl::OnPicReady(WPARAM wParam, LPARAM lParam)
                 break;
             }
         }
-        delete pWorkResult;
     }
     return 0;
 }
@@ -139,6 +137,7 @@ void CResourcePicListCtrl::OnGetDispInfo(NMHDR* pNMHDR, LRESULT* pResult)
                 ResourceBlob *pData = _GetResourceForItemRealized(pItem->lParam);
                 unique_ptr<PICWORKITEM> pWorkItem = make_unique<PICWORKITEM>();
                 pWorkItem->blob = *pData;
+                pWorkItem->lParam = pItem->lParam;
                 _pQueue->GiveWorkItem(move(pWorkItem));
                 pItem->iImage = _iTokenImageIndex; // Done!
                 pItem->mask |= LVIF_DI_SETITEM; // So we don't ask for it again.
@@ -160,6 +159,14 @@ void CResourcePicListCtrl::_RegenerateImages()
     }
 }
 
+void CResourcePicListCtrl::_OnEndScroll()
+{
+    if (_pQueue)
+    {
+        _ReprioritizePreviews(*_pQueue);
+    }
+}
+
 void CResourcePicListCtrl::_OnInitListView(int cItems)
 {
     // Put an imagelist in the view, for our pic previews.
@@ -26,6 +26,7 @@ class PICWORKITEM
 {
 public:
     ResourceBlob blob;
+    LPARAM lParam;
 };
 
 
@@ -38,7 +39,7 @@ public:
     PICWORKRESULT() { hbmp = NULL; nID= 0; }
     ~PICWORKRESULT() { DeleteObject(hbmp); }
     HBITMAP hbmp;
-    UINT nID;
+    uint64_t nID;
     int iResourceNumber;
     int iPackageNumber;
 
@@ -73,6 +74,7 @@ protected:
     virtual void _PrepareLVITEM(LVITEM *pItem);
     virtual void _OnInitListView(int cItems);
     void _RegenerateImages() override;
+    void _OnEndScroll() override;
 
 // Generated message map functions
 protected:
@@ -484,7 +484,8 @@ void VocabPreviewer::SetResource(const ResourceBlob &blob)
             initTime = timer.Stop();
 
             timer.Start();
-            _Populate(pResource->GetComponent<Vocab000>().GetWords());
+            const Vocab000::word_set &words = pResource->GetComponent<Vocab000>().GetWords();
+            _Populate(std::vector<std::string>(words.begin(), words.end()));
             popTime = timer.Stop();
             fSuccess = true;
         }
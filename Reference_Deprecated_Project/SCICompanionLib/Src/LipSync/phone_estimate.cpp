@@ -43,12 +43,9 @@ This file has the following data and constants
 
 **/
 #include "stdafx.h"
-#include <sphelper.h>
-#include <comdef.h>
 #include <string>
-#include "sapi_lipsync.h"
+// (Modified for SCI Companion: no SAPI dependencies here, so this can be used by the acoustic estimator)
 #include "phone_estimate.h"
-#include "sapi_util.h"
 #include <locale>
 #include <codecvt>
 
@@ -272,4 +269,33 @@ void phoneme_estimator::TrivialPhonemeAlignment(alignment_result& align)
 			pos = endTime;
 		}
 	}
-}
\ No newline at end of file
+}
+
+
+/**
+(Added for SCI Companion)
+This maps the engine phonemes in the alignment result to the output
+phonemes, as EstimatePhonemeAlignment does, but leaves the phoneme
+timings alone. This is used when the timings have been measured from
+the audio signal, rather than estimated.
+@param align 
+		-[in] the phoneme list
+		-[out] mapped phoneme list
+**/
+void phoneme_estimator::MapPhonemes(alignment_result& align)
+{
+	for (auto &phoneme : align.m_phonemes)
+	{
+		for (engine_phoneme_spec *p = m_pSpec; p->enginePhoneme.size(); p++)
+		{
+			if (phoneme == p->enginePhoneme)
+			{
+				if (p->outputPhoneme.size())
+				{
+					phoneme = p->outputPhoneme;
+				}
+				break;
+			}
+		}
+	}
+}
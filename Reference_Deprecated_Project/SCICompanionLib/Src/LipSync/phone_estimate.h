@@ -55,6 +55,46 @@ have a short hold compared to voiced phonemes, dipthongs hold the longest.
 // forward declaration
 class engine_phoneme_spec;
 
+/**
+    @brief This data class contains phoneme alignment/lipsync results
+
+     sapi_lipsync and it's subclasses generate a list of alignment_result
+	 objects.
+	
+	 The 'raw' form will contain the start and end time for each recognized
+	 word, along with the orthography (the text of the word) and the
+	 list of phonemes (alignment_result::m_phonemes)
+	
+	 alignment_result::m_phonemeEndTimes are not produced by SAPI.
+	 The actual phoneme times are estimated by this application. (see
+	 sapi_lipsync::finalize_phoneme_alignment for details).
+
+	 Applications can either use the raw word results or use the finalized
+	 data.
+	@see ::run_sapi_textbased_lipsync for example code
+	@see ::run_sapi_textless_lipsync for example code
+  */
+class alignment_result
+{
+public:
+    /// start time in milliseconds of this alignment result
+    long        m_msStart;
+    /// end time in milliseconds of this alignment result
+    long        m_msEnd;
+    /// the text representing this result
+    std::wstring m_orthography;
+    /** @brief the phonemes representing this result <P>
+		These are pulled from sapi. Each phoneme is a separate
+		index in the phonemes array (for easier parsing) */
+    std::vector<std::wstring> m_phonemes;
+	/**@brief the end time for each phoneme in milliseconds.<P>
+		SAPI 5.1 does not generate this information, instead sapi_lipsync
+		uses the phoneme_estimator to do this. applications can also
+		build their own */
+	std::vector<long> m_phonemeEndTimes;
+};
+
+
 /**
 @brief the phoneme estimator class is used to estimate the
 timing of phonemes in a word.
@@ -100,6 +140,10 @@ public:
 
 	/// This static method estimates the phoneme durations given an alignment result
 	static void TrivialPhonemeAlignment(alignment_result& align);
+
+	/// Maps the engine phonemes to output phonemes, leaving the timings alone.
+	/// (Added for SCI Companion, for phonemes whose timings come from the audio signal)
+	void MapPhonemes(alignment_result& align);
 protected:
 	/// the list of phonemes we expect to see in EstimatePhonemeAlignment
 	engine_phoneme_spec* m_pSpec;
@@ -428,7 +428,7 @@ void CMessageDoc::SetAudioResource(std::unique_ptr<ResourceEntity> audioResource
     UpdateAllViewsAndNonViews(nullptr, 0, &WrapHint(MessageChangeHint::ItemChanged));
 }
 
-void CMessageDoc::SetMessageResource(std::unique_ptr<ResourceEntity> pMessage, int id)
+void CMessageDoc::SetMessageResource(std::unique_ptr<ResourceEntity> pMessage, uint64_t id)
 {
     _checksum = id;
 
@@ -31,7 +31,7 @@ public:
     virtual void Serialize(CArchive& ar);   // overridden for document i/o
 
     // Takes ownership:
-    void SetMessageResource(std::unique_ptr<ResourceEntity> pText, int id = -1);
+    void SetMessageResource(std::unique_ptr<ResourceEntity> pText, uint64_t id = NoChecksum);
 
     // CUndoResource
     void v_OnUndoRedo();
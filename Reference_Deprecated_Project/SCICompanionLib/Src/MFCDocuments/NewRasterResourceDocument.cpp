@@ -127,7 +127,7 @@ void CNewRasterResourceDocument::SetNewResource(std::unique_ptr<ResourceEntity>
     SetResource(move(pResource));
 }
 
-void CNewRasterResourceDocument::SetResource(std::unique_ptr<ResourceEntity> pResource, int id)
+void CNewRasterResourceDocument::SetResource(std::unique_ptr<ResourceEntity> pResource, uint64_t id)
 {
     _checksum = id;
     const RasterComponent &raster = pResource->GetComponent<RasterComponent>();
@@ -50,7 +50,7 @@ class CNewRasterResourceDocument : public ResourceEntityDocument, public IResour
 public:
     CNewRasterResourceDocument();
 
-    void SetResource(std::unique_ptr<ResourceEntity> pResource, int id = -1);
+    void SetResource(std::unique_ptr<ResourceEntity> pResource, uint64_t id = NoChecksum);
     void SetNewResource(std::unique_ptr<ResourceEntity> pResource);
 
     void LockResource(bool fLock) { _fLocked = fLock; }
@@ -25,7 +25,7 @@ using namespace std;
 
 IMPLEMENT_DYNCREATE(CPaletteDoc, CResourceDocument)
 
-void CPaletteDoc::SetResource(std::unique_ptr<ResourceEntity> pPalette, int id)
+void CPaletteDoc::SetResource(std::unique_ptr<ResourceEntity> pPalette, uint64_t id)
 {
     _checksum = id;
     AddFirstResource(move(pPalette));
@@ -26,7 +26,7 @@ public:
 	virtual void Serialize(CArchive& ar);   // overridden for document i/o
 
     // Takes ownership:
-    void SetResource(std::unique_ptr<ResourceEntity> pPalette, int id = -1);
+    void SetResource(std::unique_ptr<ResourceEntity> pPalette, uint64_t id = NoChecksum);
 
     // CUndoResource
     void v_OnUndoRedo();
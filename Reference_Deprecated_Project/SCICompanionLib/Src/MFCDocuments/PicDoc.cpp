@@ -249,7 +249,7 @@ void CPicDoc::OnResourceAdded(const ResourceBlob *pData, AppendBehavior appendBe
     }
 }
 
-void CPicDoc::SetEditPic(DependencyTracker &tracker, std::unique_ptr<ResourceEntity> pEditPic, int id)
+void CPicDoc::SetEditPic(DependencyTracker &tracker, std::unique_ptr<ResourceEntity> pEditPic, uint64_t id)
 {
 	_isUndithered = appState->GetResourceMap().Helper().GetUndither();
 
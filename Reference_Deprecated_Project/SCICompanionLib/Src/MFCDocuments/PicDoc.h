@@ -138,7 +138,7 @@ public:
     PicDrawManager &GetDrawManager();
 
     // This transfers ownership of pic resource to this class.
-    void SetEditPic(DependencyTracker &tracker, std::unique_ptr<ResourceEntity> pEditPic, int id = -1);
+    void SetEditPic(DependencyTracker &tracker, std::unique_ptr<ResourceEntity> pEditPic, uint64_t id = NoChecksum);
     
     const PicComponent *GetPic() const { return _GetPic(); }
 
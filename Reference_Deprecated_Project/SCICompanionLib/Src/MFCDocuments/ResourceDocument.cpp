@@ -227,7 +227,7 @@ BOOL CResourceDocument::_DoResourceSave(int iPackageNumber, int iResourceNumber,
     // Ignore path name.
     const ResourceEntity *pResource = static_cast<const ResourceEntity *>(GetResource());
     bool saved = false;
-    int checksum = 0;
+    uint64_t checksum = 0;
     if (pResource)
     {
         saved = appState->GetResourceMap().AppendResource(*pResource, iPackageNumber, iResourceNumber, name, NoBase36, &checksum);
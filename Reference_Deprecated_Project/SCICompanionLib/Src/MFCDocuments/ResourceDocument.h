@@ -29,7 +29,7 @@ class CResourceDocument : public CNonViewHostDocument, public IResourceIdentifie
 	DECLARE_DYNAMIC(CResourceDocument)
 
 public:
-    CResourceDocument() { _checksum = -1; _fMostRecent = true; _needsResourceSizeUpdate = true; }
+    CResourceDocument() { _checksum = NoChecksum; _fMostRecent = true; _needsResourceSizeUpdate = true; }
     BOOL CanCloseFrame(CFrameWnd* pFrameArg);
 	virtual BOOL SaveModified(); // return TRUE if ok to continue
     void OnFileSave();
@@ -43,7 +43,7 @@ public:
     int GetNumber() const override;
     uint32_t GetBase36() const override;
     ResourceType GetType() const override;
-    int GetChecksum() const override { return _checksum; }
+    uint64_t GetChecksum() const override { return _checksum; }
 
     bool IsMostRecent() const;
 
@@ -76,7 +76,7 @@ protected:
 
     DECLARE_MESSAGE_MAP()
 
-    int _checksum;
+    uint64_t _checksum;
     bool _fMostRecent;
     bool _needsResourceSizeUpdate;
     std::string _resSize;
@@ -130,6 +130,16 @@ public:
         return modified;
     }
 
+    // For the few places that modify the current resource directly (e.g. while dragging), rather
+    // than going through ApplyChanges. Components can be shared with other frames in the undo stack,
+    // so this gives back one that belongs to the current resource only.
+    template<typename _T>
+    _T *TryGetComponentForInPlaceEdit()
+    {
+        ResourceEntity *pEntity = const_cast<ResourceEntity*>(GetResource());
+        return pEntity ? pEntity->TryGetComponent<_T>() : nullptr;
+    }
+
     void _OnSuccessfulSave(const ResourceEntity *pResource) override
     {
         SetLastSaved(pResource);
@@ -38,11 +38,13 @@
 #include "DecompilerResults.h"
 #include "GameFolderHelper.h"
 #include "DecompilerConfig.h"
+#include "ParsedScriptCache.h"
 #include "format.h"
 #include "ResourceBlob.h"
 #include "DependencyTracker.h"
 #include "OutputCodeHelper.h"
 #include "ScriptConvert.h"
+#include "ParallelFor.h"
 #include <filesystem>
 
 using namespace std;
@@ -223,6 +225,7 @@ bool NewCompileScript(CompileResults &results, CompileLog &log, CompileTables &t
 
     // Make a new buffer.
     CCrystalTextBuffer buffer;
+    FileStamp stamp = GetFileStamp(script.GetFullPath());
     if (buffer.LoadFromFile(script.GetFullPath().c_str()))
     {
         CScriptStreamLimiter limiter(&buffer);
@@ -295,6 +298,9 @@ bool NewCompileScript(CompileResults &results, CompileLog &log, CompileTables &t
                     scdFile.write((const char *)&results.GetDebugInfo()[0], (std::streamsize)results.GetDebugInfo().size());
                     scdFile.close();
                 }
+
+                // Hang onto the parsed script so things like said validation don't need to parse it again.
+                CacheParsedScript(script, stamp, std::shared_ptr<sci::Script>(move(pScript)));
                 fRet = true;
             }
         }
@@ -372,34 +378,157 @@ void FixDuplicateObjectNames(CompiledScript &compiledScript, const SelectorTable
     }
 }
 
-std::unique_ptr<sci::Script> DecompileScript(const IDecompilerConfig *config, GlobalCompiledScriptLookups &scriptLookups, const GameFolderHelper &helper, WORD wScript, CompiledScript &compiledScript, IDecompilerResults &results, bool debugControlFlow, bool debugInstConsumption, PCSTR pszDebugFilter, bool decompileAsm, bool substituteTextTuples)
+// The state for decompiling one script, which needs to stay around between the two steps.
+class ScriptDecompiler
 {
-    unique_ptr<sci::Script> pScript;
-    ObjectFileScriptLookups objectFileLookups(helper, scriptLookups.GetSelectorTable());
-    // Ok if pText fails (and is NULL)
-    unique_ptr<ResourceEntity> textResource = appState->GetResourceMap().CreateResourceFromNumber(ResourceType::Text, wScript);
-    TextComponent *pText = nullptr;
-    if (textResource)
+public:
+    ScriptDecompiler(const IDecompilerConfig *config, GlobalCompiledScriptLookups &scriptLookups, const GameFolderHelper &helper, WORD wScript, CompiledScript &compiledScript, IDecompilerResults &results, bool debugControlFlow, bool debugInstConsumption, PCSTR pszDebugFilter, bool decompileAsm, bool substituteTextTuples) :
+        _scriptLookups(scriptLookups),
+        _helper(helper),
+        _compiledScript(compiledScript),
+        _objectFileLookups(helper, scriptLookups.GetSelectorTable())
+    {
+        // Ok if pText fails (and is NULL)
+        _textResource = appState->GetResourceMap().CreateResourceFromNumber(ResourceType::Text, wScript);
+        TextComponent *pText = nullptr;
+        if (_textResource)
+        {
+            pText = _textResource->TryGetComponent<TextComponent>();
+        }
+
+        FixDuplicateObjectNames(compiledScript, config->GetSelectorTable());
+
+        _decompileLookups = make_unique<DecompileLookups>(config, helper, wScript, &scriptLookups, &_objectFileLookups, &compiledScript, pText, &compiledScript, results);
+        _decompileLookups->DebugControlFlow = debugControlFlow;
+        _decompileLookups->DebugInstructionConsumption = debugInstConsumption;
+        _decompileLookups->pszDebugFilter = pszDebugFilter;
+        _decompileLookups->DecompileAsm = decompileAsm;
+        _decompileLookups->SubstituteTextTuples = substituteTextTuples;
+    }
+
+    void Decompile(const Vocab000 *pWords)
+    {
+        _script.reset(DecompileCode(_helper, _compiledScript, *_decompileLookups, pWords, _exportSlotToName));
+    }
+
+    std::unique_ptr<sci::Script> Finish(bool &mainUpdated)
     {
-        pText = textResource->TryGetComponent<TextComponent>();
+        mainUpdated = FinishDecompile(_helper, _compiledScript, *_decompileLookups, *_script, _exportSlotToName);
+
+        if (_helper.Language == LangSyntaxSCI)
+        {
+            ConvertToSCISyntaxHelper(*_script, &_scriptLookups);
+        }
+        return move(_script);
     }
 
-    FixDuplicateObjectNames(compiledScript, config->GetSelectorTable());
+private:
+    GlobalCompiledScriptLookups &_scriptLookups;
+    const GameFolderHelper &_helper;
+    CompiledScript &_compiledScript;
+    ObjectFileScriptLookups _objectFileLookups;
+    unique_ptr<ResourceEntity> _textResource;
+    unique_ptr<DecompileLookups> _decompileLookups;
+    unique_ptr<sci::Script> _script;
+    map<int, string> _exportSlotToName;
+};
+
+std::unique_ptr<sci::Script> DecompileScript(const IDecompilerConfig *config, GlobalCompiledScriptLookups &scriptLookups, const GameFolderHelper &helper, WORD wScript, CompiledScript &compiledScript, IDecompilerResults &results, bool debugControlFlow, bool debugInstConsumption, PCSTR pszDebugFilter, bool decompileAsm, bool substituteTextTuples)
+{
+    ScriptDecompiler decompiler(config, scriptLookups, helper, wScript, compiledScript, results, debugControlFlow, debugInstConsumption, pszDebugFilter, decompileAsm, substituteTextTuples);
+    decompiler.Decompile(appState->GetResourceMap().GetVocab000());
+    bool mainUpdated;
+    return decompiler.Finish(mainUpdated);
+}
+
+// The number of scripts whose code is decompiled together before they are finished. This is fixed (rather
+// than depending on the number of workers), so that the results don't depend on the number of workers.
+const size_t DecompileBatchSize = 16;
 
-    DecompileLookups decompileLookups(config, helper, wScript, &scriptLookups, &objectFileLookups, &compiledScript, pText, &compiledScript, results);
-    decompileLookups.DebugControlFlow = debugControlFlow;
-    decompileLookups.DebugInstructionConsumption = debugInstConsumption;
-    decompileLookups.pszDebugFilter = pszDebugFilter;
-    decompileLookups.DecompileAsm = decompileAsm;
-    decompileLookups.SubstituteTextTuples = substituteTextTuples;
-    pScript.reset(Decompile(helper, compiledScript, decompileLookups, appState->GetResourceMap().GetVocab000()));
+struct ScriptDecompileJob
+{
+    uint16_t ScriptNumber;
+    unique_ptr<CompiledScript> Compiled;
+    unique_ptr<ScriptDecompiler> Decompiler;
+    exception_ptr Exception;
+};
 
-    if (helper.Language == LangSyntaxSCI)
+void DecompileScripts(const IDecompilerConfig *config, GlobalCompiledScriptLookups &scriptLookups, const GameFolderHelper &helper, const std::set<uint16_t> &scriptNumbers, IDecompilerResults &results, unsigned int workerCount, std::function<void(uint16_t, sci::Script &)> onScriptDecompiled, bool debugControlFlow, bool debugInstConsumption, PCSTR pszDebugFilter, bool decompileAsm, bool substituteTextTuples)
+{
+    if (debugControlFlow || debugInstConsumption)
     {
-        ConvertToSCISyntaxHelper(*pScript, &scriptLookups);
+        // These show debugging output as each function is decompiled.
+        workerCount = 1;
     }
+    workerCount = max(1u, workerCount);
+
+    // Load this now, so the workers don't race to do it.
+    const Vocab000 *pWords = appState->GetResourceMap().GetVocab000();
+
+    vector<uint16_t> numbers(scriptNumbers.begin(), scriptNumbers.end());
+    size_t start = 0;
+    while ((start < numbers.size()) && !results.IsAborted())
+    {
+        // Every other script gets its global variable names from main's .sco, so main is done by itself first.
+        size_t count = (numbers[start] == 0) ? 1 : min(DecompileBatchSize, numbers.size() - start);
+
+        // The resource map isn't thread-safe, so everything that needs it (loading the scripts and their
+        // text resources) is done here, before handing the scripts to the workers.
+        vector<ScriptDecompileJob> jobs(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            ScriptDecompileJob &job = jobs[i];
+            job.ScriptNumber = numbers[start + i];
+            job.Compiled = make_unique<CompiledScript>(0, CompiledScriptFlags::RemoveBadExports);
+            if (job.Compiled->Load(helper, helper.Version, job.ScriptNumber))
+            {
+                job.Decompiler = make_unique<ScriptDecompiler>(config, scriptLookups, helper, job.ScriptNumber, *job.Compiled, results, debugControlFlow, debugInstConsumption, pszDebugFilter, decompileAsm, substituteTextTuples);
+            }
+        }
+
+        ParallelFor(count, workerCount,
+            [&](size_t index)
+        {
+            ScriptDecompileJob &job = jobs[index];
+            try
+            {
+                if (job.Decompiler && !results.IsAborted())
+                {
+                    job.Decompiler->Decompile(pWords);
+                }
+            }
+            catch (...)
+            {
+                job.Exception = current_exception();
+            }
+        }
+            );
 
-    return pScript;
+        // Now finish them one at a time, in order.
+        size_t finished = 0;
+        while ((finished < count) && !results.IsAborted())
+        {
+            ScriptDecompileJob &job = jobs[finished++];
+            if (job.Exception)
+            {
+                rethrow_exception(job.Exception);
+            }
+            if (job.Decompiler)
+            {
+                results.AddResult(DecompilerResultType::Important, fmt::format("Decompiling script {0}", job.ScriptNumber));
+                bool mainUpdated;
+                unique_ptr<sci::Script> script = job.Decompiler->Finish(mainUpdated);
+                onScriptDecompiled(job.ScriptNumber, *script);
+                if (mainUpdated)
+                {
+                    // The rest of the batch was decompiled with main's old global variable names. Decompiling
+                    // them one at a time would have picked up the new ones, so they need to be done again.
+                    break;
+                }
+            }
+        }
+        start += finished;
+    }
 }
 
 void CScriptDocument::OnViewObjectFile()
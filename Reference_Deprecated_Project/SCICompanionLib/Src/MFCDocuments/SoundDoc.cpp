@@ -48,7 +48,7 @@ void CSoundDoc::v_OnUndoRedo()
     UpdateAllViewsAndNonViews(nullptr, 0, &WrapHint(SoundChangeHint::Changed | _UpdateChannelId()));
 }
 
-void CSoundDoc::SetSoundResource(std::unique_ptr<ResourceEntity> pSound, int id)
+void CSoundDoc::SetSoundResource(std::unique_ptr<ResourceEntity> pSound, uint64_t id)
 {
     _checksum = id;
     AddFirstResource(move(pSound));
@@ -226,7 +226,7 @@ void CSoundDoc::_OnImportMidi()
 
 void CSoundDoc::SetTempo(WORD wTempo)
 {
-    SoundComponent *pSound = const_cast<SoundComponent*>(GetSoundComponent());
+    SoundComponent *pSound = TryGetComponentForInPlaceEdit<SoundComponent>();
     if (pSound)
     {
         if (pSound->GetTempo() != wTempo)
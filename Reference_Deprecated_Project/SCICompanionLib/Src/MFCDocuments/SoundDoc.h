@@ -28,7 +28,7 @@ public:
 	virtual void Serialize(CArchive& ar);   // overridden for document i/o
 
     // Takes ownership:
-    void SetSoundResource(std::unique_ptr<ResourceEntity> pSound, int id = -1);
+    void SetSoundResource(std::unique_ptr<ResourceEntity> pSound, uint64_t id = NoChecksum);
     const SoundComponent *GetSoundComponent() const;
     DeviceType GetDevice() const { return _device; }
     void SetDevice(DeviceType device, bool fNotify = true);
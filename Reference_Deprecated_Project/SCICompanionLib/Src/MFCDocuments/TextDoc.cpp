@@ -25,7 +25,7 @@ using namespace std;
 
 IMPLEMENT_DYNCREATE(CTextDoc, CResourceDocument)
 
-void CTextDoc::SetTextResource(std::unique_ptr<ResourceEntity> pText, int id)
+void CTextDoc::SetTextResource(std::unique_ptr<ResourceEntity> pText, uint64_t id)
 {
     _checksum = id;
     AddFirstResource(move(pText));
@@ -26,7 +26,7 @@ public:
 	virtual void Serialize(CArchive& ar);   // overridden for document i/o
 
     // Takes ownership:
-    void SetTextResource(std::unique_ptr<ResourceEntity> pText, int id = -1);
+    void SetTextResource(std::unique_ptr<ResourceEntity> pText, uint64_t id = NoChecksum);
 
     // CUndoResource
     void v_OnUndoRedo();
@@ -20,8 +20,9 @@
 // ptrdiff_t is any extra info (like cursor position) you wish to include with the undo snapshot
 //
 
-#define MAX_UNDO 100
-#define AGGRESSIVITY_UNDO 30
+// Frames only pay for the components (and bitmaps) they don't share with the previous frame,
+// so we limit the undo stack by memory rather than by number of frames.
+#define MAX_UNDO_MEMORY (64 * 1024 * 1024)
 
 template <class _TBase, class _TItem>
 class CUndoResource : public _TBase
@@ -33,10 +34,12 @@ private:
         {
             item = std::move(theItem);
             extra = theExtra;
+            size = 0;
         }
 
         std::unique_ptr<_TItem> item;
         ptrdiff_t extra;
+        size_t size;    // Estimated memory not shared with the previous frame
     };
 
 protected:
@@ -47,7 +50,7 @@ public:
 
     typedef std::list<UndoData> _MyListType;
 
-    CUndoResource()
+    CUndoResource() : _totalSize(0)
     {
         _pos = _undo.end();
     }
@@ -58,29 +61,36 @@ public:
         _pLastSaved = pResource.get();
         _undo.emplace_back(std::move(pResource), extra);
         _pos = _GetLastUndoFrame();
+        _UpdateSize(_pos);
     }
 
-	void AddNewResourceToUndo(std::unique_ptr<_TItem> pResourceNew, ptrdiff_t extra = 0)
-	{
-		// Delete all resources after the current one.
+    void AddNewResourceToUndo(std::unique_ptr<_TItem> pResourceNew, ptrdiff_t extra = 0)
+    {
+        // Delete all resources after the current one.
         _MyListType::iterator pos = _pos;
-		++pos;
-		// Now pos points to the position after the current one.
-		while (pos != _undo.end())
-		{
-			// Delete all those resources.
+        ++pos;
+        // Now pos points to the position after the current one.
+        while (pos != _undo.end())
+        {
+            // Delete all those resources.
             _MyListType::iterator posToDel = pos;
-			++pos;
-			_undo.erase(posToDel);
-		}
+            ++pos;
+            _totalSize -= posToDel->size;
+            _undo.erase(posToDel);
+        }
+
+        // Previews are modified after they're added to the stack, so bring the size of the
+        // current frame up to date before measuring the new one against it.
+        _UpdateSize(_pos);
 
-		// Insert after the current pos (which is now the end), and make this our new pos.
+        // Insert after the current pos (which is now the end), and make this our new pos.
         _undo.emplace_back(std::move(pResourceNew), extra);
-		_pos = _GetLastUndoFrame();
+        _pos = _GetLastUndoFrame();
+        _UpdateSize(_pos);
 
-		// Make sure we don't grow infinitely.
-		_TrimUndoStack();
-	}
+        // Make sure we don't grow infinitely.
+        _TrimUndoStack();
+    }
 
     void SetExtra(ptrdiff_t extra)
     {
@@ -173,26 +183,37 @@ private:
         v_OnUndoRedo();
     }
 
-    void _TrimUndoStack()
+    void _UpdateSize(typename _MyListType::iterator pos)
     {
-        if (_undo.size() > MAX_UNDO)
+        if (pos != _undo.end())
         {
-            // Remove every other stored frame, up to a certain point.
-            _MyListType::iterator pos = _undo.begin();
-            BOOL fRemove = FALSE;
-            for (int i = 0; i < AGGRESSIVITY_UNDO; i++)
+            const _TItem *previous = nullptr;
+            if (pos != _undo.begin())
             {
-                if (pos != _pos) // Skip it if it's where we currently are!
-                {
-                    _MyListType::iterator posToMaybeDelete = pos;
-                    ++pos;
-                    if (fRemove)
-                    {
-                        _undo.erase(posToMaybeDelete);
-                    }
-                    fRemove = !fRemove;
-                }
+                _MyListType::iterator posPrevious = pos;
+                --posPrevious;
+                previous = posPrevious->item.get();
             }
+            _totalSize -= pos->size;
+            pos->size = pos->item->EstimateSize(previous);
+            _totalSize += pos->size;
+        }
+    }
+
+    void _TrimUndoStack()
+    {
+        // Drop the oldest frames until we're within budget (but never the one we're on).
+        bool trimmed = false;
+        while ((_totalSize > MAX_UNDO_MEMORY) && (_undo.begin() != _pos))
+        {
+            _totalSize -= _undo.front().size;
+            _undo.pop_front();
+            trimmed = true;
+        }
+        if (trimmed)
+        {
+            // The new oldest frame no longer shares anything with a previous one.
+            _UpdateSize(_undo.begin());
         }
     }
 
@@ -205,6 +226,7 @@ private:
     // Undo buffer.
     _MyListType _undo;
     typename _MyListType::iterator _pos;
+    size_t _totalSize;
 
     const _TItem *_pLastSaved; // Weak ref
 };
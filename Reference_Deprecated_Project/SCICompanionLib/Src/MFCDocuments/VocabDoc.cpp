@@ -42,7 +42,7 @@ void CVocabDoc::v_OnUndoRedo()
     UpdateAllViewsAndNonViews(nullptr, 0, &WrapHint(VocabChangeHint::Changed));
 }
 
-void CVocabDoc::SetVocabResource(std::unique_ptr<ResourceEntity> pVocab, int id)
+void CVocabDoc::SetVocabResource(std::unique_ptr<ResourceEntity> pVocab, uint64_t id)
 {
     _checksum = id;
     AddFirstResource(move(pVocab));
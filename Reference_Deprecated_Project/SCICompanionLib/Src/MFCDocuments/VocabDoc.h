@@ -27,7 +27,7 @@ public:
 	CVocabDoc();
 	virtual ~CVocabDoc();
 
-    void SetVocabResource(std::unique_ptr<ResourceEntity> pVocab, int id);
+    void SetVocabResource(std::unique_ptr<ResourceEntity> pVocab, uint64_t id);
     const Vocab000 *GetVocab() const;
 
     void v_OnUndoRedo() override;
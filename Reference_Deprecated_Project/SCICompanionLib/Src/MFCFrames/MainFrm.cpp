@@ -63,8 +63,10 @@
 #include "GenerateDocsDialog.h"
 #include "DependencyTracker.h"
 #include "MessageSource.h"
+#include "MessageDatabase.h"
 #include "ValidateSaid.h"
 #include "OutputScriptStrings.h"
+#include "FindInFiles.h"
 #include <filesystem>
 #include <regex>
 
@@ -1583,15 +1585,12 @@ void CMainFrame::OnFileNewPalette()
 void CMainFrame::OnFileNewMessage()
 {
     // Grok the current messages to figure out a message version.
-    auto messageContainer = appState->GetResourceMap().Resources(ResourceTypeFlags::Message, ResourceEnumFlags::AddInDefaultEnumFlags);
+    const MessageDatabase &messages = appState->GetResourceMap().GetMessageDatabase();
     uint16_t maxMessageVersion = 0;
-    vector<int> existingResources;
-    for (auto &messageBlob : *messageContainer)
+    vector<int> existingResources = messages.GetResourceNumbers();
+    for (int number : existingResources)
     {
-        existingResources.push_back(messageBlob->GetNumber());
-        sci::istream byteStream = messageBlob->GetReadStream();
-        uint16_t msgVersion = CheckMessageVersion(byteStream);
-        maxMessageVersion = max(maxMessageVersion, msgVersion);
+        maxMessageVersion = max(maxMessageVersion, messages.GetMessage(number)->msgVersion);
     }
 
     // Ask the user for resource number. We need this so we can support adding nouns and such.
@@ -2048,74 +2047,8 @@ void CMainFrame::OnCompileAll()
     CompileABunchOfScripts(appState, nullptr);
 }
 
-// TODO: Attempt at making Find in Files faster. regex was way too slow. Just need to mimic line endings of crystal text buffer.
-/*
-void CMainFrame::_AddFindResults(vector<char> &buffer, ICompileLog &log, PCTSTR pszFullPath, PCTSTR pszFileName, PCTSTR pszWhat, BOOL fMatchCase, BOOL fWholeWord)
-{
-    // Start easy at first
-    string searchString = fmt::format("({0})", pszWhat);
-    ifstream is;
-    is.open(pszFullPath, ios_base::in);
-    if (is.is_open())
-    {
-        is.read(&buffer[0], buffer.size());
-        PCSTR pszHere = &buffer[0];
-        int nPos;
-        while (-1 != (nPos = FindStringHelper(pszHere, pszWhat, fWholeWord)))
-        {
-            int x = 0;
-            pszHere += (nPos + 1);
-        }
-
-    }
-}
-*/
-
-
-void CMainFrame::_AddFindResults(vector<char> &dummyBuffer, ICompileLog &log, PCTSTR pszFullPath, PCTSTR pszFileName, PCTSTR pszWhat, BOOL fMatchCase, BOOL fWholeWord)
-{
-    CCrystalTextBuffer buffer;
-    if (buffer.LoadFromFile(pszFullPath))
-    {
-        int cLines = buffer.GetLineCount();
-        for (int nLine = 0; nLine < cLines; nLine++)
-        {
-            int nLineLength = buffer.GetLineLength(nLine);
-            if (nLineLength > 0)
-            {
-                CString strWhat = pszWhat;
-
-                PTSTR pszLine = buffer.GetLineChars(nLine);
-                CString line;
-                lstrcpyn(line.GetBuffer(nLineLength + 1), pszLine, nLineLength + 1);
-                line.ReleaseBuffer();
-                if (!fMatchCase)
-                {
-                    line.MakeUpper();
-                    strWhat.MakeUpper();
-                }
-                int nPos = FindStringHelper((LPCTSTR)line, (LPCTSTR)strWhat, fWholeWord);
-                if (nPos >= 0)
-                {
-                    // Remove tabs from the line (they don't look good in a listbox)
-                    CString lineCleansed;
-                    lstrcpyn(lineCleansed.GetBuffer(nLineLength + 1), pszLine, nLineLength + 1);
-                    lineCleansed.ReleaseBuffer();
-                    lineCleansed.Remove(TEXT('\t'));
-
-                    TCHAR szDescription[MAX_PATH];
-                    StringCchPrintf(szDescription, ARRAYSIZE(szDescription), TEXT("%s: %s"), pszFileName, (PCTSTR)lineCleansed);
-                    log.ReportResult(CompileResult(szDescription, ScriptId(pszFullPath), nLine + 1));
-                }
-            }
-        }
-    }
-    buffer.FreeAll();
-}
-
-void CMainFrame::_FindInFilesOfType(ICompileLog &log, const std::string &srcFolder, PCTSTR pszWildcard, PCTSTR pszWhat, BOOL fMatchCase, BOOL fWholeWord)
+void CMainFrame::_AddFilesOfType(std::vector<std::string> &filenames, const std::string &srcFolder, PCTSTR pszWildcard)
 {
-    vector<char> worker(5000);
     std::string wildcard = (srcFolder + pszWildcard);
     WIN32_FIND_DATA findData = { 0 };
     HANDLE hFFF = FindFirstFile(wildcard.c_str(), &findData);
@@ -2127,17 +2060,38 @@ void CMainFrame::_FindInFilesOfType(ICompileLog &log, const std::string &srcFold
             std::string strFullPath = srcFolder;
             strFullPath += "\\";
             strFullPath += (PCTSTR)findData.cFileName;
-            if (worker.size() < findData.nFileSizeLow)
-            {
-                worker.resize(findData.nFileSizeLow);
-            }
-            _AddFindResults(worker, log, strFullPath.c_str(), findData.cFileName, pszWhat, fMatchCase, fWholeWord);
+            filenames.push_back(strFullPath);
             fOk = FindNextFile(hFFF, &findData);
         }
         FindClose(hFFF);
     }
 }
 
+void CMainFrame::_FindInFiles(const std::vector<std::string> &filenames, PCTSTR pszWhat, BOOL fMatchCase, BOOL fWholeWord, std::function<void(CompileLog &)> addBatch)
+{
+    TextFinder finder(pszWhat, !!fMatchCase, !!fWholeWord);
+    FindInFiles(filenames, finder, std::thread::hardware_concurrency(),
+        [&addBatch](const std::string &fullPath, const std::vector<FoundLine> &lines)
+    {
+        CompileLog log;
+        PCTSTR pszFileName = PathFindFileName(fullPath.c_str());
+        for (const FoundLine &line : lines)
+        {
+            // Remove tabs from the line (they don't look good in a listbox)
+            std::string lineCleansed = line.Text.substr(0, line.Text.find('\0'));
+            lineCleansed.erase(std::remove(lineCleansed.begin(), lineCleansed.end(), '\t'), lineCleansed.end());
+
+            TCHAR szDescription[MAX_PATH];
+            StringCchPrintf(szDescription, ARRAYSIZE(szDescription), TEXT("%s: %s"), pszFileName, lineCleansed.c_str());
+            log.ReportResult(CompileResult(szDescription, ScriptId(fullPath), line.LineNumber + 1));
+        }
+        if (!log.Results().empty())
+        {
+            addBatch(log);
+        }
+    });
+}
+
 const int TextRangeOutsideResultToShow = 35;
 
 std::unordered_set<uint8_t> _GetSetOfMatchingNumbers(const std::vector<MessageDefine> &defines, PCTSTR pszWhat, BOOL fMatchCase, BOOL fWholeWord)
@@ -2174,7 +2128,43 @@ void CMainFrame::_FindInTexts(ICompileLog &log, PCTSTR pszWhat, BOOL fMatchCase,
         matchingTalkerNumbers = _GetSetOfMatchingNumbers(talkers->GetDefines(), pszWhat, fMatchCase, fWholeWord);
     }
 
-    auto container = appState->GetResourceMap().Resources(ResourceTypeFlags::Text | ResourceTypeFlags::Message, ResourceEnumFlags::MostRecentOnly | ResourceEnumFlags::AddInDefaultEnumFlags);
+    auto reportEntry = [&](ResourceType type, int resourceNumber, size_t index, const TextEntry &entry, int pos)
+    {
+        std::string resultText;
+        if (pos != -1)
+        {
+            const std::string &text = entry.Text;
+            int rangeStart = max(0, pos - TextRangeOutsideResultToShow);
+            int rangeEnd = min(pos + TextRangeOutsideResultToShow + lstrlen(pszWhat), (int)text.size());
+            resultText = fmt::format("{0}{1}{2}",
+                (rangeStart > 0) ? "" : "...",
+                text.substr(rangeStart, rangeEnd - rangeStart),
+                (rangeEnd < (int)text.size()) ? "" : "..."
+                );
+        }
+        else
+        {
+            if (entry.Talker && (matchingTalkerNumbers.find(entry.Talker) != matchingTalkerNumbers.end()))
+            {
+                resultText = fmt::format("{0} - {1}...", talkers->ValueToName(entry.Talker), entry.Text.substr(0, TextRangeOutsideResultToShow));
+            }
+            else if (entry.Verb && (matchingVerbNumbers.find(entry.Verb) != matchingVerbNumbers.end()))
+            {
+                resultText = fmt::format("{0} - {1}...", verbsMessageSource->ValueToName(entry.Verb), entry.Text.substr(0, TextRangeOutsideResultToShow));
+            }
+        }
+        if (!resultText.empty())
+        {
+            std::string finalText = fmt::format("{0} ({1}, {2}): {3}",
+                GetResourceInfo(type).pszTitleDefault,
+                resourceNumber,
+                index,
+                resultText);
+            log.ReportResult(CompileResult(finalText, type, resourceNumber, (int)index));
+        }
+    };
+
+    auto container = appState->GetResourceMap().Resources(ResourceTypeFlags::Text, ResourceEnumFlags::MostRecentOnly | ResourceEnumFlags::AddInDefaultEnumFlags);
     for (auto &blob : *container)
     {
         auto resource = CreateResourceFromResourceData(*blob);
@@ -2187,41 +2177,35 @@ void CMainFrame::_FindInTexts(ICompileLog &log, PCTSTR pszWhat, BOOL fMatchCase,
             {
                 ToUpper(text);
             }
-            int pos = FindStringHelper(text.c_str(), pszWhat, fWholeWord);
-            std::string resultText;
-            if (pos != -1)
-            {
-                text = textComponent.Texts[i].Text; // since we ToUpper'd it.
-                int rangeStart = max(0, pos - TextRangeOutsideResultToShow);
-                int rangeEnd = min(pos + TextRangeOutsideResultToShow + lstrlen(pszWhat), (int)text.size());
-                resultText = fmt::format("{0}{1}{2}",
-                    (rangeStart > 0) ? "" : "...",
-                    text.substr(rangeStart, rangeEnd - rangeStart),
-                    (rangeEnd < (int)text.size()) ? "" : "..."
-                    );
-            }
-            else
-            {
-                if (entry.Talker && (matchingTalkerNumbers.find(entry.Talker) != matchingTalkerNumbers.end()))
-                {
-                    resultText = fmt::format("{0} - {1}...", talkers->ValueToName(entry.Talker), textComponent.Texts[i].Text.substr(0, TextRangeOutsideResultToShow));
-                }
-                else if (entry.Verb && (matchingVerbNumbers.find(entry.Verb) != matchingVerbNumbers.end()))
-                {
-                    resultText = fmt::format("{0} - {1}...", verbsMessageSource->ValueToName(entry.Verb), textComponent.Texts[i].Text.substr(0, TextRangeOutsideResultToShow));
-                }
-            }
-            if (!resultText.empty())
-            {
-                std::string finalText = fmt::format("{0} ({1}, {2}): {3}",
-                    GetResourceInfo(blob->GetType()).pszTitleDefault,
-                    blob->GetNumber(),
-                    i,
-                    resultText);
-                log.ReportResult(CompileResult(finalText, blob->GetType(), blob->GetNumber(), (int)i));
-            }
+            reportEntry(blob->GetType(), blob->GetNumber(), i, entry, FindStringHelper(text.c_str(), pszWhat, fWholeWord));
+        }
+    }
+
+    // Messages are indexed, so we only need to look at the entries that match.
+    const MessageDatabase &messages = appState->GetResourceMap().GetMessageDatabase();
+    std::map<MessageEntryRef, int> matches; // -> position of the text, or -1 if it matched by talker or verb
+    for (const MessageTextMatch &match : messages.FindText(pszWhat, !!fMatchCase, !!fWholeWord))
+    {
+        matches[match.Entry] = (int)match.Position;
+    }
+    for (uint8_t talker : matchingTalkerNumbers)
+    {
+        for (const MessageEntryRef &ref : messages.FindByTalker(talker))
+        {
+            matches.insert(std::make_pair(ref, -1));
+        }
+    }
+    for (uint8_t verb : matchingVerbNumbers)
+    {
+        for (const MessageEntryRef &ref : messages.FindByVerb(verb))
+        {
+            matches.insert(std::make_pair(ref, -1));
         }
     }
+    for (auto &pair : matches)
+    {
+        reportEntry(ResourceType::Message, pair.first.ResourceNumber, pair.first.Index, messages.GetEntry(pair.first), pair.second);
+    }
 }
 
 void CMainFrame::_FindInVocab000(ICompileLog &log, PCTSTR pszWhat, BOOL fMatchCase, BOOL fWholeWord)
@@ -2271,6 +2255,17 @@ void CMainFrame::OnFindInFiles()
     CFindAllDialog dialog(_fMatchWholeWord, _fMatchCase, _fFindInAll, strFindWhat);
     if (IDOK == dialog.DoModal())
     {
+        // Results are shown as they are found.
+        appState->OutputClearResults(OutputPaneType::Find);
+        appState->ShowOutputPane(OutputPaneType::Find);
+        size_t occurrences = 0;
+        auto addBatch = [this, &occurrences](CompileLog &batch)
+        {
+            occurrences += batch.Results().size();
+            appState->OutputAddBatch(OutputPaneType::Find, batch.Results());
+            GetOutputPane().RedrawWindow(nullptr, nullptr, RDW_UPDATENOW | RDW_ALLCHILDREN);
+        };
+
         CompileLog log;
         // Say what we're doing:
         TCHAR szBuf[MAX_PATH];
@@ -2280,6 +2275,8 @@ void CMainFrame::OnFindInFiles()
                         _fMatchCase ? TEXT("matching case") : TEXT("not matching case"),
                         _fMatchWholeWord ? TEXT("matching whole word") : TEXT("not matching whole word"));
         log.ReportResult(CompileResult(szBuf));
+        appState->OutputAddBatch(OutputPaneType::Find, log.Results());
+        log.Clear();
 
         if (_fFindInAll)
         {
@@ -2288,14 +2285,15 @@ void CMainFrame::OnFindInFiles()
             std::string messageFolder = appState->GetResourceMap().Helper().GetMsgFolder();
             std::string includeFolder = appState->GetResourceMap().Helper().GetIncludeFolder();
 
-            _FindInFilesOfType(log, srcFolder, TEXT("\\*.sc"), strFindWhat, (_fMatchCase != 0), (_fMatchWholeWord != 0));
-            _FindInFilesOfType(log, srcFolder, TEXT("\\*.sh"), strFindWhat, (_fMatchCase != 0), (_fMatchWholeWord != 0));
-            _FindInFilesOfType(log, polyFolder, TEXT("\\*.shp"), strFindWhat, (_fMatchCase != 0), (_fMatchWholeWord != 0));
-            _FindInFilesOfType(log, messageFolder, TEXT("\\*.shm"), strFindWhat, (_fMatchCase != 0), (_fMatchWholeWord != 0));
-            _FindInFilesOfType(log, includeFolder, TEXT("\\*.sh"), strFindWhat, (_fMatchCase != 0), (_fMatchWholeWord != 0));
+            std::vector<std::string> filenames;
+            _AddFilesOfType(filenames, srcFolder, TEXT("\\*.sc"));
+            _AddFilesOfType(filenames, srcFolder, TEXT("\\*.sh"));
+            _AddFilesOfType(filenames, polyFolder, TEXT("\\*.shp"));
+            _AddFilesOfType(filenames, messageFolder, TEXT("\\*.shm"));
+            _AddFilesOfType(filenames, includeFolder, TEXT("\\*.sh"));
             // We don't support c++ syntax ATM
-            //_FindInFilesOfType(log, TEXT("\\*.scp"), strFindWhat, (_fMatchCase != 0), (_fMatchWholeWord != 0));
-            //_FindInFilesOfType(log, TEXT("\\*.shp"), strFindWhat, (_fMatchCase != 0), (_fMatchWholeWord != 0));
+            //_AddFilesOfType(filenames, srcFolder, TEXT("\\*.scp"));
+            _FindInFiles(filenames, strFindWhat, _fMatchCase, _fMatchWholeWord, addBatch);
 
             CString stdFindWhat2 = strFindWhat;
             if (_fMatchCase == 0)
@@ -2304,6 +2302,8 @@ void CMainFrame::OnFindInFiles()
             }
             _FindInTexts(log, stdFindWhat2, (_fMatchCase != 0), (_fMatchWholeWord != 0));
             _FindInVocab000(log, stdFindWhat2, (_fMatchCase != 0), (_fMatchWholeWord != 0));
+            addBatch(log);
+            log.Clear();
         }
         else
         {
@@ -2311,9 +2311,10 @@ void CMainFrame::OnFindInFiles()
             // TODO - re-implement this.
         }
 
-        StringCchPrintf(szBuf, ARRAYSIZE(szBuf), TEXT("Total occurrences found: %d"), (log.Results().size() - 1));
+        StringCchPrintf(szBuf, ARRAYSIZE(szBuf), TEXT("Total occurrences found: %d"), (int)occurrences);
         log.ReportResult(CompileResult(szBuf));
-        appState->OutputResults(OutputPaneType::Find, log.Results());
+        appState->OutputAddBatch(OutputPaneType::Find, log.Results());
+        appState->OutputFinishAdd(OutputPaneType::Find);
     }
 }
 
@@ -2768,7 +2769,7 @@ void CMainFrame::OnValidateAllSaids()
     if (vocab)
     {
         CompileLog log;
-        ValidateSaids(log, *vocab);
+        ValidateSaids(log, *vocab, std::thread::hardware_concurrency());
         appState->OutputResults(OutputPaneType::Compile, log.Results());
     }
 }
@@ -32,6 +32,7 @@
 class CNewScriptDialog;
 class GenerateDocsDialog;
 class DependencyTracker;
+class CompileLog;
 
 // wparam is the type, lparam is a vector<CompileResults> that needs to be deleted.
 #define UWM_RESULTS (WM_APP + 2)
@@ -165,10 +166,10 @@ private:
     void _RefreshToolboxPanelOnDeactivate(CFrameWnd *pWnd);
     void _OnNewScriptDialog(CNewScriptDialog &dialog);
     void _HideTabIfNot(MDITabType iTabTypeCurrent, MDITabType iTabTypeCompare, CExtControlBar &bar);
-    void _FindInFilesOfType(ICompileLog &log, const std::string &srcFolder, PCTSTR pszWildcard, PCTSTR pszWhat, BOOL fMatchCase, BOOL fWholeWord);
+    void _AddFilesOfType(std::vector<std::string> &filenames, const std::string &srcFolder, PCTSTR pszWildcard);
+    void _FindInFiles(const std::vector<std::string> &filenames, PCTSTR pszWhat, BOOL fMatchCase, BOOL fWholeWord, std::function<void(CompileLog &)> addBatch);
     void _FindInTexts(ICompileLog &log, PCTSTR pszWhat, BOOL fMatchCase, BOOL fWholeWord);
     void _FindInVocab000(ICompileLog &log, PCTSTR pszWhat, BOOL fMatchCase, BOOL fWholeWord);
-    void _AddFindResults(std::vector<char> &buffer, ICompileLog &log, PCTSTR pszFullPath, PCTSTR pszFileName, PCTSTR pszWhat, BOOL fMatchCase, BOOL fWholeWord);
     void _PrepareExplorerCommands();
     void _PrepareRasterCommands();
     void _PrepareScriptCommands();
@@ -2416,7 +2416,7 @@ void CPicView::_MovePriorityBar(bool commit, int dy)
 
     // Find the pri bar command
     // HACK: We're modifying the pic commands directly.
-    vector<PicCommand> &commands = const_cast<vector<PicCommand>&>(GetDocument()->GetPic()->commands);
+    vector<PicCommand> &commands = GetDocument()->TryGetComponentForInPlaceEdit<PicComponent>()->commands;
     size_t i = 0;
     for (i = 0; i < commands.size(); i++)
     {
@@ -4047,7 +4047,7 @@ void CPicView::_TransformPoint(bool commit, CPoint pt)
         // Apply changes works on a clone of the current resource, while the current resource
         // goes into the undo stack. Since we've been modifying the current resource, we
         // need to restore it before applying our final changes to the clone.
-        _transformCommandMod->ApplyDifference(const_cast<PicComponent&>(*GetDocument()->GetPic()), 0, 0);
+        _transformCommandMod->ApplyDifference(*GetDocument()->TryGetComponentForInPlaceEdit<PicComponent>(), 0, 0);
 
         GetDocument()->ApplyChanges<PicComponent>(
             [this, dx, dy](PicComponent &pic)
@@ -4060,7 +4060,7 @@ void CPicView::_TransformPoint(bool commit, CPoint pt)
     else
     {
         // We have to go poking around in the resource directly
-        _transformCommandMod->ApplyDifference(const_cast<PicComponent&>(*GetDocument()->GetPic()), dx, dy);
+        _transformCommandMod->ApplyDifference(*GetDocument()->TryGetComponentForInPlaceEdit<PicComponent>(), dx, dy);
         // As a result we need to tell people manually to update
     }
 }
@@ -4267,11 +4267,11 @@ bool CPicView::_CanBeInPolygons(CPoint pt)
 
 bool CPicView::_EvaluateCanBeHere(CPoint pt)
 {
-    const BYTE *pdataControl = _GetDrawManager().GetPicBits(PicScreen::Control, PicPosition::PrePlugin, _GetPicSize());
     bool canBe = true;
     if (appState->_fObserveControlLines)
     {
-        canBe = CanBeHere(_GetPicSize(), pdataControl, GetViewBoundsRect((uint16_t)pt.x, (uint16_t)pt.y, _GetFakeEgo(), _fakeEgoAttributes.back().Loop, _fakeEgoAttributes.back().Cel));
+        const ControlMask &controlMask = _GetDrawManager().GetControlMask(PicPosition::PrePlugin, _GetPicSize());
+        canBe = controlMask.CanBeHere(GetViewBoundsRect((uint16_t)pt.x, (uint16_t)pt.y, _GetFakeEgo(), _fakeEgoAttributes.back().Loop, _fakeEgoAttributes.back().Cel));
     }
 
     if (canBe && appState->_fObservePolygons)
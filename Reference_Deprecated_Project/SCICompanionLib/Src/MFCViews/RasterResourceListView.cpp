@@ -28,6 +28,8 @@
 #include "RasterOperations.h"
 #include "PaletteOperations.h"
 #include "ResourceBlob.h"
+#include "ThumbnailCache.h"
+#include "GameSnapshot.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -57,6 +59,7 @@ CRasterResourceListCtrl::CRasterResourceListCtrl()
     _iCorruptBitmapIndex = 0;
     _iTokenImageIndex = 0;
     _pQueue = nullptr;
+    _paletteHash = 0;
     _iLastImageReadyHint = -1;
 }
 
@@ -96,8 +99,7 @@ void _StretchForAspectRatio(CWnd *pwnd, CBitmap &bitmap)
 
 LRESULT CRasterResourceListCtrl::OnImageReady(WPARAM wParam, LPARAM lParam)
 {
-    VIEWWORKRESULT *pWorkResult;
-    while (_pQueue->TakeWorkResult(&pWorkResult))
+    for (std::unique_ptr<VIEWWORKRESULT> &pWorkResult : _pQueue->TakeWorkResults())
     {
         LVFINDINFO findInfo = {};
         findInfo.flags |= LVFI_PARAM | LVFI_WRAP;
@@ -132,7 +134,6 @@ LRESULT CRasterResourceListCtrl::OnImageReady(WPARAM wParam, LPARAM lParam)
             }
         }
         _iLastImageReadyHint = i;
-        delete pWorkResult;
     }
     return 0;
 }
@@ -173,11 +174,10 @@ CelIndex _FindBestPreviewCel(int dimensions, RasterComponent &raster)
     return bestCelIndex;
 }
 
-VIEWWORKRESULT *VIEWWORKRESULT::CreateFromWorkItem(VIEWWORKITEM *pWorkItem)
+HBITMAP _CreatePreviewBitmap(const ResourceBlob &blob, const GameSnapshot &snapshot)
 {
     HBITMAP hbmp = nullptr;
-
-    std::unique_ptr<ResourceEntity> pEntity = CreateResourceFromResourceData(pWorkItem->blob);
+    std::unique_ptr<ResourceEntity> pEntity = CreateResourceFromResourceData(blob);
     if (pEntity)
     {
         RasterComponent &raster = pEntity->GetComponent<RasterComponent>();
@@ -185,7 +185,7 @@ VIEWWORKRESULT *VIEWWORKRESULT::CreateFromWorkItem(VIEWWORKITEM *pWorkItem)
         std::unique_ptr<PaletteComponent> palette;
         if (raster.Traits.PaletteType == PaletteType::VGA_256)
         {
-            palette = appState->GetResourceMap().GetMergedPalette(*pEntity, 999);
+            palette = snapshot.GetMergedPalette999(*pEntity);
         }
         CelIndex previewCel = CelIndex(0, raster.Traits.PreviewCel);
         if (raster.Traits.PreviewCel == 0)
@@ -195,6 +195,29 @@ VIEWWORKRESULT *VIEWWORKRESULT::CreateFromWorkItem(VIEWWORKITEM *pWorkItem)
         }
         hbmp = GetBitmap(raster, palette.get(), previewCel, VIEW_IMAGE_SIZE, VIEW_IMAGE_SIZE, BitmapScaleOptions::AllowMag | BitmapScaleOptions::AllowMin);
     }
+    return hbmp;
+}
+
+VIEWWORKRESULT *VIEWWORKRESULT::CreateFromWorkItem(VIEWWORKITEM *pWorkItem)
+{
+    HBITMAP hbmp = nullptr;
+    if (pWorkItem->thumbnailCache)
+    {
+        ThumbnailKey key = GetThumbnailKey(pWorkItem->blob, pWorkItem->paletteHash, VIEW_IMAGE_SIZE, VIEW_IMAGE_SIZE);
+        hbmp = pWorkItem->thumbnailCache->CreateBitmap(key);
+        if (!hbmp)
+        {
+            hbmp = _CreatePreviewBitmap(pWorkItem->blob, *pWorkItem->snapshot);
+            if (hbmp)
+            {
+                pWorkItem->thumbnailCache->Add(key, hbmp);
+            }
+        }
+    }
+    else
+    {
+        hbmp = _CreatePreviewBitmap(pWorkItem->blob, *pWorkItem->snapshot);
+    }
 
     VIEWWORKRESULT *pResult = new VIEWWORKRESULT;
     pResult->hbmp = hbmp;
@@ -216,6 +239,14 @@ void CRasterResourceListCtrl::_RegenerateImages()
     }
 }
 
+void CRasterResourceListCtrl::_OnEndScroll()
+{
+    if (_pQueue)
+    {
+        _ReprioritizePreviews(*_pQueue);
+    }
+}
+
 void CRasterResourceListCtrl::OnItemChanged(NMHDR* pNMHDR, LRESULT* pResult)
 {
     NMLISTVIEW *pnmlv = (NMLISTVIEW*)pNMHDR;
@@ -249,6 +280,9 @@ void CRasterResourceListCtrl::OnGetDispInfo(NMHDR* pNMHDR, LRESULT* pResult)
                 std::unique_ptr<VIEWWORKITEM> pWorkItem = std::make_unique<VIEWWORKITEM>();
                 pWorkItem->blob = *pData;
                 pWorkItem->lParam = pItem->lParam;
+                pWorkItem->thumbnailCache = _thumbnailCache;
+                pWorkItem->snapshot = _snapshot;
+                pWorkItem->paletteHash = _paletteHash;
                 _pQueue->GiveWorkItem(move(pWorkItem));
                 pItem->iImage = _iTokenImageIndex; // Done!
                 pItem->mask |= LVIF_DI_SETITEM; // So we don't ask for it again.
@@ -312,7 +346,15 @@ void CRasterResourceListCtrl::_OnInitListView(int cItems)
         }
     }
 
-    // Prepare our worker thread.
+    // Thumbnails we've generated before are stored on disk. VGA views are drawn with the global
+    // palette, so the thumbnails are no good if it has changed. The worker threads get the global
+    // palette from the same snapshot, rather than going through the resource map.
+    _snapshot = appState->GetResourceMap().GetSnapshot();
+    _paletteHash = GetPaletteHash(_snapshot->GetPalette999());
+    std::string cacheFolder = appState->GetResourceMap().Helper().GetThumbnailCacheFolder();
+    _thumbnailCache = cacheFolder.empty() ? nullptr : ThumbnailCache::Get(cacheFolder, GetType());
+
+    // Prepare our work queue.
     if (_pQueue)
     {
         _pQueue->Abort();
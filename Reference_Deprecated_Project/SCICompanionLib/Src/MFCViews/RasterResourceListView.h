@@ -21,12 +21,18 @@
 #include "QueueItems.h"
 #include "ResourceBlob.h"
 
+class ThumbnailCache;
+class GameSnapshot;
+
 // This is created by the UI thread, and deleted by the worker thread.
 class VIEWWORKITEM
 {
 public:
     ResourceBlob blob;
     LPARAM lParam;
+    std::shared_ptr<ThumbnailCache> thumbnailCache;
+    std::shared_ptr<const GameSnapshot> snapshot;  // For the global palette
+    uint32_t paletteHash;
 };
 
 
@@ -39,7 +45,7 @@ public:
     VIEWWORKRESULT() { hbmp = NULL; nID = 0; }
     ~VIEWWORKRESULT() { DeleteObject(hbmp); }
     HBITMAP hbmp;
-    UINT nID;
+    uint64_t nID;
     int iResourceNumber;
     int iPackageNumber;
     LPARAM lParam;
@@ -74,6 +80,7 @@ private:
     virtual void _PrepareLVITEM(LVITEM *pItem);
     virtual void _OnInitListView(int cItems);
     void _RegenerateImages() override;
+    void _OnEndScroll() override;
 
 // Generated message map functions
     afx_msg int OnCreate(LPCREATESTRUCT lpCreateStruct);
@@ -85,6 +92,9 @@ private:
     int _iCorruptBitmapIndex;
     int _iTokenImageIndex;
     std::shared_ptr<QueueItems<VIEWWORKITEM, VIEWWORKRESULT>> _pQueue;
+    std::shared_ptr<ThumbnailCache> _thumbnailCache;
+    std::shared_ptr<const GameSnapshot> _snapshot;
+    uint32_t _paletteHash;
     int _iLastImageReadyHint;
 };
 
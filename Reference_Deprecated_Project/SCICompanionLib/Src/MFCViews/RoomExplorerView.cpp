@@ -25,6 +25,9 @@
 #include "PaletteOperations.h"
 #include "ResourceContainer.h"
 #include "ResourceBlob.h"
+#include "ThumbnailCache.h"
+#include "ContentHash.h"
+#include "GameSnapshot.h"
 
 using namespace sci;
 using namespace std;
@@ -267,46 +270,125 @@ void OrganizeGrid(std::vector<uint16_t> &unprocessedRooms, int suggestedWidth, c
 }
 
 
-CRoomExplorerWorkResult *CRoomExplorerWorkResult::CreateFromWorkItem(CRoomExplorerWorkItem *pWorkItem)
+// A room's composite depends on its pic, and on which views its script places on it, and where.
+ThumbnailKey GetRoomKey(const CRoomExplorerWorkItem &workItem)
 {
-    CRoomExplorerWorkResult *pResult = NULL;
-    BOOL fOk = FALSE;
-    if (pWorkItem->blob.GetType() == ResourceType::Pic)
-    {
-        unique_ptr<ResourceEntity> picEntity = CreateResourceFromResourceData(pWorkItem->blob);
-        PicComponent &pic = picEntity->GetComponent<PicComponent>();
-        PaletteComponent *palette = picEntity->TryGetComponent<PaletteComponent>();
-        PicDrawManager pdm(&pic, palette);
-		std::unique_ptr<BYTE[]> dataDisplay = std::make_unique<BYTE[]>(pic.Size.cx * pic.Size.cy);
-        std::unique_ptr<BYTE[]> dataAux = std::make_unique<BYTE[]>(pic.Size.cx * pic.Size.cy);
-        fOk = TRUE;
-        pdm.CopyBitmap(PicScreen::Visual, PicPosition::Final, pic.Size, dataDisplay.get(), dataAux.get(), nullptr);
-
-        for (auto &pRoomView : pWorkItem->_views)
+    std::vector<uint64_t> keyData;
+    keyData.push_back(workItem.blob.GetChecksum());
+    for (auto &pRoomView : workItem._views)
+    {
+        keyData.push_back(pRoomView->blob.GetChecksum());
+        keyData.push_back((uint64_t)pRoomView->wx | ((uint64_t)pRoomView->wy << 16) | ((uint64_t)pRoomView->wLoop << 32) | ((uint64_t)pRoomView->wCel << 48));
+    }
+    ThumbnailKey key = {};
+    key.ContentHash = ComputeContentHash(reinterpret_cast<const uint8_t*>(keyData.data()), keyData.size() * sizeof(uint64_t));
+    return key;
+}
+
+bool _RenderRoom(const CRoomExplorerWorkItem &workItem, CSize &size, std::vector<uint8_t> &bits, std::vector<RGBQUAD> &colors)
+{
+    if (workItem.blob.GetType() != ResourceType::Pic)
+    {
+        return false;
+    }
+
+    unique_ptr<ResourceEntity> picEntity = CreateResourceFromResourceData(workItem.blob);
+    PicComponent &pic = picEntity->GetComponent<PicComponent>();
+    PaletteComponent *palette = picEntity->TryGetComponent<PaletteComponent>();
+    PicDrawManager pdm(&pic, palette);
+    size = pic.Size;
+    bits.resize(pic.Size.cx * pic.Size.cy);
+    std::unique_ptr<BYTE[]> dataAux = std::make_unique<BYTE[]>(pic.Size.cx * pic.Size.cy);
+    pdm.CopyBitmap(PicScreen::Visual, PicPosition::Final, pic.Size, &bits[0], dataAux.get(), nullptr);
+
+    for (auto &pRoomView : workItem._views)
+    {
+        std::unique_ptr<ResourceEntity> view(CreateViewResource(workItem.snapshot->GetVersion()));
+        if (SUCCEEDED(view->InitFromResource(&pRoomView->blob)))
         {
-            std::unique_ptr<ResourceEntity> view(CreateViewResource(appState->GetVersion()));
-            if (SUCCEEDED(view->InitFromResource(&pRoomView->blob)))
-            {
-                DrawViewWithPriority(pic.Size, dataDisplay.get(), pdm.GetPicBits(PicScreen::Priority, PicPosition::Final, pic.Size), PriorityFromY(pRoomView->wy, *pdm.GetViewPort(PicPosition::Final)),
-                    pRoomView->wx, pRoomView->wy,
-                    view.get(), pRoomView->wLoop, pRoomView->wCel);
-            }
+            DrawViewWithPriority(pic.Size, &bits[0], pdm.GetPicBits(PicScreen::Priority, PicPosition::Final, pic.Size), PriorityFromY(pRoomView->wy, *pdm.GetViewPort(PicPosition::Final)),
+                pRoomView->wx, pRoomView->wy,
+                view.get(), pRoomView->wLoop, pRoomView->wCel);
         }
+    }
 
-        // Now make a smushed down bitmap for all this.
-        pResult = new CRoomExplorerWorkResult();
-        if (pResult)
+    if (palette)
+    {
+        colors.assign(palette->Colors, palette->Colors + ARRAYSIZE(palette->Colors));
+    }
+    else
+    {
+        colors.assign(g_egaColors, g_egaColors + ARRAYSIZE(g_egaColors));
+    }
+    return true;
+}
+
+bool GetRoomComposite(const CRoomExplorerWorkItem &workItem, RoomComposite &composite)
+{
+    // Rendering a room means decoding its pic and drawing all its views, so the
+    // composites are kept in a cache on disk.
+    ThumbnailKey key = GetRoomKey(workItem);
+    bool fOk = workItem.thumbnailCache && workItem.thumbnailCache->GetBits(key, composite.size, composite.bits, composite.colors);
+    if (!fOk)
+    {
+        fOk = _RenderRoom(workItem, composite.size, composite.bits, composite.colors);
+        if (fOk && workItem.thumbnailCache)
+        {
+            workItem.thumbnailCache->Add(key, composite.size, &composite.bits[0], &composite.colors[0], (int)composite.colors.size());
+        }
+    }
+    return fOk;
+}
+
+void ScaleRoomComposite(const RoomComposite &composite, CSize size, std::vector<RGBQUAD> &bits)
+{
+    bits.assign(max(0, size.cx) * max(0, size.cy), RGBQUAD());
+    if (composite.bits.empty() || bits.empty())
+    {
+        return;
+    }
+
+    RGBQUAD colors[256] = {};
+    std::copy(composite.colors.begin(), composite.colors.begin() + min((size_t)256, composite.colors.size()), colors);
+    for (int y = 0; y < size.cy; y++)
+    {
+        int yStart = y * composite.size.cy / size.cy;
+        int yEnd = max(yStart + 1, (y + 1) * composite.size.cy / size.cy);
+        RGBQUAD *dest = &bits[y * size.cx];
+        for (int x = 0; x < size.cx; x++)
         {
-            pResult->wScript = pWorkItem->wScript;
-            // Result takes ownership:
-            pResult->pBitmapData.swap(dataDisplay);
-            // Make a copy of the palette so we can draw it correctly:
-            if (palette)
+            int xStart = x * composite.size.cx / size.cx;
+            int xEnd = max(xStart + 1, (x + 1) * composite.size.cx / size.cx);
+            int blue = 0, green = 0, red = 0;
+            for (int ySource = yStart; ySource < yEnd; ySource++)
             {
-                pResult->optionalPalette.reset(new PaletteComponent(*palette));
+                const uint8_t *source = &composite.bits[ySource * composite.size.cx];
+                for (int xSource = xStart; xSource < xEnd; xSource++)
+                {
+                    const RGBQUAD &color = colors[source[xSource]];
+                    blue += color.rgbBlue;
+                    green += color.rgbGreen;
+                    red += color.rgbRed;
+                }
             }
+            int count = (yEnd - yStart) * (xEnd - xStart);
+            dest[x].rgbBlue = (BYTE)((blue + count / 2) / count);
+            dest[x].rgbGreen = (BYTE)((green + count / 2) / count);
+            dest[x].rgbRed = (BYTE)((red + count / 2) / count);
         }
     }
+}
+
+CRoomExplorerWorkResult *CRoomExplorerWorkResult::CreateFromWorkItem(CRoomExplorerWorkItem *pWorkItem)
+{
+    RoomComposite composite;
+    CRoomExplorerWorkResult *pResult = NULL;
+    if (GetRoomComposite(*pWorkItem, composite))
+    {
+        pResult = new CRoomExplorerWorkResult();
+        pResult->wScript = pWorkItem->wScript;
+        pResult->composite = move(composite);
+    }
     return pResult;
 }
 
@@ -339,64 +421,62 @@ CRoomExplorerNode::CRoomExplorerNode()
     Picture = 0;
 
     Considered = FALSE;
-    BitmapScaled = NULL;
     _fAskedForBitmap = FALSE;
+    _hbmpScaled = nullptr;
     g_count++;
-    _sizeScaled.SetSize(0, 0);
 }
 
 CRoomExplorerNode::~CRoomExplorerNode()
 {
+    if (_hbmpScaled)
+    {
+        DeleteObject(_hbmpScaled);
+    }
     g_count--;
-    if (BitmapScaled)
+}
+
+void CRoomExplorerNode::SetComposite(RoomComposite &&composite)
+{
+    _composite = move(composite);
+    if (_hbmpScaled)
     {
-        DeleteObject(BitmapScaled);
+        DeleteObject(_hbmpScaled);
+        _hbmpScaled = nullptr;
     }
 }
 
-void CRoomExplorerNode::_ResizeBitmap(CSize size)
+void CRoomExplorerNode::_EnsureScaled(CSize size)
 {
-    if (BitmapScaled)
+    if (_hbmpScaled && (_scaledSize == size))
+    {
+        return;
+    }
+    if (_hbmpScaled)
     {
-        DeleteObject(BitmapScaled);
-        BitmapScaled = NULL;
+        DeleteObject(_hbmpScaled);
+        _hbmpScaled = nullptr;
     }
 
-    if (pBitmapData)
+    std::vector<RGBQUAD> bits;
+    ScaleRoomComposite(_composite, size, bits);
+    if (!bits.empty())
     {
-        // Temporarily make a gdi+ wrapper for it.
-        Gdiplus::Bitmap *pimg = NULL;
-        RGBQUAD *palette = g_egaColors;
-        int paletteCout = ARRAYSIZE(g_egaColors);
-        if (optionalPalette)
+        BITMAPINFO bmi = {};
+        bmi.bmiHeader.biSize = sizeof(bmi.bmiHeader);
+        bmi.bmiHeader.biWidth = size.cx;
+        bmi.bmiHeader.biHeight = size.cy;
+        bmi.bmiHeader.biPlanes = 1;
+        bmi.bmiHeader.biBitCount = 32;
+        bmi.bmiHeader.biCompression = BI_RGB;
+        RGBQUAD *pBitsDest;
+        _hbmpScaled = CreateDIBSection(nullptr, &bmi, DIB_RGB_COLORS, (void**)&pBitsDest, nullptr, 0);
+        if (_hbmpScaled)
         {
-            palette = optionalPalette->Colors;
-            paletteCout = ARRAYSIZE(optionalPalette->Colors);
-        }
-        SCIBitmapInfo bmi(DEFAULT_PIC_WIDTH, DEFAULT_PIC_HEIGHT, palette, paletteCout);
-        pimg = Gdiplus::Bitmap::FromBITMAPINFO(&bmi, pBitmapData.get());
-        if (pimg)
-        {
-            if ((size.cx == DEFAULT_PIC_WIDTH) && (size.cy == DEFAULT_PIC_HEIGHT))
-            {
-                // Exact size.
-                pimg->GetHBITMAP(Color::Black, &BitmapScaled);
-            }
-            else
-            {
-                // Make a different sized version
-                // Note: this cast to (Bitmap*) is undocumented.
-                Gdiplus::Bitmap *pimage = (Gdiplus::Bitmap*)pimg->GetThumbnailImage(size.cx, size.cy, NULL, NULL);
-                if (pimage)
-                {
-                    pimage->GetHBITMAP(Color::Black, &BitmapScaled);
-                    delete pimage;
-                }
-            }
-            delete pimg;
+            // 32bpp rows don't need padding.
+            std::copy(bits.begin(), bits.end(), pBitsDest);
+            _scaledSize = size;
         }
     }
-    _sizeScaled = size;
 }
 
 void CRoomExplorerNode::OnDraw(CDC *pDC, CRect *prc, std::shared_ptr<QueueItems<CRoomExplorerWorkItem, CRoomExplorerWorkResult>> pQueue)
@@ -409,18 +489,14 @@ void CRoomExplorerNode::OnDraw(CDC *pDC, CRect *prc, std::shared_ptr<QueueItems<
         CDC dcMem;
         if (dcMem.CreateCompatibleDC(pDC))
         {
-            if (pBitmapData)
+            if (HasComposite())
             {
-                CSize sizeToPaint(prc->Width(), prc->Height());
-                if (sizeToPaint != _sizeScaled)
+                // Zooming just rescales the composite we have, so the room never needs to be rendered again.
+                _EnsureScaled(CSize(prc->Width(), prc->Height()));
+                if (_hbmpScaled)
                 {
-                    // Make a scaled version of the bitmap
-                    _ResizeBitmap(sizeToPaint);
-                }
-                if (BitmapScaled)
-                {
-                    HGDIOBJ hOld = dcMem.SelectObject(BitmapScaled);
-                    pDC->BitBlt(prc->left, prc->top, prc->Width(), prc->Height(), &dcMem, 0, 0, SRCCOPY);
+                    HGDIOBJ hOld = dcMem.SelectObject(_hbmpScaled);
+                    pDC->BitBlt(prc->left, prc->top, _scaledSize.cx, _scaledSize.cy, &dcMem, 0, 0, SRCCOPY);
                     dcMem.SelectObject(hOld);
                 }
             }
@@ -457,6 +533,8 @@ void CRoomExplorerNode::Init(const CRoomExplorerView::CRoomExplorerGrid *pGrid,
     _pGrid = pGrid;
     assert(_pWorkItem.get() == nullptr);
     _pWorkItem = make_unique<CRoomExplorerWorkItem>(compiledScript.GetScriptNumber());
+    _pWorkItem->thumbnailCache = pGrid->GetThumbnailCache();
+    _pWorkItem->snapshot = pGrid->GetSnapshot();
     ScriptNum = compiledScript.GetScriptNumber();
     const vector<CompiledVarValue> &propValues = classDefinition.GetPropertyValues();
     vector<uint16_t> props = classDefinition.GetProperties();
@@ -566,6 +644,10 @@ void CRoomExplorerView::CRoomExplorerGrid::AddRoom(GlobalCompiledScriptLookups &
 
 void CRoomExplorerView::CRoomExplorerGrid::LoadResources()
 {
+    std::string cacheFolder = appState->GetResourceMap().Helper().GetThumbnailCacheFolder();
+    _thumbnailCache = cacheFolder.empty() ? nullptr : ThumbnailCache::Get(cacheFolder, "rooms");
+    _snapshot = appState->GetResourceMap().GetSnapshot();
+
     auto resourceContainer = appState->GetResourceMap().Resources(ResourceTypeFlags::Pic | ResourceTypeFlags::View, ResourceEnumFlags::MostRecentOnly | ResourceEnumFlags::AddInDefaultEnumFlags);
     for (auto &pBlob : *resourceContainer)
     {
@@ -1360,21 +1442,20 @@ BOOL CRoomExplorerView::OnEraseBkgnd(CDC *pDC)
 
 LRESULT CRoomExplorerView::_OnRoomBitmapReady(WPARAM wParam, LPARAM lParam)
 {
-    CRoomExplorerWorkResult *pWorkResult;
-    while (_pQueue->TakeWorkResult(&pWorkResult))
+    bool invalidate = false;
+    for (std::unique_ptr<CRoomExplorerWorkResult> &pWorkResult : _pQueue->TakeWorkResults())
     {
         CRoomExplorerNode *pNode = _grid.GetNode(pWorkResult->wScript);
         if (pNode)
         {
             // Transfer ownership
-            pNode->pBitmapData.swap(pWorkResult->pBitmapData);
-            pNode->optionalPalette.swap(pWorkResult->optionalPalette);
-            if (pNode->pBitmapData)
-            {
-                Invalidate(FALSE);
-            }
+            pNode->SetComposite(move(pWorkResult->composite));
+            invalidate = invalidate || pNode->HasComposite();
         }
-        delete pWorkResult;
+    }
+    if (invalidate)
+    {
+        Invalidate(FALSE);
     }
     return 0;
 }
@@ -21,8 +21,10 @@
 #include "QueueItems.h"
 #include "ResourceBlob.h"
 
-struct PaletteComponent;
 class CRoomExplorerDoc;
+class ThumbnailCache;
+class GameSnapshot;
+struct ThumbnailKey;
 class CompiledObject;
 class GlobalCompiledScriptLookups;
 
@@ -50,16 +52,30 @@ public:
     uint16_t wScript;
     ResourceBlob blob;
     std::vector<std::unique_ptr<CRoomView>> _views;
+    std::shared_ptr<ThumbnailCache> thumbnailCache;
+    std::shared_ptr<const GameSnapshot> snapshot;   // Rooms are rendered on a worker thread, so they can't use the resource map.
 };
 
+// A room's pic with the views its script places on it: 8bpp bottom-up rows, without padding.
+struct RoomComposite
+{
+    CSize size;
+    std::vector<uint8_t> bits;
+    std::vector<RGBQUAD> colors;
+};
+
+ThumbnailKey GetRoomKey(const CRoomExplorerWorkItem &workItem);
+// Takes the composite from the work item's thumbnail cache, or renders it (and adds it to the cache).
+bool GetRoomComposite(const CRoomExplorerWorkItem &workItem, RoomComposite &composite);
+// Scales the composite to size, averaging the pixels each destination pixel covers. The result is 32bpp bottom-up rows.
+void ScaleRoomComposite(const RoomComposite &composite, CSize size, std::vector<RGBQUAD> &bits);
 
 class CRoomExplorerWorkResult
 {
 public:
     CRoomExplorerWorkResult() { wScript= 0; }
-    std::unique_ptr<BYTE[]> pBitmapData;
+    RoomComposite composite;
     uint16_t wScript;
-    std::unique_ptr<PaletteComponent> optionalPalette;
 
     static CRoomExplorerWorkResult *CreateFromWorkItem(CRoomExplorerWorkItem *pWorkItem);
 };
@@ -164,6 +180,8 @@ public:
         void DrawRooms(CDC *pDC, BOOL fHitTestOnly, CPoint pt, uint16_t *pwRoom);
         const std::unordered_map<uint16_t, std::unique_ptr<ResourceBlob>> &GetPics() const { return _pics; }
         const std::unordered_map<uint16_t, std::unique_ptr<ResourceBlob>> &GetViews() const { return _views; }
+        std::shared_ptr<ThumbnailCache> GetThumbnailCache() const { return _thumbnailCache; }
+        std::shared_ptr<const GameSnapshot> GetSnapshot() const { return _snapshot; }
         CRoomExplorerNode *GetNode(uint16_t wScript);
         void SetHoveredRoom(uint16_t wRoom);
 
@@ -177,6 +195,8 @@ public:
 
         std::unordered_map<uint16_t, std::unique_ptr<ResourceBlob>> _pics;
         std::unordered_map<uint16_t, std::unique_ptr<ResourceBlob>> _views;
+        std::shared_ptr<ThumbnailCache> _thumbnailCache;
+        std::shared_ptr<const GameSnapshot> _snapshot;
 
         BOOL _fIsComplete;
         CRoomExplorerView *_pExplorer;
@@ -231,16 +251,18 @@ public:
     BOOL Considered;
     CPoint Position;
 
-    std::unique_ptr<BYTE[]> pBitmapData;
-    std::unique_ptr<PaletteComponent> optionalPalette;
-
-    HBITMAP BitmapScaled;
+    void SetComposite(RoomComposite &&composite);
+    bool HasComposite() const { return !_composite.bits.empty(); }
 
 private:
-    void _ResizeBitmap(CSize size);
+    void _EnsureScaled(CSize size);
+
+    RoomComposite _composite;       // Empty until the room has been rendered.
+    // The composite at the size it's drawn at, so drawing doesn't need to stretch. Rebuilt when the zoom changes.
+    HBITMAP _hbmpScaled;
+    CSize _scaledSize;
 
     BOOL _fAskedForBitmap;
-    CSize _sizeScaled; // of BitmapScaled
     const CRoomExplorerView::CRoomExplorerGrid *_pGrid;
     std::unique_ptr<CRoomExplorerWorkItem> _pWorkItem;
 };
@@ -211,6 +211,11 @@ void CScriptView::UpdateView(CCrystalTextView *pSource, CUpdateContext *pContext
         {
             _pACThread->ResetPosition();
         }
+        if (!(dwFlags & UPDATE_FLAGSONLY))
+        {
+            // Let it throw away any parse checkpoints that are now stale.
+            _pACThread->OnTextChanged(LocateTextBuffer(), (dwFlags & UPDATE_RESET) ? -1 : nLineIndex);
+        }
     }
     // If the document was modified, we should ignore any hover tip task result:
     _lastHoverTipParse = -1;
@@ -29,6 +29,11 @@ T FastMax(const T& left, const T& right)
 {
     return left > right ? left : right;
 }
+template <class T>
+T FastMin(const T& left, const T& right)
+{
+    return left < right ? left : right;
+}
 
 std::string GetAudioLength(const AudioComponent &audio)
 {
@@ -49,7 +54,21 @@ uint32_t AudioComponent::GetBytesPerSecond() const
 void AudioComponent::ScanForClipped()
 {
     IsClipped = false;
-    if (IsFlagSet(Flags, AudioFlags::SixteenBit))
+    if (_encoded)
+    {
+        // No need to decode anything, the overview has what we need.
+        int16_t clipMin = IsFlagSet(Flags, AudioFlags::SixteenBit) ? -32768 : -128;
+        int16_t clipMax = IsFlagSet(Flags, AudioFlags::SixteenBit) ? 32767 : 127;
+        for (const AudioPeak &peak : _encoded->GetOverview())
+        {
+            if ((peak.Min == clipMin) || (peak.Max == clipMax))
+            {
+                IsClipped = true;
+                return;
+            }
+        }
+    }
+    else if (IsFlagSet(Flags, AudioFlags::SixteenBit))
     {
         if (!DigitalSamplePCM.empty())
         {
@@ -79,6 +98,37 @@ void AudioComponent::ScanForClipped()
     }
 }
 
+size_t AudioComponent::EstimateSize(const ResourceComponent *previous) const
+{
+    size_t size = sizeof(*this) + DigitalSamplePCM.size();
+    const AudioComponent *previousAudio = static_cast<const AudioComponent*>(previous);
+    if (_encoded && (!previousAudio || (previousAudio->_encoded != _encoded)))
+    {
+        // Each compressed byte decodes to two.
+        size += _encoded->GetDecodedSize() / 2;
+    }
+    return size;
+}
+
+void AudioComponent::SetEncodedSource(std::shared_ptr<const DPCMSampleSource> encoded)
+{
+    DigitalSamplePCM.clear();
+    _encoded = encoded;
+}
+
+void AudioComponent::ReadPCM(uint32_t offset, uint8_t *dest, uint32_t count) const
+{
+    if (_encoded)
+    {
+        _encoded->Decode(offset, dest, count);
+    }
+    else
+    {
+        assert((offset + count) <= DigitalSamplePCM.size());
+        std::copy(DigitalSamplePCM.begin() + offset, DigitalSamplePCM.begin() + offset + count, dest);
+    }
+}
+
 uint32_t AudioComponent::GetLengthInTicks() const
 {
     int bytePerSecond = max(1, Frequency);
@@ -86,7 +136,7 @@ uint32_t AudioComponent::GetLengthInTicks() const
     {
         bytePerSecond *= 2;
     }
-    return SCITicksPerSecond * DigitalSamplePCM.size() / bytePerSecond;
+    return SCITicksPerSecond * GetLength() / bytePerSecond;
 }
 
 // Decompression routines From SCUMMVM:
@@ -108,21 +158,16 @@ static const uint16_t tableDPCM16[128] = {
 };
 
 
-static void deDPCM16(byte *soundBuf, sci::istream &audioStream, uint32_t n) {
-    int16_t *out = (int16_t *)soundBuf;
-
-    int32_t s = 0;
-    for (uint32_t i = 0; i < n; i++) {
-        uint8_t b;
-        audioStream >> b;
-        if (b & 0x80)
-            s -= tableDPCM16[b & 0x7f];
-        else
-            s += tableDPCM16[b];
+static void deDPCM16(int32_t &s, uint8_t b, uint8_t *out)
+{
+    if (b & 0x80)
+        s -= tableDPCM16[b & 0x7f];
+    else
+        s += tableDPCM16[b];
 
-        s = min(32767, max(-32768, s));
-        *out++ = (int16_t)s;
-    }
+    s = min(32767, max(-32768, s));
+    int16_t value = (int16_t)s;
+    memcpy(out, &value, sizeof(value));
 }
 
 static const uint8_t tableDPCM8[8] = { 0, 1, 2, 3, 6, 10, 15, 21 };
@@ -137,16 +182,118 @@ static void deDPCM8Nibble(byte *soundBuf, int32_t &s, uint8_t b) {
     *soundBuf = s;
 }
 
-static void deDPCM8(uint8_t *soundBuf, sci::istream &audioStream, uint32_t n) {
-    int32_t s = 0x80;
+static void deDPCM8(int32_t &s, uint8_t b, uint8_t *out)
+{
+    deDPCM8Nibble(out, s, b >> 4);
+    deDPCM8Nibble(out + 1, s, b & 0xf);
+}
+
+void DPCMSampleSource::_DecodeByte(int32_t &state, uint8_t b, uint8_t *out) const
+{
+    if (_sixteenBit)
+    {
+        deDPCM16(state, b, out);
+    }
+    else
+    {
+        deDPCM8(state, b, out);
+    }
+}
+
+DPCMSampleSource::DPCMSampleSource(sci::istream &stream, uint32_t compressedSize, bool sixteenBit) : _sixteenBit(sixteenBit)
+{
+    _compressed.assign(min(compressedSize, stream.getBytesRemaining()), 0);
+    if (!_compressed.empty())
+    {
+        stream.read_data(&_compressed[0], (uint32_t)_compressed.size());
+    }
+
+    // One pass through the data to record the decoder state at the start of each block, and the waveform overview.
+    // This is much cheaper than decoding, since we don't write anything out.
+    size_t blockCount = (_compressed.size() + DPCMBlockSize - 1) / DPCMBlockSize;
+    _checkpoints.reserve(blockCount);
+    _overview.reserve(blockCount);
+    int32_t state = _sixteenBit ? 0 : 0x80;
+    int32_t bias = _sixteenBit ? 0 : 0x80;
+    for (size_t block = 0; block < blockCount; block++)
+    {
+        _checkpoints.push_back(state);
+        size_t start = block * DPCMBlockSize;
+        size_t end = min(start + DPCMBlockSize, _compressed.size());
+        int32_t blockMin = INT_MAX;
+        int32_t blockMax = INT_MIN;
+        for (size_t i = start; i < end; i++)
+        {
+            uint8_t out[2];
+            _DecodeByte(state, _compressed[i], out);
+            if (_sixteenBit)
+            {
+                blockMin = FastMin(blockMin, state);
+                blockMax = FastMax(blockMax, state);
+            }
+            else
+            {
+                // Two samples per byte, but the first nibble's value is no longer in state.
+                blockMin = FastMin(blockMin, FastMin((int32_t)out[0], (int32_t)out[1]));
+                blockMax = FastMax(blockMax, FastMax((int32_t)out[0], (int32_t)out[1]));
+            }
+        }
+        _overview.push_back({ (int16_t)(blockMin - bias), (int16_t)(blockMax - bias) });
+    }
+}
+
+void DPCMSampleSource::Decode(uint32_t offset, uint8_t *dest, uint32_t count) const
+{
+    uint32_t end = offset + count;
+    assert(end <= GetDecodedSize());
+    end = min(end, GetDecodedSize());
+    if (offset >= end)
+    {
+        // Nothing to do. This also covers reading zero bytes from the very end, where there's no checkpoint
+        // if the clip is a whole number of blocks.
+        return;
+    }
 
-    for (uint32_t i = 0; i < n; i++) {
-        uint8_t b;
-        audioStream >> b;
+    // Pick up the decoder state from the nearest checkpoint, and run forward to where we need to be.
+    uint32_t inputIndex = offset / 2;
+    uint32_t block = inputIndex / DPCMBlockSize;
+    int32_t state = _checkpoints[block];
+    uint8_t out[2];
+    for (uint32_t i = block * DPCMBlockSize; i < inputIndex; i++)
+    {
+        _DecodeByte(state, _compressed[i], out);
+    }
 
-        deDPCM8Nibble(soundBuf++, s, b >> 4);
-        deDPCM8Nibble(soundBuf++, s, b & 0xf);
+    uint32_t outputIndex = inputIndex * 2;
+    while (outputIndex < end)
+    {
+        _DecodeByte(state, _compressed[inputIndex++], out);
+        for (int k = 0; k < 2; k++, outputIndex++)
+        {
+            if ((outputIndex >= offset) && (outputIndex < end))
+            {
+                *dest++ = out[k];
+            }
+        }
+    }
+}
+
+const std::vector<uint8_t> &DPCMSampleSource::GetDecoded() const
+{
+    std::call_once(_decodedFlag,
+        [this]()
+    {
+        _decoded.assign(GetDecodedSize(), 0);
+        int32_t state = _sixteenBit ? 0 : 0x80;
+        uint8_t *out = _decoded.empty() ? nullptr : &_decoded[0];
+        for (uint8_t b : _compressed)
+        {
+            _DecodeByte(state, b, out);
+            out += 2;
+        }
     }
+        );
+    return _decoded;
 }
 
 const char solMarker[] = "SOL";
@@ -159,7 +306,7 @@ uint32_t AudioEstimateSize(const ResourceEntity &resource)
         size += SyncEstimateSize(*resource.TryGetComponent<SyncComponent>());
     }
     size += sizeof(AudioHeader);
-    size += resource.GetComponent<AudioComponent>().DigitalSamplePCM.size();
+    size += resource.GetComponent<AudioComponent>().GetLength();
     return size;
 }
 
@@ -185,7 +332,8 @@ void AudioWriteTo(const ResourceEntity &resource, sci::ostream &byteStream, std:
     // PROBLEM: headers are different sizes in different games.
     // This particular one only works with SQ5 and KQ6
     byteStream << header;
-    byteStream.WriteBytes(&audio.DigitalSamplePCM[0], (int)audio.DigitalSamplePCM.size());
+    const std::vector<uint8_t> &pcm = audio.GetPCM();
+    byteStream.WriteBytes(&pcm[0], (int)pcm.size());
 }
 
 void AudioReadFromHelper(ResourceEntity &resource, sci::istream &stream, const std::map<BlobKey, uint32_t> &propertyBag, bool isWave)
@@ -253,9 +401,8 @@ void AudioReadFromHelper(ResourceEntity &resource, sci::istream &stream, const s
                 assert(IsFlagSet(audio.Flags, AudioFlags::Signed));
                 if (IsFlagSet(audio.Flags, AudioFlags::DPCM))
                 {
-                    uint32_t newSize = header.sizeExcludingHeader * 2;
-                    audio.DigitalSamplePCM.assign(newSize, 0);
-                    deDPCM16(&audio.DigitalSamplePCM[0], stream, header.sizeExcludingHeader);
+                    // Decoded on demand, since these can be very long.
+                    audio.SetEncodedSource(std::make_shared<DPCMSampleSource>(stream, header.sizeExcludingHeader, true));
                 }
                 else
                 {
@@ -269,10 +416,8 @@ void AudioReadFromHelper(ResourceEntity &resource, sci::istream &stream, const s
                 assert(!IsFlagSet(audio.Flags, AudioFlags::Signed));
                 if (IsFlagSet(audio.Flags, AudioFlags::DPCM))
                 {
-                    // Decompress it - KQ6, ....
-                    uint32_t newSize = header.sizeExcludingHeader * 2;
-                    audio.DigitalSamplePCM.assign(newSize, 0);
-                    deDPCM8(&audio.DigitalSamplePCM[0], stream, header.sizeExcludingHeader);
+                    // Decompress it (on demand) - KQ6, ....
+                    audio.SetEncodedSource(std::make_shared<DPCMSampleSource>(stream, header.sizeExcludingHeader, false));
                 }
                 else
                 {
@@ -45,6 +45,49 @@ struct AudioHeader
 
 class ResourceEntity;
 
+// Min/max of the (normalized, signed) sample values in a range of audio.
+struct AudioPeak
+{
+    int16_t Min;
+    int16_t Max;
+};
+
+// Holds the compressed bytes of a DPCM8 or DPCM16 audio resource and decodes them on demand.
+// Each compressed byte decodes to two bytes of PCM (two 8 bit samples, or one 16 bit sample).
+// The decoder state is checkpointed every DPCMBlockSize compressed bytes, so any range of PCM
+// can be decoded without starting from the beginning of the clip. A min/max overview of each
+// block is computed at the same time, for drawing waveforms.
+// Instances are immutable once constructed (other than the caches), and are shared between copies
+// of an AudioComponent.
+class DPCMSampleSource
+{
+public:
+    static const uint32_t DPCMBlockSize = 1024;
+
+    DPCMSampleSource(sci::istream &stream, uint32_t compressedSize, bool sixteenBit);
+    DPCMSampleSource(const DPCMSampleSource &src) = delete;
+    DPCMSampleSource &operator=(const DPCMSampleSource &src) = delete;
+
+    uint32_t GetDecodedSize() const { return (uint32_t)_compressed.size() * 2; }
+    void Decode(uint32_t offset, uint8_t *dest, uint32_t count) const;
+    const std::vector<uint8_t> &GetDecoded() const;
+
+    // One entry per DPCMBlockSize compressed bytes.
+    const std::vector<AudioPeak> &GetOverview() const { return _overview; }
+    uint32_t GetSamplesPerOverviewEntry() const { return _sixteenBit ? DPCMBlockSize : (DPCMBlockSize * 2); }
+
+private:
+    void _DecodeByte(int32_t &state, uint8_t b, uint8_t *out) const;
+
+    bool _sixteenBit;
+    std::vector<uint8_t> _compressed;
+    std::vector<int32_t> _checkpoints;
+    std::vector<AudioPeak> _overview;
+
+    mutable std::once_flag _decodedFlag;
+    mutable std::vector<uint8_t> _decoded;
+};
+
 struct AudioComponent : public ResourceComponent
 {
 public:
@@ -57,17 +100,31 @@ public:
     {
         return new AudioComponent(*this);
     }
+    size_t EstimateSize(const ResourceComponent *previous) const override;
 
-    uint32_t GetLength() const { return (uint32_t)DigitalSamplePCM.size(); }
+    uint32_t GetLength() const { return _encoded ? _encoded->GetDecodedSize() : (uint32_t)DigitalSamplePCM.size(); }
     uint32_t GetLengthInTicks() const;
     uint32_t GetBytesPerSecond() const;
 
     void ScanForClipped();
 
+    // Audio loaded from compressed resources is only decoded when needed. GetPCM returns the full
+    // decoded data (decoding the entire clip on first use), while ReadPCM decodes just the requested range.
+    const std::vector<uint8_t> &GetPCM() const { return _encoded ? _encoded->GetDecoded() : DigitalSamplePCM; }
+    void ReadPCM(uint32_t offset, uint8_t *dest, uint32_t count) const;
+    const DPCMSampleSource *GetEncodedSource() const { return _encoded.get(); }
+    void SetEncodedSource(std::shared_ptr<const DPCMSampleSource> encoded);
+    // Must be called before replacing the contents of DigitalSamplePCM.
+    void DiscardEncodedSource() { _encoded.reset(); }
+
+    // Empty if the audio is still encoded.
     std::vector<uint8_t> DigitalSamplePCM;
     uint16_t Frequency; // Samples per second
     AudioFlags Flags;
     bool IsClipped;
+
+private:
+    std::shared_ptr<const DPCMSampleSource> _encoded;
 };
 
 ResourceEntity *CreateAudioResource(SCIVersion version);
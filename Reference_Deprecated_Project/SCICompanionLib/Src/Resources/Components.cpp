@@ -65,6 +65,35 @@ const Cel& RasterComponent::GetCelFallback(CelIndex index) const
     return Loops[loopNumber].Cels[celNumber];
 }
 
+size_t RasterComponent::EstimateSize(const ResourceComponent *previous) const
+{
+    // Cels can move around between edits, so just look for the same bitmap anywhere.
+    std::unordered_set<const uint8_t*> previousBitmaps;
+    if (previous)
+    {
+        for (const Loop &loop : static_cast<const RasterComponent*>(previous)->Loops)
+        {
+            for (const Cel &cel : loop.Cels)
+            {
+                previousBitmaps.insert(cel.Data.data());
+            }
+        }
+    }
+    size_t size = sizeof(*this);
+    for (const Loop &loop : Loops)
+    {
+        size += sizeof(loop) + loop.Cels.size() * sizeof(Cel);
+        for (const Cel &cel : loop.Cels)
+        {
+            if (previousBitmaps.find(cel.Data.data()) == previousBitmaps.end())
+            {
+                size += cel.Data.size();
+            }
+        }
+    }
+    return size;
+}
+
 void RasterComponent::ValidateCelIndex(int &loop, int &cel, bool wrap) const
 {
     int cLoops = (int)Loops.size();
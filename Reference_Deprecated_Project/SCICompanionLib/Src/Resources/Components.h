@@ -17,6 +17,10 @@ struct ResourceComponent
 {
     virtual ResourceComponent* Clone() const = 0;
 
+    // Roughly how many bytes this holds that aren't shared with previous, which is the same kind of
+    // component from an earlier copy of the resource (or null). Used to budget the undo history.
+    virtual size_t EstimateSize(const ResourceComponent *previous) const { return 1024; }
+
     // This is necessary, or else lists of ResourceComponents won't be properly destroyed.
     virtual ~ResourceComponent() {}
 };
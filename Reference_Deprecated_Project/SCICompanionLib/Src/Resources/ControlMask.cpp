@@ -0,0 +1,88 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "ControlMask.h"
+#include "PicCommands.h"
+
+using namespace std;
+
+ControlMask::ControlMask(size16 size, const uint8_t *pdataControl) : _size(size), _wordsPerRow((size.cx + 63) / 64)
+{
+    _control.resize(size.cx * size.cy);
+    for (int y = 0; y < size.cy; y++)
+    {
+        memcpy(&_control[y * size.cx], pdataControl + BUFFEROFFSET_NONSTD(size.cx, size.cy, 0, y), size.cx);
+    }
+}
+
+const std::vector<uint64_t> &ControlMask::_GetBlockedBits(uint16_t wControlMask) const
+{
+    auto it = _blockedBits.find(wControlMask);
+    if (it == _blockedBits.end())
+    {
+        std::vector<uint64_t> bits(_wordsPerRow * _size.cy, 0);
+        for (int y = 0; y < _size.cy; y++)
+        {
+            const uint8_t *pRow = &_control[y * _size.cx];
+            uint64_t *pBitsRow = &bits[y * _wordsPerRow];
+            for (int x = 0; x < _size.cx; x++)
+            {
+                assert(pRow[x] <= 15);
+                if (wControlMask & (1 << pRow[x]))
+                {
+                    pBitsRow[x / 64] |= (1ull << (x % 64));
+                }
+            }
+        }
+        it = _blockedBits.emplace(wControlMask, move(bits)).first;
+    }
+    return it->second;
+}
+
+// The bits from lo to hi inclusive.
+uint64_t _BitRange(int lo, int hi)
+{
+    uint64_t upTo = (hi == 63) ? ~0ull : ((1ull << (hi + 1)) - 1);
+    return upTo & ~((1ull << lo) - 1);
+}
+
+bool ControlMask::CanBeHere(const CRect &rect, uint16_t wControlMask) const
+{
+    int left = max((int)rect.left, 0);
+    int top = max((int)rect.top, 0);
+    int right = min((int)rect.right, _size.cx - 1);
+    int bottom = min((int)rect.bottom, _size.cy - 1);
+    if ((left > right) || (top > bottom))
+    {
+        return true;
+    }
+
+    const std::vector<uint64_t> &bits = _GetBlockedBits(wControlMask);
+    int wordLeft = left / 64;
+    int wordRight = right / 64;
+    for (int y = top; y <= bottom; y++)
+    {
+        const uint64_t *pBitsRow = &bits[y * _wordsPerRow];
+        for (int word = wordLeft; word <= wordRight; word++)
+        {
+            int lo = (word == wordLeft) ? (left % 64) : 0;
+            int hi = (word == wordRight) ? (right % 64) : 63;
+            if (pBitsRow[word] & _BitRange(lo, hi))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
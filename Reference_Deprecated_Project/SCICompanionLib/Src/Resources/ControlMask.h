@@ -0,0 +1,42 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+//
+// An acceleration structure for control screen queries (e.g. whether the fake ego can
+// stand somewhere). For each control mask that's asked about, the pixels it excludes
+// are bit-packed 64 to a word, so a rectangle query only needs to look at
+// (width / 64) words per row instead of every pixel.
+//
+// PicDrawManager builds these from its control buffers, and throws them away
+// whenever those buffers are redrawn.
+//
+class ControlMask
+{
+public:
+    ControlMask(size16 size, const uint8_t *pdataControl);
+    ControlMask(const ControlMask &src) = delete;
+    ControlMask &operator=(const ControlMask &src) = delete;
+
+    // Same semantics as the CanBeHere function: rect is inclusive, and is clipped to the pic.
+    bool CanBeHere(const CRect &rect, uint16_t wControlMask = 0x8000) const;
+
+private:
+    const std::vector<uint64_t> &_GetBlockedBits(uint16_t wControlMask) const;
+
+    size16 _size;
+    int _wordsPerRow;
+    std::vector<uint8_t> _control;  // Top-down copy of the control screen
+    mutable std::unordered_map<uint16_t, std::vector<uint64_t>> _blockedBits;
+};
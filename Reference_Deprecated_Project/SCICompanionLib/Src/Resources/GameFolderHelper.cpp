@@ -212,6 +212,11 @@ std::string GameFolderHelper::GetLipSyncFolder() const
     return _GetSubfolder("lipsync");
 }
 
+std::string GameFolderHelper::GetThumbnailCacheFolder() const
+{
+    return _GetSubfolder("thumbnailcache");
+}
+
 std::string GameFolderHelper::GetMsgFolder(const std::string *prefix) const
 {
     return _GetSubfolder("msg", prefix);
@@ -54,6 +54,7 @@ public:
     std::string GameFolderHelper::GetPicClipsFolder() const;
     std::string GameFolderHelper::GetSubFolder(const std::string &subFolder) const;
     std::string GameFolderHelper::GetLipSyncFolder() const;
+    std::string GameFolderHelper::GetThumbnailCacheFolder() const;
     std::string GameFolderHelper::GetPolyFolder(const std::string *prefix = nullptr) const;
     std::string GetGameIniFileName() const;
     std::string GetIniString(const std::string &sectionName, const std::string &keyName, PCSTR pszDefault = "") const;
@@ -0,0 +1,121 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "GameSnapshot.h"
+#include "ResourceContainer.h"
+#include "ResourceEntity.h"
+#include "ResourceUtil.h"
+#include "PaletteOperations.h"
+#include "Vocab000.h"
+
+using namespace std;
+
+namespace
+{
+    bool _IsEntryLess(const ResourceMapEntryAgnostic &one, const ResourceMapEntryAgnostic &two)
+    {
+        if (one.Type != two.Type)
+        {
+            return one.Type < two.Type;
+        }
+        if (one.Number != two.Number)
+        {
+            return one.Number < two.Number;
+        }
+        return one.Base36Number < two.Base36Number;
+    }
+
+    unique_ptr<ResourceEntity> _LoadResource(const GameFolderHelper &helper, ResourceType type, int number)
+    {
+        unique_ptr<ResourceEntity> resource;
+        unique_ptr<ResourceBlob> blob = helper.MostRecentResource(type, number, ResourceEnumFlags::AddInDefaultEnumFlags);
+        if (blob)
+        {
+            resource = CreateResourceFromResourceData(*blob);
+        }
+        return resource;
+    }
+}
+
+GameSnapshot::GameSnapshot(const GameFolderHelper &helper, uint32_t generation) : _helper(helper), _generation(generation)
+{
+    if (_helper.GameFolder.empty())
+    {
+        return;
+    }
+
+    // Asking for audio pulls in each audio map's entries instead of the maps themselves, so leave it out.
+    ResourceTypeFlags types = ResourceTypeFlags::All;
+    ClearFlag(types, ResourceTypeFlags::Audio);
+    auto resourceContainer = _helper.Resources(types, ResourceEnumFlags::MostRecentOnly | ResourceEnumFlags::AddInDefaultEnumFlags);
+    for (auto it = resourceContainer->begin(); it != resourceContainer->end(); ++it)
+    {
+        _mapEntries.push_back(it.GetMapEntry());
+    }
+    sort(_mapEntries.begin(), _mapEntries.end(), _IsEntryLess);
+
+    if (_helper.Version.HasPalette && DoesResourceExist(ResourceType::Palette, 999))
+    {
+        _palette999 = _LoadResource(_helper, ResourceType::Palette, 999);
+    }
+    if (DoesResourceExist(ResourceType::Vocab, _helper.Version.MainVocabResource))
+    {
+        _vocab000 = _LoadResource(_helper, ResourceType::Vocab, _helper.Version.MainVocabResource);
+    }
+    _selectors.Load(_helper);
+    _kernels.Load(_helper);
+}
+
+GameSnapshot::~GameSnapshot() {}
+
+bool GameSnapshot::DoesResourceExist(ResourceType type, int number, uint32_t base36Number) const
+{
+    ResourceMapEntryAgnostic key;
+    key.Type = type;
+    key.Number = (uint16_t)number;
+    key.Base36Number = base36Number;
+    return binary_search(_mapEntries.begin(), _mapEntries.end(), key, _IsEntryLess);
+}
+
+vector<int> GameSnapshot::GetResourceNumbers(ResourceType type) const
+{
+    vector<int> numbers;
+    auto it = lower_bound(_mapEntries.begin(), _mapEntries.end(), type,
+        [](const ResourceMapEntryAgnostic &entry, ResourceType type) { return entry.Type < type; });
+    for (; (it != _mapEntries.end()) && (it->Type == type); ++it)
+    {
+        // Entries with a base36 number share their number with others.
+        if (numbers.empty() || (numbers.back() != it->Number))
+        {
+            numbers.push_back(it->Number);
+        }
+    }
+    return numbers;
+}
+
+const PaletteComponent *GameSnapshot::GetPalette999() const
+{
+    return _palette999 ? _palette999->TryGetComponent<PaletteComponent>() : nullptr;
+}
+
+// The same as CResourceMap::GetMergedPalette(resource, 999), without going through the resource map.
+unique_ptr<PaletteComponent> GameSnapshot::GetMergedPalette999(const ResourceEntity &resource) const
+{
+    return CreateMergedPalette(resource, GetPalette999());
+}
+
+const Vocab000 *GameSnapshot::GetVocab000() const
+{
+    return _vocab000 ? _vocab000->TryGetComponent<Vocab000>() : nullptr;
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+#include "GameFolderHelper.h"
+#include "ResourceBlob.h"
+#include "Vocab99x.h"
+
+struct Vocab000;
+struct PaletteComponent;
+class ResourceEntity;
+
+//
+// An immutable picture of the currently loaded game: the most recent resource of each
+// type/number, plus the commonly needed resources that would otherwise be loaded over and over.
+//
+// CResourceMap hands these out (see CResourceMap::GetSnapshot), and replaces its copy whenever
+// resources change. Since nothing in here changes after construction, any number of threads can
+// read from one concurrently, and hold onto it for as long as they need a consistent view of the game.
+//
+class GameSnapshot
+{
+public:
+    GameSnapshot(const GameFolderHelper &helper, uint32_t generation);
+    ~GameSnapshot();
+    GameSnapshot(const GameSnapshot &src) = delete;
+    GameSnapshot &operator=(const GameSnapshot &src) = delete;
+
+    const GameFolderHelper &Helper() const { return _helper; }
+    const SCIVersion &GetVersion() const { return _helper.Version; }
+
+    // Increases each time CResourceMap publishes a new snapshot.
+    uint32_t GetGeneration() const { return _generation; }
+
+    // The map entries of the most recent resources (audio excluded, since that is enumerated per audio map),
+    // sorted by type, number and base36 number.
+    const std::vector<ResourceMapEntryAgnostic> &GetMapEntries() const { return _mapEntries; }
+    bool DoesResourceExist(ResourceType type, int number, uint32_t base36Number = NoBase36) const;
+    std::vector<int> GetResourceNumbers(ResourceType type) const;
+
+    const PaletteComponent *GetPalette999() const;
+    std::unique_ptr<PaletteComponent> GetMergedPalette999(const ResourceEntity &resource) const;
+    const Vocab000 *GetVocab000() const;
+    const SelectorTable &GetSelectorTable() const { return _selectors; }
+    const KernelTable &GetKernelTable() const { return _kernels; }
+
+private:
+    GameFolderHelper _helper;
+    uint32_t _generation;
+
+    std::vector<ResourceMapEntryAgnostic> _mapEntries;
+    std::unique_ptr<ResourceEntity> _palette999;
+    std::unique_ptr<ResourceEntity> _vocab000;
+    SelectorTable _selectors;
+    KernelTable _kernels;
+};
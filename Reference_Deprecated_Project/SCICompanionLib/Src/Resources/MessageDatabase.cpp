@@ -0,0 +1,390 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "MessageDatabase.h"
+#include "ResourceEntity.h"
+#include "ResourceUtil.h"
+#include "ResourceContainer.h"
+#include "GameFolderHelper.h"
+#include "ParallelFor.h"
+
+using namespace std;
+
+bool operator<(const MessageEntryRef &one, const MessageEntryRef &two)
+{
+    return (one.ResourceNumber < two.ResourceNumber) ||
+        ((one.ResourceNumber == two.ResourceNumber) && (one.Index < two.Index));
+}
+
+bool operator==(const MessageEntryRef &one, const MessageEntryRef &two)
+{
+    return (one.ResourceNumber == two.ResourceNumber) && (one.Index == two.Index);
+}
+
+struct MessageDatabase::ResourceIndex
+{
+    int Number;
+    unique_ptr<ResourceEntity> Resource;
+    const TextComponent *Text;
+    // Noun, verb, condition, sequence (in that order, so that sequences are adjacent) -> index
+    map<uint32_t, uint16_t> Tuples;
+    // The distinct lower case words in each entry
+    vector<pair<string, uint16_t>> Words;
+};
+
+namespace
+{
+    // Same as what the text editor considers part of a word.
+    bool _IsWordChar(char ch)
+    {
+        return isalnum((uint8_t)ch) || (ch == '_');
+    }
+
+    string _ToLower(const string &text)
+    {
+        string lower = text;
+        transform(lower.begin(), lower.end(), lower.begin(), [](char ch) { return (char)tolower((uint8_t)ch); });
+        return lower;
+    }
+
+    vector<string> _GetLowerCaseWords(const string &text)
+    {
+        vector<string> words;
+        size_t i = 0;
+        while (i < text.size())
+        {
+            while ((i < text.size()) && !_IsWordChar(text[i]))
+            {
+                i++;
+            }
+            size_t start = i;
+            while ((i < text.size()) && _IsWordChar(text[i]))
+            {
+                i++;
+            }
+            if (i > start)
+            {
+                words.push_back(_ToLower(text.substr(start, i - start)));
+            }
+        }
+        return words;
+    }
+
+    // Like FindStringHelper, but for std::strings.
+    size_t _FindString(const string &where, const string &what, bool wholeWord)
+    {
+        size_t pos = where.find(what);
+        while (wholeWord && (pos != string::npos))
+        {
+            bool startsWord = (pos == 0) || !_IsWordChar(where[pos - 1]);
+            bool endsWord = ((pos + what.size()) == where.size()) || !_IsWordChar(where[pos + what.size()]);
+            if (startsWord && endsWord)
+            {
+                break;
+            }
+            pos = where.find(what, pos + 1);
+        }
+        return pos;
+    }
+
+    uint32_t _GetSortedTuple(uint8_t noun, uint8_t verb, uint8_t condition, uint8_t sequence)
+    {
+        return (noun << 24) | (verb << 16) | (condition << 8) | sequence;
+    }
+
+    // Inserts the entries of one resource, which aren't already in the list.
+    void _InsertRefs(vector<MessageEntryRef> &list, const vector<MessageEntryRef> &refs)
+    {
+        list.insert(lower_bound(list.begin(), list.end(), refs.front()), refs.begin(), refs.end());
+    }
+
+    template<typename _TMap, typename _TKey>
+    void _RemoveRefs(_TMap &lists, const _TKey &key, uint16_t resourceNumber)
+    {
+        auto it = lists.find(key);
+        if (it != lists.end())
+        {
+            vector<MessageEntryRef> &list = it->second;
+            auto range = equal_range(list.begin(), list.end(), MessageEntryRef { resourceNumber, 0 },
+                [](const MessageEntryRef &one, const MessageEntryRef &two) { return one.ResourceNumber < two.ResourceNumber; });
+            list.erase(range.first, range.second);
+            if (list.empty())
+            {
+                lists.erase(it);
+            }
+        }
+    }
+}
+
+MessageDatabase::MessageDatabase() : _entryCount(0) {}
+MessageDatabase::~MessageDatabase() {}
+
+unique_ptr<MessageDatabase::ResourceIndex> MessageDatabase::_MakeIndex(int resourceNumber, unique_ptr<ResourceEntity> resource)
+{
+    unique_ptr<ResourceIndex> index = make_unique<ResourceIndex>();
+    index->Number = resourceNumber;
+    index->Text = &resource->GetComponent<TextComponent>();
+    index->Resource = move(resource);
+    const vector<TextEntry> &texts = index->Text->Texts;
+    for (size_t i = 0; i < texts.size(); i++)
+    {
+        const TextEntry &entry = texts[i];
+        // If there are duplicates (which the editor won't save), the first one wins.
+        index->Tuples.insert(make_pair(_GetSortedTuple(entry.Noun, entry.Verb, entry.Condition, entry.Sequence), (uint16_t)i));
+
+        vector<string> words = _GetLowerCaseWords(entry.Text);
+        sort(words.begin(), words.end());
+        words.erase(unique(words.begin(), words.end()), words.end());
+        for (string &word : words)
+        {
+            index->Words.emplace_back(move(word), (uint16_t)i);
+        }
+    }
+    return index;
+}
+
+void MessageDatabase::_Add(unique_ptr<ResourceIndex> index)
+{
+    uint16_t resourceNumber = (uint16_t)index->Number;
+    const vector<TextEntry> &texts = index->Text->Texts;
+
+    map<uint8_t, vector<MessageEntryRef>> talkers;
+    map<uint8_t, vector<MessageEntryRef>> verbs;
+    for (size_t i = 0; i < texts.size(); i++)
+    {
+        MessageEntryRef ref = { resourceNumber, (uint16_t)i };
+        talkers[texts[i].Talker].push_back(ref);
+        verbs[texts[i].Verb].push_back(ref);
+    }
+    for (auto &pair : talkers)
+    {
+        _InsertRefs(_talkers[pair.first], pair.second);
+    }
+    for (auto &pair : verbs)
+    {
+        _InsertRefs(_verbs[pair.first], pair.second);
+    }
+
+    map<string, vector<MessageEntryRef>> words;
+    for (auto &pair : index->Words)
+    {
+        words[pair.first].push_back(MessageEntryRef { resourceNumber, pair.second });
+    }
+    for (auto &pair : words)
+    {
+        _InsertRefs(_words[pair.first], pair.second);
+    }
+
+    _entryCount += texts.size();
+    _resources[index->Number] = move(index);
+}
+
+void MessageDatabase::_Remove(int resourceNumber)
+{
+    auto it = _resources.find(resourceNumber);
+    if (it != _resources.end())
+    {
+        const ResourceIndex &index = *it->second;
+        for (const TextEntry &entry : index.Text->Texts)
+        {
+            _RemoveRefs(_talkers, entry.Talker, (uint16_t)resourceNumber);
+            _RemoveRefs(_verbs, entry.Verb, (uint16_t)resourceNumber);
+        }
+        for (auto &pair : index.Words)
+        {
+            _RemoveRefs(_words, pair.first, (uint16_t)resourceNumber);
+        }
+        _entryCount -= index.Text->Texts.size();
+        _resources.erase(it);
+    }
+}
+
+void MessageDatabase::Load(const GameFolderHelper &helper, unsigned int workerCount)
+{
+    _resources.clear();
+    _talkers.clear();
+    _verbs.clear();
+    _words.clear();
+    _entryCount = 0;
+
+    vector<unique_ptr<ResourceBlob>> blobs;
+    auto container = helper.Resources(ResourceTypeFlags::Message, ResourceEnumFlags::MostRecentOnly | ResourceEnumFlags::AddInDefaultEnumFlags);
+    for (auto blob : *container)
+    {
+        blobs.push_back(move(blob));
+    }
+
+    // Reading the resources is the slow part, so that happens in parallel. Each worker fills in
+    // its own slots, and they're added in order afterwards.
+    vector<unique_ptr<ResourceIndex>> indices(blobs.size());
+    ParallelFor(blobs.size(), workerCount,
+        [&](size_t i)
+    {
+        try
+        {
+            unique_ptr<ResourceEntity> resource = CreateResourceFromResourceData(*blobs[i]);
+            if (resource && resource->TryGetComponent<TextComponent>())
+            {
+                indices[i] = _MakeIndex(blobs[i]->GetNumber(), move(resource));
+            }
+        }
+        catch (std::exception)
+        {
+            // Leave it out, the same as if it didn't exist.
+        }
+    }
+        );
+
+    for (auto &index : indices)
+    {
+        if (index && (_resources.find(index->Number) == _resources.end()))
+        {
+            _Add(move(index));
+        }
+    }
+}
+
+void MessageDatabase::Update(int resourceNumber, unique_ptr<ResourceEntity> resource)
+{
+    _Remove(resourceNumber);
+    if (resource && resource->TryGetComponent<TextComponent>())
+    {
+        _Add(_MakeIndex(resourceNumber, move(resource)));
+    }
+}
+
+vector<int> MessageDatabase::GetResourceNumbers() const
+{
+    vector<int> numbers;
+    for (auto &pair : _resources)
+    {
+        numbers.push_back(pair.first);
+    }
+    return numbers;
+}
+
+const TextComponent *MessageDatabase::GetMessage(int resourceNumber) const
+{
+    auto it = _resources.find(resourceNumber);
+    return (it != _resources.end()) ? it->second->Text : nullptr;
+}
+
+const TextEntry &MessageDatabase::GetEntry(const MessageEntryRef &ref) const
+{
+    return _resources.at(ref.ResourceNumber)->Text->Texts[ref.Index];
+}
+
+const TextEntry *MessageDatabase::Find(int resourceNumber, uint8_t noun, uint8_t verb, uint8_t condition, uint8_t sequence) const
+{
+    auto it = _resources.find(resourceNumber);
+    if (it != _resources.end())
+    {
+        auto itTuple = it->second->Tuples.find(_GetSortedTuple(noun, verb, condition, sequence));
+        if (itTuple != it->second->Tuples.end())
+        {
+            return &it->second->Text->Texts[itTuple->second];
+        }
+    }
+    return nullptr;
+}
+
+vector<MessageEntryRef> MessageDatabase::FindSequences(int resourceNumber, uint8_t noun, uint8_t verb, uint8_t condition) const
+{
+    vector<MessageEntryRef> refs;
+    auto it = _resources.find(resourceNumber);
+    if (it != _resources.end())
+    {
+        const map<uint32_t, uint16_t> &tuples = it->second->Tuples;
+        uint32_t first = _GetSortedTuple(noun, verb, condition, 0);
+        for (auto itTuple = tuples.lower_bound(first); (itTuple != tuples.end()) && (itTuple->first <= (first | 0xff)); ++itTuple)
+        {
+            refs.push_back(MessageEntryRef { (uint16_t)resourceNumber, itTuple->second });
+        }
+    }
+    return refs;
+}
+
+vector<MessageEntryRef> MessageDatabase::FindByTalker(uint8_t talker) const
+{
+    auto it = _talkers.find(talker);
+    return (it != _talkers.end()) ? it->second : vector<MessageEntryRef>();
+}
+
+vector<MessageEntryRef> MessageDatabase::FindByVerb(uint8_t verb) const
+{
+    auto it = _verbs.find(verb);
+    return (it != _verbs.end()) ? it->second : vector<MessageEntryRef>();
+}
+
+vector<MessageTextMatch> MessageDatabase::FindText(const string &text, bool matchCase, bool wholeWord) const
+{
+    vector<MessageTextMatch> matches;
+    if (text.empty())
+    {
+        return matches;
+    }
+
+    vector<MessageEntryRef> candidates;
+    vector<string> searchWords = _GetLowerCaseWords(text);
+    if (searchWords.empty())
+    {
+        // Nothing to narrow it down with, so look at everything.
+        for (auto &pair : _resources)
+        {
+            for (size_t i = 0; i < pair.second->Text->Texts.size(); i++)
+            {
+                candidates.push_back(MessageEntryRef { (uint16_t)pair.first, (uint16_t)i });
+            }
+        }
+    }
+    else
+    {
+        // Any match must contain the longest word of the search text within one of the entry's words
+        // (or as one of the entry's words, when matching whole words).
+        const string &key = *max_element(searchWords.begin(), searchWords.end(),
+            [](const string &one, const string &two) { return one.size() < two.size(); });
+        if (wholeWord)
+        {
+            auto it = _words.find(key);
+            if (it != _words.end())
+            {
+                candidates = it->second;
+            }
+        }
+        else
+        {
+            for (auto &pair : _words)
+            {
+                if (pair.first.find(key) != string::npos)
+                {
+                    candidates.insert(candidates.end(), pair.second.begin(), pair.second.end());
+                }
+            }
+            sort(candidates.begin(), candidates.end());
+            candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+        }
+    }
+
+    string what = matchCase ? text : _ToLower(text);
+    for (const MessageEntryRef &ref : candidates)
+    {
+        const string &entryText = GetEntry(ref).Text;
+        size_t pos = _FindString(matchCase ? entryText : _ToLower(entryText), what, wholeWord);
+        if (pos != string::npos)
+        {
+            matches.push_back(MessageTextMatch { ref, pos });
+        }
+    }
+    return matches;
+}
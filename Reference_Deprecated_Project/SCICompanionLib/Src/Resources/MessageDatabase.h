@@ -0,0 +1,89 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+#include "Text.h"
+
+class GameFolderHelper;
+class ResourceEntity;
+
+// Identifies one entry in the game's messages.
+struct MessageEntryRef
+{
+    uint16_t ResourceNumber;
+    uint16_t Index;     // Into the resource's TextComponent::Texts
+};
+
+bool operator<(const MessageEntryRef &one, const MessageEntryRef &two);
+bool operator==(const MessageEntryRef &one, const MessageEntryRef &two);
+
+struct MessageTextMatch
+{
+    MessageEntryRef Entry;
+    size_t Position;    // Where the search text was found
+};
+
+//
+// An index of the most recent version of every message resource in the game, so that tools which look
+// across all rooms (find in files, new message resources and so on) don't need to read and scan each resource.
+//
+// Entries can be looked up by noun/verb/condition/sequence, by talker or verb, and by the words they contain.
+// It doesn't depend on the UI, so it can be used headless. It is not thread-safe; CResourceMap owns the one for
+// the current game and keeps it up to date as message resources are saved or deleted.
+//
+class MessageDatabase
+{
+public:
+    MessageDatabase();
+    ~MessageDatabase();
+    MessageDatabase(const MessageDatabase &src) = delete;
+    MessageDatabase &operator=(const MessageDatabase &src) = delete;
+
+    // Reads all message resources, on up to workerCount threads. The result doesn't depend on the number of workers.
+    void Load(const GameFolderHelper &helper, unsigned int workerCount);
+    // Replaces what we know about a single message resource. Pass nullptr if it no longer exists.
+    void Update(int resourceNumber, std::unique_ptr<ResourceEntity> resource);
+
+    std::vector<int> GetResourceNumbers() const;
+    // Returns nullptr if there is no such message resource.
+    const TextComponent *GetMessage(int resourceNumber) const;
+    const TextEntry &GetEntry(const MessageEntryRef &ref) const;
+    size_t GetEntryCount() const { return _entryCount; }
+
+    // Returns nullptr if there is no such entry.
+    const TextEntry *Find(int resourceNumber, uint8_t noun, uint8_t verb, uint8_t condition, uint8_t sequence) const;
+    // All the sequences of a noun/verb/condition, in sequence order.
+    std::vector<MessageEntryRef> FindSequences(int resourceNumber, uint8_t noun, uint8_t verb, uint8_t condition) const;
+
+    // These are ordered by resource number, then index.
+    std::vector<MessageEntryRef> FindByTalker(uint8_t talker) const;
+    std::vector<MessageEntryRef> FindByVerb(uint8_t verb) const;
+    // Same matching rules as the text editor's find (whole words are delimited by anything other than
+    // letters, numbers and underscores).
+    std::vector<MessageTextMatch> FindText(const std::string &text, bool matchCase, bool wholeWord) const;
+
+private:
+    struct ResourceIndex;
+
+    static std::unique_ptr<ResourceIndex> _MakeIndex(int resourceNumber, std::unique_ptr<ResourceEntity> resource);
+    void _Add(std::unique_ptr<ResourceIndex> index);
+    void _Remove(int resourceNumber);
+
+    std::map<int, std::unique_ptr<ResourceIndex>> _resources;
+    std::unordered_map<uint8_t, std::vector<MessageEntryRef>> _talkers;
+    std::unordered_map<uint8_t, std::vector<MessageEntryRef>> _verbs;
+    // Lower case words -> the entries that contain them.
+    std::map<std::string, std::vector<MessageEntryRef>> _words;
+    size_t _entryCount;
+};
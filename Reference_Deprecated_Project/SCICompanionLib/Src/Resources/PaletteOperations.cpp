@@ -119,6 +119,23 @@ void PaletteComponent::MergeFromOther(const PaletteComponent *globalPalette)
     }
 }
 
+std::unique_ptr<PaletteComponent> CreateMergedPalette(const ResourceEntity &resource, const PaletteComponent *globalPalette)
+{
+    std::unique_ptr<PaletteComponent> paletteReturn;
+    const PaletteComponent *paletteEmbedded = resource.TryGetComponent<PaletteComponent>();
+    if (paletteEmbedded)
+    {
+        paletteReturn = std::make_unique<PaletteComponent>(*paletteEmbedded);
+    }
+    else
+    {
+        paletteReturn = std::make_unique<PaletteComponent>();
+        memset(paletteReturn->Colors, 0, sizeof(paletteReturn->Colors));
+    }
+    paletteReturn->MergeFromOther(globalPalette);
+    return paletteReturn;
+}
+
 const int SquareSize = 12;
 
 void DrawUnderline(uint8_t *bits, int cx, int cy, int x, int y, int border, uint8_t value)
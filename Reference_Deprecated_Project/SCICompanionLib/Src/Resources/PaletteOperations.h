@@ -72,6 +72,9 @@ struct PaletteComponent : public ResourceComponent
 
 extern PaletteComponent g_egaDummyPalette;
 
+// A copy of the resource's embedded palette (or an empty one), with the entries it doesn't use taken from globalPalette.
+std::unique_ptr<PaletteComponent> CreateMergedPalette(const ResourceEntity &resource, const PaletteComponent *globalPalette);
+
 void ReadPalette(PaletteComponent &palette, sci::istream &byteStream);
 void WritePalette(sci::ostream &byteStream, const PaletteComponent &palette);
 void WritePaletteShortForm(sci::ostream &byteStream, const PaletteComponent &palette);
@@ -17,10 +17,7 @@
 
 PatchFilesResourceSource::PatchFilesResourceSource(ResourceTypeFlags types, SCIVersion version, const std::string &gameFolder, ResourceSourceFlags sourceFlags) :
     _gameFolder(gameFolder),
-    _gameFolderSpec(gameFolder + "\\*.*"),
-    _hFind(INVALID_HANDLE_VALUE),
     _version(version),
-    _stillMore(true),
     _sourceFlags(sourceFlags)
 {
     // Prepare a filter against which to 
@@ -47,67 +44,38 @@ PatchFilesResourceSource::PatchFilesResourceSource(ResourceTypeFlags types, SCIV
 
 bool PatchFilesResourceSource::ReadNextEntry(ResourceTypeFlags typeFlags, IteratorState &state, ResourceMapEntryAgnostic &entry, std::vector<uint8_t> *optionalRawData)
 {
-    if (_stillMore && (_hFind == INVALID_HANDLE_VALUE))
+    // The folder listing is cached, so this normally doesn't need to touch the disk.
+    if (!_patchFiles)
     {
-        _hFind = FindFirstFile(_gameFolderSpec.c_str(), &_findData);
+        _patchFiles = GetCachedPatchFiles(_gameFolder);
     }
 
-    _stillMore = _stillMore && (_hFind != INVALID_HANDLE_VALUE);
-    bool foundOne = false;
-    while (_stillMore && !foundOne)
+    // mapStreamOffset is our index into the listing.
+    while (state.mapStreamOffset < _patchFiles->size())
     {
-        if (PathMatchSpec(_findData.cFileName, _fileSpec.c_str()))
+        uint32_t index = state.mapStreamOffset++;
+        const PatchFileEntry &patchFile = (*_patchFiles)[index];
+        if (IsFlagSet(typeFlags, ResourceTypeToFlag(patchFile.Type)) && PathMatchSpec(patchFile.FileName.c_str(), _fileSpec.c_str()))
         {
-            int number = ResourceNumberFromFileName(_findData.cFileName);
-            if (number != -1)
-            {
-                // We need a valid number.
-                // We do need to peek open the file right now.
-                ScopedHandle patchFile;
-                std::string fullPath = _gameFolder + "\\" + _findData.cFileName;
-                patchFile.hFile = CreateFile(fullPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
-                if (patchFile.hFile != INVALID_HANDLE_VALUE)
-                {
-                    // Read the first two bytes. The first is the type, the next is the offset.
-                    uint8_t word[2];
-                    DWORD cbRead;
-                    if (ReadFile(patchFile.hFile, &word, sizeof(word), &cbRead, nullptr) && (cbRead == sizeof(word)))
-                    {
-                        ResourceType type = (ResourceType)(word[0] & 0x7f);
-                        if (IsFlagSet(typeFlags, ResourceTypeToFlag(type)))
-                        {
-                            entry.Number = number;
-                            entry.Offset = GetResourceOffsetInFile(word[1]) + 2;    // For the word we just read.
-                            entry.Type = type;
-                            entry.ExtraData = _nextIndex;
-                            entry.PackageNumber = 0;
-
-                            // This is hokey, but we need a way to know the filename for an item
-                            _indexToFilename[_nextIndex] = _findData.cFileName;
-                            _nextIndex++;
-                            foundOne = true;
-                        }
-                    }
-                }
-            }
+            entry.Number = patchFile.Number;
+            entry.Offset = patchFile.Offset;
+            entry.Type = patchFile.Type;
+            entry.ExtraData = index;    // So we know which file this is later.
+            entry.PackageNumber = 0;
+            return true;
         }
-
-        _stillMore = !!FindNextFile(_hFind, &_findData);
-    }
-
-    if (!_stillMore)
-    {
-        FindClose(_hFind);
-        _hFind = INVALID_HANDLE_VALUE;
     }
-
-    return _stillMore || foundOne;
+    return false;
 }
 
 sci::istream PatchFilesResourceSource::GetHeaderAndPositionedStream(const ResourceMapEntryAgnostic &mapEntry, ResourceHeaderAgnostic &headerEntry)
 {
-    std::string fileName = _indexToFilename[mapEntry.ExtraData];    // We used package number as a transport vessel for our arbitrary data
-    assert(!fileName.empty());
+    assert(_patchFiles && (mapEntry.ExtraData < _patchFiles->size()));
+    if (!_patchFiles || (mapEntry.ExtraData >= _patchFiles->size()))
+    {
+        return sci::istream(nullptr, 0);
+    }
+    const std::string &fileName = (*_patchFiles)[mapEntry.ExtraData].FileName;
     ScopedHandle patchFile;
     std::string fullPath = _gameFolder + "\\" + fileName;
     patchFile.hFile = CreateFile(fullPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
@@ -150,6 +118,7 @@ void PatchFilesResourceSource::RemoveEntry(const ResourceMapEntryAgnostic &mapEn
     std::string filename = GetFileNameFor(mapEntry.Type, mapEntry.Number, mapEntry.Base36Number, _version);
     std::string fullPath = _gameFolder + "\\" + filename;
     deletefile(fullPath);
+    InvalidateResourceSourceCache(_gameFolder);
 }
 
 AppendBehavior PatchFilesResourceSource::AppendResources(const std::vector<const ResourceBlob*> &blobs)
@@ -168,13 +137,10 @@ AppendBehavior PatchFilesResourceSource::AppendResources(const std::vector<const
         deletefile(fullPath);
         movefile(bakPath, fullPath);
     }
+    InvalidateResourceSourceCache(_gameFolder);
     return AppendBehavior::Replace;
 }
 
 PatchFilesResourceSource::~PatchFilesResourceSource()
 {
-    if (_hFind != INVALID_HANDLE_VALUE)
-    {
-        FindClose(_hFind);
-    }
 }
@@ -33,17 +33,12 @@ public:
     void RebuildResources(bool force, ResourceSource &source, std::map<ResourceType, RebuildStats> &stats) override {} // Nothing to do here.
 
 private:
-    HANDLE _hFind;
-    bool _stillMore;
     std::string _gameFolder;
-    std::string _gameFolderSpec;
     std::string _fileSpec;
-    WIN32_FIND_DATA _findData;
     SCIVersion _version;
     ResourceSourceFlags _sourceFlags;
 
-    // Muck
-    int _nextIndex;
-    std::unordered_map<int, std::string> _indexToFilename;
+    // The folder listing we're enumerating. Map entries refer to files in here by index.
+    std::shared_ptr<const std::vector<PatchFileEntry>> _patchFiles;
     std::unordered_map<int, std::unique_ptr<sci::streamOwner>> _streamHolder;
 };
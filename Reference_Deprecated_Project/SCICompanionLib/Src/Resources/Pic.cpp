@@ -1061,7 +1061,7 @@ void PicWriteToVGA2(const ResourceEntity &resource, sci::ostream &byteStream, st
         {
             PicCelHeader_VGA2 celHeader = {};
             celHeader.compressed = compressed ? CompressionTag : 0;
-            Cel *pCel = command.drawVisualBitmap.pCel;
+            const Cel *pCel = command.drawVisualBitmap.pCel;
             celHeader.size = pCel->size;
             celHeader.relativePlacement = pCel->placement;
 
@@ -1291,6 +1291,35 @@ bool IsSame(const PicComponent *one, const PicComponent *two)
 
 PicComponent::PicComponent() : PicComponent(&picTraitsEGA) {}
 
+size_t PicComponent::EstimateSize(const ResourceComponent *previous) const
+{
+    // The commands themselves are always copied, but the bitmaps they contain may be shared.
+    std::unordered_set<const uint8_t*> previousBitmaps;
+    if (previous)
+    {
+        for (const PicCommand &command : static_cast<const PicComponent*>(previous)->commands)
+        {
+            if ((command.type == PicCommand::DrawBitmap) && command.drawVisualBitmap.pCel)
+            {
+                previousBitmaps.insert(command.drawVisualBitmap.pCel->Data.data());
+            }
+        }
+    }
+    size_t size = sizeof(*this) + commands.size() * sizeof(PicCommand);
+    for (const PicCommand &command : commands)
+    {
+        if ((command.type == PicCommand::DrawBitmap) && command.drawVisualBitmap.pCel)
+        {
+            size += sizeof(Cel);
+            if (previousBitmaps.find(command.drawVisualBitmap.pCel->Data.data()) == previousBitmaps.end())
+            {
+                size += command.drawVisualBitmap.pCel->Data.size();
+            }
+        }
+    }
+    return size;
+}
+
 PicComponent::PicComponent(const PicTraits *traits) : Traits(traits), Size(size16(DEFAULT_PIC_WIDTH, DEFAULT_PIC_HEIGHT)), UniqueId(g_PicIds++)  {}
 
 ResourceEntity *CreatePicResource(SCIVersion version)
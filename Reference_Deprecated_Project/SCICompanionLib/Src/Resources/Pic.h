@@ -41,6 +41,7 @@ struct PicComponent : ResourceComponent
     {
         return new PicComponent(*this);
     }
+    size_t EstimateSize(const ResourceComponent *previous) const override;
 
     std::vector<PicCommand> commands;
     size16 Size;
@@ -640,6 +640,10 @@ inline void _PlotPixI(int p, PicData *pData, int16_t x, int16_t y, PicScreenFlag
     {
         pData->pdataControl[p] = bControlValue;
     }
+    if (pData->pProvenance)
+    {
+        pData->pProvenance->Record(p, pData->dwMapsToRedraw & dwDrawEnable);
+    }
 }
 
 struct PlotEGA
@@ -739,6 +743,10 @@ inline void _PlotPix(PicData *pData, int16_t x, int16_t y, PicScreenFlags dwDraw
     }
 
     pData->pdataAux[p] |= (uint8_t)auxSet;
+    if (pData->pProvenance)
+    {
+        pData->pProvenance->Record(p, pData->dwMapsToRedraw & dwDrawEnable);
+    }
 }
 
 template<typename _TFormat>
@@ -2366,7 +2374,8 @@ void DrawVisualBitmap_Draw(const PicCommand *pCommand, PicData *pData, ViewPort
     if (pCommand->drawVisualBitmap.pCel)
     {
         size16 displaySize = pData->size;
-        Cel &cel = *pCommand->drawVisualBitmap.pCel;
+        // const, so that reading the bits doesn't unshare them from undo snapshots.
+        const Cel &cel = *pCommand->drawVisualBitmap.pCel;
         // Optimization
 #if CANT_DO_BECAUSE_OF_TRANS_COLOR
         if ((cel.size.cx == pData->size.cx) && (cel.size.cy == pData->size.cy))
@@ -2387,6 +2396,28 @@ void DrawVisualBitmap_Draw(const PicCommand *pCommand, PicData *pData, ViewPort
                 writeToPriorityScreen = true;
             }
 
+            if (pData->pProvenance)
+            {
+                // Record the pixels DrawImageWithPriority is about to write.
+                PicScreenFlags screens = PicScreenFlags::Visual;
+                if (writeToPriorityScreen)
+                {
+                    screens |= PicScreenFlags::Priority;
+                }
+                for (int y = max(0, cel.placement.y); y < min(pData->size.cy, (cel.placement.y + cel.size.cy)); y++)
+                {
+                    for (int x = max(0, cel.placement.x); x < min(pData->size.cx, (cel.placement.x + cel.size.cx)); x++)
+                    {
+                        int p = BUFFEROFFSET_NONSTD(displaySize.cx, displaySize.cy, x, y);
+                        uint8_t bCel = cel.Data[BUFFEROFFSET_NONSTD(cel.GetStride(), cel.size.cy, x - cel.placement.x, y - cel.placement.y)];
+                        if ((bCel != cel.TransparentColor) && (!pData->pdataPriority || (pData->pdataPriority[p] <= priorityValue)))
+                        {
+                            pData->pProvenance->Record(p, screens);
+                        }
+                    }
+                }
+            }
+
             // Copy line by line.
             DrawImageWithPriority(
                 displaySize,
@@ -2399,7 +2430,7 @@ void DrawVisualBitmap_Draw(const PicCommand *pCommand, PicData *pData, ViewPort
                 cel.size.cx,
                 cel.size.cy,
                 cel.GetStride(),
-                &cel.Data[0],
+                cel.Data.data(),
                 cel.TransparentColor,
                 false,
 				false);
@@ -2437,7 +2468,7 @@ void DrawVisualBitmap_Serialize(sci::ostream *pSerial, const PicCommand *pComman
     // The opcode is different in VGA vs EGA
     pSerial->WriteByte(pCommand->drawVisualBitmap.isVGA ? 0x1 : 0x7);
 
-    Cel *pCel = pCommand->drawVisualBitmap.pCel;
+    const Cel *pCel = pCommand->drawVisualBitmap.pCel;
     _WriteAbsCoordinate(pSerial, pCel->placement.x, pCel->placement.y); // REVIEW: This means no -ve?
     uint32_t currentOffset = pSerial->tellp(); // Store this place, because we'll need to write the size in.
     pSerial->WriteWord(0);
@@ -2722,6 +2753,24 @@ bool operator!=(const PenStyle &one, const PenStyle &two)
     return !(one == two);
 }
 
+PicProvenance::PicProvenance(size16 size) : Size(size), CurrentCommand(NoCommand)
+{
+    for (auto &screen : Screens)
+    {
+        screen.assign(size.cx * size.cy, NoCommand);
+    }
+}
+
+uint32_t PicProvenance::GetCommand(PicScreen screen, int x, int y) const
+{
+    assert(screen != PicScreen::Aux);
+    if ((x < 0) || (y < 0) || (x >= Size.cx) || (y >= Size.cy))
+    {
+        return NoCommand;
+    }
+    return Screens[(int)screen][BUFFEROFFSET_NONSTD(Size.cx, Size.cy, x, y)];
+}
+
 void PicData::EnsureInBounds(int &x, int &y)
 {
     x = min(x, size.cx - 1);
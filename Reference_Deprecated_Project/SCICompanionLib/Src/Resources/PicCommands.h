@@ -94,6 +94,38 @@ public:
 
 
 
+//
+// Optionally filled in while drawing a pic: for each pixel of the visual, priority and control
+// screens, the index of the last command that wrote to it.
+//
+struct PicProvenance
+{
+    static const uint32_t NoCommand = 0xffffffff;
+
+    PicProvenance(size16 size);
+
+    uint32_t GetCommand(PicScreen screen, int x, int y) const;
+    void Record(int offset, PicScreenFlags screens)
+    {
+        if (IsFlagSet(screens, PicScreenFlags::Visual))
+        {
+            Screens[(int)PicScreen::Visual][offset] = CurrentCommand;
+        }
+        if (IsFlagSet(screens, PicScreenFlags::Priority))
+        {
+            Screens[(int)PicScreen::Priority][offset] = CurrentCommand;
+        }
+        if (IsFlagSet(screens, PicScreenFlags::Control))
+        {
+            Screens[(int)PicScreen::Control][offset] = CurrentCommand;
+        }
+    }
+
+    size16 Size;
+    uint32_t CurrentCommand; // Set before drawing each command.
+    std::vector<uint32_t> Screens[3]; // Indexed by PicScreen, with the same layout as the screen buffers.
+};
+
 struct PicData
 {
     PicScreenFlags dwMapsToRedraw;
@@ -105,6 +137,7 @@ struct PicData
 	bool isUndithered;
     size16 size;
     bool isContinuousPriority;
+    PicProvenance *pProvenance; // Optional
 
     void EnsureInBounds(int &x, int &y);
 };
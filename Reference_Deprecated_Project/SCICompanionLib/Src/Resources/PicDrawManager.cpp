@@ -54,6 +54,8 @@ PicDrawManager::PicDrawManager(const PicComponent *pPic, const PaletteComponent
     }
 }
 
+PicDrawManager::~PicDrawManager() {}
+
 void PicDrawManager::_EnsureBufferPool(size16 size)
 {
     size_t byteSize = size.cx * size.cy;
@@ -87,6 +89,7 @@ void PicDrawManager::_Reset()
     _bPaletteNumber = 0;
     //_currentState.Reset(_bPaletteNumber);
     _iInsertPos = -1;
+    _provenance.reset();
 }
 
 void PicDrawManager::SetPic(const PicComponent *pPic, const PaletteComponent *pPalette, bool isEGAUndithered)
@@ -142,6 +145,17 @@ const uint8_t *PicDrawManager::GetPicBits(PicScreen screen, PicPosition pos, siz
     return GetScreenData(screen, pos);
 }
 
+const ControlMask &PicDrawManager::GetControlMask(PicPosition pos, size16 size)
+{
+    const uint8_t *pdataControl = GetPicBits(PicScreen::Control, pos, size);
+    std::unique_ptr<ControlMask> &controlMask = _controlMasks[(int)pos];
+    if (!controlMask)
+    {
+        controlMask = std::make_unique<ControlMask>(size, pdataControl);
+    }
+    return *controlMask;
+}
+
 void PicDrawManager::GetBitmapInfo(PicScreen screen, BITMAPINFO **ppbmi)
 {
     size16 size = _GetPicSize();
@@ -204,6 +218,7 @@ void PicDrawManager::SetPalette(uint8_t bPaletteNumber)
         _fValidPalette = false; // Since the palette changed.
         _fValidScreens = PicScreenFlags::None;
         _fValidState = false;
+        _provenance.reset();
     }
 }
 
@@ -300,6 +315,12 @@ void PicDrawManager::_RedrawBuffers(ViewPort *pState, PicScreenFlags screenFlags
         clearOutFromHereOn = PicPosition::Final;
     }
 
+    // The control masks for anything being redrawn are now stale.
+    for (int posIndex = (int)clearOutFromHereOn; posIndex < 3; posIndex++)
+    {
+        _controlMasks[posIndex].reset();
+    }
+
     if (clearOutFromHereOn <= PicPosition::PrePlugin)
     {
         _ReturnOldBufferIfNotUsedAnywhere(PicPosition::PrePlugin);
@@ -678,28 +699,42 @@ const ViewPort *PicDrawManager::GetViewPort(PicPosition pos)
 //
 ptrdiff_t PicDrawManager::PosFromPoint(int x, int y, ptrdiff_t iStart)
 {
-    ViewPort state(0);
-    size16 size = _GetPicSize();
-    size_t byteSize = size.cx * size.cy;
-    // Clear out our cached bitmaps.
-    PicScreenFlags dwMapsToRedraw = PicScreenFlags::None;
-    std::vector<uint8_t> pdataVisual(byteSize, 0x0f);
-    std::vector<uint8_t> pdataAux(byteSize, 0x00);
-    dwMapsToRedraw |= PicScreenFlags::Visual;
-    PicData data =
-    {
-        dwMapsToRedraw,
-        &pdataVisual[0], // Visual always needs to be provided (for fill)
-        nullptr,
-        nullptr,
-        &pdataAux[0], // Aux always needs to be provided (for fill)
-        _isVGA,
-		_isUndithered,
-        _GetPicSize(),
-        _isContinuousPri
-    };
-
-    return GetLastChangedSpot(*_pPicWeak, data, state, x, y);
+    uint32_t command = GetProvenance().GetCommand(PicScreen::Visual, x, y);
+    return (command == PicProvenance::NoCommand) ? -1 : (ptrdiff_t)command;
+}
+
+const PicProvenance &PicDrawManager::GetProvenance()
+{
+    if (!_provenance)
+    {
+        size16 size = _GetPicSize();
+        _provenance = std::make_unique<PicProvenance>(size);
+        if (_pPicWeak)
+        {
+            // Draw the whole pic once, into our own buffers.
+            size_t byteSize = size.cx * size.cy;
+            std::vector<uint8_t> pdataVisual(byteSize, (_isVGA || _isUndithered) ? 0xff : 0x0f);
+            std::vector<uint8_t> pdataPriority(byteSize, 0x00);
+            std::vector<uint8_t> pdataControl(byteSize, 0x00);
+            std::vector<uint8_t> pdataAux(byteSize, 0x00);
+            PicData data =
+            {
+                PicScreenFlags::Visual | PicScreenFlags::Priority | PicScreenFlags::Control,
+                &pdataVisual[0],
+                &pdataPriority[0],
+                &pdataControl[0],
+                &pdataAux[0],
+                _isVGA,
+                _isUndithered,
+                size,
+                _isContinuousPri,
+                _provenance.get()
+            };
+            ViewPort state(_bPaletteNumber);
+            Draw(*_pPicWeak, data, state, 0, -1);
+        }
+    }
+    return *_provenance;
 }
 
 //
@@ -728,11 +763,14 @@ void PicDrawManager::Invalidate()
 {
     _fValidScreens = PicScreenFlags::None;
     _fValidState = false;
+    _provenance.reset();
 }
 
 void PicDrawManager::_OnPosChanged(bool fNotify)
 {
-    Invalidate();
+    // The provenance covers the whole pic, so it doesn't depend on the position.
+    _fValidScreens = PicScreenFlags::None;
+    _fValidState = false;
 }
 
 void PicDrawManager::InvalidatePlugins()
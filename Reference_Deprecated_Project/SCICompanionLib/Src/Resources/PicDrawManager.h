@@ -14,9 +14,11 @@
 #pragma once
 
 #include "BufferPool.h"
+#include "ControlMask.h"
 
 // fwd decl
 struct PicData;
+struct PicProvenance;
 struct PicComponent;
 struct PaletteComponent;
 struct Cel;
@@ -54,12 +56,15 @@ class PicDrawManager
 {
 public:
     PicDrawManager(const PicComponent *pPic = nullptr, const PaletteComponent *pPalette = nullptr, bool isEGAUndithered = false);
+    ~PicDrawManager();
     void SetPic(const PicComponent *pPic, const PaletteComponent *pPalette, bool isEGAUndithered);
     const PicComponent *GetPic() const { return _pPicWeak; }
 
     // Use these to get the pic image:
     HBITMAP CreateBitmap(PicScreen screen, PicPosition position, size16 size, int cx, int cy, SCIBitmapInfo *pbmi = nullptr, uint8_t **pBitsDest = nullptr);
     const uint8_t *GetPicBits(PicScreen screen, PicPosition position, size16 size);
+    // For fast CanBeHere queries against the control screen. Only valid until the pic is redrawn.
+    const ControlMask &GetControlMask(PicPosition position, size16 size);
     void CopyBitmap(PicScreen screen, PicPosition position, size16 size, uint8_t *pdataDisplay, uint8_t *pdataAux, BITMAPINFO **ppbmi);
     void GetBitmapInfo(PicScreen screen, BITMAPINFO **ppbmi);
     std::unique_ptr<Cel> MakeCelFromPic(PicScreen screen, PicPosition position);
@@ -69,6 +74,9 @@ public:
     const ViewPort *GetViewPort(PicPosition pos);
     bool SeekToPos(ptrdiff_t iPos); // true if changed
     ptrdiff_t PosFromPoint(int x, int y, ptrdiff_t iStart);
+    // Which command last wrote each pixel of each screen, over the whole pic. Built on demand,
+    // and kept until the pic, palette or drawing mode changes.
+    const PicProvenance &GetProvenance();
     ptrdiff_t GetPos() const { return _iInsertPos; }
     void SetPreview(bool fPreview);
     void Invalidate();
@@ -113,6 +121,9 @@ private:
     uint8_t* _screenBuffers[3][4];
     // Cached view port state for each of the 3 position buffers.
     std::unique_ptr<ViewPort[]> _viewPorts;
+    // Built on demand from the control screen of each position.
+    std::unique_ptr<ControlMask> _controlMasks[3];
+    std::unique_ptr<PicProvenance> _provenance;
 
     // Are the bitmaps valid? (note, if any of these are valid, then the aux is valid too)
     PicScreenFlags _fValidScreens;
@@ -397,24 +397,10 @@ void Draw(const PicComponent &pic, PicData &data, ViewPort &state, ptrdiff_t iSt
     for (ptrdiff_t i = iStart; i < iEnd; i++)
     {
         const PicCommand &command = pic.commands[i];
-        command.Draw(&data, state);
-    }
-}
-
-size_t GetLastChangedSpot(const PicComponent &pic, PicData &data, ViewPort &state, int x, int y)
-{
-    // Now process all our pic commands!
-    uint8_t bColor = 0xf; // White, for visual.  Note - this won't work well for dithered colors.  We need to expand our radius
-    size_t iLastTimeItChanged = -1; // Never changed.
-    size_t iPos = pic.commands.size();
-    for (size_t i = 0; i < iPos; i++)
-    {
-        pic.commands[i].Draw(&data, state);
-        if (data.pdataVisual[BUFFEROFFSET_NONSTD(data.size.cx, data.size.cy, x, y)] != bColor)
+        if (data.pProvenance)
         {
-            iLastTimeItChanged = i;
-            bColor = data.pdataVisual[BUFFEROFFSET_NONSTD(data.size.cx, data.size.cy, x, y)];
+            data.pProvenance->CurrentCommand = (uint32_t)i;
         }
+        command.Draw(&data, state);
     }
-    return iLastTimeItChanged;
 }
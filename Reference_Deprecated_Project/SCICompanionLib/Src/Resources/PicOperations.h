@@ -39,4 +39,3 @@ const PicCommand &GetCommandAt(const PicComponent &pic, ptrdiff_t iIndex);
 // Interesting operations.
 void Draw(const PicComponent &pic, PicData &data, ViewPort &state, ptrdiff_t iPos);
 void Draw(const PicComponent &pic, PicData &data, ViewPort &state, ptrdiff_t iStart, ptrdiff_t iEnd);
-size_t GetLastChangedSpot(const PicComponent &pic, PicData &data, ViewPort &state, int x, int y);
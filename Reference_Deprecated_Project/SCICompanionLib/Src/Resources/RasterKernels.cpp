@@ -0,0 +1,152 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "RasterKernels.h"
+
+using namespace std;
+
+namespace
+{
+    // RotateCelBits steps through the source in fixed-point, with 40 bits of fraction.
+    const int FixedShift = 40;
+    const int64_t FixedOne = 1LL << FixedShift;
+    const int64_t FixedHalf = FixedOne / 2;
+
+    // The fixed-point source coordinates are within 2^-41 per pixel of the exact ones, and TransformRotate's
+    // doubles are much closer still. So unless they're this close to a rounding tie (x.5), both round the
+    // same way. When they are, we let TransformRotate decide.
+    const int64_t RoundingGuard = FixedOne >> 20;
+
+    int64_t _ToFixed(double value)
+    {
+        return llround(value * (double)FixedOne);
+    }
+
+    bool _TryRoundFixed(int64_t value, int &rounded)
+    {
+        int64_t fraction = value & (FixedOne - 1);
+        if (abs(fraction - FixedHalf) < RoundingGuard)
+        {
+            return false;
+        }
+        rounded = (int)((value + FixedHalf) >> FixedShift);
+        return true;
+    }
+}
+
+void StretchCelBits(const uint8_t *source, size16 sourceSize, int sourceStride, uint8_t *dest, size16 destSize, int destStride)
+{
+    // x * sourceSize.cx / destSize.cx for each column, without dividing: sourceX * destSize.cx + remainder is
+    // always x * sourceSize.cx.
+    vector<uint16_t> sourceColumns(destSize.cx);
+    int sourceX = 0;
+    int remainder = 0;
+    for (int x = 0; x < destSize.cx; x++)
+    {
+        sourceColumns[x] = (uint16_t)sourceX;
+        remainder += sourceSize.cx;
+        while (remainder >= destSize.cx)
+        {
+            remainder -= destSize.cx;
+            sourceX++;
+        }
+    }
+
+    // Likewise for the rows.
+    int sourceY = 0;
+    remainder = 0;
+    int previousSourceY = -1;
+    for (int y = 0; y < destSize.cy; y++)
+    {
+        uint8_t *destLine = dest + y * destStride;
+        if (sourceY == previousSourceY)
+        {
+            // Stretching vertically repeats lines.
+            memcpy(destLine, destLine - destStride, destSize.cx);
+        }
+        else
+        {
+            const uint8_t *sourceLine = source + sourceY * sourceStride;
+            for (int x = 0; x < destSize.cx; x++)
+            {
+                destLine[x] = sourceLine[sourceColumns[x]];
+            }
+        }
+        previousSourceY = sourceY;
+        remainder += sourceSize.cy;
+        while (remainder >= destSize.cy)
+        {
+            remainder -= destSize.cy;
+            sourceY++;
+        }
+    }
+}
+
+void MirrorCelBits(const uint8_t *source, uint8_t *dest, size16 size, int stride)
+{
+    for (int y = 0; y < size.cy; y++)
+    {
+        const uint8_t *sourceLine = source + y * stride;
+        reverse_copy(sourceLine, sourceLine + size.cx, dest + y * stride);
+    }
+}
+
+void TransformRotate(double xOrigSource, double yOrigSource, double xOrigDest, double yOrigDest, double sinTheta, double cosTheta, int &x, int &y)
+{
+    double xOut = x - xOrigSource + 0.51; // I don't use 0.5 because that would be "unstable" when rounding at the end.
+    double yOut = y - yOrigSource + 0.51;
+    double xOut2 = xOut * cosTheta - yOut * sinTheta;
+    double yOut2 = xOut * sinTheta + yOut * cosTheta;
+    xOut2 += (double)xOrigDest - 0.51;
+    yOut2 += (double)yOrigDest - 0.51;
+    x = (int)round(xOut2);
+    y = (int)round(yOut2);
+}
+
+void RotateCelBits(const uint8_t *source, size16 sourceSize, int sourceStride, uint8_t *dest, size16 destSize, int destStride, double sinTheta, double cosTheta, uint8_t fillColor)
+{
+    double xOrigDest = (double)destSize.cx * 0.5;
+    double yOrigDest = (double)destSize.cy * 0.5;
+    double xOrigSource = (double)sourceSize.cx * 0.5;
+    double yOrigSource = (double)sourceSize.cy * 0.5;
+
+    // Moving one pixel right in the destination moves (cos, sin) in the source.
+    int64_t xStep = _ToFixed(cosTheta);
+    int64_t yStep = _ToFixed(sinTheta);
+    for (int yDest = 0; yDest < destSize.cy; yDest++)
+    {
+        // Where the start of this line comes from (TransformRotate, before rounding)
+        double xOut = 0.51 - xOrigDest;
+        double yOut = yDest - yOrigDest + 0.51;
+        int64_t xSourceFixed = _ToFixed(xOut * cosTheta - yOut * sinTheta + (xOrigSource - 0.51));
+        int64_t ySourceFixed = _ToFixed(xOut * sinTheta + yOut * cosTheta + (yOrigSource - 0.51));
+
+        uint8_t *destLine = dest + yDest * destStride;
+        for (int xDest = 0; xDest < destSize.cx; xDest++)
+        {
+            int xSource, ySource;
+            if (!_TryRoundFixed(xSourceFixed, xSource) || !_TryRoundFixed(ySourceFixed, ySource))
+            {
+                xSource = xDest;
+                ySource = yDest;
+                TransformRotate(xOrigDest, yOrigDest, xOrigSource, yOrigSource, sinTheta, cosTheta, xSource, ySource);
+            }
+            destLine[xDest] = (((unsigned)xSource < (unsigned)sourceSize.cx) && ((unsigned)ySource < (unsigned)sourceSize.cy)) ?
+                source[ySource * sourceStride + xSource] :
+                fillColor;
+            xSourceFixed += xStep;
+            ySourceFixed += yStep;
+        }
+    }
+}
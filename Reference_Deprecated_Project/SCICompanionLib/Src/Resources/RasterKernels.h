@@ -0,0 +1,33 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+// The per-pixel loops behind the cel transforms in RasterOperations: stretching, mirroring and rotating.
+// These step through the source incrementally with integer (or fixed-point) arithmetic rather than
+// recomputing each source pixel from scratch, but give exactly the same results as doing so.
+// Strides are in bytes; source and destination must not overlap.
+
+// Nearest neighbour stretch: destination pixel (x, y) comes from source pixel
+// (x * sourceSize.cx / destSize.cx, y * sourceSize.cy / destSize.cy).
+void StretchCelBits(const uint8_t *source, size16 sourceSize, int sourceStride, uint8_t *dest, size16 destSize, int destStride);
+
+// Flips the bits horizontally.
+void MirrorCelBits(const uint8_t *source, uint8_t *dest, size16 size, int stride);
+
+// Rotates (x, y) about the origin (xOrigSource, yOrigSource), and moves it to (xOrigDest, yOrigDest).
+void TransformRotate(double xOrigSource, double yOrigSource, double xOrigDest, double yOrigDest, double sinTheta, double cosTheta, int &x, int &y);
+
+// Fills each destination pixel with the source pixel that TransformRotate maps it to (using the centers of
+// the destination and source as the origins), or fillColor if that's outside the source.
+void RotateCelBits(const uint8_t *source, size16 sourceSize, int sourceStride, uint8_t *dest, size16 destSize, int destStride, double sinTheta, double cosTheta, uint8_t fillColor);
@@ -17,6 +17,7 @@
 #include "RasterOperations.h"
 #include "PaletteOperations.h"
 #include "ResourceEntity.h"
+#include "RasterKernels.h"
 
 // Ok, try resizing a view resource
 //
@@ -63,7 +64,7 @@ void ReallocBits(
     if ((newSize != cel.size) || fForce)
     {
         size_t cItems = PaddedSize(newSize);
-        sci::array<uint8_t> newBits(cItems);
+        sci::shared_array<uint8_t> newBits(cItems);
         if (fCopy || fFill)
         {
             if (fFill)
@@ -74,7 +75,7 @@ void ReallocBits(
             if (fCopy)
             {
                 uint8_t *pBitsNew = &newBits[0];   // Access to raw data
-                uint8_t *pBits = &cel.Data[0];      // Access to old raw data
+                const uint8_t *pBits = cel.Data.data(); // Access to old raw data (without unsharing it)
 
                 // Copy from the old bitmap (y = 0 is at the bottom)
                 int yEnd = min(newSize.cy, cel.size.cy);
@@ -86,16 +87,7 @@ void ReallocBits(
                 if (RasterResizeFlags::Stretch == flags)
                 {
                     // We're stretching.
-                    for (int y = 0; y < newSize.cy; y++)
-                    {
-                        uint8_t *pLineDest = pBitsNew + CX_ACTUAL(newSize.cx) * y;
-                        // Careful of overflow (should be ok, views don't tend to be bigger than 256):
-                        uint8_t *pLineSrc = pBits + CX_ACTUAL(cel.size.cx) * (y * cel.size.cy / newSize.cy);
-                        for (int x = 0; x < newSize.cx; x++)
-                        {
-                            *(pLineDest + x) = *(pLineSrc + x * cel.size.cx / newSize.cx);
-                        }
-                    }
+                    StretchCelBits(pBits, cel.size, CX_ACTUAL(cel.size.cx), pBitsNew, newSize, CX_ACTUAL(newSize.cx));
                 }
                 else
                 {
@@ -116,7 +108,7 @@ void ReallocBits(
                         }
                     } // Otherwise we anchor on the top left.
                     uint8_t *pDest = (dy > 0) ? (pBitsNew + dy * CX_ACTUAL(newSize.cx)) : pBitsNew;
-                    uint8_t *pSrc = (dy < 0) ? (pBits + (-dy) * CX_ACTUAL(cel.size.cx)) : pBits;
+                    const uint8_t *pSrc = (dy < 0) ? (pBits + (-dy) * CX_ACTUAL(cel.size.cx)) : pBits;
                     for (int y = 0; y < yEnd; y++)
                     {
                         CopyMemory(pDest + y * CX_ACTUAL(newSize.cx) + xDestOffset,
@@ -366,24 +358,25 @@ void CopyMirrored(
     Cel &cel,
     const Cel &celOrig)
 {
+    // Let go of these first, or writing to our bits would copy them.
+    cel.MirroredFrom = sci::shared_array<uint8_t>();
+    cel.MirroredBits = sci::shared_array<uint8_t>();
+
     // And now the bits
-    int cxActual = CX_ACTUAL(cel.size.cx);
-    const uint8_t *pSrcBits = &celOrig.Data[0];
-    uint8_t *pBits = &cel.Data[0];
-    // Copy them over in reverse order
-    for (int y = 0; y < celOrig.size.cy; y++)
-    {
-        // Start the original at the beginning of the line
-        const uint8_t *pLineOrig = pSrcBits + (y * cxActual);
-        // ...and the mirror at the end.
-        uint8_t *pLineMirror = pBits + (y * cxActual) + (celOrig.size.cx - 1);
-        for (int x = 0; x < celOrig.size.cx; x++)
-        {
-            *pLineMirror = *pLineOrig;
-            ++pLineOrig;
-            --pLineMirror;
-        }
-    }
+    MirrorCelBits(&celOrig.Data[0], &cel.Data[0], celOrig.size, CX_ACTUAL(cel.size.cx));
+
+    cel.MirroredFrom = celOrig.Data;
+    cel.MirroredBits = cel.Data;
+}
+
+// True if celMirror's bits were mirrored from celOrig's current bits, and haven't been touched since.
+bool IsUpToDateMirror(const Cel &celMirror, const Cel &celOrig)
+{
+    return celOrig.Data.data() &&
+        (celMirror.MirroredFrom.data() == celOrig.Data.data()) &&
+        (celMirror.MirroredBits.data() == celMirror.Data.data()) &&
+        (celMirror.size == celOrig.size) &&
+        (celMirror.Stride32 == celOrig.Stride32);
 }
 
 void CopyMirrored(
@@ -412,16 +405,21 @@ void SyncCelMirrorState(Cel &celMirror, const Cel &celOrig)
     celMirror.placement.x = -celOrig.placement.x; // Note that we invert x here!  It's a mirror!
     celMirror.placement.y = celOrig.placement.y;
 
-    ReallocBits(celMirror, celOrig.size, false, false, false, 0, RasterResizeFlags::Normal);
-    CopyMirrored(celMirror, celOrig);
+    if (!IsUpToDateMirror(celMirror, celOrig))
+    {
+        ReallocBits(celMirror, celOrig.size, false, false, false, 0, RasterResizeFlags::Normal);
+        CopyMirrored(celMirror, celOrig);
+    }
 }
 
 const uint8_t UpdateFromMirror = 0xff;
 
 RasterChange MirrorLoopFrom(Loop &loop, uint8_t nOriginal, const Loop &orig)
 {
-    // Reallocate all cels.
-    loop.Cels.clear();
+    // Reallocate all cels, but hang onto the old ones: any that are still mirrors of an original cel can be
+    // reused instead of mirroring the bits again.
+    std::vector<Cel> oldCels;
+    oldCels.swap(loop.Cels);
     if (nOriginal != UpdateFromMirror)
     {
         loop.MirrorOf = nOriginal;
@@ -432,6 +430,12 @@ RasterChange MirrorLoopFrom(Loop &loop, uint8_t nOriginal, const Loop &orig)
         // Make new empty cels, and for each one, do a "sync mirror state" if the original.
         loop.Cels.push_back(Cel());
         assert(loop.Cels.size() == (i + 1));
+        auto itOld = std::find_if(oldCels.begin(), oldCels.end(),
+            [&](const Cel &oldCel) { return IsUpToDateMirror(oldCel, orig.Cels[i]); });
+        if (itOld != oldCels.end())
+        {
+            loop.Cels[i] = *itOld;
+        }
         SyncCelMirrorState(loop.Cels[i], orig.Cels[i]);
     }
     return RasterChange(RasterChangeHint::NewView);
@@ -700,18 +704,6 @@ RasterChange SetGroupSize(RasterComponent &raster, int cCels, CelIndex *rgdwInde
 
 #define TWOPI 6.283184
 
-void TransformRotate(double xOrigSource, double yOrigSource, double xOrigDest, double yOrigDest, double sinTheta, double cosTheta, int &x, int &y)
-{
-    double xOut = x - xOrigSource + 0.51; // I don't use 0.5 because that would be "unstable" when rounding at the end.
-    double yOut = y - yOrigSource + 0.51;
-    double xOut2 = xOut * cosTheta - yOut * sinTheta;
-    double yOut2 = xOut * sinTheta + yOut * cosTheta;
-    xOut2 += (double)xOrigDest - 0.51;
-    yOut2 += (double)yOrigDest - 0.51;
-    x = (int)round(xOut2);
-    y = (int)round(yOut2);
-}
-
 void TransformRotateMinMax(double xOrigSource, double yOrigSource, double xOrigDest, double yOrigDest, double sinTheta, double cosTheta, int x, int y, int &xMin, int &yMin, int &xMax, int &yMax)
 {
     TransformRotate(0, 0, 0, 0, sinTheta, cosTheta, x, y);
@@ -753,27 +745,7 @@ RasterChange RotateGroup(RasterComponent &raster, int cCels, CelIndex *rgdwIndex
 
         // Now invert the transformation, and copy the bits over.
         sinTheta = -sinTheta;
-        uint8_t *dataDest = &cel.Data[0];
-        const uint8_t *dataSource = &celOld.Data[0];
-        double xOrigSource = (double)celOld.size.cx * 0.5;
-        double yOrigSource = (double)celOld.size.cy * 0.5;
-        double xOrigDest = (double)cel.size.cx * 0.5;
-        double yOrigDest = (double)cel.size.cy * 0.5;
-        for (int yDest = 0; yDest < cy; yDest++)
-        {
-            for (int xDest = 0; xDest < cx; xDest++)
-            {
-                int xSource = xDest;
-                int ySource = yDest;
-                TransformRotate(xOrigDest, yOrigDest, xOrigSource, yOrigSource,sinTheta, cosTheta, xSource, ySource);
-                uint8_t color = celOld.TransparentColor;
-                if ((xSource >= 0) && (xSource < celOld.size.cx) && (ySource >= 0) && (ySource < celOld.size.cy))
-                {
-                    color = *(dataSource + ySource * celOld.GetStride() + xSource);
-                }
-                *(dataDest + yDest * cel.GetStride() + xDest) = color;
-            }
-        }
+        RotateCelBits(celOld.Data.data(), celOld.size, celOld.GetStride(), &cel.Data[0], cel.size, cel.GetStride(), sinTheta, cosTheta, celOld.TransparentColor);
         UpdateMirrors(raster, rgdwIndex[i]);
     }
     return (cCels > 1) ? RasterChange(RasterChangeHint::Loop) : RasterChange(RasterChangeHint::Cel, rgdwIndex[0]);
@@ -16,7 +16,7 @@
 #include "Codec.h"
 #include "CodecAlt.h"
 #include <errno.h>
-#include "crc.h"
+#include "ContentHash.h"
 #include "ResourceBlob.h"
 #include "GameFolderHelper.h"
 #include <atomic>
@@ -660,24 +660,22 @@ HRESULT ResourceBlob::SaveToHandle(HANDLE hFile, bool fNoHeader, DWORD *pcbWritt
     return hr;
 }
 
-std::atomic<int> g_nextUniqueId = 0;
-
-int ResourceBlob::GetChecksum() const
+uint64_t ResourceBlob::GetChecksum() const
 {
     if (!_fComputedChecksum)
     {
-        size_t size = _pData.size();
-        if (header.Version.IsMapAppend())
+        // This is fast enough (several GB/s) to do for every resource we load.
+        if (!_pDataCompressed.empty())
         {
-            _iChecksum = (size > 0) ? crcFast(&_pData[0], _pData.size()) : 0;
+            // Compressed blobs keep their compressed bits whether or not decompression was delayed, so hash
+            // those (and the fields that determine how they decompress). That way enumerating with
+            // CalculateRecency doesn't force every delayed blob to be decompressed.
+            uint64_t seed = ((uint64_t)header.CompressionMethod << 48) | ((uint64_t)header.Type << 32) | header.cbDecompressed;
+            _iChecksum = ComputeContentHash(&_pDataCompressed[0], _pDataCompressed.size(), seed);
         }
         else
         {
-            // Testing out just using an incrementing id instead of calculating the hash. crc is super slow
-            // for big resources. The "checksum" is used for determining if a resource is "most recent", for blob id
-            // for background threads. What else?
-            // There are issues with doing this... so for SCI0 (above) we'll still calculate the hash.
-            _iChecksum = g_nextUniqueId.fetch_add(1);
+            _iChecksum = ComputeContentHash(_pData.empty() ? nullptr : &_pData[0], _pData.size());
         }
         _fComputedChecksum = true;
     }
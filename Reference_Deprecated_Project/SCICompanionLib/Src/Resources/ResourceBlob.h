@@ -356,7 +356,7 @@ public:
         return header.Base36Number;
     }
     ResourceType GetType() const override { return header.Type; }
-    int GetChecksum() const override;
+    uint64_t GetChecksum() const override;
 
     HRESULT SaveToFile(const std::string &strFileName) const;
     int GetEncoding() const { return header.CompressionMethod; }
@@ -419,5 +419,5 @@ private:
     // To distinguish 0x65535 from -1, we can use _hasNumber
     bool _hasNumber;
     mutable bool _fComputedChecksum;
-    mutable int _iChecksum;
+    mutable uint64_t _iChecksum;
 };
@@ -80,6 +80,9 @@ public:
 
         ResourceHeaderAgnostic GetResourceHeader() const;
 
+        // The map entry for the current resource. Unlike GetResourceHeader, this doesn't touch the volume file.
+        const ResourceMapEntryAgnostic &GetMapEntry() const { return _currentEntry; }
+
         ResourceIterator& operator++();
         ResourceIterator operator++(int);
 
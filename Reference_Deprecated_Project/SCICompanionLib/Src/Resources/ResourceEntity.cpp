@@ -87,10 +87,29 @@ std::unique_ptr<ResourceEntity> ResourceEntity::Clone() const
     pClone->Base36Number = Base36Number;
     pClone->SourceFlags = SourceFlags;
 
+    pClone->components = components;
+    return pClone;
+}
+
+size_t ResourceEntity::EstimateSize(const ResourceEntity *previous) const
+{
+    size_t size = sizeof(*this);
     for (auto &pair : components)
     {
-        std::unique_ptr<ResourceComponent> pCopy(pair.second->Clone());
-        pClone->components[pair.first] = std::move(pCopy);
+        const ResourceComponent *previousComponent = nullptr;
+        if (previous)
+        {
+            auto it = previous->components.find(pair.first);
+            if (it != previous->components.end())
+            {
+                if (it->second == pair.second)
+                {
+                    continue; // Shared
+                }
+                previousComponent = it->second.get();
+            }
+        }
+        size += pair.second->EstimateSize(previousComponent);
     }
-    return pClone;
+    return size;
 }
\ No newline at end of file
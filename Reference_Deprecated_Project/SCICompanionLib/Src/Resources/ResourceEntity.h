@@ -61,7 +61,11 @@ public:
     // We could trap exceptions and then create the default resource instead?
     // Or is the caller responsible?
     HRESULT InitFromResource(const ResourceBlob *prd);
+    // The clone shares its components with this one. A component is only copied when it is
+    // obtained through one of the non-const accessors while it's still shared.
     std::unique_ptr<ResourceEntity> Clone() const;
+    // Roughly how many bytes this holds that aren't shared with previous (which may be null).
+    size_t EstimateSize(const ResourceEntity *previous) const;
     
     int ResourceNumber;
     int PackageNumber;
@@ -88,6 +92,7 @@ public:
         auto result = components.find(std::type_index(r2));
         if (result != components.end())
         {
+            _Unshare(result->second);
             return static_cast<_T&>(*(result->second));
         }
         throw std::exception("No component of this type exists");
@@ -100,6 +105,7 @@ public:
         auto result = components.find(std::type_index(r2));
         if (result != components.end())
         {
+            _Unshare(result->second);
             return static_cast<_T*>(result->second.get());
         }
         return nullptr;
@@ -120,7 +126,7 @@ public:
     template<typename _T>
     void AddComponent(std::unique_ptr<_T> pComponent)
     {
-        std::unique_ptr<ResourceComponent> pTemp(pComponent.release());
+        std::shared_ptr<ResourceComponent> pTemp(pComponent.release());
         const std::type_info& r2 = typeid(_T);
         components[std::type_index(r2)] = std::move(pTemp);
     }
@@ -153,5 +159,14 @@ public:
     ResourceType GetType() const { return Traits.Type; }
 
 private:
-    std::unordered_map<std::type_index, std::unique_ptr<ResourceComponent>> components;
+    static void _Unshare(std::shared_ptr<ResourceComponent> &component)
+    {
+        if (component.use_count() != 1)
+        {
+            component.reset(component->Clone());
+        }
+    }
+
+    // Components may be shared with clones of this resource.
+    std::unordered_map<std::type_index, std::shared_ptr<ResourceComponent>> components;
 };
@@ -38,6 +38,7 @@
 #include "ResourceMapOperations.h"
 #include "MessageHeaderFile.h"
 #include "MessageSource.h"
+#include "MessageDatabase.h"
 #include "format.h"
 #include "ResourceMapEvents.h"
 #include "DebuggerThread.h"
@@ -46,6 +47,7 @@
 #include "ResourceBlob.h"
 #include "DependencyTracker.h"
 #include "VersionDetectionHelper.h"
+#include "GameSnapshot.h"
 
 using namespace std;
 
@@ -214,8 +216,8 @@ CResourceMap::CResourceMap(ISCIAppServices *appServices, ResourceRecency *resour
     _gameFolderHelper.Language = LangSyntaxUnknown;
     _gameFolderHelper.Version = sciVersion0;    // By default
     _deferredResources.reserve(300);            // So we don't need to resize much it when adding
-    _emptyPalette = std::make_unique<PaletteComponent>();
-    memset(_emptyPalette->Colors, 0, sizeof(_emptyPalette->Colors));
+    _snapshotHelper = _gameFolderHelper;
+    _snapshotGeneration = 0;
 }
 
 CResourceMap::~CResourceMap()
@@ -387,6 +389,8 @@ void CResourceMap::AbortPostBuildThread()
 
 void CResourceMap::PokeResourceMapReloaded()
 {
+    _InvalidateSnapshot();
+    _messageDatabase.reset(nullptr);
     // Refresh everything.
     for_each(_syncs.begin(), _syncs.end(), bind2nd(mem_fun(&IResourceMapEvents::OnResourceMapReloaded), false));
 }
@@ -516,12 +520,19 @@ HRESULT CResourceMap::AppendResource(const ResourceBlob &resource)
 
         if (SUCCEEDED(hr))
         {
+            _InvalidateSnapshot();
+
             if (resource.GetType() == ResourceType::Script)
             {
                 // We'll need to re-gen this:
                 _globalCompiledScriptLookups.reset(nullptr);
             }
 
+            if (resource.GetType() == ResourceType::Message)
+            {
+                _UpdateMessageDatabase(resource.GetNumber());
+            }
+
             if (resource.GetType() == ResourceType::Palette)
             {
                 _paletteListNeedsUpdate = true;
@@ -559,7 +570,7 @@ HRESULT CResourceMap::AppendResource(const ResourceBlob &resource)
     return hr;
 }
 
-bool CResourceMap::AppendResource(const ResourceEntity &resource, int *pChecksum)
+bool CResourceMap::AppendResource(const ResourceEntity &resource, uint64_t *pChecksum)
 {
     return AppendResource(resource, resource.PackageNumber, resource.ResourceNumber, "", resource.Base36Number, pChecksum);
 }
@@ -582,7 +593,7 @@ bool ValidateResourceSize(const SCIVersion &version, DWORD cb, ResourceType type
     return fRet;
 }
 
-bool CResourceMap::AppendResource(const ResourceEntity &resource, int packageNumber, int resourceNumber, const std::string &name, uint32_t base36Number, int *pChecksum)
+bool CResourceMap::AppendResource(const ResourceEntity &resource, int packageNumber, int resourceNumber, const std::string &name, uint32_t base36Number, uint64_t *pChecksum)
 {
     bool success = false;
     if (resource.PerformChecks())
@@ -666,6 +677,7 @@ void CResourceMap::NotifyToRegenerateImages()
 
 void CResourceMap::NotifyToReloadResourceType(ResourceType iType)
 {
+    _InvalidateSnapshot();
 	for_each(_syncs.begin(), _syncs.end(), bind2nd(mem_fun(&IResourceMapEvents::OnResourceTypeReloaded), iType));
     if (iType == ResourceType::Palette)
     {
@@ -677,6 +689,11 @@ void CResourceMap::NotifyToReloadResourceType(ResourceType iType)
         // We'll need to re-gen this:
         _globalCompiledScriptLookups.reset(nullptr);
     }
+
+    if (iType == ResourceType::Message)
+    {
+        _messageDatabase.reset(nullptr);
+    }
 }
 
 //
@@ -719,6 +736,8 @@ void CResourceMap::DeleteResource(const ResourceBlob *pData)
         AfxMessageBox(e.what(), MB_OK | MB_ICONWARNING);
     }
 
+    _InvalidateSnapshot();
+
     // Call our syncs, so they update.
     if (pData->GetType() == ResourceType::Script)
     {
@@ -726,6 +745,12 @@ void CResourceMap::DeleteResource(const ResourceBlob *pData)
         _globalCompiledScriptLookups.reset(nullptr);
     }
 
+    if (pData->GetType() == ResourceType::Message)
+    {
+        // There may be an older version that takes its place.
+        _UpdateMessageDatabase(pData->GetNumber());
+    }
+
     for_each(_syncs.begin(), _syncs.end(), bind2nd(mem_fun(&IResourceMapEvents::OnResourceDeleted), pData));
     if (pData->GetType() == ResourceType::Palette)
     {
@@ -923,6 +948,49 @@ const SCIVersion &CResourceMap::GetSCIVersion() const
 void CResourceMap::SetVersion(const SCIVersion &version)
 {
     _gameFolderHelper.Version = version;
+    _InvalidateSnapshot();
+}
+
+std::shared_ptr<const GameSnapshot> CResourceMap::GetSnapshot()
+{
+    GameFolderHelper helper;
+    uint32_t generation;
+    {
+        std::lock_guard<std::mutex> lock(_snapshotMutex);
+        if (_snapshot)
+        {
+            return _snapshot;
+        }
+        helper = _snapshotHelper;
+        generation = _snapshotGeneration;
+    }
+
+    // Build it without holding the lock, since this reads a bunch of resources. If things changed in the
+    // meantime, the caller still gets a consistent (if slightly out of date) view, but we don't keep it.
+    std::shared_ptr<const GameSnapshot> snapshot = std::make_shared<GameSnapshot>(helper, generation);
+    std::lock_guard<std::mutex> lock(_snapshotMutex);
+    if (generation == _snapshotGeneration)
+    {
+        // Another thread may have beaten us to it.
+        if (!_snapshot)
+        {
+            _snapshot = snapshot;
+        }
+        return _snapshot;
+    }
+    return snapshot;
+}
+
+//
+// Called on the UI thread whenever something that goes into a snapshot changes. The next
+// call to GetSnapshot builds a new one.
+//
+void CResourceMap::_InvalidateSnapshot()
+{
+    std::lock_guard<std::mutex> lock(_snapshotMutex);
+    _snapshot.reset();
+    _snapshotHelper = _gameFolderHelper;
+    _snapshotGeneration++;
 }
 
 //
@@ -1025,28 +1093,12 @@ std::unique_ptr<PaletteComponent> CResourceMap::GetPalette(int fallbackPaletteNu
 std::unique_ptr<PaletteComponent> CResourceMap::GetMergedPalette(const ResourceEntity &resource, int fallbackPaletteNumber)
 {
     assert((_gameFolderHelper.Version.ViewFormat != ViewFormat::EGA) || (_gameFolderHelper.Version.PicFormat != PicFormat::EGA));
-    std::unique_ptr<PaletteComponent> paletteReturn;
-    const PaletteComponent *paletteEmbedded = resource.TryGetComponent<PaletteComponent>();
-    if (!paletteEmbedded)
-    {
-        paletteEmbedded = _emptyPalette.get();
-    }
-
-    // Clone the embedded palette first - REVIEW: make_unique arg forwarding doesn't work with copy constructor. No object copy happens.
-    paletteReturn = make_unique<PaletteComponent>(*paletteEmbedded);
     if (fallbackPaletteNumber == 999)
     {
-        paletteReturn->MergeFromOther(GetPalette999());
-    }
-    else
-    {
-        std::unique_ptr<ResourceEntity> paletteFallback = CreateResourceFromNumber(ResourceType::Palette, fallbackPaletteNumber);
-        if (paletteFallback)
-        {
-            paletteReturn->MergeFromOther(paletteFallback->TryGetComponent<PaletteComponent>());
-        }
+        return CreateMergedPalette(resource, GetPalette999());
     }
-    return paletteReturn;
+    std::unique_ptr<ResourceEntity> paletteFallback = CreateResourceFromNumber(ResourceType::Palette, fallbackPaletteNumber);
+    return CreateMergedPalette(resource, paletteFallback ? paletteFallback->TryGetComponent<PaletteComponent>() : nullptr);
 }
 
 void CResourceMap::SaveAudioMap65535(const AudioMapComponent &newAudioMap, int mapContext)
@@ -1137,6 +1189,7 @@ ResourceEntity *CResourceMap::GetVocabResourceToEdit()
 void CResourceMap::ClearVocab000()
 {
     _pVocab000.reset(nullptr);
+    _InvalidateSnapshot();
 }
 
 HRESULT GetFilePositionHelper(HANDLE hFile, DWORD *pdwPos)
@@ -1249,6 +1302,31 @@ MessageSource *CResourceMap::GetTalkersMessageSource(bool reload)
     return _talkersHeaderFile->GetMessageSource();
 }
 
+MessageDatabase &CResourceMap::GetMessageDatabase()
+{
+    if (!_messageDatabase)
+    {
+        _messageDatabase = make_unique<MessageDatabase>();
+        _messageDatabase->Load(_gameFolderHelper, std::thread::hardware_concurrency());
+    }
+    return *_messageDatabase;
+}
+
+void CResourceMap::_UpdateMessageDatabase(int resourceNumber)
+{
+    // Nothing to do if no one has asked for it yet.
+    if (_messageDatabase)
+    {
+        std::unique_ptr<ResourceEntity> resource;
+        std::unique_ptr<ResourceBlob> blob = _gameFolderHelper.MostRecentResource(ResourceType::Message, resourceNumber, ResourceEnumFlags::AddInDefaultEnumFlags);
+        if (blob)
+        {
+            resource = CreateResourceFromResourceData(*blob);
+        }
+        _messageDatabase->Update(resourceNumber, move(resource));
+    }
+}
+
 RunLogic &CResourceMap::GetRunLogic()
 {
     return *_runLogic;
@@ -1268,6 +1346,7 @@ void CResourceMap::SetGameFolder(const string &gameFolder)
     _gameFolderHelper.Language = LangSyntaxUnknown;
     _talkersHeaderFile.reset(nullptr);
     _verbsHeaderFile.reset(nullptr);
+    _messageDatabase.reset(nullptr);
     if (!gameFolder.empty())
     {
         try
@@ -1277,6 +1356,8 @@ void CResourceMap::SetGameFolder(const string &gameFolder)
             // We get here when we close documents.
             _SniffSCIVersion();
 
+            _InvalidateSnapshot();
+
             // Send initial load notification
             for_each(_syncs.begin(), _syncs.end(), bind2nd(mem_fun(&IResourceMapEvents::OnResourceMapReloaded), true));
 
@@ -1286,9 +1367,14 @@ void CResourceMap::SetGameFolder(const string &gameFolder)
         {
             AfxMessageBox(fmt::format("Unable to open resource map: {0}", e.what()).c_str(), MB_OK | MB_ICONWARNING);
             _gameFolderHelper.GameFolder = "";
+            _InvalidateSnapshot();
             AfxThrowUserException();
         }
     }
+    else
+    {
+        _InvalidateSnapshot();
+    }
 
     AbortDebuggerThread();
 
@@ -1391,4 +1477,5 @@ void CResourceMap::SetGameLanguage(LangSyntax lang)
     Helper().SetIniString(GameSection, LanguageKey, (lang == LangSyntaxSCI) ? LanguageValueSCI : LanguageValueStudio);
     _gameFolderHelper.Language = lang;
     _SniffGameLanguage();
+    _InvalidateSnapshot();
 }
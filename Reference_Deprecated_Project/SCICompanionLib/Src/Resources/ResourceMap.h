@@ -25,6 +25,7 @@ struct AudioMapComponent;
 struct PaletteComponent;
 class MessageSource;
 class MessageHeaderFile;
+class MessageDatabase;
 class AppState;
 
 // FWD declaration
@@ -34,10 +35,12 @@ class ResourceRecency;
 class ResourceEntity;
 class GlobalCompiledScriptLookups;
 class IResourceMapEvents;
+class GameSnapshot;
 enum class ResourceSaveLocation : uint16_t;
 
 //
-// REVIEW: CResourceMap needs to be protected with a critical section
+// REVIEW: CResourceMap needs to be protected with a critical section. In the meantime, background
+// threads should only use GetSnapshot.
 //
 
 class ISCIAppServices
@@ -66,8 +69,8 @@ public:
     HRESULT AppendResourceAskForNumber(ResourceBlob &resource, bool warnOnOverwrite);
     void AppendResourceAskForNumber(ResourceEntity &resource);
     void AppendResourceAskForNumber(ResourceEntity &resource, const std::string &name, bool warnOnOverwrite = false);
-    bool AppendResource(const ResourceEntity &resource, int *pChecksum = nullptr);
-    bool AppendResource(const ResourceEntity &resource, int packageNumber, int resourceNumber, const std::string &name, uint32_t base36Header = NoBase36, int *pChecksum = nullptr);
+    bool AppendResource(const ResourceEntity &resource, uint64_t *pChecksum = nullptr);
+    bool AppendResource(const ResourceEntity &resource, int packageNumber, int resourceNumber, const std::string &name, uint32_t base36Header = NoBase36, uint64_t *pChecksum = nullptr);
 
     int SuggestResourceNumber(ResourceType type);
     void AssignName(const ResourceBlob &resource);
@@ -124,9 +127,16 @@ public:
 
     MessageSource *GetVerbsMessageSource(bool reload = false);
     MessageSource *GetTalkersMessageSource(bool reload = false);
+    // All the game's message resources, indexed. This is built on first use, and kept up to date as
+    // message resources are saved or deleted.
+    MessageDatabase &GetMessageDatabase();
 
     bool IsResourceCompatible(const ResourceBlob &resource);
 
+    // An immutable view of the game (map index, version, palette 999, vocab 000, selector and kernel names).
+    // This can be called from any thread. It's rebuilt on demand after resources change.
+    std::shared_ptr<const GameSnapshot> GetSnapshot();
+
     void StartDebuggerThread(int optionalResourceNumber);
     void AbortDebuggerThread();
 
@@ -139,6 +149,8 @@ public:
 private:
     void _SniffGameLanguage();
     void _SniffSCIVersion();
+    void _InvalidateSnapshot();
+    void _UpdateMessageDatabase(int resourceNumber);
 
     void BeginDeferAppend();
     HRESULT EndDeferAppend();
@@ -157,12 +169,12 @@ private:
     // Useful resources to cache
     std::unique_ptr<ResourceEntity> _pVocab000;
     std::unique_ptr<ResourceEntity> _pPalette999;
-    std::unique_ptr<PaletteComponent> _emptyPalette;
     std::vector<int> _paletteList;
     bool _paletteListNeedsUpdate;
 
     std::unique_ptr<MessageHeaderFile> _verbsHeaderFile;
     std::unique_ptr<MessageHeaderFile> _talkersHeaderFile;
+    std::unique_ptr<MessageDatabase> _messageDatabase;
 
 
     std::unique_ptr<GlobalCompiledScriptLookups> _globalCompiledScriptLookups;
@@ -181,6 +193,12 @@ private:
     std::shared_ptr<PostBuildThread> _postBuildThread;
 
     std::unique_ptr<RunLogic> _runLogic;
+
+    // Guards the snapshot members, which are accessed from background threads.
+    std::mutex _snapshotMutex;
+    std::shared_ptr<const GameSnapshot> _snapshot;
+    GameFolderHelper _snapshotHelper;               // What the next snapshot will be built from.
+    uint32_t _snapshotGeneration;
 };
 
 //
@@ -34,7 +34,7 @@ bool contains(const _T &container, const _K &key)
 
 void ResourceRecency::AddResourceToRecency(const IResourceIdentifier *pData, BOOL fAddToEnd)
 {
-    _idJustAdded = -1;
+    _idJustAdded = NoChecksum;
     uint64_t iKey = _GetLookupKey(pData);
 
     ResourceIdArray *pidList;
@@ -17,14 +17,15 @@
 // Contains information regarding which resources are the "current ones"
 //
 
+#include "ResourceUtil.h"
+
 // fwd decl
 class ResourceBlob;
-class IResourceIdentifier;
 
 class ResourceRecency
 {
 public:
-    ResourceRecency() { _idJustAdded = -1; }
+    ResourceRecency() { _idJustAdded = NoChecksum; }
     ~ResourceRecency() { ClearAllResourceTypes(); } // Clean up
     //
     // We added a new resource to the view.
@@ -59,11 +60,11 @@ private:
     // A map for each of the n different resource types.
     // Each map contains values which are arrays of the unique resource ids
     //
-    typedef std::vector<int> ResourceIdArray;
+    typedef std::vector<uint64_t> ResourceIdArray;
     // hmm... each entry in this array has a bunch of resource keys (combo of number/package) that maps to lists of
     // resource ids.
 	typedef std::unordered_map<uint64_t, ResourceIdArray*> RecencyMap;
     RecencyMap _resourceRecency[NumResourceTypes];
 
-    int _idJustAdded;
+    uint64_t _idJustAdded;
 };
\ No newline at end of file
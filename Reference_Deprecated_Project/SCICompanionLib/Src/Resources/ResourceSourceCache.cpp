@@ -0,0 +1,168 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "ResourceSourceCache.h"
+
+using namespace std;
+
+bool operator==(const FileStamp &one, const FileStamp &two)
+{
+    return (one.Exists == two.Exists) &&
+        (one.Size == two.Size) &&
+        (CompareFileTime(&one.LastWrite, &two.LastWrite) == 0);
+}
+
+// This works for folders too. Their last write time changes when files are added, removed or renamed.
+FileStamp GetFileStamp(const std::string &path)
+{
+    FileStamp stamp = {};
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (GetFileAttributesEx(path.c_str(), GetFileExInfoStandard, &data))
+    {
+        stamp.Exists = true;
+        stamp.Size = ((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow;
+        stamp.LastWrite = data.ftLastWriteTime;
+    }
+    return stamp;
+}
+
+namespace
+{
+    template<typename T>
+    class StampedCache
+    {
+    public:
+        shared_ptr<const T> Get(const string &key, const string &path, function<void(T &)> create)
+        {
+            FileStamp stamp = GetFileStamp(path);
+            {
+                lock_guard<mutex> lock(_mutex);
+                auto it = _items.find(key);
+                if ((it != _items.end()) && (it->second.Stamp == stamp))
+                {
+                    return it->second.Value;
+                }
+            }
+
+            // Create it without holding the lock. If the file changes while we're reading it, the stamp
+            // we took beforehand won't match next time, and it will just be read again.
+            shared_ptr<T> value = make_shared<T>();
+            create(*value);
+            lock_guard<mutex> lock(_mutex);
+            Item &item = _items[key];
+            item.Path = path;
+            item.Stamp = stamp;
+            item.Value = value;
+            return value;
+        }
+
+        void Invalidate(const string &path)
+        {
+            lock_guard<mutex> lock(_mutex);
+            for (auto it = _items.begin(); it != _items.end(); )
+            {
+                if (0 == _stricmp(it->second.Path.c_str(), path.c_str()))
+                {
+                    it = _items.erase(it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+
+    private:
+        struct Item
+        {
+            string Path;
+            FileStamp Stamp;
+            shared_ptr<const T> Value;
+        };
+
+        mutex _mutex;
+        unordered_map<string, Item> _items;
+    };
+
+    StampedCache<MapEntries> g_mapEntriesCache;
+    StampedCache<vector<PatchFileEntry>> g_patchFilesCache;
+
+    void _ListPatchFiles(const string &folder, vector<PatchFileEntry> &patchFiles)
+    {
+        // Anything that could be a patch file of any type. Sources narrow this down to the types they want.
+        string fileSpec;
+        for (const TCHAR *typeSpec : g_szResourceSpecByType)
+        {
+            if (!fileSpec.empty())
+            {
+                fileSpec += ";";
+            }
+            fileSpec += typeSpec;
+        }
+
+        WIN32_FIND_DATA findData;
+        HANDLE hFind = FindFirstFile((folder + "\\*.*").c_str(), &findData);
+        if (hFind != INVALID_HANDLE_VALUE)
+        {
+            do
+            {
+                if (PathMatchSpec(findData.cFileName, fileSpec.c_str()))
+                {
+                    int number = ResourceNumberFromFileName(findData.cFileName);
+                    if (number != -1)
+                    {
+                        // We need a valid number.
+                        // We do need to peek open the file right now.
+                        ScopedHandle patchFile;
+                        string fullPath = folder + "\\" + findData.cFileName;
+                        patchFile.hFile = CreateFile(fullPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                        if (patchFile.hFile != INVALID_HANDLE_VALUE)
+                        {
+                            // Read the first two bytes. The first is the type, the next is the offset.
+                            uint8_t word[2];
+                            DWORD cbRead;
+                            if (ReadFile(patchFile.hFile, &word, sizeof(word), &cbRead, nullptr) && (cbRead == sizeof(word)))
+                            {
+                                PatchFileEntry patchFileEntry;
+                                patchFileEntry.FileName = findData.cFileName;
+                                patchFileEntry.Type = (ResourceType)(word[0] & 0x7f);
+                                patchFileEntry.Number = (uint16_t)number;
+                                patchFileEntry.Offset = GetResourceOffsetInFile(word[1]) + 2;    // For the word we just read.
+                                patchFiles.push_back(patchFileEntry);
+                            }
+                        }
+                    }
+                }
+            } while (FindNextFile(hFind, &findData));
+            FindClose(hFind);
+        }
+    }
+}
+
+shared_ptr<const MapEntries> GetCachedMapEntries(const string &mapFilename, const string &mapFormat, function<void(MapEntries &)> parseMap)
+{
+    return g_mapEntriesCache.Get(mapFilename + "|" + mapFormat, mapFilename, parseMap);
+}
+
+shared_ptr<const vector<PatchFileEntry>> GetCachedPatchFiles(const string &folder)
+{
+    return g_patchFilesCache.Get(folder, folder,
+        [&folder](vector<PatchFileEntry> &patchFiles) { _ListPatchFiles(folder, patchFiles); });
+}
+
+void InvalidateResourceSourceCache(const string &fileOrFolder)
+{
+    g_mapEntriesCache.Invalidate(fileOrFolder);
+    g_patchFilesCache.Invalidate(fileOrFolder);
+}
@@ -0,0 +1,57 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+#include "ResourceBlob.h"
+
+//
+// Caches what the resource sources learn from the game folder, so that enumerating resources over and
+// over doesn't need to keep re-reading resource.map or scanning the folder for patch files.
+//
+// Before a cached item is handed out, it's checked against the size and last write time of the file
+// (or folder) it came from. Resource sources also invalidate things explicitly after they write files.
+// Cached items are immutable, so they can be shared between threads. A resource source holds onto the
+// ones it got for the duration of an enumeration.
+//
+
+// A file in the game folder that looks like a patch file of a known resource type.
+struct PatchFileEntry
+{
+    std::string FileName;
+    ResourceType Type;
+    uint16_t Number;
+    uint32_t Offset;        // Where the resource data starts in the file
+};
+
+typedef std::vector<ResourceMapEntryAgnostic> MapEntries;
+
+// Enough to tell if a file has changed.
+struct FileStamp
+{
+    bool Exists;
+    uint64_t Size;
+    FILETIME LastWrite;
+};
+bool operator==(const FileStamp &one, const FileStamp &two);
+FileStamp GetFileStamp(const std::string &path);
+
+// The entries in mapFilename, which parseMap fills in if they aren't cached. The same map may be parsed
+// differently depending on the SCI version, so mapFormat distinguishes these.
+std::shared_ptr<const MapEntries> GetCachedMapEntries(const std::string &mapFilename, const std::string &mapFormat, std::function<void(MapEntries &)> parseMap);
+
+// The patch files in a folder, in the order FindFirstFile returns them.
+std::shared_ptr<const std::vector<PatchFileEntry>> GetCachedPatchFiles(const std::string &folder);
+
+// Call this after modifying a map file, or adding or removing files in a folder.
+void InvalidateResourceSourceCache(const std::string &fileOrFolder);
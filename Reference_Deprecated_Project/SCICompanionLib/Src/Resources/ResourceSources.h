@@ -14,6 +14,7 @@
 #pragma once
 
 #include "ResourceBlob.h"
+#include "ResourceSourceCache.h"
 
 // This file describes various resource sources and the base classes needed for:
 // (1) resource.map/resource.xxx
@@ -198,6 +199,7 @@ struct FileDescriptorBase
         std::string resmap_name = _GetMapFilename();
         deletefile(resmap_name);
         movefile(_GetMapFilenameBak(), resmap_name);
+        InvalidateResourceSourceCache(resmap_name);
     }
 };
 
@@ -229,7 +231,24 @@ public:
 
     bool ReadNextEntry(ResourceTypeFlags typeFlags, IteratorState &state, ResourceMapEntryAgnostic &entry, std::vector<uint8_t> *optionalRawData) override
     {
-        return NavAndReadNextEntry(typeFlags, GetMapStream(), state, entry, optionalRawData);
+        if (optionalRawData)
+        {
+            // Only the game version dialog wants the raw entries, so those aren't cached.
+            return NavAndReadNextEntry(typeFlags, GetMapStream(), state, entry, optionalRawData);
+        }
+
+        // Otherwise we iterate through the cached map entries. mapStreamOffset is our index into them.
+        const MapEntries &mapEntries = _GetMapEntries();
+        while (state.mapStreamOffset < mapEntries.size())
+        {
+            const ResourceMapEntryAgnostic &mapEntry = mapEntries[state.mapStreamOffset++];
+            if (((int)mapEntry.Type < 32) && IsFlagSet(typeFlags, ResourceTypeToFlag(mapEntry.Type)))
+            {
+                entry = mapEntry;
+                return true;
+            }
+        }
+        return false;
     }
 
     sci::istream GetHeaderAndPositionedStream(const ResourceMapEntryAgnostic &mapEntry, ResourceHeaderAgnostic &headerEntry) override
@@ -272,6 +291,7 @@ public:
         // Otherwise, the enumeration will fail, and the resource map will get cleaned out.
         _map = nullptr;
         _mapStream = nullptr;
+        _mapEntries = nullptr;
         _volumeStreams.clear();
 
         std::unordered_map<int, sci::ostream> volumeStreamWrites;
@@ -514,11 +534,33 @@ protected:
         return *_mapStream;
     }
 
+    const MapEntries &_GetMapEntries()
+    {
+        if (!_mapEntries)
+        {
+            _mapEntries = GetCachedMapEntries(this->_GetMapFilename(), typeid(_TNavigator).name(),
+                [this](MapEntries &mapEntries)
+            {
+                // Use our own stream, rather than the one from GetMapStream, which might have been read off the end already.
+                std::unique_ptr<sci::streamOwner> map = _FileDescriptor::OpenMap();
+                sci::istream mapStream = map->getReader();
+                IteratorState state;
+                ResourceMapEntryAgnostic mapEntry;
+                while (NavAndReadNextEntry(ResourceTypeFlags::All, mapStream, state, mapEntry, nullptr))
+                {
+                    mapEntries.push_back(mapEntry);
+                }
+            });
+        }
+        return *_mapEntries;
+    }
+
 private:
     ResourceHeaderReadWrite _headerReadWrite;
     SCIVersion _version;
 
     std::unique_ptr<sci::streamOwner> _map;
     std::unique_ptr<sci::istream> _mapStream;
+    std::shared_ptr<const MapEntries> _mapEntries;
     std::unordered_map<int, std::unique_ptr<sci::streamOwner>> _volumeStreams;
 };
@@ -17,13 +17,17 @@
 
 class ResourceEntity;
 
+// The checksum of something that doesn't (yet) correspond to resource data.
+const uint64_t NoChecksum = 0xffffffffffffffffULL;
+
 class IResourceIdentifier
 {
 public:
     virtual int GetPackageHint() const = 0;
     virtual int GetNumber() const = 0;
     virtual ResourceType GetType() const = 0;
-    virtual int GetChecksum() const = 0;
+    // A hash of the resource's contents, so it is the same for identical data in any session.
+    virtual uint64_t GetChecksum() const = 0;
     virtual uint32_t GetBase36() const = 0;
 };
 
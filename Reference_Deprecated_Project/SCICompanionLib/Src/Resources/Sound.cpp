@@ -17,6 +17,7 @@
 #include "ResourceEntity.h"
 #include "Audio.h"
 #include "format.h"
+#include <queue>
 
 #pragma comment( lib, "winmm.lib" )
 
@@ -584,58 +585,45 @@ uint16_t SoundComponent::_ReadMidiFileTrack(size_t nTrack, std::istream &midiFil
 // Returns the total ticks
 DWORD CombineSoundEvents(const std::vector<std::vector<SoundEvent> > &channels, std::vector<SoundEvent> &results)
 {
-    // We'll need to store a position for each channel.  Let's initialize them to zero.
-    std::vector<size_t> _channelPos;
-    _channelPos.insert(_channelPos.begin(), channels.size(), 0);
-    // And keep a running count of the time delta for each track.
-    std::vector<DWORD> _channelTimeDelta;
-    _channelTimeDelta.insert(_channelTimeDelta.begin(), channels.size(), 0);
-
-    // And here's our overall time counter.
-    DWORD dwTimeDelta = 0;
-    DWORD dwLastTimeDelta = 0;
+    // This is a k-way merge. The heap holds the absolute time of the next event in each channel that still has events.
+    // Ties are broken by channel index, so that events at the same time are ordered by channel.
+    typedef std::pair<DWORD, size_t> TimeAndChannel;
+    std::priority_queue<TimeAndChannel, std::vector<TimeAndChannel>, std::greater<TimeAndChannel>> nextEvents;
 
-    while (true)
+    // We'll need to store a position for each channel.
+    std::vector<size_t> channelPos(channels.size(), 0);
+    size_t totalEvents = 0;
+    for (size_t i = 0; i < channels.size(); i++)
     {
-        // Find the next event, time-wise
-        DWORD dwClosest = (DWORD)(-1);
-        size_t bestChannel = channels.size(); // out of bounds
-        for (size_t i = 0; i < channels.size(); i++)
+        if (!channels[i].empty())
         {
-            const std::vector<SoundEvent> &channelData = channels[i];
-            if (_channelPos[i] < channelData.size())
-            {
-                // Still events remaining in this track, so it's under consideration.
-                ASSERT((_channelTimeDelta[i] + channelData[_channelPos[i]].wTimeDelta) >= dwTimeDelta);
-                DWORD dwTimeToNextEvent = (_channelTimeDelta[i] + channelData[_channelPos[i]].wTimeDelta) - dwTimeDelta;
-                if (dwTimeToNextEvent < dwClosest)
-                {
-                    bestChannel = i; // This is the best track so far.
-                    dwClosest = dwTimeToNextEvent;
-                }
-            }
+            nextEvents.emplace(channels[i][0].wTimeDelta, i);
+            totalEvents += channels[i].size();
         }
-        if (bestChannel < channels.size())
-        {
-            // Add this event.
-            size_t posInChannel = _channelPos[bestChannel];
-            SoundEvent event = channels[bestChannel][posInChannel];
-            // Now update things.
-            _channelTimeDelta[bestChannel] += event.wTimeDelta;
-            // This is now our new time delta
-            dwTimeDelta = _channelTimeDelta[bestChannel];
-            assert(dwTimeDelta < 0xf0000000);
-            _channelPos[bestChannel]++; // We took one event from this track.
-
-            // Fixup the event time before adding it.
-            assert(dwTimeDelta >= dwLastTimeDelta);
-            event.wTimeDelta = dwTimeDelta - dwLastTimeDelta;
-            results.push_back(event);
-            dwLastTimeDelta = dwTimeDelta;
-        }
-        else
+    }
+    results.reserve(results.size() + totalEvents);
+
+    DWORD dwLastTimeDelta = 0;
+    while (!nextEvents.empty())
+    {
+        DWORD dwTimeDelta = nextEvents.top().first;
+        size_t bestChannel = nextEvents.top().second;
+        nextEvents.pop();
+        assert(dwTimeDelta < 0xf0000000);
+
+        // Add this event, fixing up the event time before adding it.
+        const std::vector<SoundEvent> &channelData = channels[bestChannel];
+        SoundEvent event = channelData[channelPos[bestChannel]];
+        assert(dwTimeDelta >= dwLastTimeDelta);
+        event.wTimeDelta = dwTimeDelta - dwLastTimeDelta;
+        results.push_back(event);
+        dwLastTimeDelta = dwTimeDelta;
+
+        // We took one event from this channel. If there are more, queue up the next one.
+        size_t posInChannel = ++channelPos[bestChannel];
+        if (posInChannel < channelData.size())
         {
-            break; // No more events left.
+            nextEvents.emplace(dwTimeDelta + channelData[posInChannel].wTimeDelta, bestChannel);
         }
     }
     return dwLastTimeDelta;
@@ -1732,8 +1720,10 @@ void ConvertSCI0ToNewFormat(const vector<SoundEvent> &events, SoundComponent &so
         tracksToUsedChannelNumbers[(uint8_t)DeviceType::RolandMT32].insert(9);
     }
 
-    // Construct the channels and put the separated sound events into them
+    // Construct the channels
     map<int, int> channelNumberToId;
+    int channelNumberToIndex[16];
+    std::fill(std::begin(channelNumberToIndex), std::end(channelNumberToIndex), -1);
     for (int channelNumber : usedChannelNumbers)
     {
         sound._allChannels.emplace_back();
@@ -1741,19 +1731,24 @@ void ConvertSCI0ToNewFormat(const vector<SoundEvent> &events, SoundComponent &so
         channel.Id = (int)(sound._allChannels.size() - 1);
         channel.Number = channelNumber;
         channelNumberToId[channel.Number] = channel.Id;
-        DWORD ticksSoFar = 0;
-        DWORD prevTicks = 0;
-        for (const SoundEvent &event : events)
+        channelNumberToIndex[channelNumber] = (int)(sound._allChannels.size() - 1);
+    }
+
+    // And put the separated sound events into them, in one pass.
+    DWORD ticksSoFar = 0;
+    DWORD prevTicks[16] = {};
+    for (const SoundEvent &event : events)
+    {
+        ticksSoFar += event.wTimeDelta;
+        int channelNumber = event.GetChannel();
+        int channelIndex = channelNumberToIndex[channelNumber];
+        if (channelIndex != -1)
         {
-            ticksSoFar += event.wTimeDelta;
-            if (event.GetChannel() == channelNumber)
-            {
-                SoundEvent newEvent = event;
-                assert(ticksSoFar >= prevTicks);
-                newEvent.wTimeDelta = ticksSoFar - prevTicks;
-                prevTicks = ticksSoFar;
-                channel.Events.push_back(newEvent);
-            }
+            SoundEvent newEvent = event;
+            assert(ticksSoFar >= prevTicks[channelNumber]);
+            newEvent.wTimeDelta = ticksSoFar - prevTicks[channelNumber];
+            prevTicks[channelNumber] = ticksSoFar;
+            sound._allChannels[channelIndex].Events.push_back(newEvent);
         }
     }
 
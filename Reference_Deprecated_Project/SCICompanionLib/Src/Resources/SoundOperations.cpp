@@ -32,11 +32,16 @@ SoundChangeHint InitializeFromMidi(SCIVersion version, std::vector<DeviceType> d
 
     try
     {
-        std::ifstream midiFile;
-        midiFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        midiFile.open(filename.c_str(), std::ios::in | std::ios::binary);
-        if (midiFile.is_open())
+        std::ifstream midiFileOnDisk;
+        midiFileOnDisk.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+        midiFileOnDisk.open(filename.c_str(), std::ios::in | std::ios::binary);
+        if (midiFileOnDisk.is_open())
         {
+            // Reading tracks involves many single byte reads and tellg calls, which are slow on a file stream.
+            // So read the whole thing into memory first.
+            std::stringstream midiFile(std::ios::in | std::ios::out | std::ios::binary);
+            midiFile << midiFileOnDisk.rdbuf();
+            midiFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
             DWORD dw = _ReadBEDWORD(midiFile);
             if (dw == 0x4D546864)
             {
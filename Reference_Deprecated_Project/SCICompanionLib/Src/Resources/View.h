@@ -46,14 +46,17 @@ struct Cel
         return (GetStride() * size.cy);
     }
 
-    // REVIEW: std::vector is 16 bytes. We could change this to 4 bytes if we wish
-    // (thus reducing size of a cel from 24 to 12?) 
-    // But we'd need to write a manual copy/assignment constructor.
-    sci::array<uint8_t> Data;
+    // Copies of a cel share this until one of them modifies it.
+    sci::shared_array<uint8_t> Data;
     size16 size;
     point16 placement;
     uint8_t TransparentColor;
     bool Stride32;  // 32 bit stride
+
+    // Cels in mirror loops hold onto the bits they were mirrored from, and the result. Since neither can then
+    // be modified in place, if they're still the ones in use, the mirror is up to date.
+    sci::shared_array<uint8_t> MirroredFrom;
+    sci::shared_array<uint8_t> MirroredBits;
 };
 
 struct Loop
@@ -169,6 +172,7 @@ struct RasterComponent : ResourceComponent
     {
         return new RasterComponent(*this);
     }
+    size_t EstimateSize(const ResourceComponent *previous) const override;
 
     // Helper functions. None of these are bounds checked.
     int LoopCount() const { return (int)Loops.size(); }
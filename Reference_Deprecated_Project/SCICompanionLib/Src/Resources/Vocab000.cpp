@@ -169,17 +169,21 @@ void Vocab000::_ReadWord(sci::istream &byteStream, char *pszBuffer, size_t cchBu
 
             // Some vocabs have duplicate words (KQ1SCI, QFG2). Our Vocab resource format doesn't handle this properly, so ignore
             // this word if that's the case.
-            if (_mapWordToGroup.find(pszBuffer) == _mapWordToGroup.end())
+            WordGroup existingGroup;
+            if (!_trie.Find(pszBuffer, existingGroup))
             {
-                _words.push_back(pszBuffer);
+                // Words are stored alphabetically in the resource, so hinting at the end makes this constant time.
+                _words.emplace_hint(_words.end(), pszBuffer);
 
                 // Keep track of which groups have been used.
                 Vocab000::WordGroup dwGroup = GetWordGroup(dwInfo);
                 assert(dwGroup < ARRAYSIZE(_rgbGroups));
                 _rgbGroups[dwGroup] = 0xff;
+                word_set &groupWords = _mapGroupToWords[dwGroup];
+                groupWords.emplace_hint(groupWords.end(), pszBuffer);
 
                 // Now we have our class.
-                _mapWordToGroup[pszBuffer] = dwGroup;
+                _trie.Insert(pszBuffer, dwGroup);
                 _mapGroupToClass[dwGroup] = GetWordClass(dwInfo);
 
                 group2words_map::iterator group2wordIt = _mapGroupToString.find(dwGroup);
@@ -223,30 +227,9 @@ std::string Vocab000::GetGroupWordString(WordGroup dwGroup) const
     return strRet;
 }
 
-int CountMatchingCharacters(PCTSTR psz1, PCTSTR psz2)
-{
-    int cMatched = 0;
-    while (*psz1 && (*psz1 == *psz2))
-    {
-        cMatched++;
-        psz1++;
-        psz2++;
-    }
-    return cMatched;
-}
-
 bool Vocab000::LookupWord(const std::string &word, WordGroup &dwGroup) const
 {
-    word2group_map::const_iterator it = _mapWordToGroup.lower_bound(word);
-    if (it != _mapWordToGroup.end())
-    {
-        dwGroup = it->second;
-        return true;
-    }
-    else
-    {
-        return false;
-    }
+    return _trie.Find(word, dwGroup);
 }
 
 size_t Vocab000::GetNumberOfGroups() const
@@ -260,63 +243,21 @@ Vocab000::WordGroup Vocab000::GroupFromString(PCTSTR pszString) const
     std::transform(strLower.begin(), strLower.end(), strLower.begin(), 
                    (int(*)(int)) tolower);
 
-    PCTSTR pszLower = strLower.c_str();
-    // Try for an exact match, before searching.
+    // This matches an incomplete string to the most likely group (or the exact one, if there is one).
     WordGroup dwGroup = { 0 };
-    if (!LookupWord(strLower, dwGroup))
-    {
-        // This matches an incomplete string to the most likely group.
-        // First we'll find the best matching word by looking through the alphabetically
-        // ordered _words array, using a binary search.
-        size_t iLowerBound = 0;
-        size_t cWords = _words.size();
-        size_t iCurrent = 0;
-        int cMaxLettersMatched = 0;
-        size_t iBest = (size_t)-1;
-        int cCurrentMatched = 0;
-        while (iLowerBound < cWords)
-        {
-            size_t iPrev = iCurrent;
-            iCurrent = (cWords + iLowerBound) / 2;
-
-            int iComp = lstrcmp(pszLower, _words[iCurrent].c_str());
-            cCurrentMatched = CountMatchingCharacters(pszLower, _words[iCurrent].c_str());
-            if (cCurrentMatched > cMaxLettersMatched)
-            {
-                iBest = iCurrent;
-                cMaxLettersMatched = cCurrentMatched;
-            }
-            if (iComp > 0)
-            {
-                // Look higher.
-                iLowerBound = iCurrent + 1;
-            }
-            else if (iComp < 0)
-            {
-                // Look lower
-                cWords = iCurrent - 1;
-            }
-            else
-            {
-                // Found an exact match!
-                break;
-            }
-        }
-
-        // If we already passed a better word, then use it.
-        if (cMaxLettersMatched > cCurrentMatched)
-        {
-            assert(iBest != (size_t)-1);
-            iCurrent = iBest;
-        }
-
-        // iCurrent is our best match.
-        LookupWord(_words[iCurrent], dwGroup);
-
-    }
+    std::string bestWord;
+    _trie.FindBestPrefixMatch(strLower, bestWord, dwGroup);
     return dwGroup;
 }
 
+void Vocab000::GetCompletions(const std::string &prefix, std::vector<std::string> &words, size_t maxCount) const
+{
+    std::string strLower = prefix;
+    std::transform(strLower.begin(), strLower.end(), strLower.begin(), 
+                   (int(*)(int)) tolower);
+    _trie.GetCompletions(strLower, words, maxCount);
+}
+
 std::string Vocab000::Lookup(uint16_t wIndex) const
 {
     group2words_map::const_iterator it = _mapGroupToString.find((WordGroup)wIndex);
@@ -400,19 +341,9 @@ VocabChangeHint Vocab000::AddNewWord(PCTSTR pszWordIn, WordClass dwClass, bool f
 
 void Vocab000::_InsertWord(PCTSTR pszWord, WordGroup dwGroup)
 {
-    _mapWordToGroup[pszWord] = dwGroup;
-    
-    // Insert it into the ordered _words array, at the correct spot.
-    vector<string>::iterator wordIt = _words.begin();
-    for (; wordIt != _words.end(); ++wordIt)
-    {
-        if (lstrcmp(pszWord, wordIt->c_str()) < 0)
-        {
-            // We're done.  Insert it here.
-            break;
-        }
-    }
-    _words.insert(wordIt, pszWord);
+    _trie.Insert(pszWord, dwGroup);
+    _words.insert(pszWord);
+    _mapGroupToWords[dwGroup].insert(pszWord);
 }
 
 VocabChangeHint Vocab000::AddSynonym(PCTSTR pszWordIn, PCTSTR pszOriginal)
@@ -492,25 +423,17 @@ VocabChangeHint Vocab000::_FixupGroupToString(WordGroup dwGroup)
 {
     assert(dwGroup < ARRAYSIZE(_rgbGroups));
     std::string strGroup;
-    size_t cMax = _words.size();
-    for (size_t i = 0; i < cMax; i++)
+    auto groupWordsIt = _mapGroupToWords.find(dwGroup);
+    if (groupWordsIt != _mapGroupToWords.end())
     {
-        WordGroup dwGroupWord;
-        std::string strWord = _words[i];
-        BOOL fTemp = LookupWord(strWord, dwGroupWord);
-        assert(fTemp); // Else we're corrupt.
-        if (dwGroup == dwGroupWord)
+        for (const std::string &strWord : groupWordsIt->second)
         {
             // This is a word from our group, add it to our string.
-            if (strGroup.empty())
-            {
-                strGroup += strWord;
-            }
-            else
+            if (!strGroup.empty())
             {
                 strGroup += TEXT(" | ");
-                strGroup += strWord;
             }
+            strGroup += strWord;
         }
     }
 
@@ -518,6 +441,10 @@ VocabChangeHint Vocab000::_FixupGroupToString(WordGroup dwGroup)
     {
         // There are no more words from this group.  Remove the group.
         _rgbGroups[dwGroup] = 0;
+        if (groupWordsIt != _mapGroupToWords.end())
+        {
+            _mapGroupToWords.erase(groupWordsIt);
+        }
         _mapGroupToString.erase(_mapGroupToString.find(dwGroup));
         return VocabChangeHint::DeleteWordGroup;
     }
@@ -539,22 +466,12 @@ VocabChangeHint Vocab000::RemoveWord(PCTSTR pszWord)
     {
         hint = (VocabChangeHint)((DWORD)dwGroup << 16);
         // Found it.  Remove from word array.
-        bool fFound = false;
-        vector<string>::iterator wordIt = _words.begin();
-        for (; wordIt != _words.end(); ++wordIt)
-        {
-            if (strLower == *wordIt)
-            {
-                // We're done.  Remove it here.
-                fFound = true;
-                break;
-            }
-        }
-        assert(fFound); // Otherwise it means our _words and our _mapWordToGroup are out of sync!
-        _words.erase(wordIt);
+        size_t cRemoved = _words.erase(strLower);
+        assert(cRemoved == 1); // Otherwise it means our _words and our _trie are out of sync!
+        _mapGroupToWords[dwGroup].erase(strLower);
 
         // Remove it from the lookup table.
-        _mapWordToGroup.erase(_mapWordToGroup.lower_bound(strLower));
+        _trie.Remove(strLower);
 
         hint |= _FixupGroupToString(dwGroup);
     }
@@ -571,12 +488,11 @@ void VocabWriteTo(const ResourceEntity &resource, sci::ostream &byteStream, bool
     byteStream.FillByte(0, is900 ? Vocab000::AlphaIndexLength_900 : Vocab000::AlphaIndexLength);
 
     PCTSTR pszPreviousWord = TEXT("");
-    size_t cWords = vocab._words.size();
-    for (size_t i = 0; i < cWords; i++)
+    for (const std::string &strWord : vocab._words)
     {
-        const std::string &strWord = vocab._words[i];
         PCTSTR pszWord = strWord.c_str();
-        Vocab000::WordGroup dwGroup = vocab._mapWordToGroup.find(pszWord)->second;   // Must exist, or we're corrupt
+        Vocab000::WordGroup dwGroup = 0;
+        vocab.LookupWord(strWord, dwGroup);   // Must exist, or we're corrupt
         WordClass dwClass = vocab._mapGroupToClass.find(dwGroup)->second; // Must exist.
         DWORD dwInfo = InfoFromClassAndGroup(dwClass, dwGroup);
 
@@ -665,9 +581,6 @@ void VocabReadFrom(ResourceEntity &resource, sci::istream &byteStream, bool is90
 {
     Vocab000 &vocab = resource.GetComponent<Vocab000>();
 
-    // Avoid needless reallocations.
-    vocab._words.reserve(1000);
-
     // Skip the "alphabetical offset" table
     byteStream.skip(is900 ? Vocab000::AlphaIndexLength_900 : Vocab000::AlphaIndexLength);
 
@@ -15,6 +15,7 @@
 
 #include "Components.h"
 #include "interfaces.h"
+#include "VocabTrie.h"
 // FWD declarations
 class ResourceBlob;
 
@@ -56,6 +57,17 @@ enum class WordClass : uint16_t
 
 DEFINE_ENUM_FLAGS(WordClass, uint16_t)
 
+// Orders vocab words the way the vocab editor always has (lstrcmp), falling back to a plain
+// comparison so that distinct words never compare equal.
+struct VocabWordLess
+{
+    bool operator()(const std::string &a, const std::string &b) const
+    {
+        int comp = lstrcmp(a.c_str(), b.c_str());
+        return (comp != 0) ? (comp < 0) : (a < b);
+    }
+};
+
 struct Vocab000 : public ResourceComponent, public ILookupNames
 {
 public:
@@ -64,9 +76,10 @@ public:
 
     typedef DWORD WordGroup;
 
-    typedef std::unordered_map<std::string, WordGroup> word2group_map;
 	typedef std::unordered_map<WordGroup, std::string> group2words_map;
 	typedef std::unordered_map<WordGroup, WordClass> group2class_map;
+    typedef std::set<std::string, VocabWordLess> word_set;
+    typedef std::unordered_map<WordGroup, word_set> group2wordset_map;
 
     Vocab000();
     Vocab000(const Vocab000 &src) = default;
@@ -87,9 +100,11 @@ public:
     std::string GetGroupWordString(WordGroup dwGroup) const;
     groups_iterator GroupsBegin() const { return _mapGroupToString.begin(); }
     groups_iterator GroupsEnd() const { return _mapGroupToString.end(); }
-    std::vector<std::string> &GetWords() { return _words; }
+    const word_set &GetWords() const { return _words; }
     bool LookupWord(const std::string &word, WordGroup &dwGroup) const;
     WordGroup GroupFromString(PCTSTR pszString) const;
+    // Words starting with prefix, in alphabetical order.
+    void GetCompletions(const std::string &prefix, std::vector<std::string> &words, size_t maxCount) const;
     size_t GetNumberOfGroups() const;
 
     // ILookupNames
@@ -106,17 +121,19 @@ private:
     VocabChangeHint _FixupGroupToString(WordGroup dwGroup);
     void _ReadWord(sci::istream &byteStream, char *pszBuffer, size_t cchBuffer, bool is900);
 
-    // Map from word to class
-    word2group_map _mapWordToGroup;
+    // Map from word to group
+    VocabTrie _trie;
     group2words_map _mapGroupToString;
+    group2wordset_map _mapGroupToWords;
     group2class_map _mapGroupToClass;
     uint8_t _rgbGroups[0x1000]; // 4096 entries, one for each group.
 
     // Duplicate words, which we don't handle - but are useful for the decompiler.
     group2words_map _duplicateMapGroupToString;
 
-    // This is just the raw vocab
-    std::vector<std::string> _words;
+    // This is just the raw vocab, in alphabetical order. A balanced tree, so that words can be added
+    // and removed in logarithmic time. Loading appends in file order, which is already sorted.
+    word_set _words;
 };
 
 bool IsValidVocabString(PCTSTR pszWord, bool fShowUI);
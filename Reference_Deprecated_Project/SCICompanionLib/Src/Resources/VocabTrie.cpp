@@ -0,0 +1,275 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "VocabTrie.h"
+
+using namespace std;
+
+VocabTrie::VocabTrie()
+{
+    Clear();
+}
+
+void VocabTrie::Clear()
+{
+    _nodes.clear();
+    _freeNodes.clear();
+    _wordCount = 0;
+    _AllocateNode(0);
+}
+
+uint32_t VocabTrie::_AllocateNode(char ch)
+{
+    Node node = { NoNode, NoNode, 0, ch, false };
+    uint32_t index;
+    if (_freeNodes.empty())
+    {
+        index = (uint32_t)_nodes.size();
+        _nodes.push_back(node);
+    }
+    else
+    {
+        index = _freeNodes.back();
+        _freeNodes.pop_back();
+        _nodes[index] = node;
+    }
+    return index;
+}
+
+uint32_t VocabTrie::_FindChild(uint32_t node, char ch) const
+{
+    uint32_t child = _nodes[node].FirstChild;
+    while ((child != NoNode) && ((uint8_t)_nodes[child].Ch < (uint8_t)ch))
+    {
+        child = _nodes[child].NextSibling;
+    }
+    return ((child != NoNode) && (_nodes[child].Ch == ch)) ? child : NoNode;
+}
+
+uint32_t VocabTrie::_FindNode(const std::string &text) const
+{
+    uint32_t node = 0;
+    for (size_t i = 0; (node != NoNode) && (i < text.length()); i++)
+    {
+        node = _FindChild(node, text[i]);
+    }
+    return node;
+}
+
+void VocabTrie::Insert(const std::string &word, WordGroup group)
+{
+    uint32_t node = 0;
+    for (char ch : word)
+    {
+        // Find the spot in the (sorted) sibling list.
+        uint32_t prev = NoNode;
+        uint32_t child = _nodes[node].FirstChild;
+        while ((child != NoNode) && ((uint8_t)_nodes[child].Ch < (uint8_t)ch))
+        {
+            prev = child;
+            child = _nodes[child].NextSibling;
+        }
+        if ((child == NoNode) || (_nodes[child].Ch != ch))
+        {
+            // Careful, this may reallocate _nodes.
+            uint32_t newChild = _AllocateNode(ch);
+            _nodes[newChild].NextSibling = child;
+            if (prev == NoNode)
+            {
+                _nodes[node].FirstChild = newChild;
+            }
+            else
+            {
+                _nodes[prev].NextSibling = newChild;
+            }
+            child = newChild;
+        }
+        node = child;
+    }
+
+    if (!_nodes[node].IsWord)
+    {
+        _wordCount++;
+    }
+    _nodes[node].IsWord = true;
+    _nodes[node].Group = group;
+}
+
+bool VocabTrie::Remove(const std::string &word)
+{
+    std::vector<uint32_t> path;
+    path.reserve(word.length() + 1);
+    path.push_back(0);
+    for (char ch : word)
+    {
+        uint32_t child = _FindChild(path.back(), ch);
+        if (child == NoNode)
+        {
+            return false;
+        }
+        path.push_back(child);
+    }
+    if (!_nodes[path.back()].IsWord)
+    {
+        return false;
+    }
+
+    _nodes[path.back()].IsWord = false;
+    _wordCount--;
+
+    // Prune the nodes that no longer lead to any words.
+    while (path.size() > 1)
+    {
+        uint32_t node = path.back();
+        if (_nodes[node].IsWord || (_nodes[node].FirstChild != NoNode))
+        {
+            break;
+        }
+        path.pop_back();
+        uint32_t parent = path.back();
+        if (_nodes[parent].FirstChild == node)
+        {
+            _nodes[parent].FirstChild = _nodes[node].NextSibling;
+        }
+        else
+        {
+            uint32_t prev = _nodes[parent].FirstChild;
+            while (_nodes[prev].NextSibling != node)
+            {
+                prev = _nodes[prev].NextSibling;
+            }
+            _nodes[prev].NextSibling = _nodes[node].NextSibling;
+        }
+        _freeNodes.push_back(node);
+    }
+    return true;
+}
+
+bool VocabTrie::Find(const std::string &word, WordGroup &group) const
+{
+    uint32_t node = _FindNode(word);
+    if ((node != NoNode) && _nodes[node].IsWord)
+    {
+        group = _nodes[node].Group;
+        return true;
+    }
+    return false;
+}
+
+// Nodes that aren't words always have children, so this ends on a word.
+void VocabTrie::_FirstWord(uint32_t node, std::string &word, WordGroup &group) const
+{
+    while (!_nodes[node].IsWord)
+    {
+        node = _nodes[node].FirstChild;
+        word += _nodes[node].Ch;
+    }
+    group = _nodes[node].Group;
+}
+
+// Leaf nodes are always words.
+void VocabTrie::_LastWord(uint32_t node, std::string &word, WordGroup &group) const
+{
+    while (_nodes[node].FirstChild != NoNode)
+    {
+        node = _nodes[node].FirstChild;
+        while (_nodes[node].NextSibling != NoNode)
+        {
+            node = _nodes[node].NextSibling;
+        }
+        word += _nodes[node].Ch;
+    }
+    group = _nodes[node].Group;
+}
+
+bool VocabTrie::FindBestPrefixMatch(const std::string &text, std::string &word, WordGroup &group) const
+{
+    if (_wordCount == 0)
+    {
+        return false;
+    }
+
+    // Go as deep as text lets us. Every word below here shares the most characters with it.
+    word.clear();
+    uint32_t node = 0;
+    size_t depth = 0;
+    for (; depth < text.length(); depth++)
+    {
+        uint32_t child = _FindChild(node, text[depth]);
+        if (child == NoNode)
+        {
+            break;
+        }
+        node = child;
+        word += text[depth];
+    }
+
+    if (depth == text.length())
+    {
+        // All of text matched, so the first word here is either text itself or the first that starts with it.
+        _FirstWord(node, word, group);
+        return true;
+    }
+
+    // text goes off the tree here. Prefer the first word that comes after it...
+    uint8_t ch = (uint8_t)text[depth];
+    uint32_t before = NoNode;
+    for (uint32_t child = _nodes[node].FirstChild; child != NoNode; child = _nodes[child].NextSibling)
+    {
+        if ((uint8_t)_nodes[child].Ch > ch)
+        {
+            word += _nodes[child].Ch;
+            _FirstWord(child, word, group);
+            return true;
+        }
+        before = child;
+    }
+    // ...otherwise the last one before it.
+    if (before != NoNode)
+    {
+        word += _nodes[before].Ch;
+        _LastWord(before, word, group);
+    }
+    else
+    {
+        assert(_nodes[node].IsWord);
+        group = _nodes[node].Group;
+    }
+    return true;
+}
+
+void VocabTrie::_Complete(uint32_t node, std::string &word, std::vector<std::string> &words, size_t maxCount) const
+{
+    if (_nodes[node].IsWord && (words.size() < maxCount))
+    {
+        words.push_back(word);
+    }
+    for (uint32_t child = _nodes[node].FirstChild; (child != NoNode) && (words.size() < maxCount); child = _nodes[child].NextSibling)
+    {
+        word += _nodes[child].Ch;
+        _Complete(child, word, words, maxCount);
+        word.pop_back();
+    }
+}
+
+void VocabTrie::GetCompletions(const std::string &prefix, std::vector<std::string> &words, size_t maxCount) const
+{
+    uint32_t node = _FindNode(prefix);
+    if (node != NoNode)
+    {
+        maxCount += words.size();
+        std::string word = prefix;
+        _Complete(node, word, words, maxCount);
+    }
+}
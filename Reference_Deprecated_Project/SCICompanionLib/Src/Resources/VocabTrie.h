@@ -0,0 +1,66 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+// A compact prefix tree over the words in a vocab, mapping each word to its word group.
+// Exact lookups, longest-prefix matches and prefix completions all cost time proportional
+// to the length of the text (times the small number of siblings at each letter), regardless
+// of how many words there are.
+// Nodes live in one array and link to their first child and next sibling. Siblings are kept
+// sorted by character, so completions come out in alphabetical order.
+class VocabTrie
+{
+public:
+    typedef DWORD WordGroup;
+
+    VocabTrie();
+
+    void Clear();
+    // Replaces the group if the word is already present.
+    void Insert(const std::string &word, WordGroup group);
+    bool Remove(const std::string &word);
+    bool Find(const std::string &word, WordGroup &group) const;
+
+    // Finds the word sharing the most leading characters with text. If there are several, the
+    // first one at or after text (alphabetically) is picked, otherwise the last one before it.
+    bool FindBestPrefixMatch(const std::string &text, std::string &word, WordGroup &group) const;
+
+    // Appends (in alphabetical order) up to maxCount words that start with prefix.
+    void GetCompletions(const std::string &prefix, std::vector<std::string> &words, size_t maxCount) const;
+
+    size_t GetWordCount() const { return _wordCount; }
+
+private:
+    static const uint32_t NoNode = 0xffffffff;
+
+    struct Node
+    {
+        uint32_t FirstChild;
+        uint32_t NextSibling;
+        WordGroup Group;
+        char Ch;
+        bool IsWord;
+    };
+
+    uint32_t _FindChild(uint32_t node, char ch) const;
+    uint32_t _FindNode(const std::string &text) const;
+    uint32_t _AllocateNode(char ch);
+    void _FirstWord(uint32_t node, std::string &word, WordGroup &group) const;
+    void _LastWord(uint32_t node, std::string &word, WordGroup &group) const;
+    void _Complete(uint32_t node, std::string &word, std::vector<std::string> &words, size_t maxCount) const;
+
+    std::vector<Node> _nodes;       // _nodes[0] is the root.
+    std::vector<uint32_t> _freeNodes;
+    size_t _wordCount;
+};
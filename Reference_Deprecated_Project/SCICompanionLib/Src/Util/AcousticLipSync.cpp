@@ -0,0 +1,546 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "AcousticLipSync.h"
+#include "phone_estimate.h"
+#include "LipSyncUtil.h"
+#include "PhonemeMap.h"
+#include "Audio.h"
+#include "Sync.h"
+#include "ResourceEntity.h"
+#include "ResourceUtil.h"
+#include "ResourceContainer.h"
+#include "GameFolderHelper.h"
+#include "ParallelFor.h"
+#include <chrono>
+#include <cfloat>
+
+using namespace std;
+
+namespace
+{
+    // Frames are FrameLengthMs long, and start every FrameStepMs.
+    const int FrameStepMs = 10;
+    const int FrameLengthMs = 20;
+    // Anything shorter than this (3 SCI ticks) is merged into its neighbours.
+    const int MinPhonemeMs = 50;
+
+    // Relative to the loudest frame in the clip.
+    const float SilenceDb = -30.0f;
+    const float QuietDb = -18.0f;
+    const float AbsoluteSilenceDb = -60.0f;
+
+    // The energy of the first difference of a frame relative to its energy. This is 2 for white noise, and
+    // approaches 0 for low frequencies, so it's a cheap measure of where the energy is in the spectrum.
+    const float FricativeTilt = 1.0f;
+    const float SibilantTilt = 1.5f;
+
+    // The coarse spectrum used to find formants.
+    const float SpectrumMinHz = 150.0f;
+    const float SpectrumMaxHz = 3000.0f;
+    const float SpectrumStepHz = 50.0f;
+    const int AnalysisFrequency = 8000;
+
+    // Phonemes are compared by pointer, so they all come from here or the Vowels table.
+    const wchar_t SilencePhoneme[] = L"-";
+    const wchar_t WeakFricativePhoneme[] = L"f";
+    const wchar_t SibilantPhoneme[] = L"s";
+    const wchar_t PostalveolarPhoneme[] = L"sh";
+    const wchar_t NasalPhoneme[] = L"m";
+    const wchar_t NeutralVowelPhoneme[] = L"ah";
+
+    struct VowelFormants
+    {
+        const wchar_t *Phoneme;
+        float F1;
+        float F2;
+    };
+
+    // Typical first and second formant frequencies of the vowels in the SAPI phoneme set (Peterson and Barney).
+    const VowelFormants Vowels[] =
+    {
+        { L"iy", 270.0f, 2290.0f },
+        { L"ih", 390.0f, 1990.0f },
+        { L"eh", 530.0f, 1840.0f },
+        { L"ae", 660.0f, 1720.0f },
+        { L"aa", 730.0f, 1090.0f },
+        { NeutralVowelPhoneme, 640.0f, 1190.0f },
+        { L"ao", 570.0f, 840.0f },
+        { L"uh", 440.0f, 1020.0f },
+        { L"uw", 300.0f, 870.0f },
+        { L"er", 490.0f, 1350.0f },
+    };
+
+    struct PhonemeSegment
+    {
+        const wchar_t *Phoneme;
+        size_t StartFrame;
+        size_t EndFrame;
+
+        size_t Length() const { return EndFrame - StartFrame; }
+    };
+
+    vector<float> _GetSamples(const AudioComponent &audio)
+    {
+        uint32_t length = audio.GetLength();
+        vector<uint8_t> pcm(length);
+        if (length)
+        {
+            audio.ReadPCM(0, &pcm[0], length);
+        }
+
+        vector<float> samples;
+        if (IsFlagSet(audio.Flags, AudioFlags::SixteenBit))
+        {
+            samples.resize(length / 2);
+            for (size_t i = 0; i < samples.size(); i++)
+            {
+                int16_t value = (int16_t)(pcm[i * 2] | (pcm[i * 2 + 1] << 8));
+                samples[i] = (float)value / 32768.0f;
+            }
+        }
+        else
+        {
+            samples.resize(length);
+            for (size_t i = 0; i < samples.size(); i++)
+            {
+                samples[i] = ((float)pcm[i] - 128.0f) / 128.0f;
+            }
+        }
+        return samples;
+    }
+
+    // Returns the frame's energy in dB, and the tilt (see FricativeTilt).
+    float _GetFrameEnergy(const float *samples, size_t count, float &tilt)
+    {
+        float mean = 0.0f;
+        for (size_t i = 0; i < count; i++)
+        {
+            mean += samples[i];
+        }
+        mean /= (float)count;
+
+        float energy = 0.0f;
+        float differenceEnergy = 0.0f;
+        float previous = samples[0] - mean;
+        for (size_t i = 0; i < count; i++)
+        {
+            float value = samples[i] - mean;
+            energy += value * value;
+            differenceEnergy += (value - previous) * (value - previous);
+            previous = value;
+        }
+        tilt = (energy > 0.0f) ? (differenceEnergy / energy) : 0.0f;
+        return 10.0f * log10(energy / (float)count + 1e-10f);
+    }
+
+    class FormantEstimator
+    {
+    public:
+        FormantEstimator(uint32_t frequency, size_t frameLength) : _window(frameLength), _windowed(frameLength)
+        {
+            // Hann window
+            for (size_t i = 0; i < frameLength; i++)
+            {
+                _window[i] = 0.5f - 0.5f * cos(2.0f * 3.14159265f * (float)i / (float)(frameLength - 1));
+            }
+            float maxHz = min(SpectrumMaxHz, (float)frequency / 2.0f - SpectrumStepHz);
+            for (float hz = SpectrumMinHz; hz <= maxHz; hz += SpectrumStepHz)
+            {
+                float omega = 2.0f * 3.14159265f * hz / (float)frequency;
+                _binHz.push_back(hz);
+                _binCoefficients.push_back(2.0f * cos(omega));
+                // The power response of a 0.9 pre-emphasis filter, which flattens the spectrum of voiced
+                // speech so that the second formant isn't buried.
+                _emphasis.push_back(1.81f - 1.8f * cos(omega));
+            }
+            _power.resize(_binHz.size());
+            _envelope.resize(_binHz.size());
+            _emphasizedEnvelope.resize(_binHz.size());
+        }
+
+        // Finds the peaks of the spectral envelope in the ranges where the first and second formants are found.
+        // It's rough, but good enough to tell the vowels' mouth shapes apart.
+        bool Estimate(const float *samples, size_t count, float &f1, float &f2)
+        {
+            if (_binHz.size() < 5)
+            {
+                return false;
+            }
+
+            count = min(count, _window.size());
+            for (size_t i = 0; i < count; i++)
+            {
+                _windowed[i] = samples[i] * _window[i];
+            }
+
+            // Goertzel for each bin
+            for (size_t bin = 0; bin < _binHz.size(); bin++)
+            {
+                float coefficient = _binCoefficients[bin];
+                float s1 = 0.0f;
+                float s2 = 0.0f;
+                for (size_t i = 0; i < count; i++)
+                {
+                    float s0 = _windowed[i] + coefficient * s1 - s2;
+                    s2 = s1;
+                    s1 = s0;
+                }
+                _power[bin] = s1 * s1 + s2 * s2 - coefficient * s1 * s2;
+            }
+
+            // Smooth across the harmonics of the voice to get the envelope.
+            const float weights[] = { 1.0f, 2.0f, 3.0f, 2.0f, 1.0f };
+            for (int bin = 0; bin < (int)_power.size(); bin++)
+            {
+                float sum = 0.0f;
+                float weightSum = 0.0f;
+                for (int k = -2; k <= 2; k++)
+                {
+                    int other = bin + k;
+                    if ((other >= 0) && (other < (int)_power.size()))
+                    {
+                        sum += _power[other] * weights[k + 2];
+                        weightSum += weights[k + 2];
+                    }
+                }
+                _envelope[bin] = sum / weightSum;
+                _emphasizedEnvelope[bin] = _envelope[bin] * _emphasis[bin];
+            }
+
+            f1 = _FindPeak(_envelope, 250.0f, 900.0f);
+            f2 = _FindPeak(_emphasizedEnvelope, max(f1 + 300.0f, 850.0f), 2600.0f);
+            return (f1 > 0.0f) && (f2 > 0.0f);
+        }
+
+    private:
+        float _FindPeak(const vector<float> &envelope, float minHz, float maxHz) const
+        {
+            int best = -1;
+            for (int bin = 0; bin < (int)envelope.size(); bin++)
+            {
+                if ((_binHz[bin] >= minHz) && (_binHz[bin] <= maxHz) && ((best == -1) || (envelope[bin] > envelope[best])))
+                {
+                    best = bin;
+                }
+            }
+            if (best == -1)
+            {
+                return 0.0f;
+            }
+
+            // Interpolate between bins
+            float hz = _binHz[best];
+            if ((best > 0) && (best < ((int)envelope.size() - 1)))
+            {
+                float left = envelope[best - 1];
+                float center = envelope[best];
+                float right = envelope[best + 1];
+                float denominator = left - 2.0f * center + right;
+                if (denominator != 0.0f)
+                {
+                    hz += SpectrumStepHz * 0.5f * (left - right) / denominator;
+                }
+            }
+            return hz;
+        }
+
+        vector<float> _window;
+        vector<float> _windowed;
+        vector<float> _binHz;
+        vector<float> _binCoefficients;
+        vector<float> _emphasis;
+        vector<float> _power;
+        vector<float> _envelope;
+        vector<float> _emphasizedEnvelope;
+    };
+
+    // Formants are below SpectrumMaxHz, so they're found in a copy of the clip with a lower sample rate,
+    // which is much quicker for higher rate clips.
+    vector<float> _Decimate(const vector<float> &samples, size_t factor)
+    {
+        vector<float> decimated(samples.size() / factor);
+        for (size_t i = 0; i < decimated.size(); i++)
+        {
+            float sum = 0.0f;
+            for (size_t j = 0; j < factor; j++)
+            {
+                sum += samples[i * factor + j];
+            }
+            decimated[i] = sum / (float)factor;
+        }
+        return decimated;
+    }
+
+    const wchar_t *_GetClosestVowel(float f1, float f2)
+    {
+        const wchar_t *closest = Vowels[0].Phoneme;
+        float closestDistance = FLT_MAX;
+        for (const VowelFormants &vowel : Vowels)
+        {
+            // Compare on a log scale, since that's closer to how we hear them.
+            float d1 = log(f1 / vowel.F1);
+            float d2 = log(f2 / vowel.F2);
+            float distance = d1 * d1 + d2 * d2;
+            if (distance < closestDistance)
+            {
+                closestDistance = distance;
+                closest = vowel.Phoneme;
+            }
+        }
+        return closest;
+    }
+
+    // Replaces each frame's phoneme with the most common one around it, to remove flicker.
+    vector<const wchar_t *> _SmoothPhonemes(const vector<const wchar_t *> &phonemes)
+    {
+        const int Radius = 2;
+        vector<const wchar_t *> smoothed(phonemes);
+        for (int i = Radius; i < ((int)phonemes.size() - Radius); i++)
+        {
+            int bestCount = 0;
+            for (int j = i - Radius; j <= i + Radius; j++)
+            {
+                int count = (int)count_if(phonemes.begin() + i - Radius, phonemes.begin() + i + Radius + 1,
+                    [&](const wchar_t *phoneme) { return phoneme == phonemes[j]; });
+                // Ties go to the original.
+                if ((count > bestCount) || ((count == bestCount) && (phonemes[j] == phonemes[i])))
+                {
+                    bestCount = count;
+                    smoothed[i] = phonemes[j];
+                }
+            }
+        }
+        return smoothed;
+    }
+
+    vector<PhonemeSegment> _GetSegments(const vector<const wchar_t *> &phonemes, size_t minFrames)
+    {
+        vector<PhonemeSegment> segments;
+        for (size_t i = 0; i < phonemes.size(); i++)
+        {
+            if (segments.empty() || (segments.back().Phoneme != phonemes[i]))
+            {
+                segments.push_back({ phonemes[i], i, i + 1 });
+            }
+            else
+            {
+                segments.back().EndFrame = i + 1;
+            }
+        }
+
+        // Merge the shortest segment into its longer neighbour, until they're all long enough.
+        while (segments.size() > 1)
+        {
+            auto shortest = min_element(segments.begin(), segments.end(),
+                [](const PhonemeSegment &one, const PhonemeSegment &two) { return one.Length() < two.Length(); });
+            if (shortest->Length() >= minFrames)
+            {
+                break;
+            }
+            bool mergeIntoPrevious = (shortest != segments.begin()) &&
+                (((shortest + 1) == segments.end()) || ((shortest - 1)->Length() >= (shortest + 1)->Length()));
+            if (mergeIntoPrevious)
+            {
+                (shortest - 1)->EndFrame = shortest->EndFrame;
+            }
+            else
+            {
+                (shortest + 1)->StartFrame = shortest->StartFrame;
+            }
+            auto next = segments.erase(shortest);
+            // The neighbours might now be the same phoneme.
+            if ((next != segments.begin()) && (next != segments.end()) && ((next - 1)->Phoneme == next->Phoneme))
+            {
+                (next - 1)->EndFrame = next->EndFrame;
+                segments.erase(next);
+            }
+        }
+        return segments;
+    }
+}
+
+void EstimatePhonemeAlignmentFromAudio(const AudioComponent &audio, std::vector<alignment_result> &rawResults)
+{
+    rawResults.clear();
+    vector<float> samples = _GetSamples(audio);
+    size_t frameStep = audio.Frequency * FrameStepMs / 1000;
+    size_t frameLength = audio.Frequency * FrameLengthMs / 1000;
+    if ((frameStep == 0) || (samples.size() < frameLength))
+    {
+        return;
+    }
+
+    size_t frameCount = (samples.size() - frameLength) / frameStep + 1;
+    vector<float> energies(frameCount);
+    vector<float> tilts(frameCount);
+    for (size_t frame = 0; frame < frameCount; frame++)
+    {
+        energies[frame] = _GetFrameEnergy(&samples[frame * frameStep], frameLength, tilts[frame]);
+    }
+    float peakDb = *max_element(energies.begin(), energies.end());
+    float silenceDb = max(peakDb + SilenceDb, AbsoluteSilenceDb);
+    float quietDb = peakDb + QuietDb;
+
+    size_t decimation = max(1, audio.Frequency / AnalysisFrequency);
+    vector<float> decimated = _Decimate(samples, decimation);
+    size_t decimatedFrameLength = frameLength / decimation;
+    FormantEstimator formants(audio.Frequency / decimation, decimatedFrameLength);
+    vector<const wchar_t *> phonemes(frameCount);
+    for (size_t frame = 0; frame < frameCount; frame++)
+    {
+        const wchar_t *phoneme;
+        float f1, f2;
+        if (energies[frame] < silenceDb)
+        {
+            phoneme = SilencePhoneme;
+        }
+        else if (tilts[frame] > FricativeTilt)
+        {
+            if (energies[frame] < quietDb)
+            {
+                phoneme = WeakFricativePhoneme;
+            }
+            else
+            {
+                phoneme = (tilts[frame] > SibilantTilt) ? SibilantPhoneme : PostalveolarPhoneme;
+            }
+        }
+        else if (energies[frame] < quietDb)
+        {
+            // Quiet voiced sounds: nasals, and the start and end of plosives.
+            phoneme = NasalPhoneme;
+        }
+        else if (formants.Estimate(&decimated[frame * frameStep / decimation], min(decimatedFrameLength, decimated.size() - frame * frameStep / decimation), f1, f2))
+        {
+            phoneme = _GetClosestVowel(f1, f2);
+        }
+        else
+        {
+            phoneme = NeutralVowelPhoneme;
+        }
+        phonemes[frame] = phoneme;
+    }
+
+    vector<PhonemeSegment> segments = _GetSegments(_SmoothPhonemes(phonemes), max(1, MinPhonemeMs / FrameStepMs));
+
+    // Silences are their own alignment result, and the phonemes between them are grouped into "words", as
+    // sapi_lipsync::finalize_phoneme_alignment does.
+    long msEndOfClip = (long)((uint64_t)samples.size() * 1000 / audio.Frequency);
+    phoneme_estimator estimator;
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        const PhonemeSegment &segment = segments[i];
+        long msStart = (long)(segment.StartFrame * FrameStepMs);
+        long msEnd = ((i + 1) == segments.size()) ? msEndOfClip : (long)(segment.EndFrame * FrameStepMs);
+        bool silence = (segment.Phoneme == SilencePhoneme);
+        if (silence || rawResults.empty() || (rawResults.back().m_phonemes.back() == L"x"))
+        {
+            alignment_result result;
+            result.m_msStart = msStart;
+            rawResults.push_back(result);
+        }
+        alignment_result &result = rawResults.back();
+        result.m_msEnd = msEnd;
+        result.m_phonemes.push_back(silence ? L"x" : segment.Phoneme);
+        result.m_phonemeEndTimes.push_back(msEnd);
+    }
+
+    for (alignment_result &result : rawResults)
+    {
+        estimator.MapPhonemes(result);
+    }
+}
+
+std::unique_ptr<SyncComponent> CreateLipSyncComponentFromAudio(const AudioComponent &audio, const PhonemeMap &phonemeMap, std::vector<alignment_result> *optRawResults)
+{
+    std::vector<alignment_result> phonemeAlignment;
+    EstimatePhonemeAlignmentFromAudio(audio, phonemeAlignment);
+    std::unique_ptr<SyncComponent> result = CreateLipSyncComponentFromPhonemes(phonemeMap, phonemeAlignment);
+    if (optRawResults)
+    {
+        *optRawResults = move(phonemeAlignment);
+    }
+    return result;
+}
+
+std::vector<std::unique_ptr<SyncComponent>> CreateLipSyncComponentsFromAudio(const std::vector<const AudioComponent*> &audios, const PhonemeMap &phonemeMap, unsigned int workerCount)
+{
+    vector<unique_ptr<SyncComponent>> results(audios.size());
+    ParallelFor(audios.size(), workerCount,
+        [&](size_t i)
+    {
+        results[i] = CreateLipSyncComponentFromAudio(*audios[i], phonemeMap);
+    });
+    return results;
+}
+
+LipSyncBatchStats CreateLipSyncComponentsForGame(const GameFolderHelper &helper, const PhonemeMap &phonemeMap, unsigned int workerCount, std::function<void(const ResourceBlob &, std::unique_ptr<SyncComponent>)> onClipDone)
+{
+    LipSyncBatchStats stats = {};
+    auto start = chrono::steady_clock::now();
+
+    vector<int> mapNumbers;
+    auto mapContainer = helper.Resources(ResourceTypeFlags::AudioMap, ResourceEnumFlags::MostRecentOnly | ResourceEnumFlags::AddInDefaultEnumFlags);
+    for (auto &blob : *mapContainer)
+    {
+        mapNumbers.push_back(blob->GetNumber());
+    }
+
+    // One audio map at a time, so we aren't holding onto every clip in the game at once.
+    for (int mapNumber : mapNumbers)
+    {
+        int mapContext = (mapNumber == helper.Version.AudioMapResourceNumber) ? -1 : mapNumber;
+        vector<unique_ptr<ResourceBlob>> blobs;
+        auto container = helper.Resources(ResourceTypeFlags::Audio, ResourceEnumFlags::MostRecentOnly | ResourceEnumFlags::AddInDefaultEnumFlags, nullptr, mapContext);
+        for (auto &blob : *container)
+        {
+            blobs.push_back(move(blob));
+        }
+
+        vector<unique_ptr<SyncComponent>> results(blobs.size());
+        vector<uint32_t> lengths(blobs.size());
+        ParallelFor(blobs.size(), workerCount,
+            [&](size_t i)
+        {
+            try
+            {
+                unique_ptr<ResourceEntity> resource = CreateResourceFromResourceData(*blobs[i], false);
+                const AudioComponent *audio = resource ? resource->TryGetComponent<AudioComponent>() : nullptr;
+                if (audio)
+                {
+                    results[i] = CreateLipSyncComponentFromAudio(*audio, phonemeMap);
+                    lengths[i] = SCITicksToMilliseconds(audio->GetLengthInTicks());
+                }
+            }
+            catch (std::exception)
+            {
+                // Skip clips we can't read.
+            }
+        });
+
+        for (size_t i = 0; i < blobs.size(); i++)
+        {
+            if (results[i])
+            {
+                stats.ClipCount++;
+                stats.AudioMilliseconds += lengths[i];
+                onClipDone(*blobs[i], move(results[i]));
+            }
+        }
+    }
+
+    stats.ElapsedMilliseconds = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
+    return stats;
+}
@@ -0,0 +1,44 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+struct SyncComponent;
+struct AudioComponent;
+class PhonemeMap;
+class alignment_result;
+class GameFolderHelper;
+class ResourceBlob;
+
+// Lip sync generation that works from the audio signal alone, without a speech recognizer (see LipSyncUtil.h
+// for the SAPI version). Each 10ms frame is classified as silence, a fricative, a closed-mouth sound or a vowel
+// (using its energy, spectral tilt and first two formants), and runs of the same class become phonemes.
+// The results are in the same form as the SAPI results, so they can be mapped to cels with a PhonemeMap.
+// Nothing here uses any shared state, so it's safe to call from multiple threads.
+void EstimatePhonemeAlignmentFromAudio(const AudioComponent &audio, std::vector<alignment_result> &rawResults);
+std::unique_ptr<SyncComponent> CreateLipSyncComponentFromAudio(const AudioComponent &audio, const PhonemeMap &phonemeMap, std::vector<alignment_result> *optRawResults = nullptr);
+
+// Generates lip sync data for a batch of clips, using up to workerCount threads. The results are in the same
+// order as the clips.
+std::vector<std::unique_ptr<SyncComponent>> CreateLipSyncComponentsFromAudio(const std::vector<const AudioComponent*> &audios, const PhonemeMap &phonemeMap, unsigned int workerCount);
+
+struct LipSyncBatchStats
+{
+    size_t ClipCount;
+    uint64_t AudioMilliseconds;
+    uint64_t ElapsedMilliseconds;
+};
+
+// Generates lip sync data for every audio resource in the game, one audio map at a time. onClipDone is called
+// on the calling thread, in order, with each audio resource and its lip sync data.
+LipSyncBatchStats CreateLipSyncComponentsForGame(const GameFolderHelper &helper, const PhonemeMap &phonemeMap, unsigned int workerCount, std::function<void(const ResourceBlob &, std::unique_ptr<SyncComponent>)> onClipDone);
@@ -49,7 +49,6 @@
 #include "View.h"
 #include "NewRasterResourceDocument.h"
 #include "Task.h"
-#include "crc.h"
 #include "ResourceSources.h"
 #include "ResourceMapOperations.h"
 #include "AudioProcessingSettings.h"
@@ -57,6 +56,8 @@
 #include "SyntaxParser.h"
 #include "ImageUtil.h"
 #include "DependencyTracker.h"
+#include "ParsedScriptCache.h"
+#include "SCOCache.h"
 
 // The one and only
 extern AppState *appState;
@@ -145,8 +146,6 @@ AppState::AppState(CWinApp *pApp) : _resourceMap(this, &_resourceRecency)
     _pACThread = new AutoCompleteThread2();
     _pHoverTipScheduler = std::make_unique<BackgroundScheduler<HoverTipPayload, HoverTipResponse>>();
 
-    crcInit();
-
     // Prepare g_egaColorsExtended
     for (int i = 0; i < 256; i += 16)
     {
@@ -582,6 +581,8 @@ void AppState::GenerateBrowseInfo()
 void AppState::ResetClassBrowser()
 {
     GetClassBrowser().ExitSchedulerAndReset();
+    ClearParsedScriptCache();
+    ClearSCOCache();
 }
 
 BOOL CALLBACK InvalidateChildProc(HWND hwnd, LPARAM lParam)
@@ -15,7 +15,7 @@
 #include "AudioPlayback.h"
 #include "Audio.h"
 
-AudioPlayback::AudioPlayback() : hWaveOut(nullptr), waveHeader()
+AudioPlayback::AudioPlayback() : hWaveOut(nullptr), waveHeaders(), _queued(), _nextReadPosition(0), _nextBuffer(0), _sound(nullptr)
 {
 
 }
@@ -29,25 +29,34 @@ void AudioPlayback::Cleanup()
 {
     if (hWaveOut)
     {
-        waveOutUnprepareHeader(hWaveOut, &waveHeader, sizeof(waveHeader));
-        // Now we can free our data. TODO
+        // Reset returns all the buffers to us, so they can be unprepared.
         waveOutReset(hWaveOut);
+        for (int i = 0; i < StreamBufferCount; i++)
+        {
+            if (_queued[i])
+            {
+                waveOutUnprepareHeader(hWaveOut, &waveHeaders[i], sizeof(waveHeaders[i]));
+                _queued[i] = false;
+            }
+        }
         waveOutClose(hWaveOut);
         hWaveOut = nullptr;
-        memset(&waveHeader, 0, sizeof(waveHeader)); // Just for good measure
+        memset(waveHeaders, 0, sizeof(waveHeaders)); // Just for good measure
     }
+    _nextReadPosition = 0;
+    _nextBuffer = 0;
 }
 
 DWORD AudioPlayback::QueryPosition(DWORD scope)
 {
     DWORD pos = 0;
-    if (hWaveOut && _sound)
+    if (hWaveOut && _sound && (_sound->GetLength() > 0))
     {
         MMTIME mmTime = {};
         mmTime.wType = TIME_BYTES;
         if (MMSYSERR_NOERROR == waveOutGetPosition(hWaveOut, &mmTime, sizeof(mmTime)))
         {
-            pos = (scope * mmTime.u.cb / _sound->DigitalSamplePCM.size());
+            pos = (DWORD)((uint64_t)scope * mmTime.u.cb / _sound->GetLength());
         }
     }
     return pos;
@@ -79,12 +88,63 @@ bool AudioPlayback::IsPlaying()
     return hWaveOut != nullptr;
 }
 
+bool AudioPlayback::_QueueBuffer(int index)
+{
+    uint32_t remaining = _sound->GetLength() - _nextReadPosition;
+    if (remaining == 0)
+    {
+        return false;
+    }
+
+    // Keep to whole samples, and start each read on a DPCM checkpoint so it doesn't need to decode from
+    // the previous one.
+    static_assert((StreamBufferSize % (DPCMSampleSource::DPCMBlockSize * 2)) == 0, "Stream buffers should be whole DPCM blocks.");
+    uint32_t size = min(remaining, StreamBufferSize);
+    std::vector<uint8_t> &buffer = _buffers[index];
+    buffer.resize(size);
+    _sound->ReadPCM(_nextReadPosition, &buffer[0], size);
+    _nextReadPosition += size;
+
+    WAVEHDR &waveHeader = waveHeaders[index];
+    memset(&waveHeader, 0, sizeof(waveHeader));
+    waveHeader.lpData = reinterpret_cast<LPSTR>(&buffer[0]);
+    waveHeader.dwBufferLength = size;
+    MMRESULT result = waveOutPrepareHeader(hWaveOut, &waveHeader, sizeof(waveHeader));
+    if (result == MMSYSERR_NOERROR)
+    {
+        _queued[index] = true;
+        result = waveOutWrite(hWaveOut, &waveHeader, sizeof(waveHeader));
+    }
+    return (result == MMSYSERR_NOERROR);
+}
+
 void AudioPlayback::IdleUpdate()
 {
     if (hWaveOut)
     {
-        // If we're finished playing, then close
-        if (waveHeader.dwFlags & WHDR_DONE)
+        // Refill any buffers that have finished playing, in the order they were played, so the device always
+        // has the following audio queued up behind what it is playing. If they're all done, then close.
+        for (int i = 0; i < StreamBufferCount; i++)
+        {
+            int index = _nextBuffer;
+            if (_queued[index])
+            {
+                if (!(waveHeaders[index].dwFlags & WHDR_DONE))
+                {
+                    break;
+                }
+                waveOutUnprepareHeader(hWaveOut, &waveHeaders[index], sizeof(waveHeaders[index]));
+                _queued[index] = false;
+                _QueueBuffer(index);
+            }
+            _nextBuffer = (_nextBuffer + 1) % StreamBufferCount;
+        }
+        bool anyPlaying = false;
+        for (int i = 0; i < StreamBufferCount; i++)
+        {
+            anyPlaying = anyPlaying || _queued[i];
+        }
+        if (!anyPlaying)
         {
             Cleanup();
         }
@@ -101,18 +161,15 @@ void AudioPlayback::Play(int slowDown)
     if (hWaveOut)
     {
         // If we're finished playing, then close
-        if (waveHeader.dwFlags & WHDR_DONE)
-        {
-            Cleanup();
-        }
-        else
+        IdleUpdate();
+        if (hWaveOut)
         {
             // We're busy.
             return;
         }
     }
 
-    if (_sound && !_sound->DigitalSamplePCM.empty())
+    if (_sound && (_sound->GetLength() > 0))
     {
         uint16_t freq = _sound->Frequency;
         freq /= slowDown;
@@ -132,14 +189,15 @@ void AudioPlayback::Play(int slowDown)
         MMRESULT result = waveOutOpen(&hWaveOut, WAVE_MAPPER, &waveFormat, 0, 0, CALLBACK_NULL);
         if (result == MMSYSERR_NOERROR)
         {
-            waveHeader.lpData = const_cast<LPSTR>(reinterpret_cast<const char*>(&_sound->DigitalSamplePCM[0]));
-            waveHeader.dwBufferLength = _sound->DigitalSamplePCM.size();
-            waveHeader.dwLoops = 10;
-            result = waveOutPrepareHeader(hWaveOut, &waveHeader, sizeof(waveHeader));
-            if (result == MMSYSERR_NOERROR)
+            _nextReadPosition = 0;
+            _nextBuffer = 0;
+            for (int i = 0; i < StreamBufferCount; i++)
             {
-                result = waveOutWrite(hWaveOut, &waveHeader, sizeof(waveHeader));
+                if (!_QueueBuffer(i))
+                {
+                    break;
+                }
             }
         }
     }
-}
\ No newline at end of file
+}
@@ -31,9 +31,20 @@ public:
     uint32_t QueryStreamPosition();
 
 private:
+    // Audio is streamed to the device through a small ring of buffers, so that compressed audio
+    // only needs to be decoded as it is played.
+    static const int StreamBufferCount = 4;
+    // A whole number of DPCM blocks, so each read starts at a checkpoint.
+    static const uint32_t StreamBufferSize = 32768;
+
     void Cleanup();
+    bool _QueueBuffer(int index);
 
     HWAVEOUT hWaveOut;
-    WAVEHDR waveHeader;
+    WAVEHDR waveHeaders[StreamBufferCount];
+    bool _queued[StreamBufferCount];
+    std::vector<uint8_t> _buffers[StreamBufferCount];
+    uint32_t _nextReadPosition;
+    int _nextBuffer; // The buffer that will finish playing next.
     const AudioComponent *_sound;
 };
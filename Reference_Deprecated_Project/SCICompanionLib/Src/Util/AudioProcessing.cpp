@@ -243,6 +243,7 @@ bool ApplyNoiseGate(float *buffer, int totalFloats, float sampleRate, const Audi
 
 void ProcessSound(const AudioNegativeComponent &negative, AudioComponent &audioFinal, AudioFlags finalFlags)
 {
+    audioFinal.DiscardEncodedSource();
     audioFinal.DigitalSamplePCM.clear();
     audioFinal.Frequency = negative.Audio.Frequency;
     audioFinal.Flags = finalFlags;
@@ -58,6 +58,7 @@ void AudioRecording::Cleanup(AudioComponent *audio, AudioNegativeComponent *audi
 
                     audio->Flags = _finalFormatFlags;
                     audio->Frequency = _recordingFreq;
+                    audio->DiscardEncodedSource();
                     audio->DigitalSamplePCM.clear();
 
                     audioNeg->Audio.ScanForClipped();
@@ -28,6 +28,8 @@
 #include "CrystalScriptStream.h"
 #include "ResourceBlob.h"
 #include "DependencyTracker.h"
+#include "GameSnapshot.h"
+#include "ParallelFor.h"
 
 using namespace sci;
 using namespace std;
@@ -205,6 +207,12 @@ void SCIClassBrowser::ExitSchedulerAndReset()
 
     _customHeaderMap.clear();
 
+    _aclist.Clear();
+    _invalidAutoCompleteSources = AutoCompleteSourceType::None;
+    // So that they're added back to _aclist when they're next loaded.
+    _kernelNamesResource = KernelTable();
+    _selectorNames = SelectorTable();
+
     // Make a new one.
     _scheduler = std::make_unique<BackgroundScheduler<ReloadScriptPayload>>();
 }
@@ -326,21 +334,66 @@ void SCIClassBrowser::_AddToClassTree(Script& script)
         }
     }
 
-    _invalidAutoCompleteSources = AutoCompleteSourceType::ScriptName | AutoCompleteSourceType::ClassName | AutoCompleteSourceType::Procedure;
+    _UpdateScriptAutoComplete(script);
+    // Globals come from the main script, and the syntax highlighting lists need to be refreshed.
+    _invalidAutoCompleteSources |= AutoCompleteSourceType::ClassName | AutoCompleteSourceType::Procedure | AutoCompleteSourceType::Variable;
+}
+
+//
+// Updates the autocomplete tokens that come from this script: its name, classes and public procedures.
+//
+void SCIClassBrowser::_UpdateScriptAutoComplete(Script &script)
+{
+    std::vector<ACTreeLeaf> items;
+    items.emplace_back(AutoCompleteSourceType::ScriptName, script.GetTitle());
+    for (auto &theClass : script.GetClasses())
+    {
+        if (!theClass->IsInstance())
+        {
+            items.emplace_back(AutoCompleteSourceType::ClassName, theClass->GetName());
+        }
+        // Superclasses are in the class tree even if we haven't seen their definition.
+        if (!theClass->GetSuperClass().empty())
+        {
+            items.emplace_back(AutoCompleteSourceType::ClassName, theClass->GetSuperClass());
+        }
+    }
+    for (auto &proc : script.GetProcedures())
+    {
+        if (proc->IsPublic())
+        {
+            items.emplace_back(AutoCompleteSourceType::Procedure, proc->GetName());
+        }
+    }
+    _aclist.SetTokens(script.GetPath(), move(items));
 }
 
 bool SCIClassBrowser::ReLoadFromSources(ITaskStatus &task)
 {
-    std::lock_guard<std::recursive_mutex> lock(_mutexClassBrowser);
     if (IsBrowseInfoEnabled())
     {
-        // Load the kernel and selector names
-        _kernelNamesResource.Load(appState->GetResourceMap().Helper());
-        _selectorNames.Load(appState->GetResourceMap().Helper());
+        // Everything is loaded and parsed without holding the lock, and then added all at once. That way
+        // the UI isn't locked out of the class browser while we parse the whole game.
+        // The kernel and selector names come from the resource map's snapshot, which is safe to use from here.
+        std::shared_ptr<const GameSnapshot> snapshot = appState->GetResourceMap().GetSnapshot();
 
         // Add headers first, since they have defines that are needed by the other scripts.
-        _AddHeaders();
+        script_map headers;
+        _LoadHeaders(headers);
+        {
+            std::lock_guard<std::recursive_mutex> lock(_mutexClassBrowser);
+            _SetKernelAndSelectorNames(snapshot->GetKernelTable(), snapshot->GetSelectorTable());
+            for (auto &header : headers)
+            {
+                _headerMap[header.first] = move(header.second);
+            }
+            // Make all the header defines accessible in a classMap.
+            _CacheHeaderDefines();
+        }
+
         bool fRet = _CreateClassTree(task);
+
+        std::lock_guard<std::recursive_mutex> lock(_mutexClassBrowser);
         _MaybeGenerateAutoCompleteTree();
         return fRet;
     }
@@ -445,13 +498,13 @@ void SCIClassBrowser::ReLoadFromCompiled(ITaskStatus &task)
         return;
     }
 
+    std::shared_ptr<const GameSnapshot> snapshot = appState->GetResourceMap().GetSnapshot();
     std::lock_guard<std::recursive_mutex> lock(_mutexClassBrowser); 
 
-#ifdef REENABLE_COMPILEDSCRIPTS
-
     // Load the kernel and selector names
-    _kernelNamesResource.Load(appState->GetResourceMap().Helper());
-    _selectorNames.Load(appState->GetResourceMap().Helper());
+    _SetKernelAndSelectorNames(snapshot->GetKernelTable(), snapshot->GetSelectorTable());
+
+#ifdef REENABLE_COMPILEDSCRIPTS
 
     GlobalClassTable classTable;
     if (!classTable.Load(appState->GetResourceMap().Helper()))
@@ -614,6 +667,46 @@ void SCIClassBrowser::ReLoadFromCompiled(ITaskStatus &task)
         _pEvents->NotifyClassBrowserStatus(HasErrors() ? IClassBrowserEvents::Errors : IClassBrowserEvents::Ok, 0);
     }
 #endif
+
+    _MaybeGenerateAutoCompleteTree();
+}
+
+void SCIClassBrowser::ReloadKernelAndSelectorNames()
+{
+    if (IsBrowseInfoEnabled())
+    {
+        std::shared_ptr<const GameSnapshot> snapshot = appState->GetResourceMap().GetSnapshot();
+        std::lock_guard<std::recursive_mutex> lock(_mutexClassBrowser);
+        _SetKernelAndSelectorNames(snapshot->GetKernelTable(), snapshot->GetSelectorTable());
+        _MaybeGenerateAutoCompleteTree();
+    }
+}
+
+void SCIClassBrowser::TriggerReloadKernelAndSelectorNames()
+{
+    _scheduler->SubmitTask(
+        std::make_unique<ReloadScriptPayload>(*this, ""),
+        [](ITaskStatus &status, ReloadScriptPayload &payload)
+    {
+        payload.Browser.ReloadKernelAndSelectorNames();
+        return nullptr;
+    }
+        );
+}
+
+// Must be called within the lock. The autocomplete tokens are only regenerated if the names changed.
+void SCIClassBrowser::_SetKernelAndSelectorNames(const KernelTable &kernelNames, const SelectorTable &selectorNames)
+{
+    if (_kernelNamesResource.GetNames() != kernelNames.GetNames())
+    {
+        _kernelNamesResource = kernelNames;
+        _invalidAutoCompleteSources |= AutoCompleteSourceType::Kernel;
+    }
+    if (_selectorNames.GetNames() != selectorNames.GetNames())
+    {
+        _selectorNames = selectorNames;
+        _invalidAutoCompleteSources |= AutoCompleteSourceType::Selector;
+    }
 }
 
 void SCIClassBrowser::TriggerReloadScript(const std::string &fullPath)
@@ -634,22 +727,29 @@ void SCIClassBrowser::TriggerReloadScript(const std::string &fullPath)
 void SCIClassBrowser::ReloadScript(const std::string &fullPath)
 {
     ClearErrors();
-    std::lock_guard<std::recursive_mutex> lock(_mutexClassBrowser); 
     if (!IsBrowseInfoEnabled())
     {
         return;
     }
+
+    // Parse it before taking the lock, so we only hold it while swapping in the new script.
+    unique_ptr<Script> pScript = _LoadScript(fullPath.c_str());
+
+    std::lock_guard<std::recursive_mutex> lock(_mutexClassBrowser); 
     if (StrRStrI(PathFindFileName(fullPath.c_str()), nullptr, TEXT(".sh")))
     {
         // It's a header file
-        _AddHeader(fullPath.c_str());
+        if (pScript)
+        {
+            _headerMap[fullPath] = move(pScript);
+        }
         // Regenerate the defines cache
         _CacheHeaderDefines();
     }
     else
     {
         // It's a regular one.
-        _AddFileName(fullPath, true);
+        _AddScript(fullPath, move(pScript), true);
 
         if (_pEvents)
         {
@@ -665,6 +765,8 @@ void SCIClassBrowser::ReloadScript(const std::string &fullPath)
 //
 void SCIClassBrowser::_RemoveAllRelatedData(Script *pScript)
 {
+    _aclist.RemoveTokens(pScript->GetPath());
+
     // Remove stuff from this script's key in the instance classMap.
     instance_map::iterator instanceIt = _instanceMap.find(GetScriptNumberHelper(pScript));
     if (instanceIt != _instanceMap.end())
@@ -739,67 +841,62 @@ void SCIClassBrowser::_RemoveAllRelatedData(Script *pScript)
     _fPublicClassesValid = false;
 }
 
-bool SCIClassBrowser::_AddFileName(std::string fullPath, bool fReplace)
+//
+// Adds a script that was parsed with _LoadScript (which might have failed, in which case pScript is null).
+//
+bool SCIClassBrowser::_AddScript(std::string fullPath, std::unique_ptr<sci::Script> pScript, bool fReplace)
 {
     _pLKGScript = nullptr; // Clear cache.  Possible optimization: check LKG number, and if this is the same, then set _pLKGScript to this one.
 
     bool fRet = false;
-    CCrystalTextBuffer buffer;
-    if (buffer.LoadFromFile(fullPath.c_str()))
+    // "normalize" it before we use it as a key.
+    std::string fullPathLower = fullPath;
+    std::transform(fullPathLower.begin(), fullPathLower.end(), fullPathLower.begin(), ::tolower);
+
+    if (pScript)
     {
-        // "normalize" it before we use it as a key.
-        std::string fullPathLower = fullPath;
-        std::transform(fullPathLower.begin(), fullPathLower.end(), fullPathLower.begin(), ::tolower);
+        Script *pWeakRef = pScript.get();
 
-        CScriptStreamLimiter limiter(&buffer);
-        CCrystalScriptStream stream(&limiter);
-        std::unique_ptr<Script> pScript = std::make_unique<Script>(fullPath.c_str());
-        if (SyntaxParser_Parse(*pScript, stream, PreProcessorDefinesFromSCIVersion(appState->GetVersion()), this))
+        bool fAdded = false;
+        if (fReplace)
         {
-            Script *pWeakRef = pScript.get();
+            WORD wScriptNumber = GetScriptNumberHelper(pScript.get());
+            _filenameToScriptNumber[fullPathLower] = wScriptNumber;
 
-            bool fAdded = false;
-            if (fReplace)
+            if (wScriptNumber != InvalidResourceNumber)
             {
-                WORD wScriptNumber = GetScriptNumberHelper(pScript.get());
-                _filenameToScriptNumber[fullPathLower] = wScriptNumber;
-
-                if (wScriptNumber != InvalidResourceNumber)
+                // Find matching script number and replace
+                for (auto &script : _scripts)
                 {
-                    // Find matching script number and replace
-                    for (auto &script : _scripts)
+                    if (GetScriptNumberHelper(script.get()) == wScriptNumber)
                     {
-                        if (GetScriptNumberHelper(script.get()) == wScriptNumber)
-                        {
-                            _RemoveAllRelatedData(script.get());
-                            fAdded = true;
-                            // Replace
-                            script = std::move(pScript); // Take ownership.
-                        }
+                        _RemoveAllRelatedData(script.get());
+                        fAdded = true;
+                        // Replace
+                        script = std::move(pScript); // Take ownership.
                     }
                 }
-                else
-                {
-                    // This can happen if the script number define can't be resolved
-                    fAdded = true;
-                }
             }
             else
             {
-                WORD wScriptNumber = GetScriptNumberHelper(pScript.get());
-                _filenameToScriptNumber[fullPathLower] = wScriptNumber;
+                // This can happen if the script number define can't be resolved
+                fAdded = true;
             }
+        }
+        else
+        {
+            WORD wScriptNumber = GetScriptNumberHelper(pScript.get());
+            _filenameToScriptNumber[fullPathLower] = wScriptNumber;
+        }
 
-            _dependencyTracker.ProcessScript(*pWeakRef);
+        _dependencyTracker.ProcessScript(*pWeakRef);
 
-            _AddToClassTree(*pWeakRef);
-            if (!fAdded)
-            {
-                _scripts.push_back(std::move(pScript)); // Takes ownership
-            }
-            fRet = true;
+        _AddToClassTree(*pWeakRef);
+        if (!fAdded)
+        {
+            _scripts.push_back(std::move(pScript)); // Takes ownership
         }
-        buffer.FreeAll();
+        fRet = true;
     }
 
     _AssertScriptsValid();
@@ -815,73 +912,87 @@ void SCIClassBrowser::_AssertScriptsValid()
     }
 }
 
+// Owners in the autocomplete token database for things that don't come from a particular script.
+// These can't collide with script paths.
+const char c_ownerHeaderDefines[] = "*defines";
+const char c_ownerSelectors[] = "*selectors";
+const char c_ownerKernels[] = "*kernels";
+const char c_ownerGlobals[] = "*globals";
+
 void SCIClassBrowser::_MaybeGenerateAutoCompleteTree()
 {
     if (_invalidAutoCompleteSources != AutoCompleteSourceType::None)
     {
-        CPrecisionTimer timer;
-        timer.Start();
-
-        // Also use this time to update our syntax highlighting things.
-        unordered_set<string> procsSyntaxHighlight;
-        unordered_set<string> classesSyntaxHighlight;
-
-        // REVIEW: If we find this takes too long, we can split things into different _acLists that are updated at different freqs
-        std::vector<ACTreeLeaf> items;
-        items.reserve(4000);
-        for (auto &aDefine : _headerDefines)
+        // Script names, classes and procedures are updated per script as they are loaded, so we
+        // only need to refresh the game-wide sources here.
+        if (IsFlagSet(_invalidAutoCompleteSources, AutoCompleteSourceType::Define))
         {
             // Standard defines in the system and game header files.
-            items.emplace_back(AutoCompleteSourceType::Define, aDefine.first);
-            //AddToTernaryList(items, aDefine.first, AutoCompleteSourceType::Define);
-        }
-        for (auto &aClass : _classMap)
-        {
-            // Updated when new classes created (rare)
-            items.emplace_back(AutoCompleteSourceType::ClassName, aClass.first);
-            classesSyntaxHighlight.insert(aClass.first);
-        }
-        for (auto &selector : _selectorNames.GetNames())
-        {
-            // Updated only when new selectors are created (rare)
-            items.emplace_back(AutoCompleteSourceType::Selector, selector);
+            std::vector<ACTreeLeaf> items;
+            items.reserve(_headerDefines.size());
+            for (auto &aDefine : _headerDefines)
+            {
+                items.emplace_back(AutoCompleteSourceType::Define, aDefine.first);
+            }
+            _aclist.SetTokens(c_ownerHeaderDefines, move(items));
         }
-        for (auto &kernelNames : _kernelNamesResource.GetNames())
+        if (IsFlagSet(_invalidAutoCompleteSources, AutoCompleteSourceType::Selector))
         {
-            items.emplace_back(AutoCompleteSourceType::Kernel, kernelNames);
-            procsSyntaxHighlight.insert(kernelNames);
+            std::vector<ACTreeLeaf> items;
+            for (auto &selector : _selectorNames.GetNames())
+            {
+                items.emplace_back(AutoCompleteSourceType::Selector, selector);
+            }
+            _aclist.SetTokens(c_ownerSelectors, move(items));
         }
-        for (auto &publicProc : _GetPublicProcedures())
+        if (IsFlagSet(_invalidAutoCompleteSources, AutoCompleteSourceType::Kernel))
         {
-            items.emplace_back(AutoCompleteSourceType::Procedure, publicProc->GetName());
-            procsSyntaxHighlight.insert(publicProc->GetName());
+            std::vector<ACTreeLeaf> items;
+            for (auto &kernelName : _kernelNamesResource.GetNames())
+            {
+                items.emplace_back(AutoCompleteSourceType::Kernel, kernelName);
+            }
+            _aclist.SetTokens(c_ownerKernels, move(items));
         }
-        for (auto &script : _scripts)
+        if (IsFlagSet(_invalidAutoCompleteSources, AutoCompleteSourceType::Variable))
         {
-            items.emplace_back(AutoCompleteSourceType::ScriptName, script->GetTitle());
+            // Now some global variables
+            std::vector<ACTreeLeaf> items;
+            const VariableDeclVector *globals = _GetMainGlobals();
+            if (globals)
+            {
+                for (const auto &global : *globals)
+                {
+                    items.emplace_back(AutoCompleteSourceType::Variable, global->GetName());
+                }
+            }
+            _aclist.SetTokens(c_ownerGlobals, move(items));
         }
 
-        // Now some global variables
-        const VariableDeclVector *globals = _GetMainGlobals();
-        if (globals)
+        // Also use this time to update our syntax highlighting things.
+        if (IsFlagSet(_invalidAutoCompleteSources, AutoCompleteSourceType::ClassName | AutoCompleteSourceType::Procedure | AutoCompleteSourceType::Kernel))
         {
-            for (const auto &global : *globals)
+            unordered_set<string> procsSyntaxHighlight;
+            unordered_set<string> classesSyntaxHighlight;
+            for (auto &aClass : _classMap)
             {
-                items.emplace_back(AutoCompleteSourceType::Variable, global->GetName());
+                classesSyntaxHighlight.insert(aClass.first);
+            }
+            for (auto &kernelName : _kernelNamesResource.GetNames())
+            {
+                procsSyntaxHighlight.insert(kernelName);
+            }
+            for (auto &publicProc : _GetPublicProcedures())
+            {
+                procsSyntaxHighlight.insert(publicProc->GetName());
             }
-        }
-
-        std::multiset<ACTreeLeaf> itemsSorted;
-        std::copy(items.begin(), items.end(), std::inserter(itemsSorted, itemsSorted.begin()));
-        _aclist.BuildDatabase(itemsSorted);
-
-        _invalidAutoCompleteSources = AutoCompleteSourceType::None;
 
-        {
             std::lock_guard<std::mutex> lock(_mutexSyntaxHighlight);
             std::swap(procsSyntaxHighlight, _procsSyntaxHighlight);
             std::swap(classesSyntaxHighlight, _classesSyntaxHighlight);
         }
+
+        _invalidAutoCompleteSources = AutoCompleteSourceType::None;
     }
 }
 
@@ -1014,24 +1125,38 @@ bool SCIClassBrowser::_CreateClassTree(ITaskStatus &task)
     std::vector<ScriptId> scripts;
     appState->GetResourceMap().GetAllScripts(scripts);
     bool fRet = false;
-    std::vector<ScriptId>::iterator scriptIt = scripts.begin();
     int cItems = (int)scripts.size();
-    int iItem = 0;
-    bool fAborted = false;
-    while ((scriptIt != scripts.end()) && !fAborted)
+
+    // Parsing is the slow part, and it doesn't need the lock, so parse the scripts on several threads.
+    std::vector<std::unique_ptr<Script>> parsedScripts(scripts.size());
+    ParallelFor(scripts.size(), std::thread::hardware_concurrency(),
+        [&](size_t index)
+    {
+        if (!task.IsAborted())
+        {
+            parsedScripts[index] = _LoadScript(scripts[index].GetFullPath().c_str());
+        }
+    },
+        [&](size_t index)
     {
         if (_pEvents)
         {
-            _pEvents->NotifyClassBrowserStatus(IClassBrowserEvents::InProgress, 100 * iItem / cItems);
+            _pEvents->NotifyClassBrowserStatus(IClassBrowserEvents::InProgress, 100 * (int)(index + 1) / cItems);
         }
-        if (_AddFileName(scriptIt->GetFullPath()))
+    }
+        );
+
+    // Now add them in order.
+    {
+        std::lock_guard<std::recursive_mutex> lock(_mutexClassBrowser);
+        for (size_t i = 0; (i < scripts.size()) && !task.IsAborted(); i++)
         {
-            // As long as we find one script, we consider it a success and don't fallback to compiled sources.
-            fRet = true;
+            if (_AddScript(scripts[i].GetFullPath(), move(parsedScripts[i])))
+            {
+                // As long as we find one script, we consider it a success and don't fallback to compiled sources.
+                fRet = true;
+            }
         }
-        ++scriptIt;
-        ++iItem;
-        fAborted = task.IsAborted();
     }
 
     if (_pEvents)
@@ -1074,17 +1199,17 @@ std::unique_ptr<sci::Script> SCIClassBrowser::_LoadScript(PCTSTR pszPath)
     return pScript;
 }
 
-void SCIClassBrowser::_AddHeader(PCTSTR pszHeaderPath)
+void SCIClassBrowser::_LoadHeader(PCTSTR pszHeaderPath, script_map &headers)
 {
     unique_ptr<Script> pScript = _LoadScript(pszHeaderPath);
     if (pScript)
     {
-        _headerMap[pszHeaderPath] = move(pScript);
+        headers[pszHeaderPath] = move(pScript);
     }
 }
 
 
-void SCIClassBrowser::_AddHeaders()
+void SCIClassBrowser::_LoadHeaders(script_map &headers)
 {
     // REVIEW: ideally we'll want to include any new headers the user has made, by analyzing the
     // include statements in the scripts.  For now, we'll just hard-code 3 scripts:
@@ -1093,16 +1218,16 @@ void SCIClassBrowser::_AddHeaders()
     TCHAR szHeaderPath[MAX_PATH];
     if (SUCCEEDED(StringCchPrintf(szHeaderPath, ARRAYSIZE(szHeaderPath), TEXT("%s\\game.sh"), appState->GetResourceMap().Helper().GetSrcFolder().c_str())))
     {
-        _AddHeader(szHeaderPath);
+        _LoadHeader(szHeaderPath, headers);
     }
     // SCI1.1 games have Verbs.sh and Talkers.sh
     if (SUCCEEDED(StringCchPrintf(szHeaderPath, ARRAYSIZE(szHeaderPath), TEXT("%s\\Verbs.sh"), appState->GetResourceMap().Helper().GetSrcFolder().c_str())))
     {
-        _AddHeader(szHeaderPath);
+        _LoadHeader(szHeaderPath, headers);
     }
     if (SUCCEEDED(StringCchPrintf(szHeaderPath, ARRAYSIZE(szHeaderPath), TEXT("%s\\Talkers.sh"), appState->GetResourceMap().Helper().GetSrcFolder().c_str())))
     {
-        _AddHeader(szHeaderPath);
+        _LoadHeader(szHeaderPath, headers);
     }
 
     // sci.sh
@@ -1112,16 +1237,13 @@ void SCIClassBrowser::_AddHeaders()
         TCHAR szHeaderPath[MAX_PATH];
         if (SUCCEEDED(StringCchPrintf(szHeaderPath, ARRAYSIZE(szHeaderPath), TEXT("%s\\sci.sh"), includeFolder.c_str())))
         {
-            _AddHeader(szHeaderPath);
+            _LoadHeader(szHeaderPath, headers);
         }
         if (SUCCEEDED(StringCchPrintf(szHeaderPath, ARRAYSIZE(szHeaderPath), TEXT("%s\\keys.sh"), includeFolder.c_str())))
         {
-            _AddHeader(szHeaderPath);
+            _LoadHeader(szHeaderPath, headers);
         }
     }
-
-    // Make all the header defines accessible in a classMap.
-    _CacheHeaderDefines();
 }
 
 //
@@ -79,6 +79,9 @@ public:
     void ReLoadFromCompiled(ITaskStatus &task);
     void ReloadScript(const std::string &fullPath);
     void TriggerReloadScript(const std::string &fullPath);
+    // Picks up kernel and selector names that were added since the game was loaded (e.g. by compiling).
+    void ReloadKernelAndSelectorNames();
+    void TriggerReloadKernelAndSelectorNames();
 
     // The remaining public functions should only be called if within a lock, as they return
     // information internal to this class.
@@ -140,13 +143,15 @@ private:
     void _AssertScriptsValid();
     bool _CreateClassTree(ITaskStatus &task);
     void _AddToClassTree(sci::Script& script);
-    bool _AddFileName(std::string fullPath, bool fReplace = false);
+    void _UpdateScriptAutoComplete(sci::Script &script);
+    bool _AddScript(std::string fullPath, std::unique_ptr<sci::Script> pScript, bool fReplace = false);
     void _RemoveAllRelatedData(sci::Script *pScript);
-    void _AddHeaders();
-    void _AddHeader(PCTSTR pszHeaderPath);
+    void _LoadHeaders(script_map &headers);
+    void _LoadHeader(PCTSTR pszHeaderPath, script_map &headers);
     void _CacheHeaderDefines();
     void _AddInstanceToMap(sci::Script& script, sci::ClassDefinition *pClass);
     void _AddSubclassesToArray(std::vector<std::string> &pArray, SCIClassBrowserNode *pBrowserInfo);
+    void _SetKernelAndSelectorNames(const KernelTable &kernelNames, const SelectorTable &selectorNames);
     void _MaybeGenerateAutoCompleteTree();
     const std::vector<sci::ProcedureDefinition*> &_GetPublicProcedures();
     const std::vector<std::unique_ptr<sci::VariableDecl>> *_GetMainGlobals() const;
@@ -19,6 +19,9 @@
 #include "SyntaxContext.h"
 #include "CodeAutoComplete.h"
 #include "AppState.h"
+#include "ResourceMap.h"
+#include "GameSnapshot.h"
+#include "Vocab000.h"
 #include "format.h"
 
 using namespace sci;
@@ -74,6 +77,9 @@ void MergeResults(std::vector<AutoCompleteChoice> &existingResults, const std::s
         [](const std::string text) { return text; });
 }
 
+// Some vocabs have thousands of words, so don't list them all for a one letter prefix.
+const size_t MaxSaidCompletions = 200;
+
 std::unique_ptr<AutoCompleteResult> GetAutoCompleteResult(const std::string &prefixIn, uint16_t scriptNumber, SyntaxContext &context, std::unordered_set<std::string> &parsedCustomHeaders)
 {
     // Use the scriptNumber provided instead of that in the SyntaxContext's script, because we may not have reached the scriptNumber declaration in the script yet.
@@ -346,6 +352,18 @@ std::unique_ptr<AutoCompleteResult> GetAutoCompleteResult(const std::string &pre
         {
             MergeResults(result->choices, prefix, AutoCompleteIconIndex::Keyword, { "scriptNumber" });
         }
+        if (containsV(acContexts, ParseAutoCompleteContext::SaidString))
+        {
+            // We're on a background thread, so use a snapshot of the vocab.
+            std::shared_ptr<const GameSnapshot> snapshot = appState->GetResourceMap().GetSnapshot();
+            const Vocab000 *vocab = snapshot->GetVocab000();
+            if (vocab)
+            {
+                std::vector<std::string> words;
+                vocab->GetCompletions(prefix, words, MaxSaidCompletions);
+                MergeResults(result->choices, prefix, AutoCompleteIconIndex::Keyword, words);
+            }
+        }
 
         LangSyntax lang = context.Script().Language();
         if (containsV(acContexts, ParseAutoCompleteContext::TopLevelKeyword))
@@ -376,7 +394,7 @@ std::unique_ptr<AutoCompleteResult> GetAutoCompleteResult(const std::string &pre
     }
     return result;
 }
-AutoCompleteThread2::AutoCompleteThread2() : _nextId(0), _instruction(AutoCompleteInstruction::None), _bgStatus(AutoCompleteStatus::Pending), _lang(LangSyntaxUnknown), _bufferUI(nullptr)
+AutoCompleteThread2::AutoCompleteThread2() : _nextId(0), _instruction(AutoCompleteInstruction::None), _bgStatus(AutoCompleteStatus::Pending), _lang(LangSyntaxUnknown), _bufferUI(nullptr), _lowestChangedLine(0)
 {
     _thread = std::thread(s_ThreadWorker, this);
 }
@@ -393,12 +411,40 @@ AutoCompleteThread2::~AutoCompleteThread2()
 
 void AutoCompleteThread2::InitializeForScript(CCrystalTextBuffer *buffer, LangSyntax lang)
 {
+    if ((_bufferUI != buffer) || (_lang != lang))
+    {
+        // Checkpoints are only meaningful for the buffer they came from.
+        std::lock_guard<std::mutex> lock(_mutex);
+        _checkpoints.clear();
+        _lowestChangedLine = 0;
+    }
     _bufferUI = buffer;
     _lang = lang;
 
     // TODO: Cancel any parsing? Or I guess it really doesn't matter. Except that if a script is closed, we want to know, so we don't send message to non-existent hwnd.
 }
 
+void AutoCompleteThread2::OnTextChanged(CCrystalTextBuffer *buffer, int nLineIndex)
+{
+    if (buffer == _bufferUI)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (nLineIndex < 0)
+        {
+            _checkpoints.clear();
+            _lowestChangedLine = 0;
+        }
+        else
+        {
+            // Anything that ends at or after the changed line might not be valid anymore.
+            _checkpoints.erase(
+                std::find_if(_checkpoints.begin(), _checkpoints.end(), [nLineIndex](const ParseCheckpoint &checkpoint) { return checkpoint.Position.Line() >= nLineIndex; }),
+                _checkpoints.end());
+            _lowestChangedLine = min(_lowestChangedLine, nLineIndex);
+        }
+    }
+}
+
 #define EXTRA_AC_CHARS 100
 
 void AutoCompleteThread2::StartAutoComplete(CPoint pt, HWND hwnd, UINT message, uint16_t scriptNumber)
@@ -439,6 +485,14 @@ void AutoCompleteThread2::StartAutoComplete(CPoint pt, HWND hwnd, UINT message,
         // Give the work to the background thread
         {
             std::lock_guard<std::mutex> lock(_mutex);
+            // Rather than parsing from the top of the script, start from the last complete
+            // top-level form before the cursor, if we know of one.
+            LineCol limit(pt.y, pt.x);
+            auto itCheckpoint = std::find_if(_checkpoints.rbegin(), _checkpoints.rend(), [&limit](const ParseCheckpoint &checkpoint) { return checkpoint.Position < limit; });
+            _checkpointPending.reset((itCheckpoint != _checkpoints.rend()) ? new ParseCheckpoint(*itCheckpoint) : nullptr);
+            // The text was just captured, so nothing has changed yet as far as this parse is concerned.
+            _lowestChangedLine = INT_MAX;
+
             _additionalCharacters.clear();
             _limiterPending = move(limiter);
             _streamPending = move(stream);
@@ -467,6 +521,7 @@ void AutoCompleteThread2::ResetPosition()
 
         _limiterPending.reset(nullptr);
         _streamPending.reset(nullptr);
+        _checkpointPending.reset(nullptr);
         _id.hwnd = nullptr;
         _id.id = -1;
         _additionalCharacters = "";
@@ -511,6 +566,28 @@ void AutoCompleteThread2::_SetResult(std::unique_ptr<AutoCompleteResult> result,
     SendMessage(id.hwnd, id.message, id.id, 0);
 }
 
+// Called with _mutex held.
+void AutoCompleteThread2::_PublishCheckpoints(std::vector<ParseCheckpoint> &checkpoints, AutoCompleteThread2::AutoCompleteId id)
+{
+    // If another parse has been requested since, the text may have moved on from what we parsed.
+    if (id.id == _id.id)
+    {
+        for (ParseCheckpoint &checkpoint : checkpoints)
+        {
+            if (checkpoint.Position.Line() < _lowestChangedLine)
+            {
+                auto itInsert = std::lower_bound(_checkpoints.begin(), _checkpoints.end(), checkpoint,
+                    [](const ParseCheckpoint &a, const ParseCheckpoint &b) { return a.Position < b.Position; });
+                if ((itInsert == _checkpoints.end()) || (checkpoint.Position < itInsert->Position))
+                {
+                    _checkpoints.insert(itInsert, move(checkpoint));
+                }
+            }
+        }
+    }
+    checkpoints.clear();
+}
+
 void AutoCompleteThread2::_DoWork()
 {
     while (_instruction != AutoCompleteInstruction::Abort)
@@ -528,6 +605,7 @@ void AutoCompleteThread2::_DoWork()
 
             std::unique_ptr<CScriptStreamLimiter> limiter = move(_limiterPending);
             std::unique_ptr<CCrystalScriptStream> stream = move(_streamPending);
+            std::unique_ptr<ParseCheckpoint> checkpoint = move(_checkpointPending);
             _bgStatus = AutoCompleteStatus::Parsing;
             if (!this->_additionalCharacters.empty())
             {
@@ -551,7 +629,7 @@ void AutoCompleteThread2::_DoWork()
                 class AutoCompleteParseCallback : public ISyntaxParserCallback
                 {
                 public:
-                    AutoCompleteParseCallback(uint16_t scriptNumber, SyntaxContext &context, AutoCompleteThread2 &ac, CScriptStreamLimiter &limiter, AutoCompleteId id) : _context(context), _id(id), _ac(ac), _limiter(limiter), _scriptNumber(scriptNumber) {}
+                    AutoCompleteParseCallback(uint16_t scriptNumber, SyntaxContext &context, AutoCompleteThread2 &ac, CScriptStreamLimiter &limiter, AutoCompleteId id, std::vector<ParseCheckpoint> &checkpoints) : _context(context), _id(id), _ac(ac), _limiter(limiter), _scriptNumber(scriptNumber), _checkpoints(checkpoints) {}
 
                     bool Done()
                     {
@@ -565,6 +643,9 @@ void AutoCompleteThread2::_DoWork()
                         _ac._SetResult(move(result), _id);
 
                         std::unique_lock<std::mutex> lock(_ac._mutex);
+                        // Everything we got through before reaching the cursor can be used as a
+                        // starting point for future parses.
+                        _ac._PublishCheckpoints(_checkpoints, _id);
                         _ac._bgStatus = AutoCompleteStatus::WaitingForMore;
                         _ac._condition.wait(lock, [&]() { return this->_ac._instruction != AutoCompleteInstruction::None; });
                         // There is a small race condition between here....
@@ -598,20 +679,39 @@ void AutoCompleteThread2::_DoWork()
                     AutoCompleteId _id;
                     AutoCompleteThread2 &_ac;
                     CScriptStreamLimiter &_limiter;
+                    std::vector<ParseCheckpoint> &_checkpoints;
                     std::unordered_set<std::string> _parsedCustomHeaders;
                 };
 
                 ScriptId scriptId;
                 scriptId.SetLanguage(_lang);
                 sci::Script script(scriptId);
+                LineCol startPosition;
+                if (checkpoint)
+                {
+                    // Pick up after the last complete top-level form. The script only needs the
+                    // state that autocomplete cares about from what came before.
+                    startPosition = checkpoint->Position;
+                    for (const std::string &include : checkpoint->Includes)
+                    {
+                        script.AddInclude(include);
+                    }
+                    for (const std::string &use : checkpoint->Uses)
+                    {
+                        script.AddUse(use);
+                    }
+                    script.SyntaxVersion = checkpoint->SyntaxVersion;
+                }
                 // Needed to get the language right.
-                CCrystalScriptStream::const_iterator it(limiter.get());
+                CCrystalScriptStream::const_iterator it(limiter.get(), startPosition);
                 SyntaxContext context(it, script, PreProcessorDefinesFromSCIVersion(appState->GetVersion()), false, false);
 #ifdef PARSE_DEBUG
                 context.ParseDebug = true;
 #endif
+                std::vector<ParseCheckpoint> newCheckpoints;
+                context.TopLevelCheckpoints = &newCheckpoints;
 
-                AutoCompleteParseCallback callback(scriptNumber, context, *this, *limiter, id);
+                AutoCompleteParseCallback callback(scriptNumber, context, *this, *limiter, id, newCheckpoints);
                 limiter->SetCallback(&callback);
 
                 bool result = SyntaxParser_ParseAC(script, it, PreProcessorDefinesFromSCIVersion(appState->GetVersion()), &context);
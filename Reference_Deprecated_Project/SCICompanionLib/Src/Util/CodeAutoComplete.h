@@ -17,6 +17,7 @@ class CCrystalScriptStream;
 class CCrystalTextBuffer;
 class CScriptStreamLimiter;
 class SyntaxContext;;
+struct ParseCheckpoint;
 enum class AutoCompleteIconIndex;
 
 class AutoCompleteChoice
@@ -81,6 +82,8 @@ public:
     ~AutoCompleteThread2();
 
     void InitializeForScript(CCrystalTextBuffer *buffer, LangSyntax lang);
+    // Lets us know the text buffer changed at nLineIndex (-1 means everything changed).
+    void OnTextChanged(CCrystalTextBuffer *buffer, int nLineIndex);
     void StartAutoComplete(CPoint pt, HWND hwnd, UINT message, uint16_t scriptNumber);
     std::unique_ptr<AutoCompleteResult> GetResult(int id);
     CPoint GetCompletedPosition();
@@ -117,11 +120,13 @@ private:
     };
 
     void _SetResult(std::unique_ptr<AutoCompleteResult> result, AutoCompleteId id);
+    void _PublishCheckpoints(std::vector<ParseCheckpoint> &checkpoints, AutoCompleteId id);
 
     // Both
     AutoCompleteId _id;
     std::unique_ptr<CScriptStreamLimiter> _limiterPending;
     std::unique_ptr<CCrystalScriptStream> _streamPending;
+    std::unique_ptr<ParseCheckpoint> _checkpointPending;
     uint16_t _scriptNumberPending;
     std::mutex _mutex;
     std::condition_variable _condition;
@@ -131,6 +136,13 @@ private:
     std::string _additionalCharacters;
     int _idUpdate;
 
+    // Places in the current text buffer from which we can resume parsing, instead of starting
+    // from the top of the script. Sorted by position.
+    std::vector<ParseCheckpoint> _checkpoints;
+    // The lowest line changed since the text for the current parse was captured. Checkpoints
+    // from that parse at or after this line are stale.
+    int _lowestChangedLine;
+
     // Both
     std::unique_ptr<AutoCompleteResult> _result;
     int _resultId;
@@ -0,0 +1,123 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "ContentHash.h"
+
+// This is a straightforward scalar implementation of XXH64 (https://github.com/Cyan4973/xxHash).
+// It works on 32 bytes per iteration in four independent lanes, so it is memory bound
+// rather than limited by a dependency chain the way a table driven CRC is.
+
+namespace
+{
+    const uint64_t Prime1 = 11400714785074694791ULL;
+    const uint64_t Prime2 = 14029467366897019727ULL;
+    const uint64_t Prime3 = 1609587929392839161ULL;
+    const uint64_t Prime4 = 9650029242287828579ULL;
+    const uint64_t Prime5 = 2870177450012600261ULL;
+
+    inline uint64_t _RotateLeft(uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    // Resources are little-endian, as are the machines we run on, but unaligned.
+    inline uint64_t _Read64(const uint8_t *p)
+    {
+        uint64_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint32_t _Read32(const uint8_t *p)
+    {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint64_t _Round(uint64_t accumulator, uint64_t input)
+    {
+        accumulator += input * Prime2;
+        accumulator = _RotateLeft(accumulator, 31);
+        return accumulator * Prime1;
+    }
+
+    inline uint64_t _MergeRound(uint64_t accumulator, uint64_t value)
+    {
+        accumulator ^= _Round(0, value);
+        return accumulator * Prime1 + Prime4;
+    }
+}
+
+uint64_t ComputeContentHash(const uint8_t *data, size_t size, uint64_t seed)
+{
+    const uint8_t *p = data;
+    const uint8_t *end = data + size;
+    uint64_t hash;
+
+    if (size >= 32)
+    {
+        uint64_t v1 = seed + Prime1 + Prime2;
+        uint64_t v2 = seed + Prime2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - Prime1;
+        const uint8_t *limit = end - 32;
+        do
+        {
+            v1 = _Round(v1, _Read64(p));
+            v2 = _Round(v2, _Read64(p + 8));
+            v3 = _Round(v3, _Read64(p + 16));
+            v4 = _Round(v4, _Read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        hash = _RotateLeft(v1, 1) + _RotateLeft(v2, 7) + _RotateLeft(v3, 12) + _RotateLeft(v4, 18);
+        hash = _MergeRound(hash, v1);
+        hash = _MergeRound(hash, v2);
+        hash = _MergeRound(hash, v3);
+        hash = _MergeRound(hash, v4);
+    }
+    else
+    {
+        hash = seed + Prime5;
+    }
+
+    hash += size;
+
+    while ((p + 8) <= end)
+    {
+        hash ^= _Round(0, _Read64(p));
+        hash = _RotateLeft(hash, 27) * Prime1 + Prime4;
+        p += 8;
+    }
+    if ((p + 4) <= end)
+    {
+        hash ^= _Read32(p) * Prime1;
+        hash = _RotateLeft(hash, 23) * Prime2 + Prime3;
+        p += 4;
+    }
+    while (p < end)
+    {
+        hash ^= (*p) * Prime5;
+        hash = _RotateLeft(hash, 11) * Prime1;
+        p++;
+    }
+
+    hash ^= hash >> 33;
+    hash *= Prime2;
+    hash ^= hash >> 29;
+    hash *= Prime3;
+    hash ^= hash >> 32;
+    return hash;
+}
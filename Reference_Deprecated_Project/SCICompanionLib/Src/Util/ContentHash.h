@@ -0,0 +1,19 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+// A fast 64 bit hash of a block of data (the XXH64 algorithm, so values are stable across
+// sessions and machines). This is what identifies the contents of a resource, and is what
+// persistent caches should key on.
+uint64_t ComputeContentHash(const uint8_t *data, size_t size, uint64_t seed = 0);
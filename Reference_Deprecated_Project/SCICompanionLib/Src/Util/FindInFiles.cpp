@@ -0,0 +1,177 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "FindInFiles.h"
+#include "ParallelFor.h"
+
+using namespace std;
+
+TextFinder::TextFinder(const std::string &what, bool matchCase, bool wholeWord) : _what(what), _matchCase(matchCase), _wholeWord(wholeWord)
+{
+    for (int i = 0; i < ARRAYSIZE(_upper); i++)
+    {
+        _upper[i] = (char)(matchCase ? i : toupper(i));
+    }
+    for (char &ch : _what)
+    {
+        ch = _upper[(uint8_t)ch];
+    }
+}
+
+// Uses memchr (which is vectorized) to skip to bytes that could start a match.
+size_t TextFinder::_FindCandidate(const char *text, size_t length, size_t pos) const
+{
+    char first = _what[0];
+    char firstLower = _matchCase ? first : (char)tolower((uint8_t)first);
+    const char *end = text + length;
+    const char *candidate = static_cast<const char *>(memchr(text + pos, first, end - (text + pos)));
+    if (firstLower != first)
+    {
+        const char *candidateLower = static_cast<const char *>(memchr(text + pos, firstLower, (candidate ? candidate : end) - (text + pos)));
+        candidate = candidateLower ? candidateLower : candidate;
+    }
+    return candidate ? (candidate - text) : string::npos;
+}
+
+bool _IsWordChar(char ch)
+{
+    return isalnum((uint8_t)ch) || (ch == '_');
+}
+
+// Is there an occurrence of the search string at match, as strstr would see it?
+bool TextFinder::_IsOccurrenceAt(const char *lineStart, const char *lineEnd, const char *match) const
+{
+    if ((size_t)(lineEnd - match) < _what.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < _what.size(); i++)
+    {
+        if (_upper[(uint8_t)match[i]] != _what[i])
+        {
+            return false;
+        }
+    }
+    // FindStringHelper works on null-terminated lines, so it can't see past a null.
+    return !memchr(lineStart, 0, match + _what.size() - lineStart);
+}
+
+size_t _FindSeparator(const char *text, size_t length, size_t pos, const char *crlf, size_t crlfLength)
+{
+    const char *end = text + length;
+    for (const char *p = text + pos; (p = static_cast<const char *>(memchr(p, crlf[0], end - p))) != nullptr; p++)
+    {
+        if ((crlfLength == 1) || ((p + 1 < end) && (p[1] == crlf[1])))
+        {
+            return p - text;
+        }
+    }
+    return length;
+}
+
+void TextFinder::FindLines(const char *text, size_t length, std::function<void(int, const char *, size_t)> onLine) const
+{
+    if (_what.empty())
+    {
+        return;
+    }
+
+    // Figure out the line endings like CCrystalTextBuffer::LoadFromFile does: by looking at the first line feed.
+    const char *crlf = "\x0d\x0a";
+    const char *firstLF = static_cast<const char *>(memchr(text, '\x0a', length));
+    if (firstLF && !((firstLF > text) && (firstLF[-1] == '\x0d')))
+    {
+        crlf = ((firstLF + 1 < text + length) && (firstLF[1] == '\x0d')) ? "\x0a\x0d" : "\x0a";
+    }
+    size_t crlfLength = strlen(crlf);
+
+    int lineNumber = 0;
+    size_t lineStart = 0;
+    size_t lineEnd = _FindSeparator(text, length, 0, crlf, crlfLength);
+    size_t lastOccurrence = string::npos;
+    size_t pos = 0;
+    while ((pos < length) && ((pos = _FindCandidate(text, length, pos)) != string::npos))
+    {
+        // Move to the line the candidate is in.
+        while ((lineEnd < length) && (pos >= lineEnd + crlfLength))
+        {
+            lineNumber++;
+            lineStart = lineEnd + crlfLength;
+            lineEnd = _FindSeparator(text, length, lineStart, crlf, crlfLength);
+            lastOccurrence = string::npos;
+        }
+
+        bool found = false;
+        if ((pos < lineEnd) && _IsOccurrenceAt(text + lineStart, text + lineEnd, text + pos))
+        {
+            found = true;
+            if (_wholeWord)
+            {
+                // FindStringHelper resumes its search one past the last occurrence it rejected, and doesn't
+                // look at the character before an occurrence it finds right there.
+                bool checkBefore = (pos > lineStart) && ((lastOccurrence == string::npos) || (pos != lastOccurrence + 1));
+                size_t after = pos + _what.size();
+                found = !(checkBefore && _IsWordChar(text[pos - 1])) &&
+                    !((after < lineEnd) && _IsWordChar(text[after]));
+            }
+            lastOccurrence = pos;
+        }
+
+        if (found)
+        {
+            onLine(lineNumber, text + lineStart, lineEnd - lineStart);
+            // One result per line
+            pos = lineEnd;
+        }
+        else
+        {
+            pos++;
+        }
+    }
+}
+
+void FindInFiles(const std::vector<std::string> &filenames, const TextFinder &finder, unsigned int workerCount, std::function<void(const std::string &, const std::vector<FoundLine> &)> onFileSearched)
+{
+    vector<vector<FoundLine>> results(filenames.size());
+    ParallelFor(filenames.size(), workerCount,
+        [&](size_t index)
+    {
+        vector<FoundLine> &found = results[index];
+        try
+        {
+            sci::streamOwner streamOwner(filenames[index]);
+            if (streamOwner.GetDataSize() > 0)
+            {
+                sci::istream reader = streamOwner.getReader();
+                finder.FindLines(reinterpret_cast<const char *>(reader.GetInternalPointer()), reader.GetDataSize(),
+                    [&found](int lineNumber, const char *line, size_t lineLength)
+                {
+                    found.push_back({ lineNumber, string(line, lineLength) });
+                });
+            }
+        }
+        catch (...)
+        {
+            // Report it as having nothing found, rather than stopping the search.
+            found.clear();
+        }
+    },
+        // Report them in order as they finish.
+        [&](size_t index)
+    {
+        onFileSearched(filenames[index], results[index]);
+        results[index].clear();
+    }
+        );
+}
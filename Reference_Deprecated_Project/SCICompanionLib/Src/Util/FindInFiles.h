@@ -0,0 +1,49 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+//
+// Finds the lines in a piece of text that contain a string, with the same results as
+// loading it into a CCrystalTextBuffer and calling FindStringHelper on each line (but
+// without copying or uppercasing anything). Line numbers are zero-based, and lines are
+// split the same way CCrystalTextBuffer splits them.
+//
+class TextFinder
+{
+public:
+    TextFinder(const std::string &what, bool matchCase, bool wholeWord);
+
+    // Calls onLine with the line number, start and length of each line that contains a match.
+    void FindLines(const char *text, size_t length, std::function<void(int, const char *, size_t)> onLine) const;
+
+private:
+    size_t _FindCandidate(const char *text, size_t length, size_t pos) const;
+    bool _IsOccurrenceAt(const char *lineStart, const char *lineEnd, const char *match) const;
+
+    std::string _what;
+    bool _matchCase;
+    bool _wholeWord;
+    char _upper[256];
+};
+
+struct FoundLine
+{
+    int LineNumber;
+    std::string Text;
+};
+
+// Searches each file (memory mapped) on up to workerCount threads. onFileSearched is called on the
+// calling thread for each file in order, as soon as that file and the ones before it have been searched,
+// so results can be shown while the rest are still being searched.
+void FindInFiles(const std::vector<std::string> &filenames, const TextFinder &finder, unsigned int workerCount, std::function<void(const std::string &, const std::vector<FoundLine> &)> onFileSearched);
@@ -0,0 +1,122 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "ParallelFor.h"
+#include <atomic>
+#include <future>
+
+using namespace std;
+
+void ParallelFor(size_t count, unsigned int workerCount, const std::function<void(size_t)> &fn, const std::function<void(size_t)> &onFinished)
+{
+    atomic<size_t> nextIndex(0);
+    atomic<bool> failed(false);
+    mutex doneMutex;
+    vector<bool> done(onFinished ? count : 0, false);
+    size_t nextToReport = 0;
+
+    // Reports the items that are done, in order, up to the first one that isn't.
+    auto reportFinished = [&]()
+    {
+        while (nextToReport < count)
+        {
+            {
+                lock_guard<mutex> lock(doneMutex);
+                if (!done[nextToReport])
+                {
+                    break;
+                }
+            }
+            onFinished(nextToReport++);
+        }
+    };
+
+    auto worker = [&](bool callingThread)
+    {
+        size_t i;
+        while (!failed && ((i = nextIndex++) < count))
+        {
+            try
+            {
+                fn(i);
+            }
+            catch (...)
+            {
+                failed = true;
+                throw;
+            }
+            if (onFinished)
+            {
+                {
+                    lock_guard<mutex> lock(doneMutex);
+                    done[i] = true;
+                }
+                if (callingThread)
+                {
+                    reportFinished();
+                }
+            }
+        }
+    };
+
+    vector<future<void>> helpers;
+    workerCount = max(1u, workerCount);
+    for (unsigned int i = 1; i < min((size_t)workerCount, count); i++)
+    {
+        try
+        {
+            helpers.push_back(async(launch::async, worker, false));
+        }
+        catch (std::system_error)
+        {
+            // Just make do with the workers we have.
+            break;
+        }
+    }
+
+    exception_ptr exception;
+    try
+    {
+        worker(true);
+    }
+    catch (...)
+    {
+        failed = true;
+        exception = current_exception();
+    }
+    for (auto &helperFuture : helpers)
+    {
+        try
+        {
+            helperFuture.get();
+        }
+        catch (...)
+        {
+            if (!exception)
+            {
+                exception = current_exception();
+            }
+        }
+    }
+
+    if (exception)
+    {
+        rethrow_exception(exception);
+    }
+    if (onFinished)
+    {
+        // Whatever the helpers finished after the calling thread ran out of items.
+        reportFinished();
+    }
+}
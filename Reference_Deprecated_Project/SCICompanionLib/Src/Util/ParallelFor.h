@@ -0,0 +1,23 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+// Calls fn(i) for each i from 0 to count - 1, on up to workerCount threads (the calling thread
+// is one of them). Items are handed out in order. If fn throws, no more items are started, and
+// the exception is rethrown on the calling thread once the workers have stopped.
+//
+// If onFinished is given, it is called on the calling thread for each item in order, once that
+// item and the ones before it are done. This lets results be used while later items are still
+// being worked on.
+void ParallelFor(size_t count, unsigned int workerCount, const std::function<void(size_t)> &fn, const std::function<void(size_t)> &onFinished = nullptr);
@@ -13,13 +13,21 @@
 ***************************************************************************/
 #pragma once
 
+#include "WorkerPool.h"
+
 //
-// This template implements a worker thread that can be used to perform background tasks.
+// This template lets a window perform background tasks on a WorkerPool.
 //
 // TITEM is a class that represents the data to work with.
 // TRESULT is a class that represents the results you get back.
 // TRESULT needs a static function of the form:
 // static TRESULT *CreateFromWorkItem(TITEM *pWorkItem);
+// CreateFromWorkItem will be called from several threads at once, and results may
+// arrive in any order.
+//
+// Work items are run most urgent first, and in the order they were given for the
+// same priority. Items that haven't been started can be reprioritized or cancelled
+// (e.g. when they are scrolled out of view).
 //
 
 //
@@ -28,13 +36,23 @@
 //  _pQueue->Abort();
 //
 template <class TITEM, class TRESULT>
-class QueueItems : public std::enable_shared_from_this<QueueItems<TITEM, TRESULT>>
+class QueueItems : public IWorkSource, public std::enable_shared_from_this<QueueItems<TITEM, TRESULT>>
 {
 public:
     //
     // uMessage is posted to hwndView when there are (potentially multiple) results ready.
+    // It isn't posted again until the results have all been taken.
+    //
+    QueueItems(HWND hwndView, UINT uMessage, WorkerPool *pool = nullptr) :
+        QueueItems([hwndView, uMessage]() { PostMessage(hwndView, uMessage, 0, 0); }, pool)
+    {
+    }
+
     //
-    QueueItems(HWND hwndView, UINT uMessage) : _fAbort(false), _uResultReadyMessage(uMessage), _hwndView(hwndView)
+    // Alternately, onResultsReady is called (on a worker thread) when there are results ready.
+    //
+    QueueItems(std::function<void()> onResultsReady, WorkerPool *pool = nullptr) :
+        _onResultsReady(onResultsReady), _pool(pool ? *pool : WorkerPool::GetShared()), _fAbort(false)
     {
     }
 
@@ -45,52 +63,76 @@ public:
 
     bool Init()
     {
-        bool fRet = false;
-        try
-        {
-            _thread = std::thread(s_ThreadWorker, this->shared_from_this());
-            _thread.detach();
-            fRet = true;
-        }
-        catch (std::system_error)
-        {
-        }
-        return fRet;
+        return _pool.GetWorkerCount() > 0;
     }
 
-    void GiveWorkItem(std::unique_ptr<TITEM> pWorkItem)
+    void GiveWorkItem(std::unique_ptr<TITEM> pWorkItem, WorkPriority priority = WorkPriority::Visible)
     {
-        // Insert things at the beginning of the list.
         {
             std::lock_guard<std::mutex> lock(_mutex);
-            _workItems.push_front(std::move(pWorkItem));
+            if (_fAbort)
+            {
+                return;
+            }
+            _workItems[(int)priority].push_back(std::move(pWorkItem));
         }
 
-        _condition.notify_one();
+        _pool.Schedule(this->shared_from_this(), priority);
+    }
+
+    //
+    // Calls reprioritize for each work item that hasn't been started yet. It can change the item's
+    // priority, or return false to cancel it. The cancelled work items are returned.
+    // This is called with the queue locked, so it should be quick.
+    //
+    std::vector<std::unique_ptr<TITEM>> ReprioritizeWorkItems(std::function<bool(const TITEM &, WorkPriority &)> reprioritize)
+    {
+        std::vector<std::unique_ptr<TITEM>> cancelled;
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::list<std::unique_ptr<TITEM>> workItems[WorkPriorityCount];
+        for (int i = 0; i < WorkPriorityCount; i++)
+        {
+            for (std::unique_ptr<TITEM> &workItem : _workItems[i])
+            {
+                WorkPriority priority = (WorkPriority)i;
+                if (reprioritize(*workItem, priority))
+                {
+                    workItems[(int)priority].push_back(std::move(workItem));
+                }
+                else
+                {
+                    cancelled.push_back(std::move(workItem));
+                }
+            }
+        }
+        for (int i = 0; i < WorkPriorityCount; i++)
+        {
+            _workItems[i] = std::move(workItems[i]);
+        }
+        return cancelled;
     }
 
-    bool TakeWorkResult(TRESULT **ppWorkResult)
+    std::vector<std::unique_ptr<TRESULT>> TakeWorkResults()
     {
-        bool fRet = false;
+        std::vector<std::unique_ptr<TRESULT>> workResults;
         std::lock_guard<std::mutex> lock(_mutexResponse);
-        if (!_workResults.empty())
+        workResults.reserve(_workResults.size());
+        for (std::unique_ptr<TRESULT> &workResult : _workResults)
         {
-            fRet = true;
-            *ppWorkResult = _workResults.front().release();
-            _workResults.pop_front();
+            workResults.push_back(std::move(workResult));
         }
-        return fRet;
+        _workResults.clear();
+        return workResults;
     }
 
     void Abort()
     {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto &workItems : _workItems)
         {
-            std::lock_guard<std::mutex> lock(_mutex);
-            _workItems.clear();
-            _fAbort = true;
+            workItems.clear();
         }
-
-        _condition.notify_one();
+        _fAbort = true;
     }
 
     bool HasAborted()
@@ -99,69 +141,56 @@ public:
         return _fAbort;
     }
 
-private:
-    bool _TakeWorkItem(TITEM **ppWorkItem)
+    void RunOne() override
     {
-        bool fRet = false;
-        std::lock_guard<std::mutex> lock(_mutex);
-        if (!_workItems.empty())
+        std::unique_ptr<TITEM> workItem;
         {
-            fRet = true;
-            *ppWorkItem = _workItems.back().release();
-            _workItems.pop_back();
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto &workItems : _workItems)
+            {
+                if (!workItems.empty())
+                {
+                    workItem = std::move(workItems.front());
+                    workItems.pop_front();
+                    break;
+                }
+            }
+        }
+
+        if (workItem)
+        {
+            std::unique_ptr<TRESULT> pResult(TRESULT::CreateFromWorkItem(workItem.get()));
+            if (pResult && !HasAborted())
+            {
+                _GiveWorkResult(std::move(pResult));
+            }
         }
-        // else No work items left.
-        return fRet;
     }
 
+private:
     void _GiveWorkResult(std::unique_ptr<TRESULT> pWorkResult)
     {
+        bool notify;
         {
             std::lock_guard<std::mutex> lock(_mutexResponse);
+            // If there were already results waiting, the UI hasn't gotten to them yet, and
+            // will pick this one up at the same time.
+            notify = _workResults.empty();
             _workResults.push_back(std::move(pWorkResult));
         }
-        PostMessage(_hwndView, _uResultReadyMessage, 0, 0);
-    }
-
-    void _ThreadWorker()
-    {
-        while (!_fAbort)
+        if (notify)
         {
-            std::unique_lock<std::mutex> lock(_mutex);
-            _condition.wait(lock, [&]() { return _fAbort || !_workItems.empty(); });
-            if (!_fAbort)
-            {
-                std::unique_ptr<TITEM> workItem = std::move(_workItems.back());
-                _workItems.pop_back();
-                lock.unlock(); // While we do heavy work
-                std::unique_ptr<TRESULT> pResult(TRESULT::CreateFromWorkItem(workItem.get()));
-                if (pResult)
-                {
-                    _GiveWorkResult(std::move(pResult));
-                }
-            }
+            _onResultsReady();
         }
     }
 
-    static UINT s_ThreadWorker(std::shared_ptr<QueueItems<TITEM, TRESULT>> me)
-    {
-        me->_ThreadWorker();
-        return 0;
-    }
-
-    HWND _hwndView;
-    UINT _uResultReadyMessage;
+    std::function<void()> _onResultsReady;
+    WorkerPool &_pool;
     std::mutex _mutex;
     std::mutex _mutexResponse;
 
-    std::condition_variable _condition;
-
-    std::thread _thread;
     bool _fAbort;
 
-    std::list<std::unique_ptr<TITEM>> _workItems;
+    std::list<std::unique_ptr<TITEM>> _workItems[WorkPriorityCount];
     std::list<std::unique_ptr<TRESULT>> _workResults;
 };
-
-
-
@@ -181,6 +181,7 @@ void AudioComponentFromWaveFile(sci::istream &stream, AudioComponent &audio, Aud
     }
 
     // Set up the AudioComponent and read the data.
+    audio.DiscardEncodedSource();
     audio.Frequency = header.sampleRate;
     if (convertedBitsPerSample == 16)
     {
@@ -339,9 +340,10 @@ void WriteWaveFile(const std::string &filename, const AudioComponent &audio, con
     out << waveHeader;
 
     out << (*(uint32_t*)dataMarker);
-    uint32_t dataSize = audio.DigitalSamplePCM.size();
+    const std::vector<uint8_t> &pcm = audio.GetPCM();
+    uint32_t dataSize = pcm.size();
     out << dataSize;
-    out.WriteBytes(&audio.DigitalSamplePCM[0], dataSize);
+    out.WriteBytes(&pcm[0], dataSize);
 
     fileSize = out.GetDataSize();
     // Go back and write it...
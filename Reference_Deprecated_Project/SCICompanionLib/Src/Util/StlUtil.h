@@ -284,6 +284,84 @@ namespace sci
         _T *_data;
         size_t _size;
     };
+
+    // Like array, but copies share their data until one of them is modified. Any non-const access
+    // counts as a modification, and gives this copy its own data if it is shared.
+    // This lets undo snapshots of resources share the bitmaps of cels that haven't changed.
+    // Pointers obtained through non-const access should not be held across a copy.
+    template<typename _T>
+    class shared_array
+    {
+    public:
+        shared_array() : _size(0) {}
+        shared_array(size_t size) : shared_array() { allocate(size); }
+
+        shared_array(const shared_array &src) = default;
+        shared_array &operator=(const shared_array &src) = default;
+
+        void allocate(size_t size)
+        {
+            _data.reset(size ? new _T[size] : nullptr, std::default_delete<_T[]>());
+            _size = size;
+        }
+
+        void assign(const _T *begin, const _T *end)
+        {
+            assert((end - begin) <= (ptrdiff_t)_size);
+            std::copy(begin, end, this->begin());
+        }
+
+        void swap(shared_array &src)
+        {
+            std::swap(_data, src._data);
+            std::swap(_size, src._size);
+        }
+
+        void fill(_T value)
+        {
+            std::fill(begin(), end(), value);
+        }
+
+        void fill(size_t position, size_t length, _T value)
+        {
+            assert((position + length) <= _size);
+            std::fill(begin() + position, begin() + position + length, value);
+        }
+
+        _T *begin() { _Unshare(); return _data.get(); }
+        _T *end() { return begin() + _size; }
+
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+
+        // Doesn't unshare the data, so this also identifies the buffer.
+        const _T *data() const { return _data.get(); }
+
+        _T& operator[](size_t index)
+        {
+            _Unshare();
+            return _data.get()[index];
+        }
+
+        const _T& operator[](size_t index) const
+        {
+            return _data.get()[index];
+        }
+
+    private:
+        void _Unshare()
+        {
+            if (_data && (_data.use_count() != 1))
+            {
+                std::shared_ptr<_T> copy(new _T[_size], std::default_delete<_T[]>());
+                std::copy(_data.get(), _data.get() + _size, copy.get());
+                _data = copy;
+            }
+        }
+
+        std::shared_ptr<_T> _data;
+        size_t _size;
+    };
 }
 
 // A remove_if for associative containers.
@@ -0,0 +1,303 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "ThumbnailCache.h"
+#include "ResourceBlob.h"
+#include "ResourceUtil.h"
+#include "PaletteOperations.h"
+#include "ContentHash.h"
+
+using namespace std;
+
+const uint32_t ThumbnailCacheSignature = 0x4e485453; // "STHN"
+const uint32_t ThumbnailCacheVersion = 2;
+const uint32_t MaxThumbnailCacheFileSize = 32 * 1024 * 1024;
+const uint16_t MaxThumbnailDimension = 2048;
+
+// Returns false for sizes that can't be right for this key.
+bool _IsValidSize(const ThumbnailKey &key, uint16_t width, uint16_t height)
+{
+    return (width > 0) && (height > 0) &&
+        (width <= MaxThumbnailDimension) && (height <= MaxThumbnailDimension) &&
+        ((key.Width == 0) || (key.Width == width)) &&
+        ((key.Height == 0) || (key.Height == height));
+}
+
+bool operator<(const ThumbnailKey &one, const ThumbnailKey &two)
+{
+    return memcmp(&one, &two, sizeof(ThumbnailKey)) < 0;
+}
+
+ThumbnailKey GetThumbnailKey(const ResourceBlob &blob, uint32_t paletteHash, int cx, int cy)
+{
+    ThumbnailKey key = {};
+    key.ContentHash = blob.GetChecksum();
+    key.PaletteHash = paletteHash;
+    key.Width = (uint16_t)cx;
+    key.Height = (uint16_t)cy;
+    return key;
+}
+
+uint32_t GetPaletteHash(const PaletteComponent *palette)
+{
+    return palette ? (uint32_t)ComputeContentHash(reinterpret_cast<const uint8_t*>(palette->Colors), sizeof(palette->Colors)) : 0;
+}
+
+std::shared_ptr<ThumbnailCache> ThumbnailCache::Get(const std::string &cacheFolder, ResourceType type)
+{
+    return Get(cacheFolder, GetResourceInfo(type).pszSampleFolderName);
+}
+
+std::shared_ptr<ThumbnailCache> ThumbnailCache::Get(const std::string &cacheFolder, const std::string &name)
+{
+    static std::mutex s_mutex;
+    static std::map<std::string, std::weak_ptr<ThumbnailCache>> s_caches;
+
+    std::string filename = cacheFolder + "\\" + name + ".thumbs";
+    std::lock_guard<std::mutex> lock(s_mutex);
+    std::shared_ptr<ThumbnailCache> cache = s_caches[filename].lock();
+    if (!cache)
+    {
+        cache = std::make_shared<ThumbnailCache>(cacheFolder, filename);
+        s_caches[filename] = cache;
+    }
+    return cache;
+}
+
+ThumbnailCache::ThumbnailCache(const std::string &cacheFolder, const std::string &filename) : _folder(cacheFolder), _filename(filename), _startOver(true)
+{
+    _Load();
+}
+
+template<typename _T>
+bool _ReadValue(std::ifstream &file, _T &value)
+{
+    return !!file.read(reinterpret_cast<char*>(&value), sizeof(value));
+}
+
+template<typename _T>
+void _WriteValue(std::ofstream &file, const _T &value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void ThumbnailCache::_Load()
+{
+    std::ifstream file;
+    file.open(_filename, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+    uint32_t fileSize = file.is_open() ? static_cast<uint32_t>(file.tellg()) : 0;
+    if (file.is_open() && (fileSize <= MaxThumbnailCacheFileSize))
+    {
+        file.seekg(0);
+        uint32_t signature, version;
+        if (_ReadValue(file, signature) && _ReadValue(file, version) &&
+            (signature == ThumbnailCacheSignature) && (version == ThumbnailCacheVersion))
+        {
+            uint32_t endOfLastEntry = static_cast<uint32_t>(file.tellg());
+            ThumbnailKey key;
+            uint16_t colorCount;
+            std::unique_ptr<Thumbnail> thumbnail = make_unique<Thumbnail>();
+            while (_ReadValue(file, key) &&
+                _ReadValue(file, thumbnail->Width) &&
+                _ReadValue(file, thumbnail->Height) &&
+                _ReadValue(file, colorCount) &&
+                (colorCount > 0) && (colorCount <= 256) &&
+                _IsValidSize(key, thumbnail->Width, thumbnail->Height))
+            {
+                thumbnail->Colors.resize(colorCount);
+                thumbnail->Bits.resize(thumbnail->Width * thumbnail->Height);
+                if (!file.read(reinterpret_cast<char*>(&thumbnail->Colors[0]), colorCount * sizeof(RGBQUAD)) ||
+                    !file.read(reinterpret_cast<char*>(thumbnail->Bits.data()), thumbnail->Bits.size()))
+                {
+                    break;
+                }
+                endOfLastEntry = static_cast<uint32_t>(file.tellg());
+                _thumbnails[key] = move(thumbnail);
+                thumbnail = make_unique<Thumbnail>();
+            }
+            // If there was a partially written or corrupt entry, anything appended after
+            // it would be unreadable. So in that case we'll write the file out again.
+            _startOver = (endOfLastEntry != fileSize);
+        }
+    }
+}
+
+void _WriteThumbnail(std::ofstream &file, const ThumbnailKey &key, uint16_t width, uint16_t height, const std::vector<RGBQUAD> &colors, const std::vector<uint8_t> &bits)
+{
+    _WriteValue(file, key);
+    _WriteValue(file, width);
+    _WriteValue(file, height);
+    _WriteValue(file, (uint16_t)colors.size());
+    file.write(reinterpret_cast<const char*>(&colors[0]), colors.size() * sizeof(RGBQUAD));
+    file.write(reinterpret_cast<const char*>(bits.data()), bits.size());
+}
+
+void ThumbnailCache::_Append(const ThumbnailKey &key, const Thumbnail &thumbnail)
+{
+    if ((_startOver || !_file.is_open()) && !EnsureFolderExists(_folder, false))
+    {
+        return;
+    }
+
+    if (_startOver)
+    {
+        _file.close();
+        _file.clear();
+        _file.open(_filename, std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+        if (_file.is_open())
+        {
+            _WriteValue(_file, ThumbnailCacheSignature);
+            _WriteValue(_file, ThumbnailCacheVersion);
+            for (auto &entry : _thumbnails)
+            {
+                _WriteThumbnail(_file, entry.first, entry.second->Width, entry.second->Height, entry.second->Colors, entry.second->Bits);
+            }
+            _startOver = false;
+        }
+    }
+    else if (!_file.is_open())
+    {
+        _file.clear();
+        _file.open(_filename, std::ios_base::out | std::ios_base::app | std::ios_base::binary);
+    }
+
+    if (_file.is_open())
+    {
+        _WriteThumbnail(_file, key, thumbnail.Width, thumbnail.Height, thumbnail.Colors, thumbnail.Bits);
+        // So that another instance loading the file (e.g. after this one is released) sees whole entries.
+        _file.flush();
+    }
+}
+
+std::shared_ptr<const ThumbnailCache::Thumbnail> ThumbnailCache::_Find(const ThumbnailKey &key) const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _thumbnails.find(key);
+    return (it != _thumbnails.end()) ? it->second : nullptr;
+}
+
+void ThumbnailCache::_Add(const ThumbnailKey &key, std::unique_ptr<Thumbnail> thumbnail)
+{
+    if (!_IsValidSize(key, thumbnail->Width, thumbnail->Height))
+    {
+        // It wouldn't be found when the file is next loaded.
+        return;
+    }
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_thumbnails.find(key) == _thumbnails.end())
+    {
+        _Append(key, *thumbnail);
+        _thumbnails[key] = move(thumbnail);
+    }
+}
+
+HBITMAP ThumbnailCache::CreateBitmap(const ThumbnailKey &key) const
+{
+    std::shared_ptr<const Thumbnail> thumbnail = _Find(key);
+    HBITMAP hbm = nullptr;
+    if (thumbnail)
+    {
+        SCIBitmapInfo bmi(thumbnail->Width, thumbnail->Height, &thumbnail->Colors[0], (int)thumbnail->Colors.size());
+        uint8_t *pBitsDest;
+        hbm = CreateDIBSection(nullptr, &bmi, DIB_RGB_COLORS, (void**)&pBitsDest, nullptr, 0);
+        if (hbm)
+        {
+            for (int y = 0; y < thumbnail->Height; y++)
+            {
+                memcpy(pBitsDest + y * CX_ACTUAL(thumbnail->Width), &thumbnail->Bits[y * thumbnail->Width], thumbnail->Width);
+            }
+        }
+    }
+    return hbm;
+}
+
+void ThumbnailCache::Add(const ThumbnailKey &key, HBITMAP hbmp)
+{
+    DIBSECTION dibSection;
+    if (!hbmp ||
+        (GetObject(hbmp, sizeof(dibSection), &dibSection) != sizeof(dibSection)) ||
+        (dibSection.dsBmih.biBitCount != 8) ||
+        (dibSection.dsBmih.biHeight < 0) ||
+        !dibSection.dsBm.bmBits)
+    {
+        return;
+    }
+
+    std::unique_ptr<Thumbnail> thumbnail = make_unique<Thumbnail>();
+    thumbnail->Width = (uint16_t)dibSection.dsBm.bmWidth;
+    thumbnail->Height = (uint16_t)dibSection.dsBm.bmHeight;
+    thumbnail->Bits.resize(thumbnail->Width * thumbnail->Height);
+    uint8_t highestIndex = 0;
+    const uint8_t *pBits = reinterpret_cast<const uint8_t*>(dibSection.dsBm.bmBits);
+    for (int y = 0; y < thumbnail->Height; y++)
+    {
+        const uint8_t *pRow = pBits + y * dibSection.dsBm.bmWidthBytes;
+        for (int x = 0; x < thumbnail->Width; x++)
+        {
+            highestIndex = max(highestIndex, pRow[x]);
+        }
+        memcpy(&thumbnail->Bits[y * thumbnail->Width], pRow, thumbnail->Width);
+    }
+
+    RGBQUAD colors[256];
+    UINT colorCount = 0;
+    CDC dc;
+    if (dc.CreateCompatibleDC(nullptr))
+    {
+        HGDIOBJ hOld = SelectObject(dc, hbmp);
+        colorCount = GetDIBColorTable(dc, 0, ARRAYSIZE(colors), colors);
+        SelectObject(dc, hOld);
+    }
+    if ((colorCount == 0) || (highestIndex >= colorCount))
+    {
+        return;
+    }
+    thumbnail->Colors.assign(colors, colors + highestIndex + 1);
+    _Add(key, move(thumbnail));
+}
+
+bool ThumbnailCache::GetBits(const ThumbnailKey &key, CSize &size, std::vector<uint8_t> &bits, std::vector<RGBQUAD> &colors) const
+{
+    std::shared_ptr<const Thumbnail> thumbnail = _Find(key);
+    if (thumbnail)
+    {
+        size.SetSize(thumbnail->Width, thumbnail->Height);
+        bits = thumbnail->Bits;
+        colors = thumbnail->Colors;
+    }
+    return !!thumbnail;
+}
+
+void ThumbnailCache::Add(const ThumbnailKey &key, CSize size, const uint8_t *bits, const RGBQUAD *colors, int colorCount)
+{
+    if ((size.cx > MaxThumbnailDimension) || (size.cy > MaxThumbnailDimension))
+    {
+        return;
+    }
+    std::unique_ptr<Thumbnail> thumbnail = make_unique<Thumbnail>();
+    thumbnail->Width = (uint16_t)size.cx;
+    thumbnail->Height = (uint16_t)size.cy;
+    thumbnail->Bits.assign(bits, bits + size.cx * size.cy);
+    if (thumbnail->Bits.empty())
+    {
+        return;
+    }
+    uint8_t highestIndex = *max_element(thumbnail->Bits.begin(), thumbnail->Bits.end());
+    if (highestIndex >= colorCount)
+    {
+        return;
+    }
+    thumbnail->Colors.assign(colors, colors + highestIndex + 1);
+    _Add(key, move(thumbnail));
+}
@@ -0,0 +1,91 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+class ResourceBlob;
+struct PaletteComponent;
+enum class ResourceType;
+
+// Identifies a thumbnail by what it was drawn from, and at what size.
+struct ThumbnailKey
+{
+    uint64_t ContentHash;   // Of the resource data
+    uint32_t PaletteHash;   // Of the global palette it was drawn with, or 0
+    uint16_t Width;         // The size of the image, or 0 if it isn't known up front
+    uint16_t Height;
+};
+
+bool operator<(const ThumbnailKey &one, const ThumbnailKey &two);
+
+ThumbnailKey GetThumbnailKey(const ResourceBlob &blob, uint32_t paletteHash, int cx, int cy);
+uint32_t GetPaletteHash(const PaletteComponent *palette);
+
+//
+// A persistent store of the preview images shown in the resource lists, so they
+// don't need to be regenerated each time a game is opened. There is one file per
+// resource type in the game's thumbnailcache folder.
+//
+// Thumbnails are 8bpp images, and only the palette entries they actually use are kept.
+// New thumbnails are appended to the file as they are added. The file is discarded and
+// started over if it gets too big (e.g. full of thumbnails of old versions of resources).
+// Entries that don't match the size in their key are treated as corrupt, and the file is
+// rewritten without them.
+//
+// Lookups and additions can be made from any thread. Use Get to obtain the cache for
+// a particular file, so that everyone writing to it shares the same instance.
+//
+class ThumbnailCache
+{
+public:
+    static std::shared_ptr<ThumbnailCache> Get(const std::string &cacheFolder, ResourceType type);
+    // For images that aren't previews of a single resource type (e.g. room explorer composites).
+    static std::shared_ptr<ThumbnailCache> Get(const std::string &cacheFolder, const std::string &name);
+
+    ThumbnailCache(const std::string &cacheFolder, const std::string &filename);
+    ThumbnailCache(const ThumbnailCache &src) = delete;
+    ThumbnailCache &operator=(const ThumbnailCache &src) = delete;
+
+    // Returns nullptr if there is no thumbnail for this key.
+    HBITMAP CreateBitmap(const ThumbnailKey &key) const;
+
+    // hbmp must be an 8bpp DIB section, such as those returned by GetBitmap.
+    void Add(const ThumbnailKey &key, HBITMAP hbmp);
+
+    // The same, but for 8bpp bottom-up bits without row padding. Returns false
+    // from GetBits if there is no image for this key.
+    bool GetBits(const ThumbnailKey &key, CSize &size, std::vector<uint8_t> &bits, std::vector<RGBQUAD> &colors) const;
+    void Add(const ThumbnailKey &key, CSize size, const uint8_t *bits, const RGBQUAD *colors, int colorCount);
+
+private:
+    struct Thumbnail
+    {
+        uint16_t Width;
+        uint16_t Height;
+        std::vector<RGBQUAD> Colors;
+        std::vector<uint8_t> Bits;      // Bottom-up rows, unpadded
+    };
+
+    void _Load();
+    std::shared_ptr<const Thumbnail> _Find(const ThumbnailKey &key) const;
+    void _Add(const ThumbnailKey &key, std::unique_ptr<Thumbnail> thumbnail);
+    void _Append(const ThumbnailKey &key, const Thumbnail &thumbnail);
+
+    std::string _folder;
+    std::string _filename;
+    bool _startOver;
+    std::ofstream _file;    // Kept open for appending, once something has been added.
+
+    mutable std::mutex _mutex;
+    std::map<ThumbnailKey, std::shared_ptr<const Thumbnail>> _thumbnails;
+};
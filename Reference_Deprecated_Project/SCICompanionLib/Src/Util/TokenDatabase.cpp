@@ -33,160 +33,281 @@ bool operator<(const ACTreeLeaf &one, const ACTreeLeaf &two)
 }
 
 
-size_t CommonPrefix(const std::string &one, const std::string &two, bool &firstLetterSame)
+namespace
 {
-    size_t length = min(one.size(), two.size());
-    firstLetterSame = false;
-    for (size_t i = 0; i < length; i++)
+    // A full ordering, unlike operator<, so that an owner's tokens can be diffed.
+    bool LeafLess(const ACTreeLeaf &one, const ACTreeLeaf &two)
     {
-        if (one[i] != two[i])
+        return std::tie(one.Lower, one.Original, one.SourceType) < std::tie(two.Lower, two.Original, two.SourceType);
+    }
+
+    bool LeafEqual(const ACTreeLeaf &one, const ACTreeLeaf &two)
+    {
+        return !LeafLess(one, two) && !LeafLess(two, one);
+    }
+
+    AutoCompleteIconIndex IconFromSourceType(AutoCompleteSourceType type)
+    {
+        AutoCompleteIconIndex icon = AutoCompleteIconIndex::Unknown;
+        switch (type)
         {
-            return i;
+            case AutoCompleteSourceType::Define:
+                icon = AutoCompleteIconIndex::Define;
+                break;
+            case AutoCompleteSourceType::TopLevelKeyword:
+                icon = AutoCompleteIconIndex::TopLevelKeyword;
+                break;
+            case AutoCompleteSourceType::ClassName:
+                icon = AutoCompleteIconIndex::Class;
+                break;
+            case AutoCompleteSourceType::Selector:
+                icon = AutoCompleteIconIndex::Selector;
+                break;
+            case AutoCompleteSourceType::Procedure:
+                icon = AutoCompleteIconIndex::PublicProcedure;
+                break;
+            case AutoCompleteSourceType::Kernel:
+                icon = AutoCompleteIconIndex::Kernel;
+                break;
+            case AutoCompleteSourceType::ScriptName:
+                icon = AutoCompleteIconIndex::Script;
+                break;
+            case AutoCompleteSourceType::Variable:
+                icon = AutoCompleteIconIndex::Variable;
+                break;
         }
-        firstLetterSame = true;
+        return icon;
     }
-    firstLetterSame = (length > 0);
-    return length;
 }
 
-void TokenDatabase::BuildDatabase(std::multiset<ACTreeLeaf> &originalsIn)
+TokenDatabase::TokenDatabase()
 {
-    _data.EnsureCapacity(20000);
-    _data.reset();
-    _originals.clear();
+    Clear();
+}
 
-    std::string previous;
-    for (const ACTreeLeaf &leaf : originalsIn)
+void TokenDatabase::Clear()
+{
+    _nodes.clear();
+    _nodes.emplace_back();
+    _freeNodes.clear();
+    _owners.clear();
+}
+
+void TokenDatabase::SetTokens(const std::string &owner, std::vector<ACTreeLeaf> tokens)
+{
+    std::sort(tokens.begin(), tokens.end(), LeafLess);
+    tokens.erase(std::unique(tokens.begin(), tokens.end(), LeafEqual), tokens.end());
+
+    // Only apply the differences from what this owner had before.
+    std::vector<ACTreeLeaf> &previous = _owners[owner];
+    auto itOld = previous.begin();
+    auto itNew = tokens.begin();
+    while ((itOld != previous.end()) || (itNew != tokens.end()))
     {
-        // Count chars in common with previous
-        bool firstLetterSame;
-        size_t commonWithPrev = CommonPrefix(previous, leaf.Lower, firstLetterSame);
-        if (!firstLetterSame)
+        if ((itNew == tokens.end()) || ((itOld != previous.end()) && LeafLess(*itOld, *itNew)))
+        {
+            _Remove(*itOld);
+            ++itOld;
+        }
+        else if ((itOld == previous.end()) || LeafLess(*itNew, *itOld))
+        {
+            _Add(*itNew);
+            ++itNew;
+        }
+        else
         {
-            // New entry in the letter table.
-            _offsets[leaf.Lower[0]] = _data.GetDataSize();
+            ++itOld;
+            ++itNew;
         }
+    }
 
-        _data.WriteByte((uint8_t)commonWithPrev);
-        size_t currentSize = leaf.Lower.size();
-        _data.WriteByte((uint8_t)(currentSize - commonWithPrev));
-        for (size_t i = commonWithPrev; i < currentSize; i++)
+    if (tokens.empty())
+    {
+        _owners.erase(owner);
+    }
+    else
+    {
+        previous = move(tokens);
+    }
+}
+
+void TokenDatabase::RemoveTokens(const std::string &owner)
+{
+    auto it = _owners.find(owner);
+    if (it != _owners.end())
+    {
+        for (const ACTreeLeaf &leaf : it->second)
         {
-            _data.WriteByte((uint8_t)leaf.Lower[i]);
+            _Remove(leaf);
         }
-        // Finally, the id.
-        _data.WriteWord((uint16_t)_originals.size());
-        _originals.push_back(leaf);
+        _owners.erase(it);
+    }
+}
 
-        previous = leaf.Lower;
+uint32_t TokenDatabase::_NewNode()
+{
+    uint32_t index;
+    if (_freeNodes.empty())
+    {
+        index = (uint32_t)_nodes.size();
+        _nodes.emplace_back();
+    }
+    else
+    {
+        index = _freeNodes.back();
+        _freeNodes.pop_back();
+        _nodes[index] = Node();
     }
-    _data.WriteByte(0); // 0 chars in common
-    // Done
+    return index;
 }
 
-void TokenDatabase::GetAutoCompleteChoices(const std::string &prefix, AutoCompleteSourceType sourceTypes, std::vector<AutoCompleteChoice> &choices)
+void TokenDatabase::_Add(const ACTreeLeaf &leaf)
+{
+    uint32_t nodeIndex = 0;
+    _nodes[nodeIndex].SourceTypes |= leaf.SourceType;
+    for (char ch : leaf.Lower)
+    {
+        auto &children = _nodes[nodeIndex].Children;
+        auto itChild = std::lower_bound(children.begin(), children.end(), (uint8_t)ch,
+            [](const std::pair<uint8_t, uint32_t> &child, uint8_t value) { return child.first < value; });
+        if ((itChild != children.end()) && (itChild->first == (uint8_t)ch))
+        {
+            nodeIndex = itChild->second;
+        }
+        else
+        {
+            size_t insertAt = itChild - children.begin();
+            uint32_t newIndex = _NewNode(); // Invalidates children
+            auto &childrenAfter = _nodes[nodeIndex].Children;
+            childrenAfter.insert(childrenAfter.begin() + insertAt, std::make_pair((uint8_t)ch, newIndex));
+            nodeIndex = newIndex;
+        }
+        _nodes[nodeIndex].SourceTypes |= leaf.SourceType;
+    }
+
+    std::vector<Token> &nodeTokens = _nodes[nodeIndex].Tokens;
+    auto itToken = std::find_if(nodeTokens.begin(), nodeTokens.end(),
+        [&leaf](const Token &token) { return (token.SourceType == leaf.SourceType) && (token.Original == leaf.Original); });
+    if (itToken != nodeTokens.end())
+    {
+        itToken->RefCount++;
+    }
+    else
+    {
+        nodeTokens.push_back({ leaf.SourceType, leaf.Original, 1 });
+    }
+}
+
+void TokenDatabase::_Remove(const ACTreeLeaf &leaf)
+{
+    // Find the path to the token
+    std::vector<uint32_t> path;
+    path.reserve(leaf.Lower.size() + 1);
+    uint32_t nodeIndex = 0;
+    path.push_back(nodeIndex);
+    for (char ch : leaf.Lower)
+    {
+        const auto &children = _nodes[nodeIndex].Children;
+        auto itChild = std::lower_bound(children.begin(), children.end(), (uint8_t)ch,
+            [](const std::pair<uint8_t, uint32_t> &child, uint8_t value) { return child.first < value; });
+        if ((itChild == children.end()) || (itChild->first != (uint8_t)ch))
+        {
+            assert(false && "Removing a token that isn't there");
+            return;
+        }
+        nodeIndex = itChild->second;
+        path.push_back(nodeIndex);
+    }
+
+    std::vector<Token> &nodeTokens = _nodes[nodeIndex].Tokens;
+    auto itToken = std::find_if(nodeTokens.begin(), nodeTokens.end(),
+        [&leaf](const Token &token) { return (token.SourceType == leaf.SourceType) && (token.Original == leaf.Original); });
+    if (itToken == nodeTokens.end())
+    {
+        assert(false && "Removing a token that isn't there");
+        return;
+    }
+    if (--itToken->RefCount > 0)
+    {
+        return;
+    }
+    nodeTokens.erase(itToken);
+
+    // Now fix up the source types on the way back up, pruning empty nodes.
+    for (size_t i = path.size(); i-- > 0;)
+    {
+        Node &node = _nodes[path[i]];
+        if ((i > 0) && node.Tokens.empty() && node.Children.empty())
+        {
+            auto &parentChildren = _nodes[path[i - 1]].Children;
+            parentChildren.erase(std::find_if(parentChildren.begin(), parentChildren.end(),
+                [&](const std::pair<uint8_t, uint32_t> &child) { return child.second == path[i]; }));
+            node.Tokens.shrink_to_fit();
+            node.Children.shrink_to_fit();
+            _freeNodes.push_back(path[i]);
+        }
+        else
+        {
+            AutoCompleteSourceType sourceTypes = AutoCompleteSourceType::None;
+            for (const Token &token : node.Tokens)
+            {
+                sourceTypes |= token.SourceType;
+            }
+            for (const auto &child : node.Children)
+            {
+                sourceTypes |= _nodes[child.second].SourceTypes;
+            }
+            if (sourceTypes == node.SourceTypes)
+            {
+                break; // Nothing above us will change either.
+            }
+            node.SourceTypes = sourceTypes;
+        }
+    }
+}
+
+void TokenDatabase::_Collect(uint32_t nodeIndex, AutoCompleteSourceType sourceTypes, std::string &lower, std::vector<AutoCompleteChoice> &choices) const
+{
+    const Node &node = _nodes[nodeIndex];
+    for (const Token &token : node.Tokens)
+    {
+        if (IsFlagSet(token.SourceType, sourceTypes))
+        {
+            choices.emplace_back(token.Original, lower, IconFromSourceType(token.SourceType));
+        }
+    }
+    for (const auto &child : node.Children)
+    {
+        if (IsFlagSet(_nodes[child.second].SourceTypes, sourceTypes))
+        {
+            lower.push_back((char)child.first);
+            _Collect(child.second, sourceTypes, lower, choices);
+            lower.pop_back();
+        }
+    }
+}
+
+void TokenDatabase::GetAutoCompleteChoices(const std::string &prefix, AutoCompleteSourceType sourceTypes, std::vector<AutoCompleteChoice> &choices) const
 {
     if (!prefix.empty())
     {
-        sci::istream stream = istream_from_ostream(_data);
-        size_t prefixLength = prefix.size();
-        auto itOffset = _offsets.find(prefix[0]);
-        if (itOffset != _offsets.end())
+        uint32_t nodeIndex = 0;
+        for (char ch : prefix)
         {
-            size_t offset = itOffset->second;
-            stream.seekg(offset);
-            assert(0 == stream.peek()); // 0 chars in common with previous.
-            uint8_t charsInCommon;
-            stream >> charsInCommon;
-            size_t matchingChars = 0; // This can only go up, then go down.
-
-            char buffer[MaxWordLength];
-            do
+            const auto &children = _nodes[nodeIndex].Children;
+            auto itChild = std::lower_bound(children.begin(), children.end(), (uint8_t)ch,
+                [](const std::pair<uint8_t, uint32_t> &child, uint8_t value) { return child.first < value; });
+            if ((itChild == children.end()) || (itChild->first != (uint8_t)ch))
             {
-                uint8_t additionalChars;
-                stream >> additionalChars;
-
-                stream.read_data(reinterpret_cast<uint8_t*>(buffer + charsInCommon), additionalChars);
-
-                if (charsInCommon < matchingChars)
-                {
-                    // We're done, nothing more could match
-                    break;
-                }
-
-                // Figure out how many characters match the prefix.
-                size_t total = charsInCommon + additionalChars;
-                while (matchingChars < prefixLength && matchingChars < total)
-                {
-                    if (buffer[matchingChars] == prefix[matchingChars])
-                    {
-                        matchingChars++;
-                    }
-                    else
-                    {
-                        break;
-                    }
-                }
-
-                if (matchingChars == prefixLength)
-                {
-                    // This is a match, unless we have less now
-                    if (buffer[matchingChars - 1] != prefix[matchingChars - 1])
-                    {
-                        // We're done. Nothing more will match
-                        break;
-                    }
-                    uint16_t index;
-                    stream >> index;
-
-                    const ACTreeLeaf &leaf = _originals[index];
-                    AutoCompleteSourceType type = leaf.SourceType;
-                    if ((type & sourceTypes) != AutoCompleteSourceType::None)
-                    {
-                        AutoCompleteIconIndex icon = AutoCompleteIconIndex::Unknown;
-                        switch (type)
-                        {
-                            case AutoCompleteSourceType::Define:
-                                icon = AutoCompleteIconIndex::Define;
-                                break;
-                            case AutoCompleteSourceType::TopLevelKeyword:
-                                icon = AutoCompleteIconIndex::TopLevelKeyword;
-                                break;
-                            case AutoCompleteSourceType::ClassName:
-                                icon = AutoCompleteIconIndex::Class;
-                                break;
-                            case AutoCompleteSourceType::Selector:
-                                icon = AutoCompleteIconIndex::Selector;
-                                break;
-                            case AutoCompleteSourceType::Procedure:
-                                icon = AutoCompleteIconIndex::PublicProcedure;
-                                break;
-                            case AutoCompleteSourceType::Kernel:
-                                icon = AutoCompleteIconIndex::Kernel;
-                                break;
-                            case AutoCompleteSourceType::ScriptName:
-                                icon = AutoCompleteIconIndex::Script;
-                                break;
-                            case AutoCompleteSourceType::Variable:
-                                icon = AutoCompleteIconIndex::Variable;
-                                break;
-                        }
-                        choices.emplace_back(leaf.Original, leaf.Lower, icon);
-                    }
-
-                    
-
-                }
-                else
-                {
-                    stream.skip(sizeof(uint16_t));
-                }
-
-                
-                stream >> charsInCommon;
-            } while (charsInCommon);
-
-            // Go through the entries until we have one where prefixLength chars are matching.
+                return; // Nothing starts with this
+            }
+            nodeIndex = itChild->second;
+        }
+
+        if (IsFlagSet(_nodes[nodeIndex].SourceTypes, sourceTypes))
+        {
+            std::string lower = prefix;
+            _Collect(nodeIndex, sourceTypes, lower, choices);
         }
     }
 }
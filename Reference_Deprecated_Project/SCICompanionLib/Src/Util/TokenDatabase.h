@@ -14,7 +14,7 @@
 #pragma once
 #include "AutoCompleteSourceTypes.h"
 
-// Implements a compressed database of tokens for autocompletion.
+// Implements a prefix index of tokens for autocompletion.
 
 class AutoCompleteChoice;
 
@@ -30,15 +30,43 @@ struct ACTreeLeaf
 bool operator<(const ACTreeLeaf &one, const ACTreeLeaf &two);
 bool operator==(const ACTreeLeaf &one, const ACTreeLeaf &two);
 
+// Tokens are stored in a trie keyed on their lowercase form. Each node knows which source types
+// are present in its subtree, so lookups can skip branches that can't produce anything.
+// Tokens are added in groups, by owner (e.g. a script, or the kernel names). Replacing an
+// owner's tokens only touches the parts of the trie that changed.
 class TokenDatabase
 {
 public:
-    void BuildDatabase(std::multiset<ACTreeLeaf> &originals);
-    void GetAutoCompleteChoices(const std::string &prefix, AutoCompleteSourceType sourceTypes, std::vector<AutoCompleteChoice> &choices);
+    TokenDatabase();
+
+    void SetTokens(const std::string &owner, std::vector<ACTreeLeaf> tokens);
+    void RemoveTokens(const std::string &owner);
+    void Clear();
+    void GetAutoCompleteChoices(const std::string &prefix, AutoCompleteSourceType sourceTypes, std::vector<AutoCompleteChoice> &choices) const;
 
 private:
-    std::vector<ACTreeLeaf> _originals;
-    sci::ostream _data;
-    // [chars in common with prev][add'l char length][remaining chars][index into _originals (2 bytes)]
-    std::unordered_map<char, size_t> _offsets;  // Into data
-};
\ No newline at end of file
+    struct Token
+    {
+        AutoCompleteSourceType SourceType;
+        std::string Original;
+        int RefCount;   // The number of owners that have this token
+    };
+
+    struct Node
+    {
+        Node() : SourceTypes(AutoCompleteSourceType::None) {}
+
+        std::vector<std::pair<uint8_t, uint32_t>> Children;    // Sorted by character
+        std::vector<Token> Tokens;                              // Tokens that end here
+        AutoCompleteSourceType SourceTypes;                     // Of all the tokens in this subtree
+    };
+
+    void _Add(const ACTreeLeaf &leaf);
+    void _Remove(const ACTreeLeaf &leaf);
+    uint32_t _NewNode();
+    void _Collect(uint32_t nodeIndex, AutoCompleteSourceType sourceTypes, std::string &lower, std::vector<AutoCompleteChoice> &choices) const;
+
+    std::vector<Node> _nodes;           // _nodes[0] is the root
+    std::vector<uint32_t> _freeNodes;
+    std::unordered_map<std::string, std::vector<ACTreeLeaf>> _owners;  // Each sorted, with no duplicates
+};
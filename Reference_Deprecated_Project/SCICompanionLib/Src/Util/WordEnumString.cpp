@@ -47,14 +47,15 @@ private:
 
     Vocab000 _vocab;
 
-    size_t _vocabIndex;
+    // Our own copy of the vocab is never modified, so this stays valid.
+    Vocab000::word_set::const_iterator _vocabIt;
 };
 
 
 CWordEnumString::CWordEnumString()
 {
     _cRef = 1;
-    _vocabIndex = 0;
+    _vocabIt = _vocab.GetWords().begin();
 }
 
 CWordEnumString::~CWordEnumString()
@@ -103,10 +104,10 @@ HRESULT CWordEnumString::Next(ULONG celt, LPOLESTR *rgelt, ULONG *pceltFetched)
 {
     HRESULT hr = S_FALSE;
     *pceltFetched = 0;
-    vector<string> &words = _vocab.GetWords();
-    while ((celt > 0) && SUCCEEDED(hr) && (_vocabIndex < words.size()))
+    const Vocab000::word_set &words = _vocab.GetWords();
+    while ((celt > 0) && SUCCEEDED(hr) && (_vocabIt != words.end()))
     {
-        string &strWord = words[_vocabIndex];
+        const string &strWord = *_vocabIt;
         int cch = (int)strWord.length() + 1;
         rgelt[*pceltFetched] = (LPOLESTR)CoTaskMemAlloc(cch * sizeof(WCHAR));
         hr = rgelt[*pceltFetched] ? S_OK : E_OUTOFMEMORY;
@@ -116,20 +117,25 @@ HRESULT CWordEnumString::Next(ULONG celt, LPOLESTR *rgelt, ULONG *pceltFetched)
             (*pceltFetched)++;
             celt--;
         }
-        _vocabIndex++;
+        ++_vocabIt;
     }
     return hr;
 }
 
 HRESULT CWordEnumString::Skip(ULONG celt)
 {
-    _vocabIndex += celt;
+    const Vocab000::word_set &words = _vocab.GetWords();
+    while ((celt > 0) && (_vocabIt != words.end()))
+    {
+        ++_vocabIt;
+        celt--;
+    }
     return S_OK;
 }
 
 HRESULT CWordEnumString::Reset()
 {
-    _vocabIndex = 0;
+    _vocabIt = _vocab.GetWords().begin();
     return S_OK;
 }
 
@@ -141,6 +147,7 @@ HRESULT CWordEnumString::Clone(IEnumString **ppenum)
 HRESULT CWordEnumString::Init()
 {
     _vocab = *appState->GetResourceMap().GetVocab000();
+    _vocabIt = _vocab.GetWords().begin();
     return S_OK;
 }
 
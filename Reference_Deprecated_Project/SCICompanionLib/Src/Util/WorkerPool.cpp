@@ -0,0 +1,96 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+#include "WorkerPool.h"
+
+using namespace std;
+
+WorkerPool &WorkerPool::GetShared()
+{
+    // This is never deleted. Worker threads may still be running code that depends on
+    // global state when the process exits, so we don't want to wait for them then.
+    static WorkerPool *sharedPool = new WorkerPool(max(1u, std::thread::hardware_concurrency()));
+    return *sharedPool;
+}
+
+WorkerPool::WorkerPool(unsigned int workerCount) : _exit(false)
+{
+    try
+    {
+        for (unsigned int i = 0; i < workerCount; i++)
+        {
+            _threads.emplace_back(&WorkerPool::_Worker, this);
+        }
+    }
+    catch (std::system_error)
+    {
+        // We'll make do with the workers we were able to start.
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _exit = true;
+    }
+    _condition.notify_all();
+    for (std::thread &thread : _threads)
+    {
+        thread.join();
+    }
+}
+
+void WorkerPool::Schedule(std::weak_ptr<IWorkSource> source, WorkPriority priority)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _scheduled[(int)priority].push_back(source);
+    }
+    _condition.notify_one();
+}
+
+void WorkerPool::_Worker()
+{
+    while (true)
+    {
+        std::shared_ptr<IWorkSource> source;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [&]()
+            {
+                return _exit || any_of(begin(_scheduled), end(_scheduled), [](const deque<weak_ptr<IWorkSource>> &scheduled) { return !scheduled.empty(); });
+            });
+            if (_exit)
+            {
+                break;
+            }
+            for (auto &scheduled : _scheduled)
+            {
+                if (!scheduled.empty())
+                {
+                    source = scheduled.front().lock();
+                    scheduled.pop_front();
+                    break;
+                }
+            }
+        }
+
+        // The source may have gone away in the meantime.
+        if (source)
+        {
+            source->RunOne();
+        }
+    }
+}
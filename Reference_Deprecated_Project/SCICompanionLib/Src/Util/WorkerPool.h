@@ -0,0 +1,69 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#pragma once
+
+#include <deque>
+
+// How soon the result of a piece of background work is needed.
+enum class WorkPriority
+{
+    Visible = 0,        // It's on screen now
+    NearVisible = 1,    // It will likely be on screen soon
+    Prefetch = 2,       // It might be wanted eventually
+};
+
+const int WorkPriorityCount = 3;
+
+class IWorkSource
+{
+public:
+    virtual ~IWorkSource() {}
+
+    // Runs the most urgent of the source's pending work items, if there are any.
+    virtual void RunOne() = 0;
+};
+
+//
+// A fixed set of worker threads shared by everything that generates previews in
+// the background (see QueueItems).
+//
+// Each time a work source has a new work item, it schedules itself with the pool at that
+// item's priority. An idle worker picks the source scheduled at the most urgent priority,
+// and asks it to run its most urgent item. Sources can reprioritize or cancel items that
+// haven't started yet without telling the pool; at worst a worker finds nothing to do.
+//
+class WorkerPool
+{
+public:
+    // Sized to the hardware, and lives for the lifetime of the process.
+    static WorkerPool &GetShared();
+
+    WorkerPool(unsigned int workerCount);
+    WorkerPool(const WorkerPool &src) = delete;
+    WorkerPool &operator=(const WorkerPool &src) = delete;
+    ~WorkerPool();
+
+    unsigned int GetWorkerCount() const { return (unsigned int)_threads.size(); }
+
+    void Schedule(std::weak_ptr<IWorkSource> source, WorkPriority priority);
+
+private:
+    void _Worker();
+
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _exit;
+    std::deque<std::weak_ptr<IWorkSource>> _scheduled[WorkPriorityCount];
+    std::vector<std::thread> _threads;
+};
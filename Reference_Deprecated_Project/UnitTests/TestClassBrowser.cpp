@@ -20,6 +20,9 @@
 #include "Helper.h"
 #include "ClassBrowser.h"
 #include "Task.h"
+#include "Vocab99x.h"
+#include "CodeAutoComplete.h"
+#include "AutoCompleteSourceTypes.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -87,10 +90,35 @@ namespace UnitTests
             browser.ReLoadFromSources(taskStatus);
             Assert::IsTrue(ok);
 
+            // Selectors added after the game was loaded (e.g. by compiling) should be completed, whichever
+            // way the class browser gets its names.
+            _AddSelector("zzNewSelectorA");
+            browser.ReloadKernelAndSelectorNames();
+            Assert::IsTrue(_IsSelectorCompleted(browser, "zzNewSelectorA"));
+            _AddSelector("zzNewSelectorB");
+            browser.ReLoadFromCompiled(taskStatus);
+            Assert::IsTrue(_IsSelectorCompleted(browser, "zzNewSelectorA"));
+            Assert::IsTrue(_IsSelectorCompleted(browser, "zzNewSelectorB"));
+
             // TODO: Now make some queries.
             // pick a script (0) and some points in it, and try to get tooltips, autocopmletes and such.
         }
 
+        static void _AddSelector(const std::string &name)
+        {
+            SelectorTable selectors;
+            Assert::IsTrue(selectors.Load(appState->GetResourceMap().Helper()));
+            selectors.Add(name);
+            selectors.Save();
+        }
+
+        static bool _IsSelectorCompleted(SCIClassBrowser &browser, const std::string &name)
+        {
+            std::vector<AutoCompleteChoice> choices;
+            browser.GetAutoCompleteChoices(name.substr(0, 8), AutoCompleteSourceType::Selector, choices);
+            return std::any_of(choices.begin(), choices.end(), [&name](const AutoCompleteChoice &choice) { return choice.GetText() == name; });
+        }
+
     private:
         static std::string _gameFolder;
     };
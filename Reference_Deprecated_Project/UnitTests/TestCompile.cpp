@@ -19,6 +19,10 @@
 #include "CompileContext.h"
 #include "Helper.h"
 #include "ScriptConvert.h"
+#include "ValidateSaid.h"
+#include "ParsedScriptCache.h"
+#include "SCOCache.h"
+#include "GameFolderHelper.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -47,6 +51,57 @@ namespace UnitTests
             _DoIt();
         }
 
+        TEST_METHOD(TestValidateSaidsSCI0)
+        {
+            _gameFolder = SetUpGameSCI0();
+            ClearParsedScriptCache();
+
+            // Once parsing everything...
+            std::vector<std::string> serial = _ValidateSaids(1);
+            Assert::IsFalse(serial.empty());
+            unsigned int maxWorkers = max(2u, std::thread::hardware_concurrency());
+            Assert::IsTrue(serial == _ValidateSaids(maxWorkers));
+
+            // ...and again with the scripts the compiler already parsed.
+            _DoItHelper();
+            Assert::IsTrue(serial == _ValidateSaids(maxWorkers));
+        }
+
+        TEST_METHOD(TestSCOCacheSCI0)
+        {
+            _gameFolder = SetUpGameSCI0();
+            _DoItHelper();
+
+            CompileTables tables;
+            tables.Load(appState->GetVersion());
+            const GameFolderHelper &helper = appState->GetResourceMap().Helper();
+            std::string scoFileName = helper.GetScriptObjectFileName("main");
+            SCOLoadStatus status;
+            std::string openError;
+            std::shared_ptr<const IndexedSCOFile> first = GetCachedSCO(scoFileName, tables.Selectors(), status, openError);
+            Assert::IsTrue(first != nullptr);
+            Assert::IsTrue(first == GetCachedSCO(scoFileName, tables.Selectors(), status, openError));
+
+            // Writing the file replaces the cached copy.
+            SaveSCOFile(helper, first->GetSCO());
+            std::shared_ptr<const IndexedSCOFile> second = GetCachedSCO(scoFileName, tables.Selectors(), status, openError);
+            Assert::IsTrue(second != nullptr);
+            Assert::IsTrue(first != second);
+            Assert::IsTrue(first->GetSCO() == second->GetSCO());
+        }
+
+        std::vector<std::string> _ValidateSaids(unsigned int workerCount)
+        {
+            CompileLog log;
+            ValidateSaids(log, *appState->GetResourceMap().GetVocab000(), workerCount);
+            std::vector<std::string> messages;
+            for (const CompileResult &result : log.Results())
+            {
+                messages.push_back(result.GetMessage());
+            }
+            return messages;
+        }
+
         TEST_METHOD_CLEANUP(TestCompileAll_Clean)
         {
             CleanUpGame(_gameFolder);
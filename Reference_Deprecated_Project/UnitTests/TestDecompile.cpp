@@ -0,0 +1,168 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+//#include "CppUnitTest.h"
+#include "ResourceMap.h"
+#include "AppState.h"
+#include "ScriptOM.h"
+#include "CompiledScript.h"
+#include "DecompilerCore.h"
+#include "DecompilerConfig.h"
+#include "DecompilerResults.h"
+#include "GameFolderHelper.h"
+#include "Helper.h"
+#include "format.h"
+#include <chrono>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+class TestDecompilerResults : public IDecompilerResults
+{
+public:
+    TestDecompilerResults() : SuccessCount(0), FallbackCount(0) {}
+    void AddResult(DecompilerResultType type, const std::string &message) override {}
+    bool IsAborted() override { return false; }
+    void InformStats(bool functionSuccessful, int byteCount) override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (functionSuccessful)
+        {
+            SuccessCount++;
+        }
+        else
+        {
+            FallbackCount++;
+        }
+    }
+    void SetGlobalVarsUpdated(const std::vector<std::pair<std::string, std::string>> &mainDirtyRenames) override {}
+
+    int SuccessCount;
+    int FallbackCount;
+
+private:
+    std::mutex _mutex;
+};
+
+namespace UnitTests
+{
+    TEST_CLASS(TestDecompile)
+    {
+    public:
+        TEST_METHOD(TestDecompileAllScalingSCI0)
+        {
+            _gameFolder = SetUpGameSCI0();
+            _DoIt();
+        }
+
+        TEST_METHOD(TestDecompileAllScalingSCI11)
+        {
+            _gameFolder = SetUpGameSCI11();
+            _DoIt();
+        }
+
+        TEST_METHOD_CLEANUP(TestDecompileAll_Clean)
+        {
+            CleanUpGame(_gameFolder);
+        }
+
+        std::map<uint16_t, std::string> _DecompileAll(unsigned int workerCount)
+        {
+            const GameFolderHelper &helper = appState->GetResourceMap().Helper();
+            GlobalCompiledScriptLookups lookups;
+            Assert::IsTrue(lookups.Load(helper));
+            // Prime the selector table, as the decompile dialog does.
+            uint16_t wDummy;
+            lookups.GetSelectorTable().ReverseLookup("", wDummy);
+            std::unique_ptr<IDecompilerConfig> config = CreateDecompilerConfig(helper, lookups.GetSelectorTable());
+
+            std::set<uint16_t> scriptNumbers;
+            for (CompiledScript *script : lookups.GetGlobalClassTable().GetAllScripts())
+            {
+                scriptNumbers.insert(script->GetScriptNumber());
+            }
+
+            std::map<uint16_t, std::string> sources;
+            TestDecompilerResults results;
+            auto start = std::chrono::high_resolution_clock::now();
+            DecompileScripts(config.get(), lookups, helper, scriptNumbers, results, workerCount,
+                [&sources, &helper](uint16_t scriptNumber, sci::Script &script)
+            {
+                std::stringstream ss;
+                sci::SourceCodeWriter out(ss, helper.GetDefaultGameLanguage(), &script);
+                script.OutputSourceCode(out);
+                sources[scriptNumber] = ss.str();
+            });
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+
+            std::wstring message = fmt::format(L"Decompiled {0} scripts ({1} functions, {2} fell back) with {3} worker(s) in {4}ms.",
+                sources.size(), results.SuccessCount + results.FallbackCount, results.FallbackCount, workerCount, elapsed.count());
+            Logger::WriteMessage(message.c_str());
+            return sources;
+        }
+
+        // Decompiles one script at a time with DecompileScript, the way the decompile dialog used to.
+        std::map<uint16_t, std::string> _DecompileAllOneByOne()
+        {
+            const GameFolderHelper &helper = appState->GetResourceMap().Helper();
+            GlobalCompiledScriptLookups lookups;
+            Assert::IsTrue(lookups.Load(helper));
+            uint16_t wDummy;
+            lookups.GetSelectorTable().ReverseLookup("", wDummy);
+            std::unique_ptr<IDecompilerConfig> config = CreateDecompilerConfig(helper, lookups.GetSelectorTable());
+
+            std::set<uint16_t> scriptNumbers;
+            for (CompiledScript *script : lookups.GetGlobalClassTable().GetAllScripts())
+            {
+                scriptNumbers.insert(script->GetScriptNumber());
+            }
+
+            std::map<uint16_t, std::string> sources;
+            TestDecompilerResults results;
+            for (uint16_t scriptNumber : scriptNumbers)
+            {
+                CompiledScript compiledScript(0, CompiledScriptFlags::RemoveBadExports);
+                if (compiledScript.Load(helper, helper.Version, scriptNumber))
+                {
+                    std::unique_ptr<sci::Script> script = DecompileScript(config.get(), lookups, helper, scriptNumber, compiledScript, results);
+                    std::stringstream ss;
+                    sci::SourceCodeWriter out(ss, helper.GetDefaultGameLanguage(), script.get());
+                    script->OutputSourceCode(out);
+                    sources[scriptNumber] = ss.str();
+                }
+            }
+            return sources;
+        }
+
+        void _DoIt()
+        {
+            // The first pass generates the .sco files that later passes pick up names from.
+            _DecompileAll(1);
+
+            std::map<uint16_t, std::string> serial = _DecompileAll(1);
+            Assert::IsFalse(serial.empty());
+            Assert::IsTrue(serial == _DecompileAllOneByOne());
+            unsigned int maxWorkers = max(2u, std::thread::hardware_concurrency());
+            for (unsigned int workerCount = 2; workerCount <= maxWorkers; workerCount *= 2)
+            {
+                std::map<uint16_t, std::string> parallel = _DecompileAll(workerCount);
+                Assert::IsTrue(serial == parallel);
+            }
+        }
+
+    private:
+        static std::string _gameFolder;
+    };
+
+    std::string TestDecompile::_gameFolder;
+}
@@ -0,0 +1,139 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+//#include "CppUnitTest.h"
+#include "ResourceMap.h"
+#include "AppState.h"
+#include "GameFolderHelper.h"
+#include "CCrystalTextBuffer.h"
+#include "FindInFiles.h"
+#include "Helper.h"
+#include "format.h"
+#include <filesystem>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// What find in files used to do: load each file into a text buffer, and search each line.
+std::vector<FoundLine> FindLinesWithTextBuffer(const std::string &filename, const std::string &what, bool matchCase, bool wholeWord)
+{
+    std::vector<FoundLine> found;
+    CCrystalTextBuffer buffer;
+    if (buffer.LoadFromFile(filename.c_str()))
+    {
+        CString strWhat = what.c_str();
+        if (!matchCase)
+        {
+            strWhat.MakeUpper();
+        }
+        for (int nLine = 0; nLine < buffer.GetLineCount(); nLine++)
+        {
+            int nLineLength = buffer.GetLineLength(nLine);
+            if (nLineLength > 0)
+            {
+                std::string lineText(buffer.GetLineChars(nLine), nLineLength);
+                CString line = lineText.c_str();
+                if (!matchCase)
+                {
+                    line.MakeUpper();
+                }
+                if (FindStringHelper(line, strWhat, wholeWord) >= 0)
+                {
+                    found.push_back({ nLine, lineText });
+                }
+            }
+        }
+    }
+    buffer.FreeAll();
+    return found;
+}
+
+bool operator==(const FoundLine &one, const FoundLine &two)
+{
+    return (one.LineNumber == two.LineNumber) && (one.Text == two.Text);
+}
+
+namespace UnitTests
+{
+    TEST_CLASS(TestFindInFiles)
+    {
+    public:
+        TEST_METHOD(TestFindInFilesMatchesTextBuffer)
+        {
+            _gameFolder = SetUpGameSCI0();
+
+            std::string srcFolder = appState->GetResourceMap().Helper().GetSrcFolder();
+            std::vector<std::string> filenames;
+            for (auto it = std::tr2::sys::directory_iterator(std::tr2::sys::path(srcFolder)); it != std::tr2::sys::directory_iterator(); ++it)
+            {
+                filenames.push_back(it->path().string());
+            }
+            Assert::IsFalse(filenames.empty());
+
+            const char *searches[] = { "send", "SEND", "gEgo", "(method", "x", "_", "init:" };
+            for (const char *what : searches)
+            {
+                for (int flags = 0; flags < 4; flags++)
+                {
+                    bool matchCase = (flags & 1) != 0;
+                    bool wholeWord = (flags & 2) != 0;
+                    size_t index = 0;
+                    FindInFiles(filenames, TextFinder(what, matchCase, wholeWord), 4,
+                        [&](const std::string &filename, const std::vector<FoundLine> &lines)
+                    {
+                        Assert::IsTrue(filenames[index++] == filename);
+                        std::vector<FoundLine> expected = FindLinesWithTextBuffer(filename, what, matchCase, wholeWord);
+                        if (!(expected == lines))
+                        {
+                            std::wstring message = fmt::format(L"Different results for \"{0}\" in {1}", what, filename);
+                            Logger::WriteMessage(message.c_str());
+                            Assert::IsTrue(false);
+                        }
+                    });
+                    Assert::IsTrue(filenames.size() == index);
+                }
+            }
+        }
+
+        TEST_METHOD(TestFindInFilesLineEndings)
+        {
+            // Unix files, mixed line endings, a trailing separator, and a search string that straddles a line break.
+            const std::string text[] = { "foo\nbar\n\nfoo", "foo\r\nbar\nfoo\r\nbaz\r\n", "foo\n\rfoo\n\r", "fo\r\no foo" };
+            const int expected[][3] = { { 0, 3, -1 }, { 0, 1, -1 }, { 0, 1, -1 }, { 1, -1, -1 } };
+            for (int i = 0; i < ARRAYSIZE(text); i++)
+            {
+                std::vector<int> lineNumbers;
+                TextFinder("foo", true, true).FindLines(text[i].c_str(), text[i].size(),
+                    [&lineNumbers](int lineNumber, const char *line, size_t lineLength) { lineNumbers.push_back(lineNumber); });
+                for (size_t j = 0; j < 3; j++)
+                {
+                    Assert::AreEqual(expected[i][j], (j < lineNumbers.size()) ? lineNumbers[j] : -1);
+                }
+            }
+        }
+
+        TEST_METHOD_CLEANUP(TestFindInFiles_Clean)
+        {
+            if (!_gameFolder.empty())
+            {
+                CleanUpGame(_gameFolder);
+                _gameFolder.clear();
+            }
+        }
+
+    private:
+        static std::string _gameFolder;
+    };
+
+    std::string TestFindInFiles::_gameFolder;
+}
@@ -0,0 +1,246 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+//#include "CppUnitTest.h"
+#include "Audio.h"
+#include "Sync.h"
+#include "PhonemeMap.h"
+#include "phone_estimate.h"
+#include "AcousticLipSync.h"
+#include "ResourceMap.h"
+#include "AppState.h"
+#include "Helper.h"
+#include "format.h"
+#include <chrono>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Synthesizes clips of "speech": vowels are harmonics of a 120Hz voice shaped by two formants, and fricatives
+// are noise.
+class SpeechSynthesizer
+{
+public:
+    SpeechSynthesizer(uint16_t frequency) : _frequency(frequency), _seed(12345) {}
+
+    void Silence(int ms)
+    {
+        for (int i = 0; i < _GetSampleCount(ms); i++)
+        {
+            _samples.push_back(_Noise() * 0.0005f);
+        }
+    }
+
+    void Fricative(int ms)
+    {
+        for (int i = 0; i < _GetSampleCount(ms); i++)
+        {
+            _samples.push_back(_Noise() * 0.3f);
+        }
+    }
+
+    void Vowel(int ms, float f1, float f2)
+    {
+        const float F0 = 120.0f;
+        for (int i = 0; i < _GetSampleCount(ms); i++)
+        {
+            float t = (float)i / (float)_frequency;
+            float value = 0.0f;
+            for (float f = F0; f < (_frequency / 2); f += F0)
+            {
+                float amplitude = 1.0f / (1.0f + pow((f - f1) / 80.0f, 2.0f)) + 0.6f / (1.0f + pow((f - f2) / 100.0f, 2.0f));
+                value += amplitude * sin(2.0f * 3.14159265f * f * t);
+            }
+            _samples.push_back(value);
+        }
+    }
+
+    AudioComponent Create(bool sixteenBit) const
+    {
+        float peak = 0.0f;
+        for (float value : _samples)
+        {
+            peak = max(peak, fabs(value));
+        }
+
+        AudioComponent audio;
+        audio.Frequency = _frequency;
+        if (sixteenBit)
+        {
+            audio.Flags = AudioFlags::SixteenBit | AudioFlags::Signed;
+            for (float value : _samples)
+            {
+                int16_t sample = (int16_t)(value / peak * 30000.0f);
+                audio.DigitalSamplePCM.push_back((uint8_t)(sample & 0xff));
+                audio.DigitalSamplePCM.push_back((uint8_t)((sample >> 8) & 0xff));
+            }
+        }
+        else
+        {
+            for (float value : _samples)
+            {
+                audio.DigitalSamplePCM.push_back((uint8_t)(128.0f + value / peak * 120.0f));
+            }
+        }
+        return audio;
+    }
+
+private:
+    int _GetSampleCount(int ms) const { return _frequency * ms / 1000; }
+
+    float _Noise()
+    {
+        _seed = _seed * 1664525 + 1013904223;
+        return (float)(_seed >> 8) / (float)(1 << 23) - 1.0f;
+    }
+
+    uint16_t _frequency;
+    uint32_t _seed;
+    std::vector<float> _samples;
+};
+
+namespace UnitTests
+{
+    TEST_CLASS(TestLipSync)
+    {
+    public:
+        TEST_METHOD(TestAcousticLipSyncPhonemes)
+        {
+            for (uint16_t frequency : { 11025, 22050 })
+            {
+                for (bool sixteenBit : { false, true })
+                {
+                    SpeechSynthesizer speech(frequency);
+                    speech.Silence(300);
+                    speech.Vowel(400, 730.0f, 1090.0f);   // "father"
+                    speech.Fricative(200);
+                    speech.Vowel(400, 270.0f, 2290.0f);   // "feel"
+                    speech.Silence(300);
+                    AudioComponent audio = speech.Create(sixteenBit);
+
+                    std::vector<alignment_result> results;
+                    EstimatePhonemeAlignmentFromAudio(audio, results);
+                    std::vector<std::wstring> phonemes;
+                    for (const alignment_result &result : results)
+                    {
+                        phonemes.insert(phonemes.end(), result.m_phonemes.begin(), result.m_phonemes.end());
+                    }
+                    std::vector<std::wstring> expected = { L"x", L"AH", L"s", L"IY", L"x" };
+                    Assert::IsTrue(expected == phonemes);
+
+                    // Roughly where they are in the clip.
+                    Assert::IsTrue(abs(results[1].m_msStart - 300) <= 20);
+                    Assert::IsTrue(abs(results[1].m_phonemeEndTimes[1] - 900) <= 20);
+                    Assert::IsTrue(abs(results[1].m_msEnd - 1300) <= 20);
+                }
+            }
+        }
+
+        TEST_METHOD(TestAcousticLipSyncThroughput)
+        {
+            PhonemeMap phonemeMap("c:\\NoSuchFolder\\phonemes.ini");
+            phonemeMap.SetCel("x", 0);
+            phonemeMap.SetCel("AH", 1);
+            phonemeMap.SetCel("s", 2);
+            phonemeMap.SetCel("IY", 3);
+
+            std::vector<AudioComponent> clips;
+            for (int i = 0; i < 200; i++)
+            {
+                SpeechSynthesizer speech(22050);
+                speech.Silence(200);
+                speech.Vowel(500 + (i % 10) * 100, 640.0f, 1190.0f);
+                speech.Fricative(150);
+                speech.Vowel(300, 270.0f, 2290.0f);
+                speech.Silence(200);
+                clips.push_back(speech.Create(true));
+            }
+            std::vector<const AudioComponent*> audios;
+            for (const AudioComponent &clip : clips)
+            {
+                audios.push_back(&clip);
+            }
+
+            std::vector<std::unique_ptr<SyncComponent>> serial = _CreateAll(audios, phonemeMap, 1);
+            unsigned int maxWorkers = max(2u, std::thread::hardware_concurrency());
+            for (unsigned int workerCount = 2; workerCount <= maxWorkers; workerCount *= 2)
+            {
+                std::vector<std::unique_ptr<SyncComponent>> parallel = _CreateAll(audios, phonemeMap, workerCount);
+                Assert::AreEqual((int)serial.size(), (int)parallel.size());
+                for (size_t i = 0; i < serial.size(); i++)
+                {
+                    Assert::IsTrue(*serial[i] == *parallel[i]);
+                }
+            }
+
+            // Silence, the two vowels and the fricative, then back to silence.
+            std::vector<uint16_t> cels;
+            for (const SyncEntry &entry : serial[0]->Entries)
+            {
+                if (cels.empty() || (cels.back() != entry.Cel))
+                {
+                    cels.push_back(entry.Cel);
+                }
+            }
+            std::vector<uint16_t> expected = { 0, 1, 2, 3, 0 };
+            Assert::IsTrue(expected == cels);
+        }
+
+        TEST_METHOD(TestAcousticLipSyncGameSCI11)
+        {
+            _gameFolder = SetUpGameSCI11();
+            PhonemeMap phonemeMap("c:\\NoSuchFolder\\phonemes.ini");
+            phonemeMap.SetCel("x", 0);
+
+            size_t callbackCount = 0;
+            LipSyncBatchStats stats = CreateLipSyncComponentsForGame(appState->GetResourceMap().Helper(), phonemeMap, std::thread::hardware_concurrency(),
+                [&callbackCount](const ResourceBlob &blob, std::unique_ptr<SyncComponent> sync)
+            {
+                Assert::IsTrue(sync != nullptr);
+                callbackCount++;
+            });
+            // The template game has clips in its main audio map.
+            Assert::IsTrue(stats.ClipCount > 0);
+            Assert::IsTrue(stats.AudioMilliseconds > 0);
+            Assert::AreEqual((int)stats.ClipCount, (int)callbackCount);
+
+            std::wstring message = fmt::format(L"Lip synced {0} clips ({1}s of audio) in {2}ms.", stats.ClipCount, stats.AudioMilliseconds / 1000, stats.ElapsedMilliseconds);
+            Logger::WriteMessage(message.c_str());
+        }
+
+        TEST_METHOD_CLEANUP(TestLipSync_Clean)
+        {
+            if (!_gameFolder.empty())
+            {
+                CleanUpGame(_gameFolder);
+                _gameFolder.clear();
+            }
+        }
+
+    private:
+        std::vector<std::unique_ptr<SyncComponent>> _CreateAll(const std::vector<const AudioComponent*> &audios, const PhonemeMap &phonemeMap, unsigned int workerCount)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            std::vector<std::unique_ptr<SyncComponent>> results = CreateLipSyncComponentsFromAudio(audios, phonemeMap, workerCount);
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+            std::wstring message = fmt::format(L"Lip synced {0} clips with {1} worker(s) in {2}ms ({3} clips per second).",
+                results.size(), workerCount, elapsed.count(), results.size() * 1000 / max(1ll, (long long)elapsed.count()));
+            Logger::WriteMessage(message.c_str());
+            return results;
+        }
+
+        static std::string _gameFolder;
+    };
+
+    std::string TestLipSync::_gameFolder;
+}
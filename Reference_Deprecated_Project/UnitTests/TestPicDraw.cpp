@@ -25,6 +25,7 @@ using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 #include "ResourceMapOperations.h"
 #include "PatchResourceSource.h"
 #include "PicDrawManager.h"
+#include "PicCommands.h"
 #include "Pic.h"
 #include "ResourceEntity.h"
 #include "ResourceSourceFlags.h"
@@ -101,17 +102,74 @@ void VerifyPic(PicDrawManager &pdm, PicScreen screen, const std::string &fileNam
     }
 }
 
+// The control mask should give the same answers as looking at each pixel.
+void VerifyControlMask(PicDrawManager &pdm, size16 size)
+{
+    const uint8_t *pdataControl = pdm.GetPicBits(PicScreen::Control, PicPosition::Final, size);
+    const ControlMask &controlMask = pdm.GetControlMask(PicPosition::Final, size);
+    const uint16_t controlMasks[] = { 0x8000, 0x0001, 0x4010, 0xffff };
+    for (uint16_t wControlMask : controlMasks)
+    {
+        for (int y = -2; y < size.cy + 2; y += 3)
+        {
+            for (int x = -20; x < size.cx; x += 7)
+            {
+                CRect rect(x, y, x + (x + 20) % 97, y + 1);
+                bool expected = CanBeHere(size, pdataControl, rect, wControlMask);
+                if (expected != controlMask.CanBeHere(rect, wControlMask))
+                {
+                    std::wstring message = fmt::format(L"ControlMask disagrees at ({0},{1})-({2},{3}) for mask {4:04x}", rect.left, rect.top, rect.right, rect.bottom, wControlMask);
+                    Logger::WriteMessage(message.c_str());
+                    Assert::IsTrue(false);
+                }
+            }
+        }
+    }
+}
+
+// Each pixel should look the same right after the command that last wrote it, as it does at the end.
+void VerifyProvenance(ResourceEntity &resource, size16 size)
+{
+    PicDrawManager pdm(resource.TryGetComponent<PicComponent>(), resource.TryGetComponent<PaletteComponent>());
+    const uint8_t *pdataFinal = pdm.GetPicBits(PicScreen::Visual, PicPosition::Final, size);
+    std::vector<uint8_t> finalVisual(pdataFinal, pdataFinal + size.cx * size.cy);
+    const PicProvenance &provenance = pdm.GetProvenance();
+
+    PicDrawManager pdmPartial(resource.TryGetComponent<PicComponent>(), resource.TryGetComponent<PaletteComponent>());
+    for (int y = 0; y < size.cy; y += 17)
+    {
+        for (int x = 0; x < size.cx; x += 23)
+        {
+            uint32_t command = provenance.GetCommand(PicScreen::Visual, x, y);
+            if (command != PicProvenance::NoCommand)
+            {
+                pdmPartial.SeekToPos(command + 1);
+                const uint8_t *pdataPartial = pdmPartial.GetPicBits(PicScreen::Visual, PicPosition::PrePlugin, size);
+                int p = BUFFEROFFSET_NONSTD(size.cx, size.cy, x, y);
+                if (finalVisual[p] != pdataPartial[p])
+                {
+                    std::wstring message = fmt::format(L"Provenance says command {0} last wrote ({1},{2}), but the pixel changed after it", command, x, y);
+                    Logger::WriteMessage(message.c_str());
+                    Assert::IsTrue(false);
+                }
+            }
+        }
+    }
+}
+
 void VerifyFileWorker(ResourceEntity &resource, const std::string &filenameRaw)
 {
     PicDrawManager pdm(resource.TryGetComponent<PicComponent>(), resource.TryGetComponent<PaletteComponent>());
 
     VerifyPic(pdm, PicScreen::Visual, filenameRaw + "-vis.bmp");
     VerifyPic(pdm, PicScreen::Priority, filenameRaw + "-pri.bmp");
+    VerifyProvenance(resource, resource.GetComponent<PicComponent>().Size);
     std::string filenameCtl = filenameRaw + "-ctl.bmp";
     // SCI2 doesn't have ctl, so check first.
     if (PathFileExists(filenameCtl.c_str()))
     {
         VerifyPic(pdm, PicScreen::Control, filenameCtl);
+        VerifyControlMask(pdm, resource.GetComponent<PicComponent>().Size);
     }
 }
 
@@ -0,0 +1,204 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+//#include "CppUnitTest.h"
+#include "QueueItems.h"
+#include "format.h"
+#include <chrono>
+#include <future>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+class TestWorkItem
+{
+public:
+    TestWorkItem(int id, int spin) : Id(id), Spin(spin) {}
+    int Id;
+    int Spin;
+    std::shared_future<void> Gate;  // If set, the work item won't finish until this is ready.
+};
+
+class TestWorkResult
+{
+public:
+    int Id;
+    uint32_t Value;
+
+    static TestWorkResult *CreateFromWorkItem(TestWorkItem *pWorkItem)
+    {
+        if (pWorkItem->Gate.valid())
+        {
+            pWorkItem->Gate.wait();
+        }
+        // Something for the CPU to do that the compiler can't get rid of.
+        uint32_t value = (uint32_t)pWorkItem->Id;
+        for (int i = 0; i < pWorkItem->Spin; i++)
+        {
+            value = value * 1664525 + 1013904223;
+        }
+        TestWorkResult *pResult = new TestWorkResult();
+        pResult->Id = pWorkItem->Id;
+        pResult->Value = value;
+        return pResult;
+    }
+};
+
+// Stands in for the UI thread: waits for the queue to say results are ready, then takes them.
+class TestResultCollector
+{
+public:
+    TestResultCollector() : _ready(false), _notificationCount(0) {}
+
+    std::function<void()> GetCallback()
+    {
+        return [this]()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _ready = true;
+                _notificationCount++;
+            }
+            _condition.notify_one();
+        };
+    }
+
+    std::vector<int> Collect(QueueItems<TestWorkItem, TestWorkResult> &queue, size_t count)
+    {
+        std::vector<int> ids;
+        while (ids.size() < count)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _condition.wait(lock, [this]() { return _ready; });
+                _ready = false;
+            }
+            for (auto &result : queue.TakeWorkResults())
+            {
+                ids.push_back(result->Id);
+            }
+        }
+        return ids;
+    }
+
+    int GetNotificationCount()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _notificationCount;
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _condition;
+    bool _ready;
+    int _notificationCount;
+};
+
+namespace UnitTests
+{
+    TEST_CLASS(TestQueueItems)
+    {
+    public:
+        TEST_METHOD(TestQueueItemsThroughput)
+        {
+            const int itemCount = 20000;
+            const int spin = 20000;
+            unsigned int maxWorkers = max(2u, std::thread::hardware_concurrency());
+            for (unsigned int workerCount = 1; workerCount <= maxWorkers; workerCount *= 2)
+            {
+                // The collector needs to outlive the pool's threads.
+                TestResultCollector collector;
+                WorkerPool pool(workerCount);
+                auto queue = std::make_shared<QueueItems<TestWorkItem, TestWorkResult>>(collector.GetCallback(), &pool);
+                Assert::IsTrue(queue->Init());
+
+                auto start = std::chrono::high_resolution_clock::now();
+                for (int i = 0; i < itemCount; i++)
+                {
+                    queue->GiveWorkItem(std::make_unique<TestWorkItem>(i, spin), (WorkPriority)(i % WorkPriorityCount));
+                }
+                std::vector<int> ids = collector.Collect(*queue, itemCount);
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+
+                // Every item should have completed exactly once.
+                std::sort(ids.begin(), ids.end());
+                Assert::AreEqual((size_t)itemCount, ids.size());
+                for (int i = 0; i < itemCount; i++)
+                {
+                    Assert::AreEqual(i, ids[i]);
+                }
+
+                std::wstring message = fmt::format(L"{0} worker(s): {1} items in {2}ms ({3} items/s), delivered in {4} batches.",
+                    workerCount, itemCount, elapsed.count(), (long long)itemCount * 1000 / max(1ll, (long long)elapsed.count()), collector.GetNotificationCount());
+                Logger::WriteMessage(message.c_str());
+                queue->Abort();
+            }
+        }
+
+        TEST_METHOD(TestQueueItemsPriorityAndCancellation)
+        {
+            TestResultCollector collector;
+            WorkerPool pool(1);
+            auto queue = std::make_shared<QueueItems<TestWorkItem, TestWorkResult>>(collector.GetCallback(), &pool);
+            Assert::IsTrue(queue->Init());
+
+            // Keep the only worker busy while we fill up the queue.
+            std::promise<void> gate;
+            std::unique_ptr<TestWorkItem> gateItem = std::make_unique<TestWorkItem>(0, 0);
+            gateItem->Gate = gate.get_future().share();
+            queue->GiveWorkItem(move(gateItem));
+            while (!_IsQueueEmpty(*queue))
+            {
+                std::this_thread::yield();
+            }
+
+            for (int i = 0; i < 10; i++)
+            {
+                queue->GiveWorkItem(std::make_unique<TestWorkItem>(100 + i, 0), WorkPriority::Prefetch);
+                queue->GiveWorkItem(std::make_unique<TestWorkItem>(200 + i, 0), WorkPriority::NearVisible);
+                queue->GiveWorkItem(std::make_unique<TestWorkItem>(300 + i, 0), WorkPriority::Visible);
+            }
+
+            // Cancel the even ones, and bump one of the prefetch items up to visible.
+            std::vector<std::unique_ptr<TestWorkItem>> cancelled = queue->ReprioritizeWorkItems(
+                [](const TestWorkItem &workItem, WorkPriority &priority)
+            {
+                if (workItem.Id == 101)
+                {
+                    priority = WorkPriority::Visible;
+                }
+                return (workItem.Id % 2) != 0;
+            });
+            Assert::AreEqual((size_t)15, cancelled.size());
+
+            gate.set_value();
+            std::vector<int> ids = collector.Collect(*queue, 16);
+            std::vector<int> expected = { 0, 301, 303, 305, 307, 309, 101, 201, 203, 205, 207, 209, 103, 105, 107, 109 };
+            Assert::IsTrue(expected == ids);
+
+            // Nothing more should come through after we abort.
+            queue->Abort();
+            queue->GiveWorkItem(std::make_unique<TestWorkItem>(400, 0));
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            Assert::IsTrue(queue->TakeWorkResults().empty());
+        }
+
+    private:
+        static bool _IsQueueEmpty(QueueItems<TestWorkItem, TestWorkResult> &queue)
+        {
+            bool empty = true;
+            queue.ReprioritizeWorkItems([&empty](const TestWorkItem &, WorkPriority &) { empty = false; return true; });
+            return empty;
+        }
+    };
+}
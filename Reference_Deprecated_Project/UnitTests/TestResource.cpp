@@ -19,7 +19,13 @@
 #include "AppState.h"
 #include "ResourceContainer.h"
 #include "RasterOperations.h"
+#include "RasterKernels.h"
+#include "Pic.h"
+#include "PicCommands.h"
+#include "Audio.h"
 #include "format.h"
+#include <chrono>
+#include <random>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -73,5 +79,353 @@ namespace UnitTests
             Assert::AreEqual(loopMirror.MirrorOf, (uint8_t)0xff);
         }
 
+        // Simulates the undo stack: each edit clones the previous snapshot and modifies one thing.
+        template<typename _TComponent, typename _Func>
+        void _BenchmarkUndoSnapshots(const char *name, std::unique_ptr<ResourceEntity> resource, size_t minimumSavings, _Func edit)
+        {
+            const int SnapshotCount = 50;
+            std::vector<std::unique_ptr<ResourceEntity>> snapshots;
+            snapshots.push_back(move(resource));
+            size_t fullSize = snapshots[0]->EstimateSize(nullptr);
+            size_t sharedSize = fullSize;
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 1; i < SnapshotCount; i++)
+            {
+                std::unique_ptr<ResourceEntity> snapshot = snapshots.back()->Clone();
+                edit(snapshot->GetComponent<_TComponent>(), i);
+                sharedSize += snapshot->EstimateSize(snapshots.back().get());
+                snapshots.push_back(move(snapshot));
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - start);
+
+            size_t unsharedSize = 0;
+            for (auto &snapshot : snapshots)
+            {
+                unsharedSize += snapshot->EstimateSize(nullptr);
+            }
+            std::wstring message = fmt::format(L"{0}: {1} snapshots of {2} bytes in {3}us, using {4} bytes ({5} bytes without sharing).",
+                name, SnapshotCount, fullSize, elapsed.count(), sharedSize, unsharedSize);
+            Logger::WriteMessage(message.c_str());
+            Assert::IsTrue(sharedSize * minimumSavings < unsharedSize);
+        }
+
+        static void _AddBigCels(RasterComponent &raster)
+        {
+            raster.Loops.resize(8);
+            for (Loop &loop : raster.Loops)
+            {
+                loop.Cels.resize(16, Cel(size16(320, 190), point16(0, 0), 0));
+                for (Cel &cel : loop.Cels)
+                {
+                    cel.Data.allocate(cel.GetDataSize());
+                    cel.Data.fill(7);
+                }
+            }
+        }
+
+        TEST_METHOD(TestUndoSnapshotsView)
+        {
+            std::unique_ptr<ResourceEntity> view(CreateViewResource(sciVersion1_1));
+            _AddBigCels(view->GetComponent<RasterComponent>());
+            _BenchmarkUndoSnapshots<RasterComponent>("View", move(view), 10,
+                [](RasterComponent &raster, int i)
+            {
+                raster.Loops[i % 8].Cels[i % 16].Data[0] = (uint8_t)i;
+            });
+        }
+
+        static void _DrawPic(const PicComponent &picComponent)
+        {
+            size16 size(320, 190);
+            std::vector<uint8_t> visual(size.cx * size.cy, 0x0f);
+            std::vector<uint8_t> priority(visual.size(), 0);
+            std::vector<uint8_t> control(visual.size(), 0);
+            std::vector<uint8_t> aux(visual.size(), 0);
+            PicProvenance provenance(size);
+            PicData data =
+            {
+                PicScreenFlags::All,
+                &visual[0],
+                &priority[0],
+                &control[0],
+                &aux[0],
+                true,
+                false,
+                size,
+                false,
+                &provenance
+            };
+            ViewPort state(0);
+            for (size_t i = 0; i < picComponent.commands.size(); i++)
+            {
+                provenance.CurrentCommand = (uint32_t)i;
+                picComponent.commands[i].Draw(&data, state);
+            }
+        }
+
+        TEST_METHOD(TestUndoSnapshotsPic)
+        {
+            std::unique_ptr<ResourceEntity> pic(CreatePicResource(sciVersion1_1));
+            PicComponent &picComponent = pic->GetComponent<PicComponent>();
+            Cel background(size16(320, 190), point16(0, 0), 0xff);
+            background.Data.allocate(background.GetDataSize());
+            background.Data.fill(7);
+            PicCommand drawBitmap;
+            drawBitmap.CreateDrawVisualBitmap(background, true);
+            picComponent.commands.push_back(drawBitmap);
+            for (int i = 0; i < 1000; i++)
+            {
+                picComponent.commands.push_back(PicCommand::CreateLine((int16_t)(i % 320), (int16_t)(i % 190), (int16_t)((i * 7) % 320), (int16_t)((i * 3) % 190)));
+            }
+            // The command list itself is copied for each snapshot, but the bitmap is shared, and
+            // drawing the pic (as the editor does after each change) shouldn't unshare it.
+            _BenchmarkUndoSnapshots<PicComponent>("Pic", move(pic), 2,
+                [](PicComponent &picEdit, int i)
+            {
+                picEdit.commands.push_back(PicCommand::CreateFill((int16_t)i, (int16_t)i));
+                _DrawPic(picEdit);
+            });
+        }
+
+        TEST_METHOD(TestUndoSnapshotsDontAffectEachOther)
+        {
+            std::unique_ptr<ResourceEntity> view(CreateViewResource(sciVersion1_1));
+            _AddBigCels(view->GetComponent<RasterComponent>());
+            std::unique_ptr<ResourceEntity> snapshot = view->Clone();
+            Assert::AreEqual((int)sizeof(ResourceEntity), (int)snapshot->EstimateSize(view.get()));
+
+            snapshot->GetComponent<RasterComponent>().Loops[0].Cels[0].Data[0] = 3;
+            const RasterComponent &originalRaster = static_cast<const ResourceEntity&>(*view).GetComponent<RasterComponent>();
+            Assert::AreEqual(7, (int)originalRaster.Loops[0].Cels[0].Data[0]);
+            Assert::AreEqual(3, (int)snapshot->GetComponent<RasterComponent>().Loops[0].Cels[0].Data[0]);
+            Assert::AreEqual(7, (int)snapshot->GetComponent<RasterComponent>().Loops[0].Cels[1].Data[0]);
+        }
+
+
+        // The same angle conversion as RotateGroup.
+        static void _SinCos(int degrees, double &sinTheta, double &cosTheta)
+        {
+            sinTheta = sin(degrees * 6.283184 / 360.0);
+            cosTheta = cos(degrees * 6.283184 / 360.0);
+        }
+
+        // The straightforward per-pixel versions of the cel kernels, which they must match exactly.
+        static void _ReferenceStretch(const std::vector<uint8_t> &source, size16 sourceSize, std::vector<uint8_t> &dest, size16 destSize)
+        {
+            for (int y = 0; y < destSize.cy; y++)
+            {
+                for (int x = 0; x < destSize.cx; x++)
+                {
+                    dest[y * CX_ACTUAL(destSize.cx) + x] = source[(y * sourceSize.cy / destSize.cy) * CX_ACTUAL(sourceSize.cx) + (x * sourceSize.cx / destSize.cx)];
+                }
+            }
+        }
+
+        static void _ReferenceMirror(const std::vector<uint8_t> &source, std::vector<uint8_t> &dest, size16 size)
+        {
+            for (int y = 0; y < size.cy; y++)
+            {
+                for (int x = 0; x < size.cx; x++)
+                {
+                    dest[y * CX_ACTUAL(size.cx) + (size.cx - 1 - x)] = source[y * CX_ACTUAL(size.cx) + x];
+                }
+            }
+        }
+
+        static void _ReferenceRotate(const std::vector<uint8_t> &source, size16 sourceSize, std::vector<uint8_t> &dest, size16 destSize, double sinTheta, double cosTheta, uint8_t fillColor)
+        {
+            for (int y = 0; y < destSize.cy; y++)
+            {
+                for (int x = 0; x < destSize.cx; x++)
+                {
+                    int xSource = x;
+                    int ySource = y;
+                    TransformRotate(destSize.cx * 0.5, destSize.cy * 0.5, sourceSize.cx * 0.5, sourceSize.cy * 0.5, sinTheta, cosTheta, xSource, ySource);
+                    uint8_t color = fillColor;
+                    if ((xSource >= 0) && (xSource < sourceSize.cx) && (ySource >= 0) && (ySource < sourceSize.cy))
+                    {
+                        color = source[ySource * CX_ACTUAL(sourceSize.cx) + xSource];
+                    }
+                    dest[y * CX_ACTUAL(destSize.cx) + x] = color;
+                }
+            }
+        }
+
+        static std::vector<uint8_t> _RandomBits(size16 size, uint32_t seed)
+        {
+            std::vector<uint8_t> bits(CX_ACTUAL(size.cx) * size.cy);
+            for (uint8_t &b : bits)
+            {
+                seed = seed * 1664525 + 1013904223;
+                b = (uint8_t)(seed >> 24);
+            }
+            return bits;
+        }
+
+        // The size RotateGroup gives a cel of the given size.
+        static size16 _RotatedSize(size16 size, double sinTheta, double cosTheta)
+        {
+            int xMin = INT_MAX, yMin = INT_MAX, xMax = INT_MIN, yMax = INT_MIN;
+            point16 corners[4] = { point16(0, 0), point16(size.cx, 0), point16(size.cx, size.cy), point16(0, size.cy) };
+            for (point16 corner : corners)
+            {
+                int x = corner.x;
+                int y = corner.y;
+                TransformRotate(0, 0, 0, 0, sinTheta, cosTheta, x, y);
+                xMin = min(xMin, x);
+                yMin = min(yMin, y);
+                xMax = max(xMax, x);
+                yMax = max(yMax, y);
+            }
+            return size16((uint16_t)(xMax - xMin), (uint16_t)(yMax - yMin));
+        }
+
+        TEST_METHOD(TestCelKernelsMatchReference)
+        {
+            for (int cx = 1; cx <= 80; cx += 7)
+            {
+                for (int cy = 1; cy <= 60; cy += 5)
+                {
+                    size16 size((uint16_t)cx, (uint16_t)cy);
+                    std::vector<uint8_t> source = _RandomBits(size, cx * 100 + cy);
+
+                    for (int cxNew = 1; cxNew <= 130; cxNew += 9)
+                    {
+                        for (int cyNew = 1; cyNew <= 90; cyNew += 11)
+                        {
+                            size16 newSize((uint16_t)cxNew, (uint16_t)cyNew);
+                            std::vector<uint8_t> expected(CX_ACTUAL(cxNew) * cyNew);
+                            std::vector<uint8_t> actual(expected.size());
+                            _ReferenceStretch(source, size, expected, newSize);
+                            StretchCelBits(&source[0], size, CX_ACTUAL(cx), &actual[0], newSize, CX_ACTUAL(cxNew));
+                            Assert::IsTrue(expected == actual);
+                        }
+                    }
+
+                    std::vector<uint8_t> expected(source.size());
+                    std::vector<uint8_t> actual(source.size());
+                    _ReferenceMirror(source, expected, size);
+                    MirrorCelBits(&source[0], &actual[0], size, CX_ACTUAL(cx));
+                    Assert::IsTrue(expected == actual);
+
+                    // Every whole degree, which includes the exact multiples of 90 where ties in rounding are common.
+                    for (int degrees = -360; degrees <= 360; degrees++)
+                    {
+                        double sinTheta, cosTheta;
+                        _SinCos(-degrees, sinTheta, cosTheta);
+                        size16 newSize = _RotatedSize(size, sinTheta, cosTheta);
+                        if (newSize.cx && newSize.cy)
+                        {
+                            std::vector<uint8_t> expected(CX_ACTUAL(newSize.cx) * newSize.cy);
+                            std::vector<uint8_t> actual(expected.size());
+                            _ReferenceRotate(source, size, expected, newSize, -sinTheta, cosTheta, 7);
+                            RotateCelBits(&source[0], size, CX_ACTUAL(cx), &actual[0], newSize, CX_ACTUAL(newSize.cx), -sinTheta, cosTheta, 7);
+                            Assert::IsTrue(expected == actual);
+                        }
+                    }
+                }
+            }
+        }
+
+        TEST_METHOD(TestCelKernelsBenchmark)
+        {
+            size16 sizes[] = { size16(16, 16), size16(32, 32), size16(64, 64), size16(160, 100), size16(320, 200) };
+            for (size16 size : sizes)
+            {
+                std::vector<uint8_t> source = _RandomBits(size, 1);
+                size16 stretchSize(size.cx * 2, size.cy * 2);
+                std::vector<uint8_t> stretched(CX_ACTUAL(stretchSize.cx) * stretchSize.cy);
+                std::vector<uint8_t> mirrored(source.size());
+                double sinTheta, cosTheta;
+                _SinCos(30, sinTheta, cosTheta);
+                size16 rotateSize = _RotatedSize(size, -sinTheta, cosTheta);
+                std::vector<uint8_t> rotated(CX_ACTUAL(rotateSize.cx) * rotateSize.cy);
+
+                int repeat = max(1, 1000000 / (size.cx * size.cy));
+                auto time = [repeat](std::function<void()> func)
+                {
+                    auto start = std::chrono::high_resolution_clock::now();
+                    for (int i = 0; i < repeat; i++)
+                    {
+                        func();
+                    }
+                    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - start).count() / repeat;
+                };
+
+                std::wstring message = fmt::format(L"{0}x{1}: stretch {2}ns (reference {3}ns), mirror {4}ns (reference {5}ns), rotate {6}ns (reference {7}ns).",
+                    size.cx, size.cy,
+                    time([&]() { StretchCelBits(&source[0], size, CX_ACTUAL(size.cx), &stretched[0], stretchSize, CX_ACTUAL(stretchSize.cx)); }),
+                    time([&]() { _ReferenceStretch(source, size, stretched, stretchSize); }),
+                    time([&]() { MirrorCelBits(&source[0], &mirrored[0], size, CX_ACTUAL(size.cx)); }),
+                    time([&]() { _ReferenceMirror(source, mirrored, size); }),
+                    time([&]() { RotateCelBits(&source[0], size, CX_ACTUAL(size.cx), &rotated[0], rotateSize, CX_ACTUAL(rotateSize.cx), sinTheta, cosTheta, 0); }),
+                    time([&]() { _ReferenceRotate(source, size, rotated, rotateSize, sinTheta, cosTheta, 0); }));
+                Logger::WriteMessage(message.c_str());
+            }
+        }
+
+        TEST_METHOD(TestUpdateMirrorsOnlyCopiesChangedCels)
+        {
+            std::unique_ptr<ResourceEntity> view(CreateViewResource(sciVersion1_1));
+            RasterComponent &raster = view->GetComponent<RasterComponent>();
+            _AddBigCels(raster);
+            MakeMirrorOf(raster, 1, 0);
+            const RasterComponent &constRaster = raster;
+            const uint8_t *unchangedMirrorBits = constRaster.Loops[1].Cels[1].Data.data();
+
+            raster.Loops[0].Cels[0].Data[0] = 3;
+            UpdateMirrors(raster, 0);
+            // The changed cel is mirrored again, but the mirror of the unchanged one is left alone.
+            Assert::AreEqual(3, (int)constRaster.Loops[1].Cels[0].Data[319]);
+            Assert::IsTrue(unchangedMirrorBits == constRaster.Loops[1].Cels[1].Data.data());
+        }
+
+        TEST_METHOD(TestDPCMRandomAccess)
+        {
+            std::mt19937 random(1234);
+            // Include clips that are exact multiples of the checkpoint block size, and ones that are shorter than a block.
+            uint32_t sizes[] = { 1, 1023, DPCMSampleSource::DPCMBlockSize, DPCMSampleSource::DPCMBlockSize * 2, 3000, DPCMSampleSource::DPCMBlockSize * 4 };
+            for (bool sixteenBit : { false, true })
+            {
+                for (uint32_t compressedSize : sizes)
+                {
+                    std::vector<uint8_t> compressed(compressedSize);
+                    for (uint8_t &b : compressed)
+                    {
+                        b = (uint8_t)random();
+                    }
+                    sci::istream stream(&compressed[0], compressedSize);
+                    DPCMSampleSource source(stream, compressedSize, sixteenBit);
+                    const std::vector<uint8_t> &whole = source.GetDecoded();
+                    uint32_t size = source.GetDecodedSize();
+                    Assert::AreEqual((int)(compressedSize * 2), (int)whole.size());
+
+                    std::vector<std::pair<uint32_t, uint32_t>> ranges =
+                    {
+                        { 0, size },
+                        { size - 1, 1 },
+                        { size, 0 },
+                        { size / 2, size - size / 2 },
+                    };
+                    for (int i = 0; i < 200; i++)
+                    {
+                        uint32_t offset = random() % (size + 1);
+                        ranges.emplace_back(offset, random() % (size - offset + 1));
+                    }
+
+                    for (auto &range : ranges)
+                    {
+                        // Guard bytes on either side, to catch writes outside the range.
+                        std::vector<uint8_t> decoded(range.second + 2, 0xcd);
+                        source.Decode(range.first, &decoded[1], range.second);
+                        Assert::AreEqual(0xcd, (int)decoded.front());
+                        Assert::AreEqual(0xcd, (int)decoded.back());
+                        Assert::IsTrue(std::equal(whole.begin() + range.first, whole.begin() + range.first + range.second, decoded.begin() + 1));
+                    }
+                }
+            }
+        }
+
 	};
 }
\ No newline at end of file
@@ -20,6 +20,7 @@ GNU General Public License for more details.
 #include "Helper.h"
 #include "ScriptConvert.h"
 #include "ResourceContainer.h"
+#include "GameSnapshot.h"
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -71,14 +72,38 @@ namespace UnitTests
             return retrieve;
         }
 
+        // The snapshot's index should match what we get from enumerating the resources. Returns its generation.
+        uint32_t _VerifySnapshot()
+        {
+            std::shared_ptr<const GameSnapshot> snapshot = appState->GetResourceMap().GetSnapshot();
+            ResourceType types[] = { ResourceType::View, ResourceType::Pic, ResourceType::Sound };
+            int count = 0;
+            auto resourceContainer = appState->GetResourceMap().Resources(ResourceTypeFlags::View | ResourceTypeFlags::Pic | ResourceTypeFlags::Sound, ResourceEnumFlags::MostRecentOnly | ResourceEnumFlags::AddInDefaultEnumFlags);
+            for (auto it = resourceContainer->begin(); it != resourceContainer->end(); ++it)
+            {
+                const ResourceMapEntryAgnostic &entry = it.GetMapEntry();
+                Assert::IsTrue(snapshot->DoesResourceExist(entry.Type, entry.Number, entry.Base36Number));
+                count++;
+            }
+            int snapshotCount = 0;
+            for (ResourceType type : types)
+            {
+                snapshotCount += (int)snapshot->GetResourceNumbers(type).size();
+            }
+            Assert::AreEqual(count, snapshotCount);
+            return snapshot->GetGeneration();
+        }
+
         void _DoIt()
         {
             int count;
             std::unique_ptr<ResourceBlob> first = _Count(0, count);
             Assert::IsNotNull(first.get());
+            uint32_t generation = _VerifySnapshot();
 
             // Delete first guy
             appState->GetResourceMap().DeleteResource(first.get());
+            Assert::AreNotEqual(generation, _VerifySnapshot());
 
             // Count again, and this time retrieve the second item
             int count2;
@@ -19,7 +19,14 @@
 #include "AppState.h"
 #include "ResourceContainer.h"
 #include "Helper.h"
+#include "ContentHash.h"
+#include "MessageDatabase.h"
+#include "Text.h"
+#include "Message.h"
+#include "ThumbnailCache.h"
+#include "RoomExplorerView.h"
 #include "format.h"
+#include <chrono>
 
 using namespace Microsoft::VisualStudio::CppUnitTestFramework;
 
@@ -48,9 +55,228 @@ namespace UnitTests
             _DoIt();
         }
 
+        TEST_METHOD(TestContentHash)
+        {
+            // Reference values from XXH64, since these get persisted.
+            Assert::IsTrue(ComputeContentHash(nullptr, 0) == 0xef46db3751d8e999ULL);
+            Assert::IsTrue(ComputeContentHash(reinterpret_cast<const uint8_t*>("abc"), 3) == 0x44bc2cf5ad770999ULL);
+            std::vector<uint8_t> data;
+            for (int i = 0; i < 1024; i++)
+            {
+                data.push_back((uint8_t)i);
+            }
+            Assert::IsTrue(ComputeContentHash(data.data(), data.size()) == 0x6f3914f18fe4df57ULL);
+        }
+
+        TEST_METHOD(TestChecksumsSCI0)
+        {
+            _gameFolder = SetUpGameSCI0();
+            _HashAll();
+        }
+
+        TEST_METHOD(TestChecksumsSCI11)
+        {
+            _gameFolder = SetUpGameSCI11();
+            _HashAll();
+        }
+
+        TEST_METHOD(TestDelayedChecksumsSCI0)
+        {
+            _gameFolder = SetUpGameSCI0();
+            _CompareDelayedChecksums();
+        }
+
+        TEST_METHOD(TestDelayedChecksumsSCI11)
+        {
+            _gameFolder = SetUpGameSCI11();
+            _CompareDelayedChecksums();
+        }
+
+        TEST_METHOD(TestMessageDatabaseSCI11)
+        {
+            _gameFolder = SetUpGameSCI11();
+            const GameFolderHelper &helper = appState->GetResourceMap().Helper();
+
+            auto start = std::chrono::high_resolution_clock::now();
+            MessageDatabase serial;
+            serial.Load(helper, 1);
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+            std::wstring message = fmt::format(L"Indexed {0} message resources ({1} entries) in {2}ms.", serial.GetResourceNumbers().size(), serial.GetEntryCount(), elapsed.count());
+            Logger::WriteMessage(message.c_str());
+            Assert::IsTrue(serial.GetEntryCount() > 0);
+
+            MessageDatabase parallel;
+            parallel.Load(helper, max(2u, std::thread::hardware_concurrency()));
+            Assert::IsTrue(serial.GetResourceNumbers() == parallel.GetResourceNumbers());
+            Assert::AreEqual((int)serial.GetEntryCount(), (int)parallel.GetEntryCount());
+
+            // Every entry can be found by its tuple, talker and words.
+            for (int number : serial.GetResourceNumbers())
+            {
+                const TextComponent &text = *serial.GetMessage(number);
+                for (size_t i = 0; i < text.Texts.size(); i++)
+                {
+                    const TextEntry &entry = text.Texts[i];
+                    const TextEntry *found = parallel.Find(number, entry.Noun, entry.Verb, entry.Condition, entry.Sequence);
+                    Assert::IsNotNull(found);
+                    Assert::AreEqual(GetMessageTuple(entry), GetMessageTuple(*found));
+
+                    MessageEntryRef ref = { (uint16_t)number, (uint16_t)i };
+                    std::vector<MessageEntryRef> byTalker = parallel.FindByTalker(entry.Talker);
+                    Assert::IsTrue(std::binary_search(byTalker.begin(), byTalker.end(), ref));
+                }
+            }
+
+            // Text search agrees with a brute force search.
+            int number = serial.GetResourceNumbers().back();
+            const TextEntry &someEntry = serial.GetMessage(number)->Texts[0];
+            std::string what = someEntry.Text.substr(0, min((size_t)6, someEntry.Text.size()));
+            Assert::IsFalse(what.empty());
+            size_t bruteForceCount = 0;
+            for (int otherNumber : serial.GetResourceNumbers())
+            {
+                for (const TextEntry &entry : serial.GetMessage(otherNumber)->Texts)
+                {
+                    bruteForceCount += (entry.Text.find(what) != std::string::npos) ? 1 : 0;
+                }
+            }
+            Assert::AreEqual((int)bruteForceCount, (int)parallel.FindText(what, true, false).size());
+
+            // Updating a single resource only affects that resource.
+            std::unique_ptr<ResourceEntity> resource(CreateNewMessageResource(helper.Version, serial.GetMessage(number)->msgVersion));
+            TextEntry entry = {};
+            entry.Talker = 250;
+            entry.Text = "Zyzzyva";
+            resource->GetComponent<TextComponent>().Texts.push_back(entry);
+            size_t oldCount = parallel.GetMessage(number)->Texts.size();
+            parallel.Update(number, std::move(resource));
+            Assert::AreEqual((int)(serial.GetEntryCount() - oldCount + 1), (int)parallel.GetEntryCount());
+            Assert::AreEqual(1, (int)parallel.FindText("zyzzyva", false, true).size());
+            std::vector<MessageEntryRef> oldTalkers = serial.FindByTalker(250);
+            int otherTalkers = (int)std::count_if(oldTalkers.begin(), oldTalkers.end(), [number](const MessageEntryRef &ref) { return ref.ResourceNumber != number; });
+            Assert::AreEqual(otherTalkers + 1, (int)parallel.FindByTalker(250).size());
+            Assert::IsNotNull(parallel.Find(number, 0, 0, 0, 0));
+            Assert::IsNotNull(serial.Find(number, someEntry.Noun, someEntry.Verb, someEntry.Condition, someEntry.Sequence));
+        }
+
+        TEST_METHOD(TestThumbnailCache)
+        {
+            _gameFolder = SetUpGameSCI0();
+            std::string folder = appState->GetResourceMap().Helper().GetThumbnailCacheFolder();
+            std::string filename = folder + "\\test.thumbs";
+            ThumbnailKey key = { 0x1234, 0, 4, 2 };
+            ThumbnailKey otherKey = { 0x5678, 0, 4, 2 };
+            ThumbnailKey wrongSizeKey = { 0x9abc, 0, 8, 8 };
+            const uint8_t bits[] = { 0, 1, 2, 3, 3, 2, 1, 0 };
+            const RGBQUAD colors[] = { { 0, 0, 0, 0 }, { 255, 0, 0, 0 }, { 0, 255, 0, 0 }, { 0, 0, 255, 0 } };
+            {
+                ThumbnailCache cache(folder, filename);
+                Assert::IsFalse(_HasThumbnail(cache, key));
+                cache.Add(key, CSize(4, 2), bits, colors, ARRAYSIZE(colors));
+                cache.Add(otherKey, CSize(4, 2), bits, colors, ARRAYSIZE(colors));
+                cache.Add(wrongSizeKey, CSize(4, 2), bits, colors, ARRAYSIZE(colors));
+                Assert::IsTrue(_HasThumbnail(cache, key));
+                Assert::IsFalse(_HasThumbnail(cache, wrongSizeKey));
+            }
+
+            // Saved and loaded again.
+            {
+                ThumbnailCache cache(folder, filename);
+                CSize size;
+                std::vector<uint8_t> loadedBits;
+                std::vector<RGBQUAD> loadedColors;
+                Assert::IsTrue(cache.GetBits(key, size, loadedBits, loadedColors));
+                Assert::AreEqual(4, (int)size.cx);
+                Assert::AreEqual(2, (int)size.cy);
+                Assert::IsTrue(std::equal(loadedBits.begin(), loadedBits.end(), bits));
+                Assert::AreEqual((int)ARRAYSIZE(colors), (int)loadedColors.size());
+                Assert::IsTrue(memcmp(&loadedColors[0], colors, sizeof(colors)) == 0);
+                Assert::IsTrue(_HasThumbnail(cache, otherKey));
+                Assert::IsFalse(_HasThumbnail(cache, wrongSizeKey));
+            }
+
+            // A different version is ignored.
+            const size_t versionOffset = sizeof(uint32_t);
+            uint32_t version = _ReadFileValue<uint32_t>(filename, versionOffset);
+            _WriteFileValue<uint32_t>(filename, versionOffset, version + 1);
+            {
+                ThumbnailCache cache(folder, filename);
+                Assert::IsFalse(_HasThumbnail(cache, key));
+                Assert::IsFalse(_HasThumbnail(cache, otherKey));
+                // ...and the file is started over
+                cache.Add(key, CSize(4, 2), bits, colors, ARRAYSIZE(colors));
+                cache.Add(otherKey, CSize(4, 2), bits, colors, ARRAYSIZE(colors));
+            }
+            Assert::AreEqual(version, _ReadFileValue<uint32_t>(filename, versionOffset));
+
+            // A corrupt size in the first entry means neither it nor anything after it can be trusted.
+            const size_t firstWidthOffset = sizeof(uint32_t) * 2 + sizeof(ThumbnailKey);
+            _WriteFileValue<uint16_t>(filename, firstWidthOffset, 0xffff);
+            {
+                ThumbnailCache cache(folder, filename);
+                Assert::IsFalse(_HasThumbnail(cache, key));
+                Assert::IsFalse(_HasThumbnail(cache, otherKey));
+                cache.Add(otherKey, CSize(4, 2), bits, colors, ARRAYSIZE(colors));
+            }
+            {
+                ThumbnailCache cache(folder, filename);
+                Assert::IsFalse(_HasThumbnail(cache, key));
+                Assert::IsTrue(_HasThumbnail(cache, otherKey));
+            }
+        }
+
+        TEST_METHOD(TestRoomCompositeCache)
+        {
+            _gameFolder = SetUpGameSCI0();
+            std::string folder = appState->GetResourceMap().Helper().GetThumbnailCacheFolder();
+            std::string filename = folder + "\\rooms.thumbs";
+            auto container = appState->GetResourceMap().Resources(ResourceTypeFlags::Pic, ResourceEnumFlags::MostRecentOnly | ResourceEnumFlags::AddInDefaultEnumFlags);
+            std::unique_ptr<ResourceBlob> picBlob = *container->begin();
+            Assert::IsNotNull(picBlob.get());
+
+            CRoomExplorerWorkItem workItem(0);
+            workItem.blob = *picBlob;
+            workItem.snapshot = appState->GetResourceMap().GetSnapshot();
+            workItem.thumbnailCache = std::make_shared<ThumbnailCache>(folder, filename);
+            RoomComposite rendered;
+            Assert::IsTrue(GetRoomComposite(workItem, rendered));
+            Assert::IsFalse(rendered.bits.empty());
+            Assert::AreEqual((int)(rendered.size.cx * rendered.size.cy), (int)rendered.bits.size());
+
+            // It comes back the same from the file.
+            workItem.thumbnailCache.reset();
+            workItem.thumbnailCache = std::make_shared<ThumbnailCache>(folder, filename);
+            RoomComposite cached;
+            Assert::IsTrue(workItem.thumbnailCache->GetBits(GetRoomKey(workItem), cached.size, cached.bits, cached.colors));
+            Assert::IsTrue(rendered.size == cached.size);
+            Assert::IsTrue(rendered.bits == cached.bits);
+            // Only the colors that are used are kept.
+            uint8_t highestIndex = *std::max_element(rendered.bits.begin(), rendered.bits.end());
+            Assert::AreEqual((int)highestIndex + 1, (int)cached.colors.size());
+            Assert::IsTrue(memcmp(&rendered.colors[0], &cached.colors[0], cached.colors.size() * sizeof(RGBQUAD)) == 0);
+
+            // At full size, scaling just looks up the colors.
+            std::vector<RGBQUAD> scaled;
+            ScaleRoomComposite(cached, cached.size, scaled);
+            Assert::AreEqual((int)cached.bits.size(), (int)scaled.size());
+            for (size_t i = 0; i < cached.bits.size(); i++)
+            {
+                const RGBQUAD &color = cached.colors[cached.bits[i]];
+                Assert::IsTrue((scaled[i].rgbRed == color.rgbRed) && (scaled[i].rgbGreen == color.rgbGreen) && (scaled[i].rgbBlue == color.rgbBlue));
+            }
+            CSize third(cached.size.cx / 3, cached.size.cy / 3);
+            ScaleRoomComposite(cached, third, scaled);
+            Assert::AreEqual((int)(third.cx * third.cy), (int)scaled.size());
+        }
+
         TEST_METHOD_CLEANUP(TestLoadResources_Clean)
         {
-            CleanUpGame(_gameFolder);
+            // Not every test here sets up a game.
+            if (!_gameFolder.empty())
+            {
+                CleanUpGame(_gameFolder);
+                _gameFolder.clear();
+            }
         }
 
         void _DoIt()
@@ -70,6 +296,98 @@ namespace UnitTests
             }
         }
 
+        void _HashAll()
+        {
+            auto container = appState->GetResourceMap().Resources(ResourceTypeFlags::All, ResourceEnumFlags::AddInDefaultEnumFlags);
+            std::vector<std::unique_ptr<ResourceBlob>> blobs;
+            for (auto blob : *container)
+            {
+                blobs.push_back(std::move(blob));
+            }
+
+            size_t totalSize = 0;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (auto &blob : blobs)
+            {
+                blob->GetChecksum();
+                totalSize += blob->GetLength();
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+            std::wstring message = fmt::format(L"Hashed {0} resources ({1} bytes) in {2}ms.", blobs.size(), totalSize, elapsed.count());
+            Logger::WriteMessage(message.c_str());
+
+            // The checksum only depends on the data, so it's the same when the resources are loaded again.
+            auto containerAgain = appState->GetResourceMap().Resources(ResourceTypeFlags::All, ResourceEnumFlags::AddInDefaultEnumFlags);
+            size_t index = 0;
+            for (auto blob : *containerAgain)
+            {
+                Assert::IsTrue(index < blobs.size());
+                Assert::IsTrue(blob->GetChecksum() == blobs[index]->GetChecksum());
+                if (blob->GetDataCompressed() == nullptr)
+                {
+                    Assert::IsTrue(blob->GetChecksum() == ComputeContentHash(blob->GetData(), blob->GetLength()));
+                }
+                index++;
+            }
+            Assert::AreEqual((int)blobs.size(), (int)index);
+        }
+
+        static bool _HasThumbnail(const ThumbnailCache &cache, const ThumbnailKey &key)
+        {
+            CSize size;
+            std::vector<uint8_t> bits;
+            std::vector<RGBQUAD> colors;
+            return cache.GetBits(key, size, bits, colors);
+        }
+
+        template<typename _T>
+        static _T _ReadFileValue(const std::string &filename, size_t offset)
+        {
+            _T value = 0;
+            std::ifstream file(filename, std::ios_base::in | std::ios_base::binary);
+            file.seekg(offset);
+            Assert::IsTrue(!!file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+            return value;
+        }
+
+        template<typename _T>
+        static void _WriteFileValue(const std::string &filename, size_t offset, _T value)
+        {
+            std::fstream file(filename, std::ios_base::in | std::ios_base::out | std::ios_base::binary);
+            file.seekp(offset);
+            Assert::IsTrue(!!file.write(reinterpret_cast<const char*>(&value), sizeof(value)));
+        }
+
+        // The resource list enumerates blobs without decompressing them, and their checksums need to
+        // match those of the same resources loaded normally (e.g. when opened in a document).
+        void _CompareDelayedChecksums()
+        {
+            ResourceEnumFlags enumFlags = ResourceEnumFlags::MostRecentOnly | ResourceEnumFlags::AddInDefaultEnumFlags;
+            std::vector<uint64_t> delayedChecksums;
+            auto delayedContainer = appState->GetResourceMap().Resources(ResourceTypeFlags::All, enumFlags);
+            for (auto it = delayedContainer->begin(); it != delayedContainer->end(); ++it)
+            {
+                auto blob = it.CreateButDelayDecompression();
+                delayedChecksums.push_back(blob->GetChecksum());
+                // Getting the checksum shouldn't decompress the blob.
+                Assert::IsTrue((blob->GetDataCompressed() == nullptr) || IsFlagSet(blob->GetStatusFlags(), ResourceLoadStatusFlags::Delayed));
+            }
+
+            std::vector<uint64_t> checksums;
+            auto container = appState->GetResourceMap().Resources(ResourceTypeFlags::All, enumFlags);
+            for (auto &blob : *container)
+            {
+                checksums.push_back(blob->GetChecksum());
+            }
+
+            Assert::IsFalse(checksums.empty());
+            Assert::AreEqual((int)checksums.size(), (int)delayedChecksums.size());
+            for (size_t i = 0; i < checksums.size(); i++)
+            {
+                Assert::IsTrue(checksums[i] == delayedChecksums[i]);
+            }
+        }
+
     private:
         static std::string _gameFolder;
 
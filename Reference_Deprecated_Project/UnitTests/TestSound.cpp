@@ -0,0 +1,110 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+//#include "CppUnitTest.h"
+#include "Sound.h"
+#include "SoundOperations.h"
+#include "ResourceEntity.h"
+#include "format.h"
+#include <chrono>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+// Midi files used for the import benchmark. As with the game folder in TestAllGamesLoad, these can't be checked
+// in, so place your own standard midi files here (or change based on your needs):
+const char MidiCorpusFolder[] = "e:\\MidiFiles\\";
+
+SoundEvent MakeNoteOn(uint8_t channel, uint8_t note, DWORD timeDelta)
+{
+    SoundEvent event;
+    event.SetRawStatus(SoundEvent::NoteOn | channel);
+    event.bParam1 = note;
+    event.bParam2 = 64;
+    event.wTimeDelta = timeDelta;
+    return event;
+}
+
+namespace UnitTests
+{
+    TEST_CLASS(TestSound)
+    {
+    public:
+        TEST_METHOD(TestCombineSoundEventsOrder)
+        {
+            std::vector<std::vector<SoundEvent>> channels(3);
+            channels[0].push_back(MakeNoteOn(0, 1, 10));
+            channels[0].push_back(MakeNoteOn(0, 2, 5));     // @15
+            channels[1].push_back(MakeNoteOn(1, 3, 10));    // @10, ties with channel 0
+            channels[1].push_back(MakeNoteOn(1, 4, 10));    // @20
+            channels[2].push_back(MakeNoteOn(2, 5, 0));     // @0
+
+            std::vector<SoundEvent> combined;
+            DWORD totalTicks = CombineSoundEvents(channels, combined);
+            Assert::AreEqual((DWORD)20, totalTicks);
+            Assert::AreEqual((size_t)5, combined.size());
+
+            // Events at the same time are ordered by channel.
+            uint8_t expectedNotes[] = { 5, 1, 3, 2, 4 };
+            DWORD expectedDeltas[] = { 0, 10, 0, 5, 5 };
+            for (size_t i = 0; i < combined.size(); i++)
+            {
+                Assert::AreEqual(expectedNotes[i], combined[i].bParam1);
+                Assert::AreEqual(expectedDeltas[i], (DWORD)combined[i].wTimeDelta);
+            }
+        }
+
+        TEST_METHOD(TestMidiImportBenchmark)
+        {
+            std::vector<std::string> midiFiles;
+            std::string findString = MidiCorpusFolder;
+            findString += "*.mid";
+            WIN32_FIND_DATA findData = { 0 };
+            HANDLE hFind = FindFirstFile(findString.c_str(), &findData);
+            if (hFind != INVALID_HANDLE_VALUE)
+            {
+                BOOL ok = TRUE;
+                while (ok)
+                {
+                    midiFiles.push_back(std::string(MidiCorpusFolder) + findData.cFileName);
+                    ok = FindNextFile(hFind, &findData);
+                }
+                FindClose(hFind);
+            }
+
+            if (midiFiles.empty())
+            {
+                Logger::WriteMessage(L"Found no midi files.");
+                return;
+            }
+
+            std::vector<DeviceType> devices = { DeviceType::SCI1_GM, DeviceType::SCI1_Adlib };
+            auto start = std::chrono::high_resolution_clock::now();
+            size_t eventCount = 0;
+            for (const std::string &midiFile : midiFiles)
+            {
+                std::unique_ptr<ResourceEntity> resource(CreateSoundResource(sciVersion1_1));
+                SoundComponent &sound = resource->GetComponent<SoundComponent>();
+                InitializeFromMidi(sciVersion1_1, devices, sound, midiFile);
+                for (auto &channelInfo : sound.GetChannelInfos())
+                {
+                    eventCount += channelInfo.Events.size();
+                }
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+
+            std::wstring message = fmt::format(L"Imported {0} midi files ({1} events) in {2}ms.", midiFiles.size(), eventCount, elapsed.count());
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}
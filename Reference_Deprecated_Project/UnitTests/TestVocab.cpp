@@ -0,0 +1,171 @@
+/***************************************************************************
+    Copyright (c) 2015 Philip Fortier
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+***************************************************************************/
+#include "stdafx.h"
+//#include "CppUnitTest.h"
+#include "Vocab000.h"
+#include "VocabTrie.h"
+#include "ResourceEntity.h"
+#include "format.h"
+#include <chrono>
+
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+namespace UnitTests
+{
+    TEST_CLASS(TestVocab)
+    {
+    public:
+        // Four letter words, so none is a prefix of another.
+        static std::string _MakeWord(int index)
+        {
+            std::string word;
+            word += (char)('a' + (index % 26));
+            index /= 26;
+            word += (char)('a' + (index / 26) % 26);
+            word += (char)('a' + (index % 26));
+            word += 'e';
+            return word;
+        }
+
+        TEST_METHOD(TestVocabTrie)
+        {
+            VocabTrie trie;
+            trie.Insert("look", 1);
+            trie.Insert("lookup", 2);
+            trie.Insert("lock", 3);
+            trie.Insert("door", 4);
+            Assert::AreEqual(4, (int)trie.GetWordCount());
+
+            VocabTrie::WordGroup group;
+            Assert::IsTrue(trie.Find("lookup", group));
+            Assert::AreEqual(2, (int)group);
+            Assert::IsFalse(trie.Find("loo", group));
+
+            std::string word;
+            Assert::IsTrue(trie.FindBestPrefixMatch("loo", word, group));
+            Assert::AreEqual(std::string("look"), word);
+            Assert::IsTrue(trie.FindBestPrefixMatch("lookx", word, group));
+            Assert::AreEqual(std::string("lookup"), word);
+            Assert::IsTrue(trie.FindBestPrefixMatch("lod", word, group));
+            Assert::AreEqual(std::string("look"), word);
+            Assert::IsTrue(trie.FindBestPrefixMatch("dz", word, group));
+            Assert::AreEqual(std::string("door"), word);
+
+            std::vector<std::string> completions;
+            trie.GetCompletions("lo", completions, 10);
+            Assert::IsTrue(std::vector<std::string>({ "lock", "look", "lookup" }) == completions);
+            completions.clear();
+            trie.GetCompletions("lo", completions, 2);
+            Assert::IsTrue(std::vector<std::string>({ "lock", "look" }) == completions);
+
+            Assert::IsTrue(trie.Remove("look"));
+            Assert::IsFalse(trie.Remove("look"));
+            Assert::IsTrue(trie.Remove("lookup"));
+            Assert::IsFalse(trie.Find("look", group));
+            completions.clear();
+            trie.GetCompletions("lo", completions, 10);
+            Assert::IsTrue(std::vector<std::string>({ "lock" }) == completions);
+            trie.Insert("loom", 5);
+            Assert::IsTrue(trie.Find("loom", group));
+            Assert::AreEqual(5, (int)group);
+        }
+
+        TEST_METHOD(TestLoadAndEditLargeVocab)
+        {
+            const int WordCount = 10000;
+            const int GroupCount = 1000;
+
+            std::unique_ptr<ResourceEntity> source(CreateVocabResource(sciVersion0));
+            Vocab000 &sourceVocab = source->GetComponent<Vocab000>();
+
+            // Add the words in a scrambled order.
+            std::vector<Vocab000::WordGroup> groups;
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int i = 0; i < WordCount; i++)
+            {
+                std::string word = _MakeWord((i * 7919) % WordCount);
+                if (i < GroupCount)
+                {
+                    VocabChangeHint hint = sourceVocab.AddNewWord(word.c_str(), WordClass::Noun, false);
+                    groups.push_back((Vocab000::WordGroup)((DWORD)hint >> 16));
+                }
+                else
+                {
+                    VocabChangeHint hint = sourceVocab.AddWordToGroup(word.c_str(), groups[i % GroupCount], false);
+                    Assert::IsTrue(hint != VocabChangeHint::None);
+                }
+            }
+            auto addTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+            Assert::AreEqual(WordCount, (int)sourceVocab.GetWords().size());
+            Assert::IsTrue(std::is_sorted(sourceVocab.GetWords().begin(), sourceVocab.GetWords().end(), VocabWordLess()));
+
+            sci::ostream out;
+            source->WriteToTest(out, false, 0);
+
+            start = std::chrono::high_resolution_clock::now();
+            std::unique_ptr<ResourceEntity> loaded(CreateVocabResource(sciVersion0));
+            loaded->ReadFrom(sci::istream_from_ostream(out), std::map<BlobKey, uint32_t>());
+            auto loadTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+
+            Vocab000 &vocab = loaded->GetComponent<Vocab000>();
+            Assert::IsTrue(sourceVocab.GetWords() == vocab.GetWords());
+            Assert::AreEqual(GroupCount, (int)vocab.GetNumberOfGroups());
+            for (int i = 0; i < WordCount; i += 97)
+            {
+                std::string word = _MakeWord(i);
+                Vocab000::WordGroup group;
+                Assert::IsTrue(vocab.LookupWord(word, group));
+                Assert::AreEqual((int)group, (int)vocab.GroupFromString(word.c_str()));
+                Assert::AreEqual((int)group, (int)vocab.GroupFromString((word + "zz").c_str()));
+                Assert::AreEqual(sourceVocab.GetGroupWordString(group), vocab.GetGroupWordString(group));
+
+                std::vector<std::string> completions;
+                vocab.GetCompletions(word.substr(0, 3), completions, 100);
+                Assert::IsTrue(std::find(completions.begin(), completions.end(), word) != completions.end());
+                Assert::IsTrue(std::is_sorted(completions.begin(), completions.end()));
+            }
+
+            // Remove every other word, then put them back.
+            start = std::chrono::high_resolution_clock::now();
+            std::vector<std::pair<std::string, Vocab000::WordGroup>> removed;
+            for (int i = 0; i < WordCount; i += 2)
+            {
+                std::string word = _MakeWord(i);
+                Vocab000::WordGroup group;
+                Assert::IsTrue(vocab.LookupWord(word, group));
+                Assert::IsTrue(vocab.RemoveWord(word.c_str()) != VocabChangeHint::None);
+                removed.emplace_back(word, group);
+            }
+            Assert::AreEqual(WordCount / 2, (int)vocab.GetWords().size());
+            for (auto &wordAndGroup : removed)
+            {
+                if (vocab.GetGroupWordString(wordAndGroup.second).empty())
+                {
+                    // The whole group went away.
+                    vocab.AddNewWord(wordAndGroup.first.c_str(), WordClass::Noun, false);
+                }
+                else
+                {
+                    vocab.AddWordToGroup(wordAndGroup.first.c_str(), wordAndGroup.second, false);
+                }
+            }
+            auto editTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start);
+            Assert::IsTrue(sourceVocab.GetWords() == vocab.GetWords());
+
+            std::wstring message = fmt::format(L"{0} words: built in {1}ms, loaded in {2}ms, removed and re-added half in {3}ms.",
+                WordCount, addTime.count(), loadTime.count(), editTime.count());
+            Logger::WriteMessage(message.c_str());
+        }
+    };
+}